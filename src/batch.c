@@ -0,0 +1,257 @@
+/*
+ * microsim360 - Run a job stream without the front panel.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "logger.h"
+#include "device.h"
+#include "event.h"
+#include "cpu.h"
+#include "stats.h"
+#include "itimer.h"
+#include "conf.h"
+#include "journal.h"
+#include "checkpoint.h"
+#include "storage.h"
+#include "batch.h"
+#ifdef MACHINE_THREADS
+#include <SDL_thread.h>
+#endif
+
+#define BATCH_CHECK    (1 << 20)    /* Cycles between checks for end */
+
+MACHINE_LOCAL struct _batch batch = { 0, NULL, NULL, 4000000000ULL, NULL };
+
+static MACHINE_LOCAL long watch_pos;        /* Where last look at watch ended */
+
+int
+batch_until(const char *arg)
+{
+    const char  *p = strrchr(arg, ':');
+    char        *file;
+
+    if (p == NULL || p == arg || p[1] == '\0')
+        return 0;
+    if ((file = (char *)malloc((size_t)(p - arg) + 1)) == NULL)
+        return 0;
+    memcpy(file, arg, (size_t)(p - arg));
+    file[p - arg] = '\0';
+    batch.watch = file;
+    batch.until = p + 1;
+    return 1;
+}
+
+/* Look at what was added to watch file since last time for end text */
+static int
+job_done()
+{
+    FILE      *f;
+    char      *buf;
+    long       len;
+    long       start;
+    long       end;
+    size_t     n;
+    int        found;
+
+    if (batch.watch == NULL || (f = fopen(batch.watch, "rb")) == NULL)
+        return 0;
+    len = (long)strlen(batch.until);
+    (void)fseek(f, 0, SEEK_END);
+    end = ftell(f);
+    /* Back up so text split over two looks is still found */
+    start = (watch_pos > len) ? watch_pos - len : 0;
+    if (end <= start || (buf = (char *)malloc((size_t)(end - start) + 1)) == NULL) {
+        fclose(f);
+        return 0;
+    }
+    (void)fseek(f, start, SEEK_SET);
+    n = fread(buf, 1, (size_t)(end - start), f);
+    buf[n] = '\0';
+    fclose(f);
+    found = strstr(buf, batch.until) != NULL;
+    free(buf);
+    watch_pos = end;
+    return found;
+}
+
+static uint64_t
+host_ns()
+{
+    struct timespec  ts;
+
+    timespec_get(&ts, TIME_UTC);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* Step the system the same way the panel process thread does */
+void
+batch_step()
+{
+    step_count++;
+    if (journal_mode != JOURNAL_OFF)
+        journal_step();
+    debug_step();
+    (*step_cpu)();
+    step_disk();
+    step_disk();
+    advance();
+    checkpoint_step();
+}
+
+int
+run_batch()
+{
+    uint64_t   start_ns;
+    uint64_t   ns;
+    uint64_t   insts;
+    uint64_t   cycles;
+    double     secs;
+    int        done = 0;
+    int        i;
+    char       report[512];
+
+    if (step_cpu == NULL || set_load_unit == NULL) {
+        fprintf(stderr, "No CPU configured\n");
+        return 0;
+    }
+
+    /* Note end of any listing left from an earlier run */
+    if (batch.watch != NULL) {
+        FILE *f = fopen(batch.watch, "rb");
+        if (f != NULL) {
+            (void)fseek(f, 0, SEEK_END);
+            watch_pos = ftell(f);
+            fclose(f);
+        }
+    }
+
+    /* Front panel dials as the panel sets them at start up */
+    CHK_SW = 2;
+    RATE_SW = 1;
+    PROC_SW = 1;
+    POWER = 1;
+    SYS_RST = 1;
+    /* No host clock to follow, batch runs always tick in simulated time */
+    timer_realtime = 0;
+    timer_start();
+    for (i = 0; i < 100; i++)
+        batch_step();
+    (*set_load_unit)(batch.unit);
+    LOAD = 1;
+    /* Going back starts from here, with the IPL under way */
+    if (!checkpoint_start())
+        return 0;
+
+    insts = stats.insts;
+    cycles = step_count;
+    start_ns = host_ns();
+    while (!done && (step_count - cycles) < batch.max_cycles) {
+        if (debug_back != 0)
+            debug_go_back(&batch_step);
+        batch_step();
+        if ((step_count % BATCH_CHECK) == 0) {
+            done = job_done();
+            stats_poll();
+        }
+    }
+    ns = host_ns() - start_ns;
+    cycles = step_count - cycles;
+    insts = stats.insts - insts;
+    secs = (double)ns / 1e9;
+
+    /* One write, so reports from several machines do not mix */
+    snprintf(report, sizeof(report),
+           "job %s %s\ncycles %llu\ninsts %llu\nhost_secs %.3f\n"
+           "cycles_per_sec %.0f\nmips %.3f\n",
+           (batch.name != NULL) ? batch.name : "-", done ? "done" : "timeout",
+           (unsigned long long)cycles, (unsigned long long)insts, secs,
+           (secs > 0.0) ? (double)cycles / secs : 0.0,
+           (secs > 0.0) ? (double)insts / secs / 1e6 : 0.0);
+    fputs(report, stdout);
+    fflush(stdout);
+    POWER = 0;
+    return done;
+}
+
+#ifdef MACHINE_THREADS
+static struct _batch  farm_batch;   /* Settings shared by all jobs */
+
+/* Build and run one machine, all of it lives on this thread */
+static int
+farm_thread(void *data)
+{
+    struct _batch_job  *job = (struct _batch_job *)data;
+
+    batch = farm_batch;
+    batch.watch = NULL;
+    batch.until = NULL;
+    if (load_config(job->conf) == 0) {
+        fprintf(stderr, "error in configuration: %s\n", job->conf);
+        return 0;
+    }
+    if (job->until != NULL && batch_until(job->until) == 0) {
+        fprintf(stderr, "Bad end of job for %s: %s\n", job->conf, job->until);
+        return 0;
+    }
+    batch.name = (job->name != NULL) ? job->name : job->conf;
+    job->done = run_batch();
+    storage_dump_all();
+    system_shutdown();
+    return 0;
+}
+#endif
+
+int
+run_farm(struct _batch_job *jobs, int njobs)
+{
+#ifdef MACHINE_THREADS
+    SDL_Thread  **thrd;
+    int           done = 0;
+    int           i;
+
+    if ((thrd = (SDL_Thread **)calloc((size_t)njobs, sizeof(SDL_Thread *))) == NULL)
+        return 0;
+    farm_batch = batch;
+    for (i = 0; i < njobs; i++) {
+        jobs[i].done = 0;
+        thrd[i] = SDL_CreateThread(farm_thread, "Machine", &jobs[i]);
+        if (thrd[i] == NULL)
+            fprintf(stderr, "Unable to start %s: %s\n", jobs[i].conf, SDL_GetError());
+    }
+    for (i = 0; i < njobs; i++) {
+        if (thrd[i] != NULL)
+            SDL_WaitThread(thrd[i], NULL);
+        done += jobs[i].done;
+    }
+    free(thrd);
+    return done;
+#else
+    fprintf(stderr, "Several machines need a MACHINE_THREADS build\n");
+    return 0;
+#endif
+}
@@ -0,0 +1,73 @@
+/*
+ * microsim360 - Run a job stream without the front panel.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _BATCH_H_
+#define _BATCH_H_
+
+#include <stdint.h>
+#include "machine.h"
+
+/*
+ * Runs the configured system without the front panel: IPL from a unit,
+ * then step until a text shows up in a file written by a device, such
+ * as the printer listing, or until a cycle limit.  Reports the cycles
+ * and instructions run and the host time taken.
+ */
+
+struct _batch {
+    uint16_t          unit;         /* Unit to IPL from */
+    const char       *watch;        /* File to watch for end of job */
+    const char       *until;        /* Text ending job */
+    uint64_t          max_cycles;   /* Give up after this many cycles */
+    const char       *name;         /* Name of job for report */
+};
+
+extern MACHINE_LOCAL struct _batch  batch;
+
+/* Set end of job from "file:text", return 0 if not valid */
+int batch_until(const char *arg);
+
+/* Run job, return 1 if end of job text was seen */
+int run_batch();
+
+/* Run the system one step */
+void batch_step();
+
+/*
+ * Built with MACHINE_THREADS several configurations can be run at once,
+ * each machine on its own thread.  Every job uses the unit and cycle
+ * limit from batch, with its own end of job text and name.
+ */
+struct _batch_job {
+    char             *conf;         /* Configuration file */
+    const char       *until;        /* End of job as file:text, or NULL */
+    const char       *name;         /* Name of job for report */
+    int               done;         /* End of job text was seen */
+};
+
+/* Run each job on a thread, return number of jobs that finished */
+int run_farm(struct _batch_job *job, int njobs);
+
+#endif
@@ -78,17 +78,17 @@
 /*
  * Holds configutation file while reading.
  */
-FILE      *config;
+MACHINE_LOCAL FILE *config;
 
 /*
  * Holds the current line from configuration file.
  */
-char       line_buffer[1024];
+MACHINE_LOCAL char line_buffer[1024];
 
 /*
  * Pointer to where to grab next character from.
  */
-char      *line_ptr;
+MACHINE_LOCAL char *line_ptr;
 
 /* Define header to look for */
 DEV_LIST_SECTION struct _control model_list_start = {
@@ -397,6 +397,13 @@ load_config(char *name)
                                 return 0;
                              }
                              break;
+                   case OPT_TYPE:
+                             if ((devlist->create)(&opt) == 0) {
+                                fprintf(stderr, "Unable to set %s\n", opt.opt);
+                                fclose(config);
+                                return 0;
+                             }
+                             break;
                    default:
                              fprintf(stderr, "Unknown type %d\n", devlist->type);
                              break;
@@ -448,6 +455,12 @@ load_line(char *line)
                              return 0;
                           }
                           break;
+                case OPT_TYPE:
+                          if ((devlist->create)(&opt) == 0) {
+                             fprintf(stderr, "Unable to set %s\n", opt.opt);
+                             return 0;
+                          }
+                          break;
                 default:
                           fprintf(stderr, "Unknown type %d\n", devlist->type);
                           break;
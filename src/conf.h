@@ -46,6 +46,7 @@ struct _option {
 #define CTRL_TYPE    3
 #define UNIT_TYPE    4
 #define LOG_TYPE     5
+#define OPT_TYPE     6
 
 #define CHAR_OPT     1
 #define NUM_MOD      2
@@ -74,6 +75,11 @@ struct _option {
         STRINGIFY(LOG##opt), LOG_TYPE, 0, log##opt##_create, NULL, DEV_LIST_MAGIC, \
     }
 
+#define SIM_OPT_STRUCT(opt) \
+    DEV_LIST_SECTION struct _control sim_##opt = { \
+        STRINGIFY(opt), OPT_TYPE, 0, sim##opt##_create, NULL, DEV_LIST_MAGIC, \
+    }
+
 
 
 /* Example
@@ -93,6 +99,7 @@ struct _option {
  * 2841  190
  * 2311  190 file="system.ckd"
  * 2311  191 file="data.ckd" new label=111111
+ * timer rate=300 # Interval timer ticks, from simulated time.
  *
  */
 
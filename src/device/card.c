@@ -65,8 +65,15 @@
 #include <ctype.h>
 #include <string.h>
 #include <memory.h>
+#include <stddef.h>
 #include "logger.h"
 #include "card.h"
+#include "stats.h"
+#include "machine.h"
+#include "checkpoint.h"
+#include "iothread.h"
+
+#define PUNCH_BLOCK   8192          /* Bytes saved to file at a time */
 
 char *card_fmt_type[6] = { "AUTO", "ASCII", "EBCDIC", "BIN", "OCTAL", NULL};
 
@@ -232,9 +239,9 @@ static uint16_t ebcdic_to_hol_table[256] = {
 };
 
 /* Back tables which are automatically generated */
-static uint8_t  hol_to_ascii_table[4096];  /* Back conversion table */
+static MACHINE_LOCAL uint8_t  hol_to_ascii_table[4096];  /* Back conversion table */
 
-static uint16_t hol_to_ebcdic_table[4096];
+static MACHINE_LOCAL uint16_t hol_to_ebcdic_table[4096];
 
 /* Convert EBCDIC character into hollerith code */
 uint16_t
@@ -310,6 +317,7 @@ read_card(struct card_context *card_ctx, uint16_t (*image)[80])
         log_card("Read hopper binary\n");
     }
     card_ctx->hopper_pos++;
+    stats.cards_read++;
     memcpy(image, img, 80 * sizeof(uint16_t));
     return 1;
 }
@@ -502,16 +510,16 @@ _parse_card(struct card_context *card_ctx, struct _card_buffer *buf, uint16_t (*
 */
 
 
-static void
-_punch_card(struct card_context *card_ctx, uint16_t (*image)[80])
+static int
+_format_card(struct card_context *card_ctx, uint16_t (*image)[80], uint8_t *out)
 {
 /* Convert word record into column image */
 /* Check output type, if auto or text, try and convert record to bcd first */
 /* If failed and text report error and dump what we have */
 /* Else if binary or not convertable, dump as image */
+/* Return number of bytes put in out, at most 512 */
 
     /* Try to convert to text */
-    uint8_t             out[512];
     int                  i;
     int                  outp = 0;
     int                  mode = card_ctx->mode;
@@ -614,6 +622,16 @@ _punch_card(struct card_context *card_ctx, uint16_t (*image)[80])
         break;
     }
     card_ctx->hopper_pos++;
+    return outp;
+}
+
+static void
+_punch_card(struct card_context *card_ctx, uint16_t (*image)[80])
+{
+    uint8_t             out[512];
+    int                 outp;
+
+    outp = _format_card(card_ctx, image, out);
     fwrite(out, 1, outp, card_ctx->file);
 }
 
@@ -623,6 +641,9 @@ int
 read_deck(struct card_context *card_ctx, char *file_name)
 {
     struct _card_buffer   buf;
+    struct _io_req        req;
+    uint8_t               next[8192];
+    int                   more = 1;
     int                   i;
     int                   l;
     int                   cards = 0;
@@ -631,6 +652,7 @@ read_deck(struct card_context *card_ctx, char *file_name)
     buf.len = 0;
     buf.size = 0;
     buf.buffer[0] = 0; /* Initialize bufer to empty */
+    checkpoint_changed();
 
     free (card_ctx->file_name);
 	card_ctx->file_name = NULL;
@@ -659,16 +681,24 @@ read_deck(struct card_context *card_ctx, char *file_name)
        card_ctx->hopper_pos = 0;
     }
 
-    /* Slurp up requested file */
+    /* Slurp up requested file, reading each block while the cards
+       before it are parsed */
+    memset(&req, 0, sizeof(req));
+    io_start(&req, IO_READ, fileno(card_ctx->file), -1, next, sizeof(next));
     do {
         int                   j;
 
-        if (buf.len < 500 && !feof(card_ctx->file)) {
-            l = fread(&buf.buffer[buf.len], 1, 8192, card_ctx->file);
-            if (l < 0)
+        if (buf.len < 500 && more) {
+            l = io_wait(&req);
+            if (l < 0) {
                 r = -1;
-            else
+            } else if (l == 0) {
+                more = 0;
+            } else {
+                memcpy(&buf.buffer[buf.len], next, l);
                 buf.len += l;
+                io_start(&req, IO_READ, fileno(card_ctx->file), -1, next, sizeof(next));
+            }
         }
 
         /* Allocate space for some more cards if needed */
@@ -680,6 +710,7 @@ read_deck(struct card_context *card_ctx, char *file_name)
 				card_ctx->hopper_size = 0;
 				card_ctx->hopper_cards = 0;
                 log_warn("Out of memory reading deck\n");
+                (void)io_wait(&req);
 				return -1;
 			}
             memset((void *)&card_ctx->images[card_ctx->hopper_cards], 0,
@@ -701,6 +732,7 @@ read_deck(struct card_context *card_ctx, char *file_name)
     } while (buf.len > 0 && r == 1);
 
     /* If there is an error, free just read deck */
+    (void)io_wait(&req);
     fclose (card_ctx->file);
     card_ctx->file = 0;
     return r;
@@ -713,6 +745,7 @@ read_deck(struct card_context *card_ctx, char *file_name)
 void
 empty_cards(struct card_context *card_ctx)
 {
+    checkpoint_changed();
     /* Flush any cards in hopper out to file */
     if (card_ctx->file != NULL) {
         while (card_ctx->hopper_pos < card_ctx->hopper_cards) {
@@ -808,6 +841,7 @@ stack_card(struct card_context *card_ctx, uint16_t (*image)[80])
     /* Process one card */
     memcpy(&(*card_ctx->images)[card_ctx->hopper_cards], image, 80 * sizeof(uint16_t));
     card_ctx->hopper_cards++;
+    stats.cards_stacked++;
     if (card_ctx->file != NULL) {
         while (card_ctx->hopper_pos < card_ctx->hopper_cards) {
             _punch_card(card_ctx, &(*card_ctx->images)[card_ctx->hopper_pos]);
@@ -822,6 +856,12 @@ stack_card(struct card_context *card_ctx, uint16_t (*image)[80])
 int
 save_deck(struct card_context *card_ctx, char *file_name)
 {
+    uint8_t              blk[2][PUNCH_BLOCK + 512];
+    struct _io_req       req[2];
+    int                  b = 0;
+    int                  len = 0;
+    int                  r = 0;
+
     if (card_ctx->file) {
         fclose(card_ctx->file);
     }
@@ -838,11 +878,26 @@ save_deck(struct card_context *card_ctx, char *file_name)
 
 	strcpy(card_ctx->file_name, file_name);
 
+    /* Cards go in one block while the other is written */
+    memset(req, 0, sizeof(req));
     while (card_ctx->hopper_pos < card_ctx->hopper_cards) {
-        _punch_card(card_ctx, &(*card_ctx->images)[card_ctx->hopper_pos]);
+        len += _format_card(card_ctx, &(*card_ctx->images)[card_ctx->hopper_pos],
+                            &blk[b][len]);
+        if (len >= PUNCH_BLOCK || card_ctx->hopper_pos == card_ctx->hopper_cards) {
+            io_start(&req[b], IO_WRITE, fileno(card_ctx->file), -1, blk[b], len);
+            b ^= 1;
+            if (req[b].state != IO_IDLE && io_wait(&req[b]) != req[b].len)
+                r = -1;
+            len = 0;
+        }
     }
-    fflush(card_ctx->file);
-	return 0;
+    if (req[b ^ 1].state != IO_IDLE && io_wait(&req[b ^ 1]) != req[b ^ 1].len)
+        r = -1;
+    if (r != 0)
+        log_error("Unable to save deck %s\n", file_name);
+    /* Later cards are punched after the saved ones */
+    fseek(card_ctx->file, 0, SEEK_END);
+	return r;
 }
 
 /*
@@ -862,6 +917,18 @@ close_deck(struct card_context *card_ctx)
 	return 0;
 }
 
+/*
+ * Register hopper position for checkpoints.  The card images only
+ * change when a deck is loaded or emptied, which drops checkpoints.
+ */
+void
+checkpoint_card(struct card_context *card_ctx, const char *name)
+{
+    checkpoint_area(name, &card_ctx->hopper_cards,
+          offsetof(struct card_context, hopper_pos) + sizeof(int) -
+          offsetof(struct card_context, hopper_cards));
+}
+
 /*
  * Initialize a stacker. On first time also initialize back
  * conversion tables.
@@ -869,7 +936,7 @@ close_deck(struct card_context *card_ctx)
 struct card_context *
 init_card_context()
 {
-    static int           ebcdic_init = 0;
+    static MACHINE_LOCAL int ebcdic_init = 0;
     struct card_context *card_ctx;
 
 	if ((card_ctx = (struct card_context*)malloc(sizeof(struct card_context))) == NULL)
@@ -142,4 +142,7 @@ int close_deck(struct card_context *card_ctx);
 /* Initialize a card reader context */
 struct card_context *init_card_context();
 
+/* Register hopper position for checkpoints */
+void checkpoint_card(struct card_context *card_ctx, const char *name);
+
 #endif
@@ -0,0 +1,538 @@
+/*
+ * microsim360 - Machine checkpoints.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef _WIN32
+#include <io.h>
+#define ftruncate _chsize
+#endif
+#include "logger.h"
+#include "conf.h"
+#include "event.h"
+#include "stats.h"
+#include "itimer.h"
+#include "journal.h"
+#include "cpu.h"
+#include "iothread.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_SRC   16         /* Longest area name */
+
+struct _area {
+    char              name[CHECKPOINT_SRC];
+    uint8_t          *ptr;          /* Machine state */
+    int               size;         /* Size of state */
+    int               first;        /* Index of first page */
+    uint32_t         *dirty;        /* Bit map of blocks written, or NULL */
+    int               shift;        /* Bytes to block in dirty */
+};
+
+struct _hook {
+    void             *ctx;
+    uint64_t        (*save)(void *ctx);
+    void            (*restore)(void *ctx, uint64_t value);
+};
+
+/* Copy of one page of an area, shared by checkpoints it did not change in */
+struct _page {
+    int               refs;         /* Checkpoints using page */
+    int               len;          /* Bytes in page */
+    uint8_t           data[];
+};
+
+/* File contents written over after checkpoint */
+struct _undo {
+    struct _undo     *next;         /* Older undo */
+    int               fd;           /* File written */
+    long              pos;          /* Where written */
+    long              size;         /* Size of file before */
+    int               len;          /* Bytes saved */
+    uint8_t           data[];
+};
+
+struct _checkpoint {
+    struct _checkpoint *next;       /* Newer checkpoint */
+    struct _checkpoint *prev;       /* Older checkpoint */
+    uint64_t          step;         /* Step checkpoint taken after */
+    struct _page    **page;         /* Pages of all areas */
+    uint64_t         *hook;         /* Values from hooks */
+    struct _event    *events;       /* Pending events */
+    int               n_events;
+    struct _undo     *undo;         /* Files written since, newest first */
+};
+
+MACHINE_LOCAL uint64_t checkpoint_every;
+MACHINE_LOCAL size_t   checkpoint_memory = 64 * 1024 * 1024;
+MACHINE_LOCAL uint64_t checkpoint_due = UINT64_MAX;
+
+static MACHINE_LOCAL struct _area       *area;
+static MACHINE_LOCAL int                 areas;
+static MACHINE_LOCAL int                 pages;      /* Pages in all areas */
+static MACHINE_LOCAL struct _hook       *hook;
+static MACHINE_LOCAL int                 hooks;
+static MACHINE_LOCAL struct _checkpoint *oldest;
+static MACHINE_LOCAL struct _checkpoint *newest;
+static MACHINE_LOCAL int                 count;
+static MACHINE_LOCAL size_t              held;       /* Bytes held by checkpoints */
+static MACHINE_LOCAL int                 stale;      /* Areas changed since last */
+
+/* Put pages in areas, after areas change */
+static void
+number_pages()
+{
+    int     i;
+
+    pages = 0;
+    for (i = 0; i < areas; i++) {
+        area[i].first = pages;
+        pages += (area[i].size + CHECKPOINT_PAGE - 1) / CHECKPOINT_PAGE;
+    }
+}
+
+void
+checkpoint_area(const char *name, void *ptr, int size)
+{
+    struct _area  *n;
+    int            i;
+
+    for (i = 0; i < areas; i++) {
+        if (area[i].ptr == (uint8_t *)ptr)
+            break;
+    }
+    if (i == areas) {
+        if ((n = (struct _area *)realloc(area, (areas + 1) * sizeof(struct _area))) == NULL) {
+            log_error("Checkpoint has no room for %s\n", name);
+            return;
+        }
+        area = n;
+        areas++;
+    } else if (area[i].size == size) {
+        return;
+    }
+    strncpy(area[i].name, (name != NULL) ? name : "", CHECKPOINT_SRC - 1);
+    area[i].name[CHECKPOINT_SRC - 1] = '\0';
+    area[i].ptr = (uint8_t *)ptr;
+    area[i].size = size;
+    area[i].dirty = NULL;
+    number_pages();
+    stale = 1;
+}
+
+void
+checkpoint_forget(void *ptr)
+{
+    int     i;
+
+    for (i = 0; i < areas; i++) {
+        if (area[i].ptr == (uint8_t *)ptr) {
+            areas--;
+            memmove(&area[i], &area[i + 1], (areas - i) * sizeof(struct _area));
+            number_pages();
+            stale = 1;
+            return;
+        }
+    }
+}
+
+void
+checkpoint_dirty(void *ptr, uint32_t *map, int shift)
+{
+    int     i;
+
+    if ((1 << shift) < CHECKPOINT_PAGE)
+        return;
+    for (i = 0; i < areas; i++) {
+        if (area[i].ptr == (uint8_t *)ptr) {
+            area[i].dirty = map;
+            area[i].shift = shift;
+            return;
+        }
+    }
+}
+
+/* Set blocks of area to written or not */
+static void
+fill_dirty(struct _area *a, int v)
+{
+    int     blocks;
+
+    if (a->dirty != NULL) {
+        blocks = (a->size + (1 << a->shift) - 1) >> a->shift;
+        memset(a->dirty, v, ((blocks + 31) / 32) * sizeof(uint32_t));
+    }
+}
+
+void
+checkpoint_changed()
+{
+    stale = 1;
+}
+
+void
+checkpoint_hook(void *ctx, uint64_t (*save)(void *ctx),
+                void (*restore)(void *ctx, uint64_t value))
+{
+    struct _hook  *n;
+
+    if ((n = (struct _hook *)realloc(hook, (hooks + 1) * sizeof(struct _hook))) == NULL)
+        return;
+    hook = n;
+    hook[hooks].ctx = ctx;
+    hook[hooks].save = save;
+    hook[hooks].restore = restore;
+    hooks++;
+    stale = 1;
+}
+
+void
+checkpoint_file(int fd, long pos, int len)
+{
+    struct _undo  *u;
+    long           size;
+    int            r;
+
+    if (newest == NULL)
+        return;
+    /* Earlier writes must be in the file before it is copied */
+    io_sync();
+    size = (long)lseek(fd, 0, SEEK_END);
+    if (pos < 0)
+        pos = size;
+    /* Only the first write since the checkpoint matters, and nothing
+       past the old end of file needs saving */
+    for (u = newest->undo; u != NULL; u = u->next) {
+        if (u->fd == fd && ((u->pos == pos && u->len >= len) || pos >= u->size)) {
+            (void)lseek(fd, pos, SEEK_SET);
+            return;
+        }
+    }
+    if ((u = (struct _undo *)malloc(sizeof(struct _undo) + len)) == NULL) {
+        (void)lseek(fd, pos, SEEK_SET);
+        return;
+    }
+    (void)lseek(fd, pos, SEEK_SET);
+    r = (pos < size) ? (int)read(fd, u->data, len) : 0;
+    (void)lseek(fd, pos, SEEK_SET);
+    u->fd = fd;
+    u->pos = pos;
+    u->size = size;
+    u->len = (r < 0) ? 0 : r;
+    u->next = newest->undo;
+    newest->undo = u;
+    held += sizeof(struct _undo) + len;
+}
+
+/* Put file contents back as they were before checkpoint */
+static void
+undo_files(struct _checkpoint *c)
+{
+    struct _undo  *u;
+
+    while ((u = c->undo) != NULL) {
+        c->undo = u->next;
+        (void)lseek(u->fd, u->pos, SEEK_SET);
+        if (u->len > 0 && write(u->fd, u->data, u->len) != u->len)
+            log_error("Checkpoint unable to restore file\n");
+        (void)ftruncate(u->fd, u->size);
+        held -= sizeof(struct _undo) + u->len;
+        free(u);
+    }
+}
+
+static void
+release_page(struct _page *p)
+{
+    if (p != NULL && --p->refs == 0) {
+        held -= sizeof(struct _page) + p->len;
+        free(p);
+    }
+}
+
+/* Free checkpoint, file changes since it are kept */
+static void
+free_checkpoint(struct _checkpoint *c)
+{
+    struct _undo  *u;
+    int            i;
+
+    for (i = 0; i < pages; i++)
+        release_page(c->page[i]);
+    while ((u = c->undo) != NULL) {
+        c->undo = u->next;
+        held -= sizeof(struct _undo) + u->len;
+        free(u);
+    }
+    held -= c->n_events * sizeof(struct _event);
+    free(c->page);
+    free(c->hook);
+    free(c->events);
+    free(c);
+    count--;
+}
+
+/* Drop oldest checkpoint */
+static void
+drop_oldest()
+{
+    struct _checkpoint *c = oldest;
+
+    oldest = c->next;
+    if (oldest != NULL)
+        oldest->prev = NULL;
+    else
+        newest = NULL;
+    free_checkpoint(c);
+    if (oldest != NULL)
+        journal_discard(oldest->step);
+}
+
+/* Drop checkpoints newer than c */
+static void
+drop_newer(struct _checkpoint *c)
+{
+    struct _checkpoint *n;
+
+    while (newest != c) {
+        n = newest;
+        newest = n->prev;
+        newest->next = NULL;
+        free_checkpoint(n);
+    }
+}
+
+static void
+drop_all()
+{
+    while (oldest != NULL)
+        drop_oldest();
+    stale = 0;
+}
+
+void
+checkpoint_take()
+{
+    struct _checkpoint *c;
+    struct _page       *p;
+    struct _area       *a;
+    int                 i, j;
+
+    checkpoint_due = step_count + checkpoint_every;
+    if (stale)
+        drop_all();
+    /* Buffers being filled are part of the copy */
+    io_sync();
+    if ((c = (struct _checkpoint *)calloc(1, sizeof(struct _checkpoint))) == NULL)
+        return;
+    c->step = step_count;
+    c->page = (struct _page **)calloc(pages + 1, sizeof(struct _page *));
+    c->hook = (uint64_t *)calloc(hooks + 1, sizeof(uint64_t));
+    c->n_events = save_events(&c->events);
+    if (c->page == NULL || c->hook == NULL || c->n_events < 0) {
+        free(c->page);
+        free(c->hook);
+        free(c->events);
+        free(c);
+        return;
+    }
+    held += c->n_events * sizeof(struct _event);
+
+    /* Share each page that has not changed since last checkpoint, a
+       page in a block not written has not */
+    for (i = 0, a = area; i < areas; i++, a++) {
+        for (j = 0; (j * CHECKPOINT_PAGE) < a->size; j++) {
+            uint8_t  *data = a->ptr + (j * CHECKPOINT_PAGE);
+            int       len = a->size - (j * CHECKPOINT_PAGE);
+            int       pg = a->first + j;
+            int       clean = 0;
+
+            if (len > CHECKPOINT_PAGE)
+                len = CHECKPOINT_PAGE;
+            if (a->dirty != NULL) {
+                int   blk = (j * CHECKPOINT_PAGE) >> a->shift;
+
+                clean = (a->dirty[blk >> 5] & (1u << (blk & 0x1f))) == 0;
+            }
+            if (newest != NULL &&
+                   (clean || memcmp(newest->page[pg]->data, data, len) == 0)) {
+                p = newest->page[pg];
+            } else {
+                if ((p = (struct _page *)malloc(sizeof(struct _page) + len)) == NULL) {
+                    /* Pages already taken no longer show as written */
+                    for (j = 0; j < i; j++)
+                        fill_dirty(&area[j], 0xff);
+                    c->prev = NULL;
+                    count++;
+                    free_checkpoint(c);
+                    return;
+                }
+                p->refs = 0;
+                p->len = len;
+                memcpy(p->data, data, len);
+                held += sizeof(struct _page) + len;
+            }
+            p->refs++;
+            c->page[pg] = p;
+        }
+        fill_dirty(a, 0);
+    }
+    for (i = 0; i < hooks; i++)
+        c->hook[i] = (*hook[i].save)(hook[i].ctx);
+
+    c->prev = newest;
+    if (newest != NULL)
+        newest->next = c;
+    else
+        oldest = c;
+    newest = c;
+    count++;
+    while (held > checkpoint_memory && oldest != newest)
+        drop_oldest();
+}
+
+/* Put machine back as it was at checkpoint c */
+static void
+restore(struct _checkpoint *c)
+{
+    struct _checkpoint *n;
+    struct _area       *a;
+    int                 i, j;
+
+    /* Nothing may still be going to files or buffers */
+    io_sync();
+    /* Files go back newest change first */
+    for (n = newest; n != c; n = n->prev)
+        undo_files(n);
+    undo_files(c);
+    drop_newer(c);
+    for (i = 0, a = area; i < areas; i++, a++) {
+        for (j = 0; (j * CHECKPOINT_PAGE) < a->size; j++) {
+            struct _page *p = c->page[a->first + j];
+
+            memcpy(a->ptr + (j * CHECKPOINT_PAGE), p->data, p->len);
+        }
+        fill_dirty(a, 0);
+    }
+    for (i = 0; i < hooks; i++)
+        (*hook[i].restore)(hook[i].ctx, c->hook[i]);
+    restore_events(c->events, c->n_events);
+    step_count = c->step;
+    checkpoint_due = step_count + checkpoint_every;
+}
+
+int
+checkpoint_back(uint64_t step, void (*run)())
+{
+    struct _checkpoint *c;
+
+    if (stale)
+        drop_all();
+    for (c = newest; c != NULL && c->step > step; c = c->prev);
+    if (c == NULL) {
+        log_warn("No checkpoint before step %" PRIu64 "\n", step);
+        return 0;
+    }
+    log_info("Back to checkpoint at %" PRIu64 " for %" PRIu64 "\n", c->step, step);
+    restore(c);
+    journal_rewind(c->step);
+    while (step_count < step)
+        (*run)();
+    journal_truncate(step);
+    return 1;
+}
+
+int
+checkpoint_start()
+{
+    if (checkpoint_every == 0)
+        return 1;
+    checkpoint_switches();
+    checkpoint_area("stats", &stats, sizeof(stats));
+    checkpoint_area("timer", &timer_event, sizeof(timer_event));
+    /* Inputs between checkpoints are needed to run forward again */
+    if (journal_mode == JOURNAL_OFF) {
+        journal_switches();
+        if (!journal_record(NULL))
+            return 0;
+    }
+    journal_keep = 1;
+    checkpoint_take();
+    return 1;
+}
+
+void
+checkpoint_stop()
+{
+    drop_all();
+    checkpoint_due = UINT64_MAX;
+}
+
+int
+checkpoint_count()
+{
+    return count;
+}
+
+uint64_t
+checkpoint_oldest()
+{
+    return (oldest != NULL) ? oldest->step : 0;
+}
+
+int
+simCHECKPOINT_create(struct _option *opt)
+{
+    struct _option   opts;
+    int              v;
+
+    checkpoint_every = 10000000;
+    while (get_option(&opts)) {
+        if (strcmp(opts.opt, "EVERY") == 0 && opts.flags == 1) {
+            if (!get_integer(&opts, &v) || v == 0) {
+                fprintf(stderr, "Checkpoint every needs millions of steps\n");
+                return 0;
+            }
+            checkpoint_every = (uint64_t)v * 1000000;
+        } else if (strcmp(opts.opt, "MEMORY") == 0 && opts.flags == 1) {
+            if (!get_integer(&opts, &v) || v == 0) {
+                fprintf(stderr, "Checkpoint memory needs megabytes\n");
+                return 0;
+            }
+            checkpoint_memory = (size_t)v * 1024 * 1024;
+        } else {
+            fprintf(stderr, "Invalid option %s to checkpoint\n", opts.opt);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+SIM_OPT_STRUCT(CHECKPOINT);
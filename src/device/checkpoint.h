@@ -0,0 +1,100 @@
+/*
+ * microsim360 - Machine checkpoints.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "machine.h"
+
+/*
+ * Checkpoints let a run be put back to an earlier step.  Every
+ * checkpoint_every steps the machine is copied: the areas of memory
+ * registered with checkpoint_area, the pending events, and values kept
+ * by device hooks.  Areas are copied in pages, and a page that has not
+ * changed since the last checkpoint is shared with it, so a checkpoint
+ * costs about what changed.  Devices call checkpoint_file before they
+ * overwrite part of a host file, so what was there can be put back.
+ *
+ * checkpoint_back restores the last checkpoint at or before a step and
+ * runs forward to it, with inputs taken from the journal so the run
+ * goes the same way.  When checkpoints hold more than checkpoint_memory
+ * bytes the oldest are dropped.
+ *
+ * Configured with:  checkpoint every=<million steps> memory=<megabytes>
+ */
+
+#define CHECKPOINT_PAGE   2048       /* Size of page shared between checkpoints */
+
+extern MACHINE_LOCAL uint64_t checkpoint_every;   /* Steps between checkpoints */
+extern MACHINE_LOCAL size_t   checkpoint_memory;  /* Bytes checkpoints may hold */
+extern MACHINE_LOCAL uint64_t checkpoint_due;     /* Step of next checkpoint */
+
+/* Register machine state at ptr, it must stay put until forgotten */
+void checkpoint_area(const char *name, void *ptr, int size);
+
+/* Bit map of blocks of area at ptr written since the last checkpoint,
+   each block 1 << shift bytes, at least a page.  Pages in blocks not
+   written are not looked at */
+void checkpoint_dirty(void *ptr, uint32_t *map, int shift);
+
+/* Stop copying area at ptr, before it is freed */
+void checkpoint_forget(void *ptr);
+
+/* Device attached or changed files, earlier checkpoints are no good */
+void checkpoint_changed();
+
+/* Register state held outside memory, like a file position */
+void checkpoint_hook(void *ctx, uint64_t (*save)(void *ctx),
+                     void (*restore)(void *ctx, uint64_t value));
+
+/* Save len bytes at pos of file fd before they are written over, pos
+   of -1 for data added at end of file.  Leaves fd positioned at pos */
+void checkpoint_file(int fd, long pos, int len);
+
+/* Start taking checkpoints, if configured */
+int  checkpoint_start();
+
+/* Drop all checkpoints and stop taking them */
+void checkpoint_stop();
+
+/* Take a checkpoint of the machine now */
+void checkpoint_take();
+
+/* Called after each step */
+#define checkpoint_step()  if (step_count >= checkpoint_due) checkpoint_take()
+
+/* Put machine back to step, running forward from last checkpoint with
+   run.  Return 0 if there is no checkpoint before step */
+int  checkpoint_back(uint64_t step, void (*run)());
+
+/* Number of checkpoints held */
+int  checkpoint_count();
+
+/* Step of oldest checkpoint */
+uint64_t checkpoint_oldest();
+
+#endif
@@ -27,56 +27,119 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "cpu.h"
+#include "journal.h"
+#include "checkpoint.h"
 
-int      SYS_RST;
-int      ROAR_RST;
-int      START;
-int      SET_IC;
-int      CHECK_RST;
-int      STOP;
-int      INT_TMR;
-int      STORE;
-int      DISPLAY;
-int      LAMP_TEST;
-int      POWER;
-int      INTR;
-int      LOAD;
-int      timer_event;
-uint32_t ADR_CMP;
-uint32_t INST_REP;
-uint32_t ROS_CMP;
-uint32_t ROS_REP;
-uint32_t SAR_CMP;
-uint32_t FORC_IND;
-uint32_t FLT_MODE;
-uint32_t CHN_MODE;
-uint8_t  SEL_SW;
-int      SEL_ENTER;
+MACHINE_LOCAL int      SYS_RST;
+MACHINE_LOCAL int      ROAR_RST;
+MACHINE_LOCAL int      START;
+MACHINE_LOCAL int      SET_IC;
+MACHINE_LOCAL int      CHECK_RST;
+MACHINE_LOCAL int      STOP;
+MACHINE_LOCAL int      INT_TMR;
+MACHINE_LOCAL int      STORE;
+MACHINE_LOCAL int      DISPLAY;
+MACHINE_LOCAL int      LAMP_TEST;
+MACHINE_LOCAL int      POWER;
+MACHINE_LOCAL int      INTR;
+MACHINE_LOCAL int      LOAD;
+MACHINE_LOCAL uint32_t ADR_CMP;
+MACHINE_LOCAL uint32_t INST_REP;
+MACHINE_LOCAL uint32_t ROS_CMP;
+MACHINE_LOCAL uint32_t ROS_REP;
+MACHINE_LOCAL uint32_t SAR_CMP;
+MACHINE_LOCAL uint32_t FORC_IND;
+MACHINE_LOCAL uint32_t FLT_MODE;
+MACHINE_LOCAL uint32_t CHN_MODE;
+MACHINE_LOCAL uint8_t  SEL_SW;
+MACHINE_LOCAL int      SEL_ENTER;
 
-uint8_t  A_SW;
-uint8_t  B_SW;
-uint8_t  C_SW;
-uint8_t  D_SW;
-uint8_t  E_SW;
-uint8_t  F_SW;
-uint8_t  G_SW;
-uint8_t  H_SW;
-uint8_t  J_SW;
+MACHINE_LOCAL uint8_t  A_SW;
+MACHINE_LOCAL uint8_t  B_SW;
+MACHINE_LOCAL uint8_t  C_SW;
+MACHINE_LOCAL uint8_t  D_SW;
+MACHINE_LOCAL uint8_t  E_SW;
+MACHINE_LOCAL uint8_t  F_SW;
+MACHINE_LOCAL uint8_t  G_SW;
+MACHINE_LOCAL uint8_t  H_SW;
+MACHINE_LOCAL uint8_t  J_SW;
 
-uint8_t  PROC_SW;
-uint8_t  RATE_SW;
-uint8_t  CHK_SW;
-uint8_t  MATCH_SW;
-uint8_t  STORE_SW;
+MACHINE_LOCAL uint8_t  PROC_SW;
+MACHINE_LOCAL uint8_t  RATE_SW;
+MACHINE_LOCAL uint8_t  CHK_SW;
+MACHINE_LOCAL uint8_t  MATCH_SW;
+MACHINE_LOCAL uint8_t  STORE_SW;
 
-uint8_t  wait;
-uint8_t  test_mode;
-uint8_t  load_mode;
+MACHINE_LOCAL uint8_t  wait;
+MACHINE_LOCAL uint8_t  test_mode;
+MACHINE_LOCAL uint8_t  load_mode;
 
-char *title = NULL;
+MACHINE_LOCAL char *title = NULL;
 
-void *(*setup_cpu)(char *title) = NULL;
+MACHINE_LOCAL void *(*setup_cpu)(char *title) = NULL;
 
-void (*step_cpu)() = NULL;
+MACHINE_LOCAL void (*step_cpu)() = NULL;
 
+MACHINE_LOCAL void (*set_load_unit)(uint16_t addr) = NULL;
 
+/* Call fn for each panel switch common to all models */
+#define SWITCH(v)    (*fn)(#v, &v, sizeof(v))
+
+static void
+each_switch(void (*fn)(const char *name, void *value, int size))
+{
+    SWITCH(SYS_RST);
+    SWITCH(ROAR_RST);
+    SWITCH(START);
+    SWITCH(SET_IC);
+    SWITCH(CHECK_RST);
+    SWITCH(STOP);
+    SWITCH(INT_TMR);
+    SWITCH(STORE);
+    SWITCH(DISPLAY);
+    SWITCH(LAMP_TEST);
+    SWITCH(POWER);
+    SWITCH(INTR);
+    SWITCH(LOAD);
+    SWITCH(ADR_CMP);
+    SWITCH(INST_REP);
+    SWITCH(ROS_CMP);
+    SWITCH(ROS_REP);
+    SWITCH(SAR_CMP);
+    SWITCH(FORC_IND);
+    SWITCH(FLT_MODE);
+    SWITCH(CHN_MODE);
+    SWITCH(SEL_SW);
+    SWITCH(SEL_ENTER);
+    SWITCH(A_SW);
+    SWITCH(B_SW);
+    SWITCH(C_SW);
+    SWITCH(D_SW);
+    SWITCH(E_SW);
+    SWITCH(F_SW);
+    SWITCH(G_SW);
+    SWITCH(H_SW);
+    SWITCH(J_SW);
+    SWITCH(PROC_SW);
+    SWITCH(RATE_SW);
+    SWITCH(CHK_SW);
+    SWITCH(MATCH_SW);
+    SWITCH(STORE_SW);
+}
+
+/* Panel switches are journal inputs */
+void
+journal_switches()
+{
+    each_switch(&journal_watch);
+}
+
+/* Switches and lamps the models share are part of the machine */
+void
+checkpoint_switches()
+{
+    each_switch(&checkpoint_area);
+    checkpoint_area("wait", &wait, sizeof(wait));
+    checkpoint_area("test_mode", &test_mode, sizeof(test_mode));
+    checkpoint_area("load_mode", &load_mode, sizeof(load_mode));
+}
@@ -25,62 +25,113 @@
 
 
 #include <stdint.h>
+#include "machine.h"
+#include "debugger.h"
 
 #ifndef _CPU_H_
 #define _CPU_H_
 
-extern int      SYS_RST;
-extern int      ROAR_RST;
-extern int      START;
-extern int      SET_IC;
-extern int      CHECK_RST;
-extern int      STOP;
-extern int      INT_TMR;
-extern int      STORE;
-extern int      DISPLAY;
-extern int      LAMP_TEST;
-extern int      POWER;
-extern int      INTR;
-extern int      LOAD;
-extern int      timer_event;
-extern uint32_t ADR_CMP;
-extern uint32_t INST_REP;
-extern uint32_t ROS_CMP;
-extern uint32_t ROS_REP;
-extern uint32_t SAR_CMP;
-extern uint32_t FORC_IND;
-extern uint32_t FLT_MODE;
-extern uint32_t CHN_MODE;
-extern uint8_t  SEL_SW;
-extern int      SEL_ENTER;
-
-extern uint8_t  A_SW;
-extern uint8_t  B_SW;
-extern uint8_t  C_SW;
-extern uint8_t  D_SW;
-extern uint8_t  E_SW;
-extern uint8_t  F_SW;
-extern uint8_t  G_SW;
-extern uint8_t  H_SW;
-extern uint8_t  J_SW;
-
-extern uint8_t  PROC_SW;
-extern uint8_t  RATE_SW;
-extern uint8_t  CHK_SW;
-extern uint8_t  MATCH_SW;
-extern uint8_t  STORE_SW;
-
-extern uint8_t  wait;
-extern uint8_t  test_mode;
-extern uint8_t  load_mode;
-
-extern uint32_t *M;
-extern uint32_t mem_max;     /* 8K = 0x1FFF, 16K = 0x3FFF, 32K = 0x7FF, 64k = 0xFFFF */
-
-extern char *title;
-
-extern void *(*setup_cpu)(char *title);
-
-extern void (*step_cpu)();
+extern MACHINE_LOCAL int      SYS_RST;
+extern MACHINE_LOCAL int      ROAR_RST;
+extern MACHINE_LOCAL int      START;
+extern MACHINE_LOCAL int      SET_IC;
+extern MACHINE_LOCAL int      CHECK_RST;
+extern MACHINE_LOCAL int      STOP;
+extern MACHINE_LOCAL int      INT_TMR;
+extern MACHINE_LOCAL int      STORE;
+extern MACHINE_LOCAL int      DISPLAY;
+extern MACHINE_LOCAL int      LAMP_TEST;
+extern MACHINE_LOCAL int      POWER;
+extern MACHINE_LOCAL int      INTR;
+extern MACHINE_LOCAL int      LOAD;
+extern MACHINE_LOCAL int      timer_event;
+extern MACHINE_LOCAL uint32_t ADR_CMP;
+extern MACHINE_LOCAL uint32_t INST_REP;
+extern MACHINE_LOCAL uint32_t ROS_CMP;
+extern MACHINE_LOCAL uint32_t ROS_REP;
+extern MACHINE_LOCAL uint32_t SAR_CMP;
+extern MACHINE_LOCAL uint32_t FORC_IND;
+extern MACHINE_LOCAL uint32_t FLT_MODE;
+extern MACHINE_LOCAL uint32_t CHN_MODE;
+extern MACHINE_LOCAL uint8_t  SEL_SW;
+extern MACHINE_LOCAL int      SEL_ENTER;
+
+extern MACHINE_LOCAL uint8_t  A_SW;
+extern MACHINE_LOCAL uint8_t  B_SW;
+extern MACHINE_LOCAL uint8_t  C_SW;
+extern MACHINE_LOCAL uint8_t  D_SW;
+extern MACHINE_LOCAL uint8_t  E_SW;
+extern MACHINE_LOCAL uint8_t  F_SW;
+extern MACHINE_LOCAL uint8_t  G_SW;
+extern MACHINE_LOCAL uint8_t  H_SW;
+extern MACHINE_LOCAL uint8_t  J_SW;
+
+extern MACHINE_LOCAL uint8_t  PROC_SW;
+extern MACHINE_LOCAL uint8_t  RATE_SW;
+extern MACHINE_LOCAL uint8_t  CHK_SW;
+extern MACHINE_LOCAL uint8_t  MATCH_SW;
+extern MACHINE_LOCAL uint8_t  STORE_SW;
+
+extern MACHINE_LOCAL uint8_t  wait;
+extern MACHINE_LOCAL uint8_t  test_mode;
+extern MACHINE_LOCAL uint8_t  load_mode;
+
+extern MACHINE_LOCAL uint32_t *M;
+extern MACHINE_LOCAL uint32_t mem_max;     /* 8K = 0x1FFF, 16K = 0x3FFF, 32K = 0x7FF, 64k = 0xFFFF */
+
+/*
+ * Main storage is marked written in 2K blocks, the size of a storage
+ * protect block, with a bit per block in M_dirty.  Anything that keeps
+ * copies of storage, like checkpoints, need only look at the blocks
+ * written since it last cleared the bits.  The CPU stores with
+ * store_main so nothing is missed.
+ */
+#define STORE_BLOCK     2048                /* Bytes in a storage block */
+
+extern MACHINE_LOCAL uint32_t *M_dirty;     /* Bit set for block written */
+extern MACHINE_LOCAL int       M_shift;     /* Index in M to block number */
+
+/* Write value to M[index] */
+static inline void
+store_main(uint32_t index, uint32_t value)
+{
+    uint32_t   blk = index >> M_shift;
+
+    M[index] = value;
+    M_dirty[blk >> 5] |= 1u << (blk & 0x1f);
+    if (DEBUG_BIT(debug_write, blk))
+        debug_storage(index << (11 - M_shift), 1 << (11 - M_shift), DEBUG_WRITE);
+}
+
+/* Read M[index] */
+static inline uint32_t
+load_main(uint32_t index)
+{
+    uint32_t   blk = index >> M_shift;
+
+    if (DEBUG_BIT(debug_read, blk))
+        debug_storage(index << (11 - M_shift), 1 << (11 - M_shift), DEBUG_READ);
+    return M[index];
+}
+
+/* Set up M_dirty for size entries of M, each holding bytes of storage */
+int  storage_track(uint32_t size, int bytes);
+
+/* Mark all of storage written, after it was changed behind store_main */
+void storage_all_dirty();
+
+extern MACHINE_LOCAL char *title;
+
+extern MACHINE_LOCAL void *(*setup_cpu)(char *title);
+
+extern MACHINE_LOCAL void (*step_cpu)();
+
+extern MACHINE_LOCAL void (*set_load_unit)(uint16_t addr);
+
+/* Register the panel switches as journal inputs */
+void journal_switches();
+
+/* Register the panel switches as checkpoint areas */
+void checkpoint_switches();
 
 #endif
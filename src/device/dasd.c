@@ -112,6 +112,9 @@
 #include "logger.h"
 #include "dasd.h"
 #include "xlat.h"
+#include "stats.h"
+#include "checkpoint.h"
+#include "iothread.h"
 
 
 #define BIT0    0x80
@@ -254,6 +257,63 @@ static uint8_t gap3[] = {
  *  Bit 7            Seek in progress.
  */
 
+/* Wait for last cylinder to be written back */
+static void
+cyl_written(struct _dasd_t *dasd)
+{
+    int                 r;
+
+    if (dasd->wio.state == IO_IDLE)
+        return;
+    r = io_wait(&dasd->wio);
+    if (r != dasd->wio.len) {
+        log_error("Disk write on %s %d\n", dasd->file_name, r);
+    }
+}
+
+/* Wait for cylinder to be read in */
+static void
+cyl_wait(struct _dasd_t *dasd)
+{
+    struct _io_req     *io = &dasd->io;
+    int                 r;
+
+    /* Swapped back to a buffer that is still being written out */
+    if (dasd->wio.buf == dasd->cbuf)
+        cyl_written(dasd);
+    if (dasd->nread) {
+        io = &dasd->nio;
+        dasd->nread = 0;
+    }
+    if (io->state == IO_IDLE)
+        return;
+    r = io_wait(io);
+    if (r != io->len) {
+        log_error("Disk read on %s %d\n", dasd->file_name, r);
+    }
+}
+
+/*
+ * Start reading the cylinder the arm is going to, so it is there when
+ * the seek finishes.  Only nbuf is read into, the current cylinder
+ * can still be used.
+ */
+static void
+cyl_prefetch(struct _dasd_t *dasd)
+{
+    uint32_t            tsize = dasd->tsize * disk_type[dasd->type].heads;
+
+    if (dasd->nbuf == NULL || dasd->ncyl == dasd->cyl || dasd->ncyl == dasd->pcyl)
+        return;
+    /* Collect last read into nbuf before it is used again */
+    if (dasd->nread)
+        cyl_wait(dasd);
+    dasd->pcyl = dasd->ncyl;
+    log_disk("Prefetch cyl=%d\n", dasd->ncyl);
+    io_start(&dasd->nio, IO_READ, dasd->fd,
+             (long)(tsize * dasd->ncyl) + sizeof(struct dasd_header), dasd->nbuf, tsize);
+}
+
 static void
 seek_callback(struct _device *unit, void *arg, int iarg)
 {
@@ -264,28 +324,39 @@ seek_callback(struct _device *unit, void *arg, int iarg)
     dasd->diff = 0;
     dasd->flags &= ~1;
     dasd->status |= READY;
+    stats.dasd_seeks++;
 
     log_disk("Disk Seek %s %d\n", dasd->file_name, dasd->ncyl);
     /* Check if read or write command, if so grab correct cylinder */
     if (dasd->cyl != dasd->ncyl) {
         uint32_t tsize = dasd->tsize * disk_type[type].heads;
         size_t   pos = (tsize * dasd->ncyl) + sizeof(struct dasd_header);
-        int r;
+        int      ocyl = (dasd->fpos - sizeof(struct dasd_header)) / tsize;
+        uint8_t *buf;
+        /* The cylinder is read in while the disk turns to the record,
+           it is waited for when first looked at */
+        cyl_wait(dasd);
         if (dasd->dirty) {
-            (void)lseek(dasd->fd, dasd->fpos, SEEK_SET);
-            r = write(dasd->fd, dasd->cbuf, tsize);
-            if (r != tsize) {
-                log_error("Disk write on %s %d\n", dasd->file_name, r);
-            }
+            checkpoint_file(dasd->fd, (long)dasd->fpos, tsize);
+            cyl_written(dasd);
+            io_start(&dasd->wio, IO_WRITE, dasd->fd, (long)dasd->fpos, dasd->cbuf, tsize);
             dasd->dirty = 0;
+            stats.dasd_writes += disk_type[type].heads;
         }
         dasd->fpos = pos;
         log_disk("Load cyl=%d %x\n", dasd->ncyl, dasd->fpos);
-        (void)lseek(dasd->fd, dasd->fpos, SEEK_SET);
-        r = read(dasd->fd, dasd->cbuf, tsize);
-        if (r != tsize) {
-            log_error("Disk read on %s %d\n", dasd->file_name, r);
+        if (dasd->pcyl == dasd->ncyl) {
+            /* Read during the seek, the old cylinder is kept in
+               case the arm comes back to it */
+            buf = dasd->cbuf;
+            dasd->cbuf = dasd->nbuf;
+            dasd->nbuf = buf;
+            dasd->pcyl = ocyl;
+            dasd->nread = dasd->nio.state != IO_IDLE;
+        } else {
+            io_start(&dasd->io, IO_READ, dasd->fd, (long)dasd->fpos, dasd->cbuf, tsize);
         }
+        stats.dasd_reads += disk_type[type].heads;
         dasd->cyl = dasd->ncyl;
     }
     dasd->tstart = (dasd->tsize * dasd->head);
@@ -328,6 +399,7 @@ dasd_settags(struct _dasd_t *dasd, uint8_t ft, uint8_t fc)
                     dasd->ncyl, dasd->diff, dasd->dir);
             if (dasd->diff != 0) {
                 add_event((struct _device *)dasd, seek_callback, 50,  NULL, 0);
+                cyl_prefetch(dasd);
                 dasd->flags |= 1;
                 dasd->status &= ~READY;
             }
@@ -349,6 +421,7 @@ dasd_settags(struct _dasd_t *dasd, uint8_t ft, uint8_t fc)
             dasd->status &= ~READY;
             dasd->tstart = (dasd->tsize * dasd->head);
             add_event((struct _device *)dasd, seek_callback, 50,  NULL, 0);
+            cyl_prefetch(dasd);
         }
         if (disk_type[dasd->type].dev_type != 0x14) { /* Head advance */
             if (ft & BIT4) {
@@ -472,6 +545,7 @@ dasd_update(struct _dasd_t *dasd)
     int        type  = dasd->type;
     int        i;
 
+    cyl_wait(dasd);
 #if 0
     pos = ((dasd->tsize * disk_type[type].heads) * dasd->cyl) + sizeof(struct dasd_header);
     /* Check if read or write command, if so grab correct cylinder */
@@ -788,6 +862,7 @@ dasd_read_byte(struct _dasd_t *dasd, uint8_t *data, uint8_t *am, uint8_t *ix)
     log_disk("Disk read %s %s %d %d\n", dasd->file_name, disk_state[dasd->state], count, dasd->cpos);
     dasd->step = 0;
     *am = 0;
+    cyl_wait(dasd);
 #if 0
     pos = ((dasd->tsize * disk_type[type].heads) * dasd->cyl) + sizeof(struct dasd_header);
     /* Check if read or write command, if so grab correct cylinder */
@@ -1223,6 +1298,7 @@ dasd_write_byte(struct _dasd_t *dasd, uint8_t *data, uint8_t *am, uint8_t *ix)
         return 0;
     }
     dasd->step = 0;
+    cyl_wait(dasd);
 #if 0
     pos = ((dasd->tsize * disk_type[type].heads) * dasd->cyl) + sizeof(struct dasd_header);
     /* Check if read or write command, if so grab correct cylinder */
@@ -1850,6 +1926,11 @@ dasd_format(struct _dasd_t * dasd, int flag) {
     int                 pos;
     int                 r;
 
+    /* Writes behind the cylinder buffers, so drop the read ahead */
+    cyl_wait(dasd);
+    io_sync();
+    dasd->pcyl = -1;
+
     /* Create header */
     log_disk("Format\n");
     memset(&hdr, 0, sizeof(struct dasd_header));
@@ -1951,6 +2032,15 @@ dasd_format(struct _dasd_t * dasd, int flag) {
         }
         memset(dasd->cbuf, 0, tsize);
     }
+    /* Put back the cylinder the arm is on */
+    if (dasd->fpos >= sizeof(struct dasd_header)) {
+        (void)lseek(dasd->fd, dasd->fpos, SEEK_SET);
+        r = read(dasd->fd, dasd->cbuf, tsize);
+        if (r != tsize) {
+            log_error("Disk read on %s %d\n", dasd->file_name, r);
+            return 1;
+        }
+    }
     return 0;
 }
 
@@ -1966,7 +2056,9 @@ dasd_attach(struct _dasd_t *dasd, char *file_name, int init)
     uint8_t             *rec;
     int                 pos;
 
-    /* Attempt to open disk */
+    /* Attempt to open disk, after any file being detached is written */
+    checkpoint_changed();
+    io_sync();
     log_info("Attach %s %s\n", file_name, disk_type[dasd->type].name);
     if ((dasd->fd = open(file_name, O_RDWR, 0660)) < 0) {
         if (init) {
@@ -2036,6 +2128,14 @@ dasd_attach(struct _dasd_t *dasd, char *file_name, int init)
         dasd_detach(dasd);
         return -1;
     }
+    /* Without room to read ahead seeks read after they finish */
+    if (dasd->nbuf == NULL)
+        dasd->nbuf = (uint8_t *)calloc(tsize, sizeof(uint8_t));
+    dasd->pcyl = -1;
+    checkpoint_area("dasd", dasd, sizeof(struct _dasd_t));
+    checkpoint_area("dasd cylinder", dasd->cbuf, tsize);
+    if (dasd->nbuf != NULL)
+        checkpoint_area("dasd next", dasd->nbuf, tsize);
     /* Read in first cylinder */
     (void)lseek(dasd->fd, sizeof(struct dasd_header), SEEK_SET);
     r = read(dasd->fd, dasd->cbuf, tsize);
@@ -2077,20 +2177,33 @@ dasd_detach(struct _dasd_t *dasd)
     int                 type = dasd->type;
     uint32_t            tsize = dasd->tsize * disk_type[type].heads;
 
-    if (dasd->dirty) {
-          (void)lseek(dasd->fd, dasd->fpos, SEEK_SET);
-          (void)write(dasd->fd, dasd->cbuf, tsize);
-          dasd->dirty = 0;
-    }
+    checkpoint_changed();
+    cyl_wait(dasd);
+    cyl_written(dasd);
+    (void)io_wait(&dasd->nio);
+    checkpoint_forget(dasd);
+    checkpoint_forget(dasd->cbuf);
+    checkpoint_forget(dasd->nbuf);
+    /* The I/O thread writes the last cylinder, then closes the file
+       and frees the buffers, nbuf may still be being written from */
     if (dasd->fd >= 0) {
-        close(dasd->fd);
+        if (dasd->dirty) {
+            io_post(IO_WRITE|IO_FREE, dasd->fd, (long)dasd->fpos, dasd->cbuf, tsize);
+            dasd->dirty = 0;
+            stats.dasd_writes += disk_type[type].heads;
+        } else {
+            free(dasd->cbuf);
+        }
+        io_post(IO_CLOSE|IO_FREE, dasd->fd, 0, dasd->nbuf, 0);
         dasd->fd = -1;
+    } else {
+        free(dasd->cbuf);
+        free(dasd->nbuf);
     }
-    free(dasd->cbuf);
     dasd->cbuf = NULL;
+    dasd->nbuf = NULL;
+    dasd->pcyl = -1;
     free(dasd->file_name);
     dasd->file_name = NULL;
     dasd->status = 0;
 }
-
-
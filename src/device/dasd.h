@@ -100,6 +100,7 @@
 */
 
 #include <stdint.h>
+#include "iothread.h"
 
 #ifndef _DASD_H_
 #define _DASD_H_
@@ -136,6 +137,12 @@ struct _dasd_t
      uint8_t            klen;        /* remaining in key */
      uint8_t            ck_sum[2];   /* Record checksum */
      int                step;        /* Byte step count */
+     struct _io_req     io;          /* Cylinder being read */
+     uint8_t           *nbuf;        /* Cylinder read while seeking */
+     int                pcyl;        /* Cylinder in nbuf, or -1 */
+     struct _io_req     nio;         /* Read into nbuf */
+     uint8_t            nread;       /* nio is still reading cbuf */
+     struct _io_req     wio;         /* Write back of last cylinder */
 };
 
 /* Status bits */
@@ -0,0 +1,567 @@
+/*
+ * microsim360 - Breakpoints and watchpoints.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <inttypes.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <arpa/inet.h>
+#define closesocket close
+#define SOCKET int
+#else
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+#include "logger.h"
+#include "conf.h"
+#include "device.h"
+#include "cpu.h"
+#include "storage.h"
+#include "checkpoint.h"
+#include "debugger.h"
+
+#define DEBUG_POLL    0x3fff        /* Look at socket every 16K steps */
+#define DEBUG_WAIT    1000000       /* Steps to wait for instruction */
+
+struct _bpt {
+    int               num;          /* Number shown to debugger */
+    int               type;         /* DEBUG_INST, DEBUG_RBREAK, ... */
+    uint32_t          addr;         /* First address */
+    uint32_t          len;          /* Number of bytes */
+};
+
+MACHINE_LOCAL uint32_t debug_inst[DEBUG_PAGES / 32];
+MACHINE_LOCAL uint32_t debug_read[DEBUG_PAGES / 32];
+MACHINE_LOCAL uint32_t debug_write[DEBUG_PAGES / 32];
+MACHINE_LOCAL uint32_t debug_ros[DEBUG_ROS / 32];
+MACHINE_LOCAL int      debug_active;
+MACHINE_LOCAL int      debug_stopped;
+MACHINE_LOCAL uint32_t debug_addr;
+MACHINE_LOCAL uint32_t debug_data;
+MACHINE_LOCAL int      debug_watch_inst;
+MACHINE_LOCAL uint64_t debug_back;
+MACHINE_LOCAL void     (*debug_serve)(int wait) = NULL;
+MACHINE_LOCAL void     (*debug_regs)(struct _debug_regs *regs) = NULL;
+
+static MACHINE_LOCAL struct _bpt *bpt;
+static MACHINE_LOCAL int          bpts;
+static MACHINE_LOCAL int          last_num;
+static MACHINE_LOCAL int          inst_stop;      /* Stop at next instruction */
+static MACHINE_LOCAL uint64_t     inst_limit;     /* Stop anyway at step */
+static MACHINE_LOCAL int          reported;       /* Stop sent to debugger */
+static MACHINE_LOCAL int          ros_pass = -1;  /* ROS word to run once */
+static MACHINE_LOCAL uint64_t     run_until;      /* Stop at step */
+static MACHINE_LOCAL SOCKET       listener = -1;
+static MACHINE_LOCAL SOCKET       client = -1;
+static MACHINE_LOCAL char         line[256];      /* Command being read */
+static MACHINE_LOCAL int          line_len;
+
+/* Set bits for pages from addr to addr + len - 1 */
+static void
+set_pages(uint32_t *map, uint32_t addr, uint32_t len)
+{
+    uint32_t   pg;
+    uint32_t   last = ((addr + len - 1) & 0xffffff) >> DEBUG_SHIFT;
+
+    for (pg = (addr & 0xffffff) >> DEBUG_SHIFT; pg <= last; pg++)
+        map[pg >> 5] |= 1u << (pg & 0x1f);
+}
+
+/* Rebuild bit maps after breakpoints change */
+static void
+set_maps()
+{
+    int     i;
+
+    memset(debug_inst, (inst_stop) ? 0xff : 0, sizeof(debug_inst));
+    memset(debug_read, 0, sizeof(debug_read));
+    memset(debug_write, 0, sizeof(debug_write));
+    memset(debug_ros, 0, sizeof(debug_ros));
+    for (i = 0; i < bpts; i++) {
+        switch (bpt[i].type) {
+        case DEBUG_INST:
+             set_pages(debug_inst, bpt[i].addr, bpt[i].len);
+             break;
+        case DEBUG_RBREAK:
+             debug_ros[bpt[i].addr >> 5] |= 1u << (bpt[i].addr & 0x1f);
+             break;
+        default:
+             if (bpt[i].type & DEBUG_READ)
+                 set_pages(debug_read, bpt[i].addr, bpt[i].len);
+             if (bpt[i].type & DEBUG_WRITE)
+                 set_pages(debug_write, bpt[i].addr, bpt[i].len);
+             break;
+        }
+    }
+}
+
+int
+debug_add(int type, uint32_t addr, uint32_t len)
+{
+    struct _bpt  *n;
+
+    if (len == 0 || (type == DEBUG_RBREAK && addr >= DEBUG_ROS))
+        return 0;
+    if ((n = (struct _bpt *)realloc(bpt, (bpts + 1) * sizeof(struct _bpt))) == NULL)
+        return 0;
+    bpt = n;
+    bpt[bpts].num = ++last_num;
+    bpt[bpts].type = type;
+    bpt[bpts].addr = addr;
+    bpt[bpts].len = len;
+    bpts++;
+    set_maps();
+    return last_num;
+}
+
+int
+debug_delete(int n)
+{
+    int     i;
+
+    for (i = 0; i < bpts; i++) {
+        if (n == 0 || bpt[i].num == n) {
+            bpts--;
+            memmove(&bpt[i], &bpt[i + 1], (bpts - i) * sizeof(struct _bpt));
+            i--;
+            if (n != 0)
+                break;
+        }
+    }
+    set_maps();
+    return (n == 0 || i < bpts);
+}
+
+static void
+stop(int why, uint32_t addr)
+{
+    if (debug_stopped)
+        return;
+    debug_stopped = why;
+    debug_addr = addr;
+    reported = 0;
+}
+
+/* Find breakpoint of type covering addr to addr + len - 1 */
+static int
+find(int type, uint32_t addr, int len)
+{
+    int     i;
+
+    for (i = 0; i < bpts; i++) {
+        if ((bpt[i].type & type) != 0 && addr < bpt[i].addr + bpt[i].len &&
+                 addr + len > bpt[i].addr)
+            return 1;
+    }
+    return 0;
+}
+
+void
+debug_inst_hit(uint32_t addr)
+{
+    int     why = inst_stop;
+
+    if (why != 0) {
+        inst_stop = 0;
+        set_maps();
+        stop(why, addr);
+    } else if (find(DEBUG_INST, addr, 1)) {
+        stop(DEBUG_INST, addr);
+    }
+}
+
+void
+debug_next_inst(int why)
+{
+    if (inst_stop == 0)
+        inst_stop = why;
+    inst_limit = step_count + DEBUG_WAIT;
+    set_maps();
+}
+
+int
+debug_ros_hit(uint16_t addr)
+{
+    if (debug_stopped)
+        return debug_stopped == DEBUG_RBREAK && addr == debug_addr;
+    if (ros_pass == addr) {
+        ros_pass = -1;
+        return 0;
+    }
+    if (!find(DEBUG_RBREAK, addr, 1))
+        return 0;
+    stop(DEBUG_RBREAK, addr);
+    return 1;
+}
+
+void
+debug_storage(uint32_t addr, int len, int flag)
+{
+    if (!find(flag, addr, len))
+        return;
+    debug_data = addr;
+    if (debug_watch_inst)
+        debug_next_inst(flag);
+    else
+        stop(flag, addr);
+}
+
+int
+debug_find(int type, uint32_t addr, uint32_t len)
+{
+    int     i;
+
+    for (i = 0; i < bpts; i++) {
+        if (bpt[i].type == type && bpt[i].addr == addr && bpt[i].len == len)
+            return bpt[i].num;
+    }
+    return 0;
+}
+
+int
+debug_read_byte(uint32_t addr, uint8_t *data)
+{
+    return storage_read(addr, data, 1) == 1;
+}
+
+static void
+reply(const char *fmt, ...)
+{
+    char     buf[256];
+    va_list  ap;
+    int      len;
+
+    if (client < 0)
+        return;
+    va_start(ap, fmt);
+    len = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (len > (int)sizeof(buf) - 1)
+        len = sizeof(buf) - 1;
+    (void)send(client, buf, len, 0);
+}
+
+static const char *
+type_name(int type)
+{
+    switch (type) {
+    case DEBUG_INST:               return "break";
+    case DEBUG_RBREAK:             return "rbreak";
+    case DEBUG_READ:               return "r";
+    case DEBUG_WRITE:              return "w";
+    case DEBUG_READ|DEBUG_WRITE:   return "rw";
+    }
+    return "request";
+}
+
+void
+debug_resume()
+{
+    if (debug_stopped == DEBUG_RBREAK)
+        ros_pass = debug_addr;
+    debug_stopped = 0;
+    if (inst_stop != 0) {
+        inst_stop = 0;
+        set_maps();
+    }
+}
+
+/* Run one command from debugger */
+static void
+command(char *cmd)
+{
+    char      word[16];
+    char      mode[4];
+    uint32_t  addr;
+    uint32_t  len;
+    int       n;
+    int       i;
+
+    n = sscanf(cmd, "%15s", word);
+    if (n != 1)
+        return;
+    if (strcmp(word, "break") == 0 && sscanf(cmd, "%*s %x", &addr) == 1) {
+        n = debug_add(DEBUG_INST, addr, 1);
+    } else if (strcmp(word, "rbreak") == 0 && sscanf(cmd, "%*s %x", &addr) == 1) {
+        n = debug_add(DEBUG_RBREAK, addr, 1);
+    } else if (strcmp(word, "watch") == 0 &&
+               (n = sscanf(cmd, "%*s %3s %x %x", mode, &addr, &len)) >= 2) {
+        int   type = 0;
+
+        if (n == 2)
+            len = 1;
+        if (strchr(mode, 'r') != NULL)
+            type |= DEBUG_READ;
+        if (strchr(mode, 'w') != NULL)
+            type |= DEBUG_WRITE;
+        n = (type != 0) ? debug_add(type, addr, len) : 0;
+    } else if (strcmp(word, "delete") == 0) {
+        if (sscanf(cmd, "%*s %d", &n) != 1)
+            n = 0;
+        n = debug_delete(n);
+    } else if (strcmp(word, "list") == 0) {
+        for (i = 0; i < bpts; i++)
+            reply("%d %s %x %x\n", bpt[i].num, type_name(bpt[i].type),
+                         bpt[i].addr, bpt[i].len);
+        n = 1;
+    } else if (strcmp(word, "stop") == 0) {
+        stop(DEBUG_REQUEST, 0);
+        n = 1;
+    } else if (strcmp(word, "cont") == 0) {
+        debug_resume();
+        n = 1;
+    } else if (strcmp(word, "step") == 0) {
+        if (sscanf(cmd, "%*s %d", &n) != 1 || n <= 0)
+            n = 1;
+        run_until = step_count + n;
+        debug_resume();
+        n = 1;
+    } else if (strcmp(word, "back") == 0) {
+        uint64_t  to;
+
+        /* Step loop does it once this step is done */
+        n = 0;
+        if (sscanf(cmd, "%*s %" SCNu64, &to) == 1 && to > 0 &&
+                 to <= step_count && checkpoint_count() != 0 &&
+                 to > checkpoint_oldest()) {
+            debug_back = to;
+            run_until = 0;
+            debug_resume();
+            n = 1;
+        }
+    } else if (strcmp(word, "status") == 0) {
+        if (debug_stopped)
+            reply("stopped %s %x %" PRIu64 "\n", type_name(debug_stopped),
+                         debug_addr, step_count);
+        else
+            reply("running %" PRIu64 "\n", step_count);
+        n = 1;
+    } else {
+        n = 0;
+    }
+    if (n == 0)
+        reply("error %s\n", cmd);
+    else if (strcmp(word, "break") == 0 || strcmp(word, "rbreak") == 0 ||
+             strcmp(word, "watch") == 0)
+        reply("ok %d\n", n);
+    else
+        reply("ok\n");
+}
+
+/* Debugger went away, let machine run */
+static void
+drop_client()
+{
+    closesocket(client);
+    client = -1;
+    line_len = 0;
+    debug_delete(0);
+    run_until = 0;
+    debug_resume();
+}
+
+/* Take connections and commands, waiting up to ms */
+static void
+poll_socket(int ms)
+{
+    struct timeval  tv;
+    fd_set          read_set;
+    SOCKET          s;
+    char            buf[256];
+    int             len;
+    int             i;
+
+    FD_ZERO(&read_set);
+    FD_SET(listener, &read_set);
+    if (client >= 0)
+        FD_SET(client, &read_set);
+    tv.tv_sec = 0;
+    tv.tv_usec = ms * 1000;
+    if (select(((client > listener) ? client : listener) + 1, &read_set,
+               NULL, NULL, &tv) <= 0)
+        return;
+
+    if (FD_ISSET(listener, &read_set)) {
+        if ((s = accept(listener, NULL, NULL)) >= 0) {
+            if (client >= 0) {
+                (void)send(s, "error busy\n", 11, 0);
+                closesocket(s);
+            } else {
+                client = s;
+                log_info("Debugger connected\n");
+                reported = 0;
+            }
+        }
+    }
+
+    if (client >= 0 && FD_ISSET(client, &read_set)) {
+        if ((len = recv(client, buf, sizeof(buf), 0)) <= 0) {
+            log_info("Debugger disconnected\n");
+            drop_client();
+            return;
+        }
+        for (i = 0; i < len; i++) {
+            if (buf[i] == '\n') {
+                line[line_len] = '\0';
+                command(line);
+                line_len = 0;
+            } else if (buf[i] != '\r' && line_len < (int)sizeof(line) - 1) {
+                line[line_len++] = buf[i];
+            }
+        }
+    }
+}
+
+/* Text socket, report stop and take commands */
+static void
+text_serve(int wait)
+{
+    if (wait && !reported && client >= 0) {
+        reply("stopped %s %x %" PRIu64 "\n", type_name(debug_stopped),
+                     debug_addr, step_count);
+        reported = 1;
+    }
+    poll_socket((wait) ? 100 : 0);
+}
+
+void
+debug_check()
+{
+    struct _debug_regs  regs;
+
+    if (run_until != 0 && step_count >= run_until) {
+        run_until = 0;
+        stop(DEBUG_REQUEST, 0);
+    }
+    /* CPU in wait state, stop where it is */
+    if (inst_stop != 0 && step_count >= inst_limit) {
+        regs.ia = 0;
+        if (debug_regs != NULL)
+            (*debug_regs)(&regs);
+        debug_inst_hit(regs.ia);
+    }
+    if (!debug_stopped && (step_count & DEBUG_POLL) == 0)
+        (*debug_serve)(0);
+    /* Hold here until debugger lets it go */
+    while (debug_stopped && POWER)
+        (*debug_serve)(1);
+}
+
+void
+debug_go_back(void (*run)())
+{
+    uint64_t   to = debug_back;
+    int        active = debug_active;
+
+    /* Breakpoints are passed over on the way, the stop taken is ours */
+    debug_back = 0;
+    debug_active = 0;
+    debug_stopped = DEBUG_REQUEST;
+    (void)checkpoint_back(to - 1, run);
+    debug_active = active;
+    inst_stop = 0;
+    set_maps();
+    debug_addr = 0;
+    reported = 0;
+}
+
+int
+debug_open(int port)
+{
+    struct sockaddr_in   addr;
+    int                  on = 1;
+#ifdef _WIN32
+    WSADATA              wsa;
+
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+        return 0;
+#endif
+    debug_close();
+    if ((listener = socket(PF_INET, SOCK_STREAM, 0)) < 0)
+        return 0;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (char *)&on, sizeof(on));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(listener, 1) < 0) {
+        closesocket(listener);
+        listener = -1;
+        return 0;
+    }
+    debug_serve = &text_serve;
+    debug_watch_inst = 0;
+    debug_active = 1;
+    log_info("Debugger on port %d\n", port);
+    return 1;
+}
+
+void
+debug_close()
+{
+    if (client >= 0)
+        drop_client();
+    if (listener >= 0)
+        closesocket(listener);
+    listener = -1;
+    debug_active = 0;
+}
+
+int
+simDEBUG_create(struct _option *opt)
+{
+    struct _option   opts;
+    int              port = 0;
+
+    while (get_option(&opts)) {
+        if (strcmp(opts.opt, "PORT") == 0 && opts.flags == 1) {
+            if (!get_integer(&opts, &port) || port <= 0 || port > 65535) {
+                fprintf(stderr, "Debug port needs a number\n");
+                return 0;
+            }
+        } else {
+            fprintf(stderr, "Invalid option %s to debug\n", opts.opt);
+            return 0;
+        }
+    }
+    if (port == 0) {
+        fprintf(stderr, "Debug needs port=\n");
+        return 0;
+    }
+    if (!debug_open(port)) {
+        fprintf(stderr, "Unable to open debug port %d\n", port);
+        return 0;
+    }
+    return 1;
+}
+
+SIM_OPT_STRUCT(DEBUG);
@@ -0,0 +1,153 @@
+/*
+ * microsim360 - Breakpoints and watchpoints.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _DEBUGGER_H_
+#define _DEBUGGER_H_
+
+#include <stdint.h>
+#include "machine.h"
+
+/*
+ * Breakpoints on instruction addresses, on ROS addresses, and watches
+ * on ranges of storage read or written.  Each kind has a bit map: one
+ * bit per 2K page of storage for instructions and watches, one bit per
+ * ROS address.  The CPU tests the bit, and only when it is set is the
+ * list of breakpoints searched.  So with nothing set near where the
+ * program runs it costs one bit test per access.
+ *
+ * When one is hit the machine stops between steps and waits for the
+ * debugger.  The ROS breakpoint holds the CPU clock before the word
+ * runs, as the ROS address compare stop does.
+ *
+ * Breakpoints are set from a text socket on the local host, one
+ * command per line:
+ *
+ *     break <addr>                 stop at instruction
+ *     rbreak <ros addr>            stop at ROS word
+ *     watch <r|w|rw> <addr> [len]  stop at storage access
+ *     delete [n]                   remove breakpoint n, or all
+ *     list                         show breakpoints
+ *     stop, cont, step [n]         stop, continue, or run n steps
+ *     status                       show if running or stopped
+ *     back <step>                  go back to step from a checkpoint
+ *
+ * Addresses are hex.  When the machine stops a line "stopped <why>
+ * <addr> <step>" is sent.  Configured with:  debug port=<port>
+ *
+ * Other front ends, like the GDB stub, set debug_serve and ask for
+ * stops at the next instruction, so registers are never seen part
+ * way through one.
+ */
+
+#define DEBUG_SHIFT   11            /* 2K pages, as storage blocks */
+#define DEBUG_PAGES   (1 << (24 - DEBUG_SHIFT))
+#define DEBUG_ROS     65536
+
+#define DEBUG_INST    1             /* Instruction breakpoint */
+#define DEBUG_RBREAK  2             /* ROS address breakpoint */
+#define DEBUG_READ    4             /* Watch storage read */
+#define DEBUG_WRITE   8             /* Watch storage write */
+#define DEBUG_REQUEST 16            /* Stop asked for */
+
+extern MACHINE_LOCAL uint32_t debug_inst[DEBUG_PAGES / 32];
+extern MACHINE_LOCAL uint32_t debug_read[DEBUG_PAGES / 32];
+extern MACHINE_LOCAL uint32_t debug_write[DEBUG_PAGES / 32];
+extern MACHINE_LOCAL uint32_t debug_ros[DEBUG_ROS / 32];
+extern MACHINE_LOCAL int      debug_active;    /* Debugger is listening */
+extern MACHINE_LOCAL int      debug_stopped;   /* Why machine is stopped */
+extern MACHINE_LOCAL uint32_t debug_addr;      /* Where machine stopped */
+extern MACHINE_LOCAL uint32_t debug_data;      /* Storage address of watch */
+extern MACHINE_LOCAL int      debug_watch_inst; /* Watch stops after instruction */
+extern MACHINE_LOCAL uint64_t debug_back;      /* Step to go back to, or 0 */
+
+/* Program visible state, as the CPU keeps it */
+struct _debug_regs {
+    uint32_t    gpr[16];
+    uint64_t    fpr[4];
+    uint8_t     mask;               /* System mask */
+    uint8_t     key;                /* Protection key */
+    uint8_t     amwp;               /* ASCII, machine check, wait, problem */
+    uint8_t     cc;                 /* Condition code */
+    uint8_t     pm;                 /* Program mask */
+    uint32_t    ia;                 /* Instruction address */
+};
+
+/* Front end, called between steps.  Wait is set when machine is stopped */
+extern MACHINE_LOCAL void (*debug_serve)(int wait);
+
+/* Set by the CPU model to read registers */
+extern MACHINE_LOCAL void (*debug_regs)(struct _debug_regs *regs);
+
+#define DEBUG_BIT(map, n)  ((map)[(n) >> 5] & (1u << ((n) & 0x1f)))
+
+/* Stop if instruction at addr has a breakpoint */
+#define debug_inst_check(addr) \
+    if (DEBUG_BIT(debug_inst, ((addr) & 0xffffff) >> DEBUG_SHIFT)) \
+        debug_inst_hit(addr)
+
+/* True if CPU clock should hold at ROS address */
+#define debug_ros_check(addr) \
+    (DEBUG_BIT(debug_ros, (addr)) && debug_ros_hit(addr))
+
+/* Check stop and socket, called before each step */
+#define debug_step()  if (debug_active) debug_check()
+
+void debug_inst_hit(uint32_t addr);
+int  debug_ros_hit(uint16_t addr);
+
+/* Storage at addr for len bytes accessed in page with a watch */
+void debug_storage(uint32_t addr, int len, int flag);
+
+void debug_check();
+
+/* Go back to debug_back, with run doing one step, then stop there.
+   Called from the step loop, not from inside a step */
+void debug_go_back(void (*run)());
+
+/* Stop at start of next instruction, or where it is if the CPU waits */
+void debug_next_inst(int why);
+
+/* Let machine run on */
+void debug_resume();
+
+/* Add breakpoint of type for addr to addr + len - 1, return its number
+   or 0 if no room */
+int  debug_add(int type, uint32_t addr, uint32_t len);
+
+/* Remove breakpoint n, or all if 0 */
+int  debug_delete(int n);
+
+/* Number of breakpoint of type for addr and len, 0 if none */
+int  debug_find(int type, uint32_t addr, uint32_t len);
+
+/* Read byte of main storage at addr, return 0 if none there */
+int  debug_read_byte(uint32_t addr, uint8_t *data);
+
+/* Open debug socket on port, return 0 if it can't be */
+int  debug_open(int port);
+
+void debug_close();
+
+#endif
@@ -27,8 +27,12 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "logger.h"
 #include "device.h"
+#include "cpu.h"
+#include "checkpoint.h"
+#include "iothread.h"
 
 
 static char *bus_tags[] = {
@@ -40,10 +44,13 @@ static char *state_tags[] = {
     "END", "ENDACCEPT", "DEVEND", "OPR", "DATA1", "DATA2"};
 
 
-struct _disk *disk = NULL;       /* Disk controllers */
-struct _device *chan[6];         /* Channels */
-uint32_t      *M;
-uint32_t      mem_max;
+MACHINE_LOCAL struct _disk   *disk = NULL;  /* Disk controllers */
+MACHINE_LOCAL struct _device *chan[6];      /* Channels */
+MACHINE_LOCAL uint32_t       *M;
+MACHINE_LOCAL uint32_t        mem_max;
+MACHINE_LOCAL uint32_t       *M_dirty;
+MACHINE_LOCAL int             M_shift;
+static MACHINE_LOCAL int      M_words;     /* Size of M_dirty */
 
 /*
  * Log channel control bits to log.
@@ -73,6 +80,31 @@ print_tags(char *name, int state, uint16_t tags, uint16_t bus_out)
     }
 }
 
+/*
+ * Allocate bit map of storage blocks written.
+ */
+int
+storage_track(uint32_t size, int bytes)
+{
+    uint32_t   blocks;
+
+    for (M_shift = 0; (bytes << M_shift) < STORE_BLOCK; M_shift++);
+    blocks = (size + (1 << M_shift) - 1) >> M_shift;
+    M_words = (blocks + 31) / 32;
+    free(M_dirty);
+    if ((M_dirty = (uint32_t *)calloc(M_words, sizeof(uint32_t))) == NULL)
+        return 0;
+    storage_all_dirty();
+    return 1;
+}
+
+void
+storage_all_dirty()
+{
+    if (M_dirty != NULL)
+        memset(M_dirty, 0xff, M_words * sizeof(uint32_t));
+}
+
 /*
  * Initialize all devices. Called before simulator starts.
  */
@@ -107,6 +139,8 @@ system_shutdown()
             }
         }
     }
+    /* Files are closed when all writes are done */
+    io_sync();
 }
 
 /*
@@ -120,6 +154,8 @@ add_chan(struct _device *dev, uint16_t addr)
 
       dev->addr = addr;
       dev->next = NULL;
+      checkpoint_area(dev->type_name, &dev->request,
+                      offsetof(struct _device, next) - offsetof(struct _device, request));
       /* If channel empty, add it */
       if (chan[ch] == NULL) {
           chan[ch] = dev;
@@ -157,6 +193,7 @@ del_chan(struct _device *dev, uint16_t addr)
       uint16_t    ch = (addr >> 8) & 0x7;
       struct   _device *d;
 
+      checkpoint_forget(&dev->request);
       /* If channel empty, nothing to do. */
       if (chan[ch] == NULL) {
           return;
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include "conf.h"
+#include "machine.h"
 
 #define BIT0    0x80
 #define BIT1    0x40
@@ -120,6 +121,7 @@ typedef struct _device {
                           uint16_t bus_out,
                           uint16_t *bus_in);
     void      (*draw_model)(struct _device *unit, void *render, int u);
+    uint64_t  (*draw_state)(struct _device *unit, int u);
     void      *(*create_ctrl)(struct _device *unit, int u, int x, int y);
     void      (*init_device)(struct _device *unit, void *render);
     void      (*close_device)(struct _device *unit);
@@ -162,13 +164,15 @@ struct _control {
     unsigned int    magic;
 };
 
-extern device_t       *chan[6];         /* Channels */
-extern struct _disk   *disk;            /* Disk controller that need to be run */
+extern MACHINE_LOCAL device_t     *chan[6];  /* Channels */
+extern MACHINE_LOCAL struct _disk *disk;     /* Disk controller that need to be run */
 
 void print_tags(char *name, int state, uint16_t tags, uint16_t bus_out);
 
 void print_inst(uint8_t *val);
 
+const char *op_name(uint8_t op);
+
 void add_chan(device_t *dev, uint16_t addr);
 
 struct _device *find_chan(uint16_t addr, uint16_t mask);
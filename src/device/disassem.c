@@ -371,6 +371,19 @@ t_opcode  optab[] = {
        { 0,            NULL, 0 }
 };
 
+/* Return mnemonic of opcode, NULL if not an instruction */
+const char *
+op_name(uint8_t op)
+{
+    t_opcode        *tab;
+
+    for (tab = optab; tab->name != NULL; tab++) {
+       if (tab->opbase == op)
+          return tab->name;
+    }
+    return NULL;
+}
+
 void print_inst(uint8_t *val) {
     t_opcode        *tab;
     char            buffer[256];
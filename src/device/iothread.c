@@ -0,0 +1,239 @@
+/*
+ * microsim360 - Host file I/O thread.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+#ifdef _WIN32
+#include <io.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include "logger.h"
+#include "iothread.h"
+
+#define IO_POSTED   0x20          /* Request belongs to the queue */
+
+/*
+ * One thread and one queue for the whole process, a MACHINE_THREADS
+ * build shares it between machines.
+ */
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t  io_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   io_work = PTHREAD_COND_INITIALIZER;  /* Queue not empty */
+static pthread_cond_t   io_done = PTHREAD_COND_INITIALIZER;  /* Request finished */
+static struct _io_req  *head;          /* Request being done */
+static struct _io_req  *tail;
+static uint64_t         started;       /* Requests queued */
+static uint64_t         finished;      /* Requests done */
+static int              running;       /* Thread started */
+#endif
+
+static const char *op_name[] = { "", "Read", "Write", "Close" };
+
+/* Do a request, return bytes moved or -1 */
+static int
+do_io(struct _io_req *req)
+{
+    int      r = -1;
+
+    switch (req->op & IO_OP) {
+    case IO_READ:
+#ifdef HAVE_PTHREAD
+         if (req->pos >= 0)
+             return (int)pread(req->fd, req->buf, req->len, (off_t)req->pos);
+#else
+         if (req->pos >= 0)
+             (void)lseek(req->fd, req->pos, SEEK_SET);
+#endif
+         r = (int)read(req->fd, req->buf, req->len);
+         break;
+    case IO_WRITE:
+#ifdef HAVE_PTHREAD
+         if (req->pos >= 0)
+             return (int)pwrite(req->fd, req->buf, req->len, (off_t)req->pos);
+#else
+         if (req->pos >= 0)
+             (void)lseek(req->fd, req->pos, SEEK_SET);
+#endif
+         r = (int)write(req->fd, req->buf, req->len);
+         break;
+    case IO_CLOSE:
+         r = close(req->fd);
+         break;
+    }
+    return r;
+}
+
+/* Finish a request nobody waits on */
+static void
+done_posted(struct _io_req *req, int r)
+{
+    if ((req->op & IO_OP) == IO_CLOSE ? r != 0 : r != req->len)
+        log_error("%s of %d bytes on %d failed %d\n", op_name[req->op & IO_OP],
+                   req->len, req->fd, r);
+    if (req->op & IO_FREE)
+        free(req->buf);
+}
+
+#ifdef HAVE_PTHREAD
+static void *
+io_thread(void *arg)
+{
+    struct _io_req  *req;
+    int              posted;
+    int              r;
+
+    pthread_mutex_lock(&io_lock);
+    for (;;) {
+        while (head == NULL)
+            pthread_cond_wait(&io_work, &io_lock);
+        /* Request stays at head of queue until done */
+        req = head;
+        posted = (req->op & IO_POSTED) != 0;
+        pthread_mutex_unlock(&io_lock);
+        r = do_io(req);
+        pthread_mutex_lock(&io_lock);
+        if ((head = head->next) == NULL)
+            tail = NULL;
+        finished++;
+        if (!posted) {
+            req->result = r;
+            req->done = 1;
+        }
+        pthread_cond_broadcast(&io_done);
+        if (posted) {
+            pthread_mutex_unlock(&io_lock);
+            done_posted(req, r);
+            free(req);
+            pthread_mutex_lock(&io_lock);
+        }
+    }
+    return NULL;
+}
+
+/* Put request on queue, return 0 if there is no thread to do it */
+static int
+queue(struct _io_req *req)
+{
+    pthread_t    thread;
+
+    pthread_mutex_lock(&io_lock);
+    if (!running) {
+        if (pthread_create(&thread, NULL, io_thread, NULL) != 0) {
+            pthread_mutex_unlock(&io_lock);
+            return 0;
+        }
+        pthread_detach(thread);
+        running = 1;
+    }
+    req->next = NULL;
+    if (tail != NULL)
+        tail->next = req;
+    else
+        head = req;
+    tail = req;
+    started++;
+    pthread_cond_signal(&io_work);
+    pthread_mutex_unlock(&io_lock);
+    return 1;
+}
+#else
+#define queue(req)   0
+#endif
+
+void
+io_start(struct _io_req *req, int op, int fd, long pos, void *buf, int len)
+{
+    if (req->state == IO_QUEUED)
+        (void)io_wait(req);
+    req->op = op & (IO_OP|IO_FREE);
+    req->fd = fd;
+    req->pos = pos;
+    req->buf = buf;
+    req->len = len;
+    req->result = 0;
+    req->state = IO_QUEUED;
+    req->done = 0;
+    if (!queue(req)) {
+        req->result = do_io(req);
+        req->done = 1;
+    }
+}
+
+void
+io_post(int op, int fd, long pos, void *buf, int len)
+{
+    struct _io_req  *req;
+    struct _io_req   now;
+
+    /* With no memory for the queue do it now */
+    if ((req = (struct _io_req *)calloc(1, sizeof(struct _io_req))) == NULL)
+        req = &now;
+    req->op = (op & (IO_OP|IO_FREE)) | IO_POSTED;
+    req->fd = fd;
+    req->pos = pos;
+    req->buf = buf;
+    req->len = len;
+    if (req == &now || !queue(req)) {
+        done_posted(req, do_io(req));
+        if (req != &now)
+            free(req);
+    }
+}
+
+int
+io_wait(struct _io_req *req)
+{
+#ifdef HAVE_PTHREAD
+    if (req->state == IO_QUEUED) {
+        pthread_mutex_lock(&io_lock);
+        while (!req->done)
+            pthread_cond_wait(&io_done, &io_lock);
+        pthread_mutex_unlock(&io_lock);
+    }
+#endif
+    req->state = IO_IDLE;
+    return req->result;
+}
+
+void
+io_sync()
+{
+#ifdef HAVE_PTHREAD
+    uint64_t   last;
+
+    pthread_mutex_lock(&io_lock);
+    last = started;
+    while (finished < last)
+        pthread_cond_wait(&io_done, &io_lock);
+    pthread_mutex_unlock(&io_lock);
+#endif
+}
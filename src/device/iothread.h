@@ -0,0 +1,78 @@
+/*
+ * microsim360 - Host file I/O thread.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _IOTHREAD_H_
+#define _IOTHREAD_H_
+
+#include <stdint.h>
+
+/*
+ * Reads and writes of host files done by devices are handed to an I/O
+ * thread, so the machine does not stop while the host waits on a
+ * disk.  Requests are done one at a time in the order given, so a
+ * read after a write of the same place gets what was written.  A
+ * device only waits on a request when it needs the data.
+ *
+ * A request with a position of -1 reads or writes at the file's
+ * current position.  io_post requests are not waited on: the buffer is
+ * freed when done if IO_FREE is given, and errors are logged.
+ *
+ * Without threads the request is done when it is started.
+ */
+
+#define IO_READ     1
+#define IO_WRITE    2
+#define IO_CLOSE    3             /* Close fd after earlier requests */
+#define IO_OP       0x0f
+#define IO_FREE     0x10          /* Free buffer when done */
+
+#define IO_IDLE     0             /* Result collected */
+#define IO_QUEUED   1             /* Started, not waited for */
+
+struct _io_req {
+    struct _io_req   *next;       /* Next in queue */
+    int               op;         /* What to do */
+    int               fd;         /* File */
+    long              pos;        /* Where in file, or -1 */
+    void             *buf;        /* Data */
+    int               len;        /* Bytes to move */
+    int               result;     /* Bytes moved, or -1 on error */
+    int               state;      /* IO_IDLE or IO_QUEUED, set by caller */
+    int               done;       /* Set by thread when finished */
+};
+
+/* Start request, waiting first if req is still queued */
+void io_start(struct _io_req *req, int op, int fd, long pos, void *buf, int len);
+
+/* Start request that is never waited on */
+void io_post(int op, int fd, long pos, void *buf, int len);
+
+/* Wait for request, return bytes moved or -1 */
+int  io_wait(struct _io_req *req);
+
+/* Wait for everything started so far */
+void io_sync();
+
+#endif
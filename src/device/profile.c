@@ -0,0 +1,305 @@
+/*
+ * microsim360 - Microcode profiler.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logger.h"
+#include "device.h"
+#include "profile.h"
+
+MACHINE_LOCAL char      *profile_file = NULL;
+static MACHINE_LOCAL struct _profile  *profile_list = NULL;
+
+struct _profile *
+profile_create(const char *name, int rows, const char *(*note)(int addr))
+{
+    struct _profile   *p;
+
+    if (profile_file == NULL)
+        return NULL;
+    if ((p = (struct _profile *)calloc(1, sizeof(struct _profile))) == NULL)
+        return NULL;
+    p->count = (uint64_t *)calloc((size_t)rows * PROF_ROS_SIZE, sizeof(uint64_t));
+    if (p->count == NULL) {
+        free(p);
+        return NULL;
+    }
+    p->name = name;
+    p->rows = rows;
+    p->note = note;
+    p->next = profile_list;
+    profile_list = p;
+    return p;
+}
+
+/*
+ * Format is a line per model followed by its counts:
+ *
+ *   model <name> <rows>
+ *   inst <op> <count>
+ *   word <addr> <row> <count> <note>
+ *
+ * Row is the opcode in hex, "ch" for channel microcode, or "--" for a
+ * model with one row.  Only counts that are not zero are written.
+ */
+void
+profile_write(FILE *f)
+{
+    struct _profile   *p;
+    const char        *note;
+    char               row[12];
+    int                r, a;
+
+    fprintf(f, "# microsim360 microcode profile\n");
+    for (p = profile_list; p != NULL; p = p->next) {
+        fprintf(f, "model %s %d\n", p->name, p->rows);
+        for (r = 0; r < 256; r++) {
+            if (p->insts[r] != 0)
+                fprintf(f, "inst %02x %llu\n", r, (unsigned long long)p->insts[r]);
+        }
+        for (r = 0; r < p->rows; r++) {
+            if (p->rows == 1)
+                strcpy(row, "--");
+            else if (r == PROF_CHAN)
+                strcpy(row, "ch");
+            else
+                sprintf(row, "%02x", r);
+            for (a = 0; a < PROF_ROS_SIZE; a++) {
+                if (p->count[(r << 12) | a] == 0)
+                    continue;
+                note = (p->note != NULL) ? p->note(a) : NULL;
+                fprintf(f, "word %03x %s %llu %s\n", a, row,
+                        (unsigned long long)p->count[(r << 12) | a],
+                        (note != NULL && *note != '\0') ? note : "-");
+            }
+        }
+    }
+}
+
+int
+profile_save()
+{
+    FILE   *f;
+
+    if (profile_file == NULL || profile_list == NULL)
+        return 1;
+    if ((f = fopen(profile_file, "w")) == NULL) {
+        log_error("Unable to create profile %s\n", profile_file);
+        return 0;
+    }
+    profile_write(f);
+    fclose(f);
+    return 1;
+}
+
+/* Totals of one model read back for report */
+struct _prof_sum {
+    char              name[32];
+    uint64_t          word[PROF_ROS_SIZE];
+    char             *note[PROF_ROS_SIZE];
+    uint64_t          op[256];
+    uint64_t          insts[256];
+    uint64_t          chan;
+    uint64_t          total;
+    int               rows;
+};
+
+/* Routine is the part of the note naming the ALD page */
+static int
+same_routine(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return 0;
+    while (*a != '\0' && *a != ':' && *a != '-' && *a == *b) {
+        a++;
+        b++;
+    }
+    return (*a == '\0' || *a == ':' || *a == '-') &&
+           (*b == '\0' || *b == ':' || *b == '-');
+}
+
+static double
+pct(uint64_t n, uint64_t total)
+{
+    return (total == 0) ? 0.0 : (100.0 * (double)n) / (double)total;
+}
+
+static void
+report_model(struct _prof_sum *s, FILE *out, int top)
+{
+    uint64_t          *rout;
+    uint64_t           best;
+    uint64_t           insts = 0;
+    const char        *name;
+    char               page[32];
+    int               *used;
+    int                i, j, k;
+
+    for (i = 0; i < 256; i++)
+        insts += s->insts[i];
+    fprintf(out, "Model %s: %llu cycles", s->name, (unsigned long long)s->total);
+    if (s->rows > 1) {
+        fprintf(out, ", %.1f%% CPU microcode, %.1f%% channel microcode, "
+                     "%llu instructions",
+                pct(s->total - s->chan, s->total), pct(s->chan, s->total),
+                (unsigned long long)insts);
+    }
+    fprintf(out, "\n\nHottest ROS words\n");
+    fprintf(out, "  Addr Note                  Count       %%\n");
+    used = (int *)calloc(PROF_ROS_SIZE, sizeof(int));
+    rout = (uint64_t *)calloc(PROF_ROS_SIZE, sizeof(uint64_t));
+    for (k = 0; k < top; k++) {
+        best = 0;
+        j = -1;
+        for (i = 0; i < PROF_ROS_SIZE; i++) {
+            if (!used[i] && s->word[i] > best) {
+                best = s->word[i];
+                j = i;
+            }
+        }
+        if (j < 0)
+            break;
+        used[j] = 1;
+        fprintf(out, "  %03X  %-16s %12llu %6.2f\n", j,
+                (s->note[j] != NULL) ? s->note[j] : "-",
+                (unsigned long long)best, pct(best, s->total));
+    }
+
+    /* Add up each word into the first word with the same routine */
+    for (i = 0; i < PROF_ROS_SIZE; i++) {
+        for (j = 0; j <= i; j++) {
+            if (j == i || same_routine(s->note[i], s->note[j])) {
+                rout[j] += s->word[i];
+                break;
+            }
+        }
+    }
+    fprintf(out, "\nHottest microroutines\n");
+    fprintf(out, "  Routine                Count       %%\n");
+    memset(used, 0, PROF_ROS_SIZE * sizeof(int));
+    for (k = 0; k < top; k++) {
+        best = 0;
+        j = -1;
+        for (i = 0; i < PROF_ROS_SIZE; i++) {
+            if (!used[i] && rout[i] > best) {
+                best = rout[i];
+                j = i;
+            }
+        }
+        if (j < 0)
+            break;
+        used[j] = 1;
+        name = (s->note[j] != NULL) ? s->note[j] : "-";
+        snprintf(page, sizeof(page), "%.*s", (int)strcspn(name, ":-"), name);
+        fprintf(out, "  %-21s %12llu %6.2f\n", page,
+                (unsigned long long)best, pct(best, s->total));
+    }
+    free(used);
+    free(rout);
+
+    if (s->rows == 1) {
+        fprintf(out, "\n");
+        return;
+    }
+    fprintf(out, "\nCycles per opcode\n");
+    fprintf(out, "  Op Name        Insts       Cycles  Cyc/inst       %%\n");
+    for (i = 0; i < 256; i++) {
+        if (s->op[i] == 0 && s->insts[i] == 0)
+            continue;
+        name = op_name(i);
+        fprintf(out, "  %02X %-5s %12llu %12llu %9.1f %7.2f\n", i,
+                (name != NULL) ? name : "?",
+                (unsigned long long)s->insts[i], (unsigned long long)s->op[i],
+                (s->insts[i] == 0) ? 0.0 : (double)s->op[i] / (double)s->insts[i],
+                pct(s->op[i], s->total));
+    }
+    fprintf(out, "  Channel                  %12llu           %7.2f\n\n",
+            (unsigned long long)s->chan, pct(s->chan, s->total));
+}
+
+static void
+free_sum(struct _prof_sum *s)
+{
+    int    i;
+
+    for (i = 0; i < PROF_ROS_SIZE; i++)
+        free(s->note[i]);
+    free(s);
+}
+
+int
+profile_report(FILE *in, FILE *out, int top)
+{
+    struct _prof_sum  *s = NULL;
+    char               line[256];
+    char               name[32];
+    char               row[8];
+    char               note[128];
+    unsigned int       a, op;
+    unsigned long long n;
+    int                rows;
+    int                models = 0;
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+        if (sscanf(line, "model %31s %d", name, &rows) == 2) {
+            if (s != NULL) {
+                report_model(s, out, top);
+                free_sum(s);
+            }
+            if ((s = (struct _prof_sum *)calloc(1, sizeof(struct _prof_sum))) == NULL)
+                return 0;
+            strcpy(s->name, name);
+            s->rows = rows;
+            models++;
+        } else if (s != NULL && sscanf(line, "inst %x %llu", &op, &n) == 2) {
+            s->insts[op & 0xff] += n;
+        } else if (s != NULL &&
+                   sscanf(line, "word %x %7s %llu %127s", &a, row, &n, note) == 4) {
+            a &= PROF_ROS_SIZE - 1;
+            s->word[a] += n;
+            s->total += n;
+            if (s->note[a] == NULL && strcmp(note, "-") != 0)
+                s->note[a] = strdup(note);
+            if (strcmp(row, "ch") == 0)
+                s->chan += n;
+            else if (strcmp(row, "--") != 0 && sscanf(row, "%x", &op) == 1)
+                s->op[op & 0xff] += n;
+        } else {
+            fprintf(stderr, "Bad profile line: %s", line);
+            if (s != NULL)
+                free_sum(s);
+            return 0;
+        }
+    }
+    if (s != NULL) {
+        report_model(s, out, top);
+        free_sum(s);
+    }
+    return models != 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * microsim360 - Microcode profiler.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "machine.h"
+
+/*
+ * Counts how often each ROS word is executed.  A CPU keeps one row of
+ * counters per S/360 opcode, so the same counts also give cycles per
+ * opcode, plus a row for channel microcode.  Controllers keep one row.
+ *
+ * Profiling is on when profile_file is set before the models are
+ * created, otherwise models get a NULL profile and PROFILE() costs a
+ * test of a pointer.
+ */
+
+#define PROF_ROS_SIZE   4096       /* Words of ROS */
+#define PROF_CHAN       256        /* Row of channel microcode */
+#define PROF_ROWS       257        /* Rows for a CPU */
+
+struct _profile {
+    const char       *name;        /* Model profiled */
+    int               rows;        /* Number of rows of counters */
+    int               row;         /* Row counting now */
+    uint64_t         *count;       /* rows * PROF_ROS_SIZE counters */
+    uint64_t          insts[256];  /* Instructions started per opcode */
+    const char     *(*note)(int addr);   /* Note of ROS word */
+    struct _profile  *next;
+};
+
+extern MACHINE_LOCAL char *profile_file;            /* Where to save profiles */
+
+/* Count execution of ROS word addr, in channel row if chan is set */
+#define PROFILE(p, addr, chan)  do { if ((p) != NULL) \
+              (p)->count[(((chan) ? PROF_CHAN : (p)->row) << 12) | \
+                         ((addr) & (PROF_ROS_SIZE - 1))]++; } while (0)
+
+/* Start of instruction op on a CPU, following words count against it */
+#define PROFILE_INST(p, op)  do { if ((p) != NULL) { \
+              (p)->row = (op) & 0xff; \
+              (p)->insts[(p)->row]++; } } while (0)
+
+/* Create profile for model, NULL if profiling is not enabled */
+struct _profile *profile_create(const char *name, int rows,
+                                const char *(*note)(int addr));
+
+/* Write all profiles to profile_file */
+int profile_save();
+
+/* Write profiles in f */
+void profile_write(FILE *f);
+
+/* Read profiles written by profile_write() from in, and write report of
+   the top hottest words and routines to out */
+int profile_report(FILE *in, FILE *out, int top);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * microsim360 - Microcode profile report.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+/*
+ * Report on a profile saved by microsim360 -p file.
+ *
+ *   profrep [-n top] [file]
+ *
+ * For each model gives the hottest ROS words and microroutines with
+ * their ROS notes, and for a CPU the cycles spent in each opcode and in
+ * channel microcode.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "profile.h"
+
+MACHINE_LOCAL uint64_t  step_count;             /* Used by logger */
+
+int
+main(int argc, char *argv[])
+{
+    FILE   *f = stdin;
+    int     top = 20;
+    int     i;
+    int     r;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && (i + 1) < argc) {
+            top = atoi(argv[++i]);
+        } else if (argv[i][0] == '-' || f != stdin) {
+            fprintf(stderr, "Usage: %s [-n top] [file]\n", argv[0]);
+            return 1;
+        } else if ((f = fopen(argv[i], "r")) == NULL) {
+            fprintf(stderr, "Unable to open %s\n", argv[i]);
+            return 1;
+        }
+    }
+    r = profile_report(f, stdout, top);
+    if (f != stdin)
+        fclose(f);
+    return !r;
+}
@@ -0,0 +1,361 @@
+/*
+ * microsim360 - Binary ROS images.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "rosimg.h"
+
+static void
+put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+static uint32_t
+get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+uint32_t
+rosimg_crc(uint32_t crc, const uint8_t *buf, size_t len)
+{
+    int    i;
+
+    crc = ~crc;
+    while (len-- > 0) {
+        crc ^= *buf++;
+        for (i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+/* Get value of a numeric field */
+static uint32_t
+get_field(const uint8_t *word, const struct rosimg_field *f)
+{
+    uint8_t    v8;
+    uint16_t   v16;
+    uint32_t   v32;
+
+    switch (f->size) {
+    case 1:  memcpy(&v8, word + f->off, 1);  return v8;
+    case 2:  memcpy(&v16, word + f->off, 2); return v16;
+    default: memcpy(&v32, word + f->off, 4); return v32;
+    }
+}
+
+/* Set value of a numeric field */
+static void
+set_field(uint8_t *word, const struct rosimg_field *f, uint32_t v)
+{
+    uint8_t    v8 = (uint8_t)v;
+    uint16_t   v16 = (uint16_t)v;
+
+    switch (f->size) {
+    case 1:  memcpy(word + f->off, &v8, 1);  break;
+    case 2:  memcpy(word + f->off, &v16, 2); break;
+    default: memcpy(word + f->off, &v, 4);   break;
+    }
+}
+
+/* Get string of a string field, NULL reads as empty */
+static const char *
+get_str(const uint8_t *word, const struct rosimg_field *f)
+{
+    const char *s;
+
+    memcpy(&s, word + f->off, sizeof(s));
+    return (s == NULL) ? "" : s;
+}
+
+int
+rosimg_write(FILE *f, int model, const void *ros, size_t size, int count,
+             const struct rosimg_field *fields, int nfields)
+{
+    const uint8_t *base = (const uint8_t *)ros;
+    uint8_t       *img;
+    uint8_t       *p;
+    uint8_t        bits[256];
+    size_t         width;
+    size_t         strings = 0;
+    size_t         len;
+    size_t         pos;
+    int            i, j, n;
+    int            r;
+
+    if (nfields > 256)
+        return 0;
+
+    /* Find width of each field and size of strings */
+    width = 0;
+    for (j = 0; j < nfields; j++) {
+        bits[j] = 0;
+        if (fields[j].str) {
+            for (i = 0; i < count; i++)
+                strings += strlen(get_str(base + (i * size), &fields[j])) + 1;
+            continue;
+        }
+        bits[j] = 1;
+        for (i = 0; i < count; i++) {
+            uint32_t v = get_field(base + (i * size), &fields[j]);
+            while (bits[j] < 32 && (v >> bits[j]) != 0)
+                bits[j]++;
+        }
+        width += bits[j];
+    }
+    width = (width + 7) / 8;
+
+    len = ROSIMG_HEADER + nfields + (count * width) + strings;
+    if ((img = (uint8_t *)calloc(1, len)) == NULL)
+        return 0;
+
+    memcpy(img, ROSIMG_MAGIC, 4);
+    img[4] = ROSIMG_VERSION;
+    img[6] = nfields & 0xff;
+    img[7] = (nfields >> 8) & 0xff;
+    put32(&img[8], model);
+    put32(&img[12], count);
+    put32(&img[16], (uint32_t)width);
+    put32(&img[20], (uint32_t)strings);
+    p = &img[ROSIMG_HEADER];
+    memcpy(p, bits, nfields);
+    p += nfields;
+
+    /* Pack words */
+    for (i = 0; i < count; i++, p += width) {
+        pos = 0;
+        for (j = 0; j < nfields; j++) {
+            uint32_t  v;
+
+            if (bits[j] == 0)
+                continue;
+            v = get_field(base + (i * size), &fields[j]);
+            for (n = 0; n < bits[j]; n++, pos++) {
+                if ((v >> n) & 1)
+                    p[pos >> 3] |= 1 << (pos & 7);
+            }
+        }
+    }
+
+    /* Then the strings */
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < nfields; j++) {
+            const char *s;
+
+            if (bits[j] != 0)
+                continue;
+            s = get_str(base + (i * size), &fields[j]);
+            n = (int)strlen(s);
+            memcpy(p, s, n);
+            p += n + 1;
+        }
+    }
+
+    put32(&img[24], rosimg_crc(0, &img[ROSIMG_HEADER], len - ROSIMG_HEADER));
+    r = fwrite(img, 1, len, f) == len;
+    free(img);
+    return r;
+}
+
+/* Check image of len bytes and unpack it into ros */
+static int
+unpack(const uint8_t *img, size_t len, int model, uint8_t *ros, size_t size,
+       int count, const struct rosimg_field *fields, int nfields, char **strtab)
+{
+    const uint8_t *bits;
+    const uint8_t *p;
+    const uint8_t *end;
+    char          *str;
+    size_t         width;
+    size_t         strings;
+    size_t         pos;
+    int            nstr = 0;
+    int            i, j, n;
+
+    if (len < ROSIMG_HEADER || memcmp(img, ROSIMG_MAGIC, 4) != 0 ||
+        img[4] != ROSIMG_VERSION)
+        return ROSIMG_FORMAT;
+    if (get32(&img[8]) != (uint32_t)model || get32(&img[12]) != (uint32_t)count ||
+        (img[6] | (img[7] << 8)) != nfields)
+        return ROSIMG_MODEL;
+    width = get32(&img[16]);
+    strings = get32(&img[20]);
+    if (len != ROSIMG_HEADER + nfields + (count * width) + strings)
+        return ROSIMG_FORMAT;
+    if (get32(&img[24]) != rosimg_crc(0, &img[ROSIMG_HEADER], len - ROSIMG_HEADER))
+        return ROSIMG_CHECK;
+
+    /* Fields must be laid out as the model expects */
+    bits = &img[ROSIMG_HEADER];
+    pos = 0;
+    for (j = 0; j < nfields; j++) {
+        if ((bits[j] == 0) != (fields[j].str != 0) || bits[j] > fields[j].size * 8 ||
+            (fields[j].str && fields[j].size != sizeof(char *)))
+            return ROSIMG_MODEL;
+        pos += bits[j];
+        nstr += fields[j].str != 0;
+    }
+    if ((pos + 7) / 8 != width)
+        return ROSIMG_FORMAT;
+
+    /* Make sure there are enough strings before changing anything */
+    p = bits + nfields + (count * width);
+    end = p + strings;
+    for (n = 0; p < end; p++)
+        n += *p == '\0';
+    if (n != count * nstr)
+        return ROSIMG_FORMAT;
+    str = NULL;
+    if (strings != 0) {
+        if ((str = (char *)malloc(strings)) == NULL)
+            return ROSIMG_OPEN;
+        memcpy(str, end - strings, strings);
+    }
+
+    p = bits + nfields;
+    end = p + (count * width);
+    for (i = 0; i < count; i++, p += width) {
+        uint8_t  *word = ros + (i * size);
+
+        pos = 0;
+        for (j = 0; j < nfields; j++) {
+            uint32_t  v = 0;
+
+            if (bits[j] == 0)
+                continue;
+            for (n = 0; n < bits[j]; n++, pos++)
+                v |= (uint32_t)((p[pos >> 3] >> (pos & 7)) & 1) << n;
+            set_field(word, &fields[j], v);
+        }
+    }
+
+    /* Strings point into the copy of the string table */
+    n = 0;
+    for (i = 0; i < count; i++) {
+        uint8_t  *word = ros + (i * size);
+
+        for (j = 0; j < nfields; j++) {
+            const char *s;
+
+            if (bits[j] != 0)
+                continue;
+            s = &str[n];
+            memcpy(word + fields[j].off, &s, sizeof(s));
+            n += (int)strlen(s) + 1;
+        }
+    }
+    *strtab = str;
+    return ROSIMG_OK;
+}
+
+int
+rosimg_load(const char *name, int model, void *ros, size_t size, int count,
+            const struct rosimg_field *fields, int nfields, char **strtab)
+{
+    uint8_t   *img;
+    size_t     len;
+    int        r;
+#ifdef _WIN32
+    FILE      *f;
+    long       l;
+
+    if ((f = fopen(name, "rb")) == NULL)
+        return ROSIMG_OPEN;
+    if (fseek(f, 0, SEEK_END) != 0 || (l = ftell(f)) < 0) {
+        fclose(f);
+        return ROSIMG_OPEN;
+    }
+    rewind(f);
+    len = (size_t)l;
+    if ((img = (uint8_t *)malloc(len + 1)) == NULL ||
+         fread(img, 1, len, f) != len) {
+        free(img);
+        fclose(f);
+        return ROSIMG_OPEN;
+    }
+    fclose(f);
+    r = unpack(img, len, model, (uint8_t *)ros, size, count, fields, nfields, strtab);
+    free(img);
+#else
+    struct stat st;
+    int         fd;
+
+    if ((fd = open(name, O_RDONLY)) < 0)
+        return ROSIMG_OPEN;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return ROSIMG_OPEN;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return ROSIMG_FORMAT;
+    }
+    len = (size_t)st.st_size;
+    img = (uint8_t *)mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (img == (uint8_t *)MAP_FAILED)
+        return ROSIMG_OPEN;
+    r = unpack(img, len, model, (uint8_t *)ros, size, count, fields, nfields, strtab);
+    munmap(img, len);
+#endif
+    return r;
+}
+
+int
+rosimg_name(const char *name)
+{
+    size_t    len = strlen(name);
+
+    return len > 4 && strcmp(name + len - 4, ".ros") == 0;
+}
+
+const char *
+rosimg_error(int err)
+{
+    switch (err) {
+    case ROSIMG_OK:     return "no error";
+    case ROSIMG_OPEN:   return "unable to open";
+    case ROSIMG_FORMAT: return "not a ROS image";
+    case ROSIMG_MODEL:  return "ROS image is for another model";
+    case ROSIMG_CHECK:  return "ROS image checksum error";
+    }
+    return "unknown error";
+}
@@ -0,0 +1,87 @@
+/*
+ * microsim360 - Binary ROS images.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _ROSIMG_H_
+#define _ROSIMG_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary ROS image.  The ROS generators write one in place of a C table
+ * and the models load it over their built in ROS at start up, so another
+ * EC level can be run without rebuilding.
+ *
+ * The image is a 32 byte header, one byte per field giving its width in
+ * bits (0 for a string), the words with their fields packed low bit
+ * first, then the strings of each word with a trailing NUL.  All values
+ * are little endian and the checksum is a CRC-32 of everything after the
+ * header.
+ *
+ * String fields are char pointers, so a C table only holds one copy of
+ * each note.  A loaded image points them into a copy of its string table.
+ */
+
+#define ROSIMG_MAGIC    "ROS\032"
+#define ROSIMG_VERSION  1
+#define ROSIMG_HEADER   32
+
+/* Error returns of rosimg_load */
+#define ROSIMG_OK        0
+#define ROSIMG_OPEN     -1        /* Could not open or map file */
+#define ROSIMG_FORMAT   -2        /* Not an image or wrong version */
+#define ROSIMG_MODEL    -3        /* Image for a different model */
+#define ROSIMG_CHECK    -4        /* Checksum does not match */
+
+/* Describes one field of a ROS word structure */
+struct rosimg_field {
+    uint16_t    off;              /* Offset in structure */
+    uint8_t     size;             /* Size of field in bytes */
+    uint8_t     str;              /* Field is a string pointer */
+};
+
+#define ROSIMG_FIELD(type, f)  { offsetof(type, f), sizeof(((type *)0)->f), 0 }
+#define ROSIMG_STR(type, f)    { offsetof(type, f), sizeof(((type *)0)->f), 1 }
+
+/* Write count words of size bytes at ros as image for model to f */
+int rosimg_write(FILE *f, int model, const void *ros, size_t size, int count,
+                 const struct rosimg_field *fields, int nfields);
+
+/* Load image in name for model over count words of ros.  The strings
+   are put in a block returned in strtab, free it when ros is reloaded */
+int rosimg_load(const char *name, int model, void *ros, size_t size, int count,
+                const struct rosimg_field *fields, int nfields, char **strtab);
+
+/* Message for an error return of rosimg_load */
+const char *rosimg_error(int err);
+
+/* Non zero if name is that of a ROS image, ends with .ros */
+int rosimg_name(const char *name);
+
+/* CRC-32 of len bytes at buf, continued from crc */
+uint32_t rosimg_crc(uint32_t crc, const uint8_t *buf, size_t len);
+
+#endif
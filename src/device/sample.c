@@ -0,0 +1,316 @@
+/*
+ * microsim360 - S/360 instruction address sampler.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logger.h"
+#include "sample.h"
+
+MACHINE_LOCAL char      *sample_file = NULL;
+MACHINE_LOCAL uint32_t   sample_interval = 997;
+static MACHINE_LOCAL struct _sample  *sample_list = NULL;
+
+struct _sample *
+sample_create(const char *name)
+{
+    struct _sample    *s;
+
+    if (sample_file == NULL)
+        return NULL;
+    if ((s = (struct _sample *)calloc(1, sizeof(struct _sample))) == NULL)
+        return NULL;
+    s->name = name;
+    s->interval = (sample_interval == 0) ? 1 : sample_interval;
+    s->left = s->interval;
+    s->next = sample_list;
+    sample_list = s;
+    return s;
+}
+
+void
+sample_hit(struct _sample *s, uint32_t addr, int wait)
+{
+    uint32_t          *page;
+
+    s->left = s->interval;
+    s->total++;
+    if (wait) {
+        s->wait++;
+        return;
+    }
+    addr &= 0xffffff;
+    page = s->page[addr >> 16];
+    if (page == NULL) {
+        page = (uint32_t *)calloc(SAMPLE_PAGE_SIZE, sizeof(uint32_t));
+        if (page == NULL)
+            return;
+        s->page[addr >> 16] = page;
+    }
+    page[(addr & 0xffff) >> 1]++;
+}
+
+/*
+ * Format is a line per model followed by its counts:
+ *
+ *   model <name> <interval> <samples> <wait samples>
+ *   addr <address> <count>
+ *
+ * Addresses are in hex in ascending order.  Only counts that are not
+ * zero are written.
+ */
+void
+sample_write(FILE *f)
+{
+    struct _sample    *s;
+    int                p, h;
+
+    fprintf(f, "# microsim360 address samples\n");
+    for (s = sample_list; s != NULL; s = s->next) {
+        fprintf(f, "model %s %u %llu %llu\n", s->name, s->interval,
+                (unsigned long long)s->total, (unsigned long long)s->wait);
+        for (p = 0; p < SAMPLE_PAGES; p++) {
+            if (s->page[p] == NULL)
+                continue;
+            for (h = 0; h < SAMPLE_PAGE_SIZE; h++) {
+                if (s->page[p][h] != 0)
+                    fprintf(f, "addr %06x %u\n", (p << 16) | (h << 1),
+                            s->page[p][h]);
+            }
+        }
+    }
+}
+
+int
+sample_save()
+{
+    FILE   *f;
+
+    if (sample_file == NULL || sample_list == NULL)
+        return 1;
+    if ((f = fopen(sample_file, "w")) == NULL) {
+        log_error("Unable to create samples %s\n", sample_file);
+        return 0;
+    }
+    sample_write(f);
+    fclose(f);
+    return 1;
+}
+
+/* Address or symbol with its count read back for report */
+struct _samp_ent {
+    uint32_t          addr;
+    uint64_t          count;
+    char             *name;
+};
+
+struct _samp_tab {
+    struct _samp_ent *ent;
+    int               num;
+    int               max;
+};
+
+static struct _samp_ent *
+add_ent(struct _samp_tab *t, uint32_t addr, uint64_t count, const char *name)
+{
+    struct _samp_ent  *n;
+
+    if (t->num == t->max) {
+        t->max = (t->max == 0) ? 256 : t->max * 2;
+        n = (struct _samp_ent *)realloc(t->ent, t->max * sizeof(struct _samp_ent));
+        if (n == NULL)
+            return NULL;
+        t->ent = n;
+    }
+    n = &t->ent[t->num++];
+    n->addr = addr;
+    n->count = count;
+    n->name = (name != NULL) ? strdup(name) : NULL;
+    return n;
+}
+
+static void
+free_tab(struct _samp_tab *t)
+{
+    int    i;
+
+    for (i = 0; i < t->num; i++)
+        free(t->ent[i].name);
+    free(t->ent);
+    t->ent = NULL;
+    t->num = t->max = 0;
+}
+
+static int
+by_addr(const void *a, const void *b)
+{
+    const struct _samp_ent *x = (const struct _samp_ent *)a;
+    const struct _samp_ent *y = (const struct _samp_ent *)b;
+
+    return (x->addr > y->addr) - (x->addr < y->addr);
+}
+
+static int
+by_count(const void *a, const void *b)
+{
+    const struct _samp_ent *x = (const struct _samp_ent *)a;
+    const struct _samp_ent *y = (const struct _samp_ent *)b;
+
+    if (x->count != y->count)
+        return (x->count < y->count) - (x->count > y->count);
+    return by_addr(a, b);
+}
+
+/* Symbol at or below addr, map is sorted by address */
+static struct _samp_ent *
+find_sym(struct _samp_tab *map, uint32_t addr)
+{
+    int    lo = 0;
+    int    hi = map->num - 1;
+    int    mid;
+
+    if (map->num == 0 || addr < map->ent[0].addr)
+        return NULL;
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (map->ent[mid].addr <= addr)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return &map->ent[lo];
+}
+
+static double
+pct(uint64_t n, uint64_t total)
+{
+    return (total == 0) ? 0.0 : (100.0 * (double)n) / (double)total;
+}
+
+static void
+report_model(const char *name, unsigned int interval, uint64_t total,
+             uint64_t wait, struct _samp_tab *hits, struct _samp_tab *map,
+             FILE *out, int top)
+{
+    struct _samp_tab   rout = { NULL, 0, 0 };
+    struct _samp_ent  *sym;
+    char               where[64];
+    uint32_t           base;
+    int                i;
+
+    fprintf(out, "Model %s: %llu samples every %u cycles, %.1f%% in wait\n\n",
+            name, (unsigned long long)total, interval, pct(wait, total));
+
+    /* Add up each address into its routine, or its 256 byte block */
+    qsort(hits->ent, hits->num, sizeof(struct _samp_ent), &by_addr);
+    for (i = 0; i < hits->num; i++) {
+        sym = find_sym(map, hits->ent[i].addr);
+        base = (sym != NULL) ? sym->addr : (hits->ent[i].addr & ~0xffu);
+        if (rout.num != 0 && rout.ent[rout.num - 1].addr == base)
+            rout.ent[rout.num - 1].count += hits->ent[i].count;
+        else
+            add_ent(&rout, base, hits->ent[i].count,
+                    (sym != NULL) ? sym->name : NULL);
+    }
+
+    fprintf(out, "Hottest addresses\n");
+    fprintf(out, "  Addr   Symbol                       Count       %%\n");
+    qsort(hits->ent, hits->num, sizeof(struct _samp_ent), &by_count);
+    for (i = 0; i < top && i < hits->num; i++) {
+        sym = find_sym(map, hits->ent[i].addr);
+        if (sym != NULL)
+            snprintf(where, sizeof(where), "%s+%X", sym->name,
+                     hits->ent[i].addr - sym->addr);
+        else
+            strcpy(where, "-");
+        fprintf(out, "  %06X %-24s %12llu %6.2f\n", hits->ent[i].addr, where,
+                (unsigned long long)hits->ent[i].count,
+                pct(hits->ent[i].count, total));
+    }
+
+    fprintf(out, (map->num != 0) ? "\nHottest routines\n"
+                                 : "\nHottest 256 byte blocks\n");
+    fprintf(out, "  Addr   Routine                      Count       %%\n");
+    qsort(rout.ent, rout.num, sizeof(struct _samp_ent), &by_count);
+    for (i = 0; i < top && i < rout.num; i++) {
+        fprintf(out, "  %06X %-24s %12llu %6.2f\n", rout.ent[i].addr,
+                (rout.ent[i].name != NULL) ? rout.ent[i].name : "-",
+                (unsigned long long)rout.ent[i].count,
+                pct(rout.ent[i].count, total));
+    }
+    fprintf(out, "\n");
+    free_tab(&rout);
+}
+
+int
+sample_report(FILE *in, FILE *map, FILE *out, int top)
+{
+    struct _samp_tab   syms = { NULL, 0, 0 };
+    struct _samp_tab   hits = { NULL, 0, 0 };
+    char               line[256];
+    char               name[32] = "";
+    char               nname[32];
+    char               sym[64];
+    unsigned int       a, interval = 0, nint;
+    unsigned long long n, total = 0, wait = 0, ntotal, nwait;
+    int                models = 0;
+
+    while (map != NULL && fgets(line, sizeof(line), map) != NULL) {
+        if (sscanf(line, "%x %63s", &a, sym) == 2)
+            add_ent(&syms, a & 0xffffff, 0, sym);
+    }
+    qsort(syms.ent, syms.num, sizeof(struct _samp_ent), &by_addr);
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+        if (sscanf(line, "model %31s %u %llu %llu", nname, &nint,
+                   &ntotal, &nwait) == 4) {
+            if (models != 0) {
+                report_model(name, interval, total, wait, &hits, &syms,
+                             out, top);
+                free_tab(&hits);
+            }
+            strcpy(name, nname);
+            interval = nint;
+            total = ntotal;
+            wait = nwait;
+            models++;
+        } else if (models != 0 && sscanf(line, "addr %x %llu", &a, &n) == 2) {
+            add_ent(&hits, a, n, NULL);
+        } else {
+            fprintf(stderr, "Bad sample line: %s", line);
+            free_tab(&hits);
+            free_tab(&syms);
+            return 0;
+        }
+    }
+    if (models != 0)
+        report_model(name, interval, total, wait, &hits, &syms, out, top);
+    free_tab(&hits);
+    free_tab(&syms);
+    return models != 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * microsim360 - S/360 instruction address sampler.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _SAMPLE_H_
+#define _SAMPLE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "machine.h"
+
+/*
+ * Samples the S/360 instruction address every interval CPU cycles to
+ * find where guest programs spend their time.  Counts are kept per
+ * halfword in 64K pages which are only allocated when first hit.
+ *
+ * Sampling is on when sample_file is set before the CPU is created,
+ * otherwise the CPU gets a NULL sampler and SAMPLE() costs a test of a
+ * pointer.  The address is only worked out when a sample is taken.
+ */
+
+#define SAMPLE_PAGES     256        /* 64K pages in 24 bit address */
+#define SAMPLE_PAGE_SIZE 32768      /* Halfwords per page */
+
+struct _sample {
+    const char       *name;         /* Model sampled */
+    uint32_t          interval;     /* Cycles between samples */
+    uint32_t          left;         /* Cycles to next sample */
+    uint64_t          total;        /* Samples taken */
+    uint64_t          wait;         /* Samples taken in wait state */
+    uint32_t         *page[SAMPLE_PAGES];  /* Counts per halfword */
+    struct _sample   *next;
+};
+
+extern MACHINE_LOCAL char     *sample_file;      /* Where to save samples */
+extern MACHINE_LOCAL uint32_t  sample_interval;  /* Cycles between samples */
+
+/* Count a cycle, and every interval record address addr or wait */
+#define SAMPLE(s, addr, w)  do { if ((s) != NULL && --(s)->left == 0) \
+              sample_hit((s), (addr), (w)); } while (0)
+
+/* Create sampler for model, NULL if sampling is not enabled */
+struct _sample *sample_create(const char *name);
+
+/* Record one sample */
+void sample_hit(struct _sample *s, uint32_t addr, int wait);
+
+/* Write all samples to sample_file */
+int sample_save();
+
+/* Write samples in f */
+void sample_write(FILE *f);
+
+/* Read samples written by sample_write() from in, and write report of
+   the top hottest addresses and routines to out.  Routines are named
+   from map, lines of a hex address and a name, if not NULL */
+int sample_report(FILE *in, FILE *map, FILE *out, int top);
+
+#endif
@@ -0,0 +1,418 @@
+/*
+ * microsim360 - Load and dump main storage.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "logger.h"
+#include "conf.h"
+#include "device.h"
+#include "xlat.h"
+#include "cpu.h"
+#include "storage.h"
+
+#define CARD_LEN    80
+
+struct _dump {
+    struct _dump     *next;
+    char             *name;
+    uint32_t          addr;
+    uint32_t          len;          /* 0 is all of storage */
+};
+
+static MACHINE_LOCAL struct _dump  *dumps;
+
+/* Mark blocks from addr to addr + len - 1 written */
+static void
+mark_written(uint32_t addr, uint32_t len)
+{
+    uint32_t   blk;
+
+    for (blk = addr / STORE_BLOCK; blk <= (addr + len - 1) / STORE_BLOCK; blk++)
+        M_dirty[blk >> 5] |= 1u << (blk & 0x1f);
+}
+
+/* Bytes of storage that can be reached */
+static uint32_t
+fit(uint32_t addr, uint32_t len)
+{
+    if (M == NULL || M_dirty == NULL || addr > mem_max)
+        return 0;
+    if (len > mem_max - addr + 1)
+        len = mem_max - addr + 1;
+    return len;
+}
+
+uint32_t
+storage_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    uint32_t   i;
+    int        sh;
+
+    if ((len = fit(addr, len)) == 0)
+        return 0;
+    if (M_shift == 11) {
+        /* One byte and its parity in each entry */
+        for (i = 0; i < len; i++)
+            M[addr + i] = odd_parity[data[i]] | data[i];
+    } else {
+        /* Bytes up to a word, then whole words, then what is left */
+        for (i = 0; i < len && ((addr + i) & 3) != 0; i++) {
+            sh = 8 * (3 - ((addr + i) & 3));
+            M[(addr + i) >> 2] = (M[(addr + i) >> 2] & ~(0xffu << sh)) |
+                                 ((uint32_t)data[i] << sh);
+        }
+        for (; i + 4 <= len; i += 4)
+            M[(addr + i) >> 2] = ((uint32_t)data[i] << 24) |
+                                 ((uint32_t)data[i + 1] << 16) |
+                                 ((uint32_t)data[i + 2] << 8) | data[i + 3];
+        for (; i < len; i++) {
+            sh = 8 * (3 - ((addr + i) & 3));
+            M[(addr + i) >> 2] = (M[(addr + i) >> 2] & ~(0xffu << sh)) |
+                                 ((uint32_t)data[i] << sh);
+        }
+    }
+    mark_written(addr, len);
+    return len;
+}
+
+uint32_t
+storage_read(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t   i;
+
+    if ((len = fit(addr, len)) == 0)
+        return 0;
+    for (i = 0; i < len; i++) {
+        if (M_shift == 11)
+            data[i] = M[addr + i] & 0xff;
+        else
+            data[i] = (M[(addr + i) >> 2] >> (8 * (3 - ((addr + i) & 3)))) & 0xff;
+    }
+    return len;
+}
+
+/* 24 bit address from card */
+static uint32_t
+card_addr(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+/* Move address constant at addr by reloc */
+static void
+relocate(uint32_t addr, int len, int neg, uint32_t reloc)
+{
+    uint8_t    v[4];
+    uint32_t   value = 0;
+    int        i;
+
+    if (storage_read(addr, v, len) != (uint32_t)len)
+        return;
+    for (i = 0; i < len; i++)
+        value = (value << 8) | v[i];
+    value = (neg) ? value - reloc : value + reloc;
+    for (i = len - 1; i >= 0; i--) {
+        v[i] = value & 0xff;
+        value >>= 8;
+    }
+    storage_write(addr, v, len);
+}
+
+/*
+ * Object deck.  Each card has 02 in column 1 and the type in columns 2-4.
+ * TXT: address in 6-8, count in 11-12, text from 17.  RLD: count in
+ * 11-12, items from 17 of relocation and position ESDID, then flag and
+ * address; flag bit 7 set means the next item has the same ESDIDs.
+ */
+static int
+load_object(FILE *f, const char *name, uint32_t addr)
+{
+    static const uint8_t esd[3] = { 0xC5, 0xE2, 0xC4 };
+    static const uint8_t txt[3] = { 0xE3, 0xE7, 0xE3 };
+    static const uint8_t rld[3] = { 0xD9, 0xD3, 0xC4 };
+    static const uint8_t end[3] = { 0xC5, 0xD5, 0xC4 };
+    uint8_t    card[CARD_LEN];
+    uint32_t   origin = 0;
+    uint32_t   reloc = 0;
+    int        have_origin = 0;
+    int        cnt;
+    int        i;
+    int        flag;
+    int        r = 0, p = 0;
+    int        same = 0;
+    int        cards = 0;
+
+    while (fread(card, 1, CARD_LEN, f) == CARD_LEN) {
+        cards++;
+        if (card[0] != 0x02) {
+            log_warn("%s card %d is not an object card\n", name, cards);
+            continue;
+        }
+        cnt = (card[10] << 8) | card[11];
+        if (cnt > 56)
+            cnt = 56;
+        if (memcmp(&card[1], esd, 3) == 0) {
+            /* First control section sets where deck was assembled */
+            for (i = 0; i + 16 <= cnt && !have_origin; i += 16) {
+                if (card[16 + i + 8] == 0x00 || card[16 + i + 8] == 0x04) {
+                    origin = card_addr(&card[16 + i + 9]);
+                    have_origin = 1;
+                }
+            }
+            if (have_origin && addr != STORAGE_ASSEMBLED)
+                reloc = addr - origin;
+        } else if (memcmp(&card[1], txt, 3) == 0) {
+            if (!have_origin && addr != STORAGE_ASSEMBLED) {
+                have_origin = 1;
+                reloc = addr;
+            }
+            storage_write((card_addr(&card[5]) + reloc) & 0xffffff, &card[16], cnt);
+        } else if (memcmp(&card[1], rld, 3) == 0) {
+            for (i = 0; i + 4 <= cnt; ) {
+                if (!same) {
+                    r = (card[16 + i] << 8) | card[17 + i];
+                    p = (card[18 + i] << 8) | card[19 + i];
+                    i += 4;
+                    if (i + 4 > cnt)
+                        break;
+                }
+                flag = card[16 + i];
+                same = flag & 1;
+                /* Only A type constants within the deck */
+                if (reloc != 0 && (flag & 0xf0) == 0 && r == p) {
+                    relocate((card_addr(&card[17 + i]) + reloc) & 0xffffff,
+                             ((flag >> 2) & 3) + 1, (flag & 2) != 0, reloc);
+                }
+                i += 4;
+            }
+            same = 0;
+        } else if (memcmp(&card[1], end, 3) == 0) {
+            if (card[5] != 0x40)
+                log_info("%s entry %06x\n", name,
+                         (card_addr(&card[5]) + reloc) & 0xffffff);
+            have_origin = 0;
+            reloc = 0;
+        }
+    }
+    return cards > 0;
+}
+
+int
+storage_load(const char *name, int format, uint32_t addr)
+{
+    FILE      *f;
+    uint8_t    buf[4096];
+    size_t     len;
+    uint32_t   total = 0;
+    int        ch;
+    int        r = 1;
+
+    if (M == NULL || M_dirty == NULL) {
+        fprintf(stderr, "No storage to load %s into\n", name);
+        return 0;
+    }
+    if ((f = fopen(name, "rb")) == NULL) {
+        fprintf(stderr, "Unable to open %s\n", name);
+        return 0;
+    }
+    if (format == STORAGE_AUTO) {
+        ch = fgetc(f);
+        format = (ch == 0x02) ? STORAGE_OBJECT : STORAGE_RAW;
+        rewind(f);
+    }
+    if (format == STORAGE_OBJECT) {
+        r = load_object(f, name, addr);
+    } else {
+        if (format == STORAGE_IMAGE || addr == STORAGE_ASSEMBLED)
+            addr = 0;
+        while ((len = fread(buf, 1, sizeof(buf), f)) > 0) {
+            if (storage_write(addr + total, buf, (uint32_t)len) != len) {
+                fprintf(stderr, "%s does not fit in storage\n", name);
+                r = 0;
+                break;
+            }
+            total += (uint32_t)len;
+        }
+        if (r)
+            log_info("Loaded %s, %u bytes at %06x\n", name, total, addr);
+    }
+    fclose(f);
+    return r;
+}
+
+int
+storage_dump(const char *name, uint32_t addr, uint32_t len)
+{
+    FILE      *f;
+    uint8_t    buf[4096];
+    uint32_t   n;
+    int        r = 1;
+
+    if ((len = fit(addr, len)) == 0) {
+        fprintf(stderr, "Nothing in storage to dump to %s\n", name);
+        return 0;
+    }
+    if ((f = fopen(name, "wb")) == NULL) {
+        fprintf(stderr, "Unable to create %s\n", name);
+        return 0;
+    }
+    while (len > 0) {
+        n = storage_read(addr, buf, (len > sizeof(buf)) ? sizeof(buf) : len);
+        if (fwrite(buf, 1, n, f) != n) {
+            r = 0;
+            break;
+        }
+        addr += n;
+        len -= n;
+    }
+    if (fclose(f) != 0)
+        r = 0;
+    return r;
+}
+
+int
+storage_dump_add(const char *name, uint32_t addr, uint32_t len)
+{
+    struct _dump  *d;
+    struct _dump **p;
+
+    if ((d = (struct _dump *)calloc(1, sizeof(struct _dump))) == NULL)
+        return 0;
+    if ((d->name = strdup(name)) == NULL) {
+        free(d);
+        return 0;
+    }
+    d->addr = addr;
+    d->len = len;
+    /* Keep them in order asked */
+    for (p = &dumps; *p != NULL; p = &(*p)->next);
+    *p = d;
+    return 1;
+}
+
+void
+storage_dump_all()
+{
+    struct _dump  *d;
+
+    while ((d = dumps) != NULL) {
+        dumps = d->next;
+        if (storage_dump(d->name, d->addr, (d->len == 0) ? mem_max + 1 : d->len))
+            log_info("Dumped storage to %s\n", d->name);
+        free(d->name);
+        free(d);
+    }
+}
+
+/* Hex number from option */
+static int
+get_hex(struct _option *opt, uint32_t *value)
+{
+    char    *end;
+
+    *value = (uint32_t)strtoul(opt->string, &end, 16);
+    if (opt->string[0] == '\0' || *end != '\0') {
+        fprintf(stderr, "Option %s requires a hex number (%s)\n", opt->opt,
+                         opt->string);
+        return 0;
+    }
+    return 1;
+}
+
+int
+simLOAD_create(struct _option *opt)
+{
+    static char     *formats[] = { "RAW", "OBJECT", "IMAGE", NULL };
+    struct _option   opts;
+    char             name[1024];
+    uint32_t         addr = STORAGE_ASSEMBLED;
+    int              format = STORAGE_AUTO;
+
+    name[0] = '\0';
+    while (get_option(&opts)) {
+        if (strcmp(opts.opt, "FILE") == 0 && opts.flags == 1) {
+            if (strlen(opts.string) >= sizeof(name)) {
+                fprintf(stderr, "File name too long %s\n", opts.string);
+                return 0;
+            }
+            strcpy(name, opts.string);
+        } else if (strcmp(opts.opt, "ADDR") == 0 && opts.flags == 1) {
+            if (!get_hex(&opts, &addr))
+                return 0;
+        } else if (strcmp(opts.opt, "FORMAT") == 0 && opts.flags == 1) {
+            if ((format = get_index(&opts, formats)) < 0)
+                return 0;
+            format++;
+        } else {
+            fprintf(stderr, "Invalid option %s to load\n", opts.opt);
+            return 0;
+        }
+    }
+    if (name[0] == '\0') {
+        fprintf(stderr, "Load needs file=\n");
+        return 0;
+    }
+    return storage_load(name, format, addr);
+}
+
+SIM_OPT_STRUCT(LOAD);
+
+int
+simDUMP_create(struct _option *opt)
+{
+    struct _option   opts;
+    char             name[1024];
+    uint32_t         addr = 0;
+    uint32_t         len = 0;
+
+    name[0] = '\0';
+    while (get_option(&opts)) {
+        if (strcmp(opts.opt, "FILE") == 0 && opts.flags == 1) {
+            if (strlen(opts.string) >= sizeof(name)) {
+                fprintf(stderr, "File name too long %s\n", opts.string);
+                return 0;
+            }
+            strcpy(name, opts.string);
+        } else if (strcmp(opts.opt, "ADDR") == 0 && opts.flags == 1) {
+            if (!get_hex(&opts, &addr))
+                return 0;
+        } else if (strcmp(opts.opt, "LEN") == 0 && opts.flags == 1) {
+            if (!get_hex(&opts, &len))
+                return 0;
+        } else {
+            fprintf(stderr, "Invalid option %s to dump\n", opts.opt);
+            return 0;
+        }
+    }
+    if (name[0] == '\0') {
+        fprintf(stderr, "Dump needs file=\n");
+        return 0;
+    }
+    return storage_dump_add(name, addr, len);
+}
+
+SIM_OPT_STRUCT(DUMP);
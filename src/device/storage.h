@@ -0,0 +1,77 @@
+/*
+ * microsim360 - Load and dump main storage.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _STORAGE_H_
+#define _STORAGE_H_
+
+#include <stdint.h>
+
+/*
+ * Load files straight into main storage, and dump it to files, without
+ * running the machine.  Bytes are packed into M as the CPU holds them,
+ * one byte with parity per entry on the 2030, four bytes per word on
+ * the 2050, and the blocks written are marked for checkpoints.
+ *
+ * Formats:
+ *    raw      bytes loaded at an address.
+ *    object   object deck of 80 byte EBCDIC cards.  TXT cards are
+ *             loaded, and RLD address constants moved if the deck is
+ *             loaded away from where it was assembled.  The END card
+ *             entry is logged.  Only one control section is moved,
+ *             external references are left alone.
+ *    image    all of storage from address 0, as dump writes it.
+ *
+ * In the configuration file:
+ *    load file="name" [addr=hex] [format=raw|object|image]
+ *    dump file="name" [addr=hex] [len=hex]
+ * A dump is written at the end of the run, all of storage if no len.
+ */
+
+#define STORAGE_AUTO    0           /* Object if it looks like one, else raw */
+#define STORAGE_RAW     1
+#define STORAGE_OBJECT  2
+#define STORAGE_IMAGE   3
+
+#define STORAGE_ASSEMBLED  0xffffffff   /* Load object where assembled */
+
+/* Write len bytes at addr, return number written */
+uint32_t storage_write(uint32_t addr, const uint8_t *data, uint32_t len);
+
+/* Read len bytes at addr, return number read */
+uint32_t storage_read(uint32_t addr, uint8_t *data, uint32_t len);
+
+/* Load file in format at addr, return 0 on error */
+int  storage_load(const char *name, int format, uint32_t addr);
+
+/* Write len bytes from addr to file, return 0 on error */
+int  storage_dump(const char *name, uint32_t addr, uint32_t len);
+
+/* Dump at end of run, len 0 for all of storage */
+int  storage_dump_add(const char *name, uint32_t addr, uint32_t len);
+
+/* Write all dumps asked for */
+void storage_dump_all();
+
+#endif
@@ -38,6 +38,9 @@
 #include "logger.h"
 #include "tape.h"
 #include "xlat.h"
+#include "stats.h"
+#include "checkpoint.h"
+#include "iothread.h"
 
 struct _tape_image tape_position[1300];
 
@@ -51,6 +54,84 @@ char *tape_label_mode[3] = { "No", "Yes", NULL };
 int max_tape_length;
 int max_tape_pos;
 
+/*
+ * The I/O thread reads the next buffer while the current one is used,
+ * and writes the last buffer while the next is filled.  The read ahead
+ * is dropped whenever anything is written.
+ */
+struct _tape_io {
+     struct _io_req  rreq;              /* Read of next buffer */
+     struct _io_req  wreq;              /* Write of last buffer */
+     long            rpos;              /* Where read ahead is from, or -1 */
+     uint8_t         rbuf[TAPE_BUFFER];
+     uint8_t         wbuf[TAPE_BUFFER];
+};
+
+/*
+ * Collect last write, return error if it failed.
+ */
+static int
+tape_written(struct _tape_buffer *tape)
+{
+     struct _tape_io *io = tape->io;
+     int              r;
+
+     if (io->wreq.state == IO_IDLE)
+         return TAPE_STATUS_OK;
+     r = io_wait(&io->wreq);
+     if (r != io->wreq.len) {
+         log_error("Tape write failed %s %d\n", tape->file_name, r);
+         return TAPE_STATUS_FILE_ERROR;
+     }
+     return TAPE_STATUS_OK;
+}
+
+/*
+ * Start writing buffer to file at pos.
+ */
+static int
+tape_flush(struct _tape_buffer *tape)
+{
+     struct _tape_io *io = tape->io;
+     int              r;
+
+     if ((r = tape_written(tape)) != TAPE_STATUS_OK)
+         return r;
+     checkpoint_file(tape->fd, (long)tape->pos, tape->len_buff);
+     memcpy(io->wbuf, tape->buffer, tape->len_buff);
+     io_start(&io->wreq, IO_WRITE, tape->fd, (long)tape->pos, io->wbuf, tape->len_buff);
+     io->rpos = -1;
+     tape->dirty = 0;
+     return TAPE_STATUS_OK;
+}
+
+/*
+ * Fill buffer from file at pos, return length read.  If forw start
+ * reading the buffer after it.
+ */
+static int
+tape_fill(struct _tape_buffer *tape, int forw)
+{
+     struct _tape_io *io = tape->io;
+     int              len;
+
+     if (io->rpos == (long)tape->pos) {
+         len = io_wait(&io->rreq);
+         if (len > 0)
+             memcpy(tape->buffer, io->rbuf, len);
+     } else {
+         io_start(&io->rreq, IO_READ, tape->fd, (long)tape->pos, tape->buffer,
+                  sizeof(tape->buffer));
+         len = io_wait(&io->rreq);
+     }
+     io->rpos = -1;
+     if (forw && len == sizeof(tape->buffer)) {
+         io->rpos = (long)tape->pos + len;
+         io_start(&io->rreq, IO_READ, tape->fd, io->rpos, io->rbuf, sizeof(io->rbuf));
+     }
+     return len;
+}
+
 /*
  * Check it tape at load point.
  */
@@ -128,6 +209,7 @@ int
 tape_attach(struct _tape_buffer *tape, char *file_name, int type, int ring, int den)
 {
       int    flags;
+      checkpoint_changed();
       tape->format = type | (tape->format & TRACK9);
       if (ring) {
            flags = O_RDWR|O_CREAT;
@@ -145,8 +227,18 @@ tape_attach(struct _tape_buffer *tape, char *file_name, int type, int ring, int
       tape->srec = 0;
       tape->dirty = 0;
       tape->format |= ONLINE|TAPE_BOT|ATTACHED;
+      /* File may still be being written from last attach */
+      io_sync();
       if ((tape->fd = open(file_name, flags, 0660)) < 0)
           return 0;
+      if (tape->io == NULL &&
+             (tape->io = (struct _tape_io *)calloc(1, sizeof(struct _tape_io))) == NULL) {
+          close(tape->fd);
+          tape->fd = -1;
+          return 0;
+      }
+      tape->io->rpos = -1;
+      checkpoint_area("tape io", tape->io, sizeof(struct _tape_io));
       tape->file_name = strdup(file_name);
       return 1;
 }
@@ -160,17 +252,19 @@ tape_attach(struct _tape_buffer *tape, char *file_name, int type, int ring, int
 void
 tape_detach(struct _tape_buffer *tape)
 {
-    int  r;
-    /* If buffer is dirty flush it to the file */
-    if (tape->dirty) {
-        lseek(tape->fd, tape->pos, SEEK_SET);
-        r = write(tape->fd, tape->buffer, tape->len_buff);
-        if (r != tape->len_buff) {
-            log_error("Tape write failed %s %d\n", tape->file_name, r);
-        }
-        tape->dirty = 0;
+    checkpoint_changed();
+    if (tape->io != NULL) {
+        /* If buffer is dirty flush it to the file */
+        if (tape->dirty)
+            (void)tape_flush(tape);
+        /* Wait for last write so errors are reported */
+        (void)tape_written(tape);
+        (void)io_wait(&tape->io->rreq);
+        checkpoint_forget(tape->io);
+        free(tape->io);
+        tape->io = NULL;
+        io_post(IO_CLOSE, tape->fd, 0, NULL, 0);
     }
-    close(tape->fd);
     tape->fd = -1;
     tape->format &= ~(ONLINE|ATTACHED);
     free(tape->file_name);
@@ -194,20 +288,14 @@ tape_read_byte(struct _tape_buffer *tape, uint8_t *data)
          /* If buffer is dirty flush it to the file */
          if (tape->dirty) {
              int     r;
-             lseek(tape->fd, tape->pos, SEEK_SET);
-             r = write(tape->fd, tape->buffer, tape->len_buff);
-             if (r != tape->len_buff) {
-                 log_error("Tape write failed %s %d\n", tape->file_name, r);
-                 return TAPE_STATUS_FILE_ERROR;
-             }
+             if ((r = tape_flush(tape)) != TAPE_STATUS_OK)
+                 return r;
              tape->pos += tape->len_buff;
              tape->len_buff = 0;
-             tape->dirty = 0;
          }
          /* Advance tape by size of buffer */
          tape->pos += tape->len_buff;
-         lseek(tape->fd, tape->pos, SEEK_SET);
-         tape->len_buff = read(tape->fd, tape->buffer, sizeof(tape->buffer));
+         tape->len_buff = tape_fill(tape, 1);
          tape->pos_buff = 0;
          if (tape->len_buff <= 0) {
              tape->format |= TAPE_EOT;
@@ -239,20 +327,14 @@ tape_peek_byte(struct _tape_buffer *tape, uint8_t *data)
          /* If buffer is dirty flush it to the file */
          if (tape->dirty) {
              int     r;
-             lseek(tape->fd, tape->pos, SEEK_SET);
-             r = write(tape->fd, tape->buffer, tape->len_buff);
-             if (r != tape->len_buff) {
-                 log_error("Tape write failed %s %d\n", tape->file_name, r);
-                 return TAPE_STATUS_FILE_ERROR;
-             }
+             if ((r = tape_flush(tape)) != TAPE_STATUS_OK)
+                 return r;
              tape->pos += tape->len_buff;
              tape->len_buff = 0;
-             tape->dirty = 0;
          }
          /* Advance tape by size of buffer */
          tape->pos += tape->len_buff;
-         lseek(tape->fd, tape->pos, SEEK_SET);
-         tape->len_buff = read(tape->fd, tape->buffer, sizeof(tape->buffer));
+         tape->len_buff = tape_fill(tape, 1);
          tape->pos_buff = 0;
          if (tape->len_buff <= 0) {
              log_tape("Tape EOT\n");
@@ -281,14 +363,9 @@ tape_write_byte(struct _tape_buffer *tape, uint8_t data)
          /* If buffer is dirty flush it to the file */
          if (tape->dirty) {
              int     r;
-             lseek(tape->fd, tape->pos, SEEK_SET);
-             r = write(tape->fd, tape->buffer, tape->len_buff);
-             if (r != tape->len_buff) {
-                 log_error("Tape write failed %s %d\n", tape->file_name, r);
-                 return TAPE_STATUS_FILE_ERROR;
-             }
+             if ((r = tape_flush(tape)) != TAPE_STATUS_OK)
+                 return r;
              tape->pos += tape->len_buff;
-             tape->dirty = 0;
          }
          tape->len_buff = 0;
          tape->pos_buff = 0;
@@ -318,13 +395,8 @@ tape_readbk_byte(struct _tape_buffer *tape, uint8_t *data)
          /* If buffer is dirty flush it to the file */
          if (tape->dirty) {
              int     r;
-             lseek(tape->fd, tape->pos, SEEK_SET);
-             r = write(tape->fd, tape->buffer, tape->len_buff);
-             if (r != tape->len_buff) {
-                 log_error("Tape write failed %s %d\n", tape->file_name, r);
-                 return TAPE_STATUS_FILE_ERROR;
-             }
-             tape->dirty = 0;
+             if ((r = tape_flush(tape)) != TAPE_STATUS_OK)
+                 return r;
          }
          if (tape->format & TAPE_BOT) {
             return TAPE_STATUS_BOT;
@@ -345,8 +417,7 @@ tape_readbk_byte(struct _tape_buffer *tape, uint8_t *data)
              } else {
                  tape->pos -= sizeof(tape->buffer);
              }
-             lseek(tape->fd, tape->pos, SEEK_SET);
-             tape->len_buff = read(tape->fd, tape->buffer, sizeof(tape->buffer));
+             tape->len_buff = tape_fill(tape, 0);
              if (opos == -1) {
                  tape->pos_buff = tape->len_buff;
              } else {
@@ -381,11 +452,16 @@ tape_write_prev(struct _tape_buffer *tape, uint8_t data)
          }
          tape->dirty = 1;
      } else {
-         /* Point file at it and write one byte */
-         lseek(tape->fd, tape->srec, SEEK_SET);
-         if (write(tape->fd, &data, 1) != 1) {
-             return TAPE_STATUS_FILE_ERROR;
-         }
+         /* Write one byte behind the buffer */
+         struct _tape_io *io = tape->io;
+         int              r;
+
+         if ((r = tape_written(tape)) != TAPE_STATUS_OK)
+             return r;
+         checkpoint_file(tape->fd, tape->srec, 1);
+         io->wbuf[0] = data;
+         io_start(&io->wreq, IO_WRITE, tape->fd, tape->srec, io->wbuf, 1);
+         io->rpos = -1;
      }
      tape->srec++;
      return TAPE_STATUS_OK;
@@ -796,6 +872,8 @@ tape_read_frame(struct _tape_buffer *tape, uint8_t *data)
                    break;
      }
      tape->pos_frame += l;
+     if (r == TAPE_STATUS_OK)
+         stats.tape_reads++;
      return r;
 }
 
@@ -814,6 +892,7 @@ tape_write_frame(struct _tape_buffer *tape, uint8_t data)
      }
      tape->lrecl++;
      tape->pos_frame += ((tape->format & DENSITY_MASK) == DEN_800) ? 2 : 1;
+     stats.tape_writes++;
      return tape_write_byte(tape, data);
 }
 
@@ -983,12 +1062,8 @@ tape_start_rewind(struct _tape_buffer *tape)
     /* If buffer is dirty flush it to the file */
     if (tape->dirty) {
         int     r;
-        lseek(tape->fd, tape->pos, SEEK_SET);
-        r = write(tape->fd, tape->buffer, tape->len_buff);
-        if (r != tape->len_buff) {
-            return TAPE_STATUS_FILE_ERROR;
-        }
-        tape->dirty = 0;
+        if ((r = tape_flush(tape)) != TAPE_STATUS_OK)
+            return r;
     }
     tape->pos = 0;
     tape->pos_buff = 0;
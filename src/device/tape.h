@@ -70,6 +70,8 @@
 #define TAPE_STATUS_MARK           6   /* Tape mark read */
 #define TAPE_STATUS_WRP            7   /* Tape write protected */
 
+#define TAPE_BUFFER        (32*1024)   /* Size of file buffer */
+
 struct _tape_buffer {
      char         *file_name;           /* File name attached to */
      int           fd;                  /* Open file descriptor. */
@@ -83,7 +85,8 @@ struct _tape_buffer {
      int           parity;              /* Record incomplete */
      long          srec;                /* Start of record offset for TAP and E11 format */
      int           dirty;               /* Buffer dirty */
-     uint8_t       buffer[32*1024];     /* Buffer of current record */
+     struct _tape_io *io;               /* Read ahead and write behind */
+     uint8_t       buffer[TAPE_BUFFER]; /* Buffer of current record */
 };
 
 extern struct _tape_image {
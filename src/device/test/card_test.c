@@ -29,10 +29,11 @@
 #include "ctest.h"
 #include "logger.h"
 #include "card.h"
+#include "machine.h"
 
 static struct card_context *card_ctx;
 
-uint64_t step_count = 0;
+MACHINE_LOCAL uint64_t step_count = 0;
 
 /* Create a card file with number of cards. */
 static
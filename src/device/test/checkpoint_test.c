@@ -0,0 +1,268 @@
+/*
+ * microsim360 - Test checkpoints.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include "ctest.h"
+#include "event.h"
+#include "journal.h"
+#include "cpu.h"
+#include "checkpoint.h"
+
+extern MACHINE_LOCAL uint64_t step_count;
+
+static uint8_t           state[5000];   /* Spans three pages */
+static uint32_t          key;           /* Last input taken */
+static int               fired;         /* Events fired */
+static struct _device    test_dev;
+
+static void
+tick_callback(struct _device *unit, void *arg, int iarg)
+{
+    fired++;
+    state[iarg] = (uint8_t)step_count;
+    add_event(unit, &tick_callback, 37, NULL, (iarg + 1) % 5000);
+}
+
+/* One machine step: change a little state and take inputs */
+static void
+test_step()
+{
+    step_count++;
+    journal_step();
+    state[(step_count * 7) % sizeof(state)] ^= (uint8_t)step_count;
+    if (journal_mode == JOURNAL_RECORD) {
+        if ((step_count % 50) == 3) {
+            key = (uint32_t)step_count;
+            journal_input("KEY", key);
+        }
+    } else {
+        journal_next("KEY", &key);
+    }
+    advance();
+    checkpoint_step();
+}
+
+static void
+setup()
+{
+    step_count = 0;
+    fired = 0;
+    key = 0;
+    memset(state, 0, sizeof(state));
+    checkpoint_every = 100;
+    checkpoint_area("test", state, sizeof(state));
+    checkpoint_area("fired", &fired, sizeof(fired));
+    checkpoint_area("key", &key, sizeof(key));
+    add_event(&test_dev, &tick_callback, 10, NULL, 0);
+}
+
+static void
+finish()
+{
+    cancel_event(&test_dev, &tick_callback);
+    checkpoint_stop();
+    checkpoint_forget(state);
+    checkpoint_forget(&fired);
+    checkpoint_forget(&key);
+    journal_close();
+    checkpoint_every = 0;
+}
+
+/* Going back gives the same state as the first time through */
+CTEST(checkpoint_test, back) {
+    uint8_t   copy[sizeof(state)];
+    int       copy_fired = 0;
+    uint32_t  copy_key = 0;
+
+    setup();
+    ASSERT_TRUE(checkpoint_start());
+    while (step_count < 1000) {
+        test_step();
+        if (step_count == 555) {
+            memcpy(copy, state, sizeof(state));
+            copy_fired = fired;
+            copy_key = key;
+        }
+    }
+    ASSERT_EQUAL(11, checkpoint_count());
+    ASSERT_TRUE(checkpoint_back(555, &test_step));
+    ASSERT_EQUAL(555, step_count);
+    ASSERT_DATA(copy, sizeof(copy), state, sizeof(state));
+    ASSERT_EQUAL(copy_fired, fired);
+    ASSERT_EQUAL(553, key);
+    ASSERT_EQUAL(copy_key, key);
+    /* Checkpoints after step are gone, inputs are live again */
+    ASSERT_EQUAL(6, checkpoint_count());
+    ASSERT_EQUAL(JOURNAL_RECORD, journal_mode);
+    finish();
+}
+
+/* Running on after going back gives the same state as not going back */
+CTEST(checkpoint_test, forward) {
+    uint8_t   copy[sizeof(state)];
+    int       copy_fired;
+
+    setup();
+    ASSERT_TRUE(checkpoint_start());
+    while (step_count < 800)
+        test_step();
+    memcpy(copy, state, sizeof(state));
+    copy_fired = fired;
+    ASSERT_TRUE(checkpoint_back(250, &test_step));
+    while (step_count < 800)
+        test_step();
+    ASSERT_DATA(copy, sizeof(copy), state, sizeof(state));
+    ASSERT_EQUAL(copy_fired, fired);
+    finish();
+}
+
+/* Nothing to go back to before first checkpoint */
+CTEST(checkpoint_test, too_far) {
+    setup();
+    step_count = 1000;
+    ASSERT_TRUE(checkpoint_start());
+    test_step();
+    ASSERT_FALSE(checkpoint_back(500, &test_step));
+    ASSERT_EQUAL(1001, step_count);
+    finish();
+}
+
+/* Oldest checkpoints are dropped to stay in memory budget */
+CTEST(checkpoint_test, memory) {
+    size_t    save = checkpoint_memory;
+
+    setup();
+    checkpoint_memory = 4 * sizeof(state);
+    ASSERT_TRUE(checkpoint_start());
+    while (step_count < 1000)
+        test_step();
+    ASSERT_TRUE(checkpoint_count() < 11);
+    ASSERT_TRUE(checkpoint_oldest() > 0);
+    ASSERT_FALSE(checkpoint_back(50, &test_step));
+    checkpoint_memory = save;
+    finish();
+}
+
+/* Files written after a checkpoint are put back */
+CTEST(checkpoint_test, file) {
+    char      name[] = "checkpoint_test.dat";
+    char      buf[16];
+    int       fd;
+
+    setup();
+    fd = open(name, O_RDWR|O_CREAT|O_TRUNC, 0660);
+    ASSERT_TRUE(fd >= 0);
+    ASSERT_EQUAL(4, write(fd, "AAAA", 4));
+    ASSERT_TRUE(checkpoint_start());
+    while (step_count < 150)
+        test_step();
+    checkpoint_file(fd, 0, 4);
+    ASSERT_EQUAL(4, write(fd, "BBBB", 4));
+    while (step_count < 250)
+        test_step();
+    checkpoint_file(fd, -1, 4);
+    ASSERT_EQUAL(4, write(fd, "CCCC", 4));
+    ASSERT_EQUAL(8, lseek(fd, 0, SEEK_END));
+    ASSERT_TRUE(checkpoint_back(120, &test_step));
+    ASSERT_EQUAL(4, lseek(fd, 0, SEEK_END));
+    (void)lseek(fd, 0, SEEK_SET);
+    memset(buf, 0, sizeof(buf));
+    ASSERT_EQUAL(4, read(fd, buf, sizeof(buf)));
+    ASSERT_STR("AAAA", buf);
+    close(fd);
+    remove(name);
+    finish();
+}
+
+/* Adding an area makes older checkpoints no good */
+CTEST(checkpoint_test, changed) {
+    static uint32_t   extra;
+
+    setup();
+    ASSERT_TRUE(checkpoint_start());
+    while (step_count < 500)
+        test_step();
+    checkpoint_area("extra", &extra, sizeof(extra));
+    ASSERT_FALSE(checkpoint_back(450, &test_step));
+    checkpoint_forget(&extra);
+    finish();
+}
+
+/* Only blocks marked written are looked at */
+CTEST(checkpoint_test, dirty) {
+    static uint32_t   mem[2048];
+    uint32_t          map[1];
+
+    setup();
+    memset(mem, 0, sizeof(mem));
+    map[0] = 0xffffffff;
+    checkpoint_area("mem", mem, sizeof(mem));
+    checkpoint_dirty(mem, map, 11);
+    ASSERT_TRUE(checkpoint_start());
+    ASSERT_EQUAL(0, map[0]);
+    mem[0] = 1;
+    map[0] |= 1;
+    mem[600] = 2;                      /* Block 1 not marked */
+    while (step_count < 150)
+        test_step();
+    ASSERT_EQUAL(0, map[0]);
+    mem[0] = 5;
+    map[0] |= 1;
+    ASSERT_TRUE(checkpoint_back(120, &test_step));
+    ASSERT_EQUAL(1, mem[0]);
+    ASSERT_EQUAL(0, mem[600]);
+    ASSERT_EQUAL(0, map[0]);
+    checkpoint_forget(mem);
+    finish();
+}
+
+/* Stores to main storage mark their 2K block */
+CTEST(checkpoint_test, store_main) {
+    static uint32_t   mem[0x4000];
+    uint32_t         *save = M;
+
+    M = mem;
+    ASSERT_TRUE(storage_track(0x4000, 1));
+    ASSERT_EQUAL(11, M_shift);
+    ASSERT_EQUAL(0xffffffff, M_dirty[0]);
+    M_dirty[0] = 0;
+    store_main(0x1801, 0x55);
+    ASSERT_EQUAL(0x55, mem[0x1801]);
+    ASSERT_EQUAL(0x08, M_dirty[0]);
+    ASSERT_TRUE(storage_track(0x4000, 4));
+    ASSERT_EQUAL(9, M_shift);
+    M_dirty[0] = 0;
+    store_main(0x3fff, 0xaabbccdd);
+    ASSERT_EQUAL(0x80000000, M_dirty[0]);
+    M = save;
+}
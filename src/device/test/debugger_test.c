@@ -0,0 +1,277 @@
+/*
+ * microsim360 - Breakpoint test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#define closesocket close
+#define SOCKET int
+#else
+#include <winsock2.h>
+#endif
+#include "ctest.h"
+#include "cpu.h"
+#include "journal.h"
+#include "checkpoint.h"
+#include "debugger.h"
+
+#define TEST_PORT  39871
+
+static uint8_t    back_state[256];
+
+/* One machine step for going back */
+static void
+back_step()
+{
+    step_count++;
+    journal_step();
+    debug_step();
+    back_state[step_count & 0xff]++;
+    checkpoint_step();
+}
+
+/* Breakpoints set bits only for the pages they cover */
+CTEST(debugger_test, maps) {
+    int     n1, n2, n3;
+
+    debug_delete(0);
+    n1 = debug_add(DEBUG_INST, 0x1000, 1);
+    n2 = debug_add(DEBUG_WRITE, 0x17fe, 4);
+    n3 = debug_add(DEBUG_RBREAK, 0x123, 1);
+    ASSERT_NOT_EQUAL(0, n1);
+    ASSERT_NOT_EQUAL(n1, n2);
+    ASSERT_EQUAL(0x4, debug_inst[0]);
+    ASSERT_EQUAL(0x0, debug_read[0]);
+    ASSERT_EQUAL(0xc, debug_write[0]);
+    ASSERT_TRUE(DEBUG_BIT(debug_ros, 0x123));
+    ASSERT_FALSE(DEBUG_BIT(debug_ros, 0x122));
+    ASSERT_TRUE(debug_delete(n2));
+    ASSERT_FALSE(debug_delete(n2));
+    ASSERT_EQUAL(0x0, debug_write[0]);
+    ASSERT_EQUAL(0x4, debug_inst[0]);
+    ASSERT_EQUAL(0, debug_add(DEBUG_RBREAK, DEBUG_ROS, 1));
+    ASSERT_TRUE(debug_delete(n3));
+    debug_delete(0);
+    ASSERT_EQUAL(0x0, debug_inst[0]);
+    ASSERT_FALSE(DEBUG_BIT(debug_ros, 0x123));
+}
+
+/* Only an address in the list stops the machine */
+CTEST(debugger_test, inst) {
+    debug_delete(0);
+    debug_stopped = 0;
+    debug_add(DEBUG_INST, 0x1004, 1);
+    debug_inst_check(0x1002);
+    ASSERT_EQUAL(0, debug_stopped);
+    debug_inst_check(0x8002);
+    ASSERT_EQUAL(0, debug_stopped);
+    debug_inst_check(0x1004);
+    ASSERT_EQUAL(DEBUG_INST, debug_stopped);
+    debug_delete(0);
+    debug_stopped = 0;
+}
+
+/* Watches are checked on load_main and store_main */
+CTEST(debugger_test, watch) {
+    static uint32_t   mem[0x4000];
+    uint32_t         *save = M;
+
+    M = mem;
+    ASSERT_TRUE(storage_track(0x4000, 4));
+    debug_delete(0);
+    debug_stopped = 0;
+    debug_add(DEBUG_READ, 0x2006, 2);
+    debug_add(DEBUG_WRITE, 0x3000, 1);
+    store_main(0x2004 >> 2, 1);
+    (void)load_main(0x2000 >> 2);
+    (void)load_main(0x3000 >> 2);
+    ASSERT_EQUAL(0, debug_stopped);
+    (void)load_main(0x2004 >> 2);
+    ASSERT_EQUAL(DEBUG_READ, debug_stopped);
+    debug_stopped = 0;
+    store_main(0x3000 >> 2, 2);
+    ASSERT_EQUAL(DEBUG_WRITE, debug_stopped);
+    debug_delete(0);
+    debug_stopped = 0;
+    M = save;
+}
+
+/* ROS breakpoint holds the clock until continued, then runs once */
+CTEST(debugger_test, ros) {
+    struct sockaddr_in   addr;
+    SOCKET               s;
+    char                 buf[128] = "";
+    int                  len = 0;
+    int                  r;
+    int                  power = POWER;
+
+    debug_delete(0);
+    debug_stopped = 0;
+    ASSERT_TRUE(debug_open(TEST_PORT));
+    ASSERT_EQUAL(1, debug_active);
+    debug_add(DEBUG_RBREAK, 0x188, 1);
+    ASSERT_FALSE(debug_ros_check(0x187));
+    ASSERT_TRUE(debug_ros_check(0x188));
+    ASSERT_EQUAL(DEBUG_RBREAK, debug_stopped);
+    ASSERT_TRUE(debug_ros_check(0x188));
+
+    s = socket(PF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(TEST_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQUAL(0, connect(s, (struct sockaddr *)&addr, sizeof(addr)));
+    ASSERT_EQUAL(5, send(s, "cont\n", 5, 0));
+    POWER = 1;
+    debug_step();
+    POWER = power;
+    ASSERT_EQUAL(0, debug_stopped);
+    while (len < (int)sizeof(buf) - 1 && strstr(buf, "ok\n") == NULL) {
+        if ((r = recv(s, &buf[len], sizeof(buf) - 1 - len, 0)) <= 0)
+            break;
+        len += r;
+        buf[len] = '\0';
+    }
+    ASSERT_EQUAL(0, strncmp(buf, "stopped rbreak 188 ", 19));
+    ASSERT_NOT_NULL(strstr(buf, "ok\n"));
+
+    /* Runs the word once, then stops there again */
+    ASSERT_FALSE(debug_ros_check(0x188));
+    ASSERT_TRUE(debug_ros_check(0x188));
+    debug_stopped = 0;
+    closesocket(s);
+    debug_close();
+    ASSERT_EQUAL(0, debug_active);
+    debug_delete(0);
+}
+
+/* Asking for next instruction stops at the first one seen */
+CTEST(debugger_test, next_inst) {
+    debug_delete(0);
+    debug_stopped = 0;
+    debug_next_inst(DEBUG_REQUEST);
+    ASSERT_EQUAL(0xffffffff, debug_inst[0]);
+    debug_inst_check(0x8006);
+    ASSERT_EQUAL(DEBUG_REQUEST, debug_stopped);
+    ASSERT_EQUAL(0x8006, debug_addr);
+    ASSERT_EQUAL(0x0, debug_inst[0]);
+    debug_resume();
+    ASSERT_EQUAL(0, debug_stopped);
+    debug_inst_check(0x800a);
+    ASSERT_EQUAL(0, debug_stopped);
+
+    /* Resume drops a stop not yet taken */
+    debug_next_inst(DEBUG_REQUEST);
+    debug_resume();
+    ASSERT_EQUAL(0x0, debug_inst[0]);
+}
+
+/* Watches can wait for the instruction to finish */
+CTEST(debugger_test, watch_inst) {
+    static uint32_t   mem[0x4000];
+    uint32_t         *save = M;
+    uint32_t          save_max = mem_max;
+    uint8_t           byte;
+    int               n;
+
+    M = mem;
+    ASSERT_TRUE(storage_track(0x4000, 4));
+    mem_max = 0xffff;
+    debug_delete(0);
+    debug_stopped = 0;
+    debug_watch_inst = 1;
+    n = debug_add(DEBUG_WRITE, 0x100, 4);
+    ASSERT_EQUAL(n, debug_find(DEBUG_WRITE, 0x100, 4));
+    ASSERT_EQUAL(0, debug_find(DEBUG_READ, 0x100, 4));
+    store_main(0x100 >> 2, 0x12345678);
+    ASSERT_EQUAL(0, debug_stopped);
+    ASSERT_EQUAL(0x100, debug_data);
+    debug_inst_check(0x2004);
+    ASSERT_EQUAL(DEBUG_WRITE, debug_stopped);
+    ASSERT_EQUAL(0x2004, debug_addr);
+    ASSERT_TRUE(debug_read_byte(0x101, &byte));
+    ASSERT_EQUAL(0x34, byte);
+    ASSERT_FALSE(debug_read_byte(0x10000, &byte));
+    debug_watch_inst = 0;
+    debug_delete(0);
+    debug_stopped = 0;
+    mem_max = save_max;
+    M = save;
+}
+
+/* Back command runs forward from a checkpoint and stops there */
+CTEST(debugger_test, back) {
+    struct sockaddr_in   addr;
+    uint8_t              copy[sizeof(back_state)];
+    SOCKET               s;
+    int                  power = POWER;
+
+    debug_delete(0);
+    debug_stopped = 0;
+    step_count = 0;
+    memset(back_state, 0, sizeof(back_state));
+    checkpoint_every = 100;
+    checkpoint_area("back", back_state, sizeof(back_state));
+    ASSERT_TRUE(checkpoint_start());
+    while (step_count < 349)
+        back_step();
+    memcpy(copy, back_state, sizeof(copy));
+    while (step_count < 500)
+        back_step();
+
+    ASSERT_TRUE(debug_open(TEST_PORT + 1));
+    s = socket(PF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(TEST_PORT + 1);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQUAL(0, connect(s, (struct sockaddr *)&addr, sizeof(addr)));
+    ASSERT_EQUAL(9, send(s, "back 350\n", 9, 0));
+    debug_stopped = DEBUG_REQUEST;
+    POWER = 1;
+    debug_step();
+    ASSERT_EQUAL(0, debug_stopped);
+    ASSERT_EQUAL(350, debug_back);
+    debug_go_back(&back_step);
+    POWER = power;
+    ASSERT_EQUAL(0, debug_back);
+    ASSERT_EQUAL(349, step_count);
+    ASSERT_EQUAL(DEBUG_REQUEST, debug_stopped);
+    ASSERT_DATA(copy, sizeof(copy), back_state, sizeof(back_state));
+
+    debug_stopped = 0;
+    closesocket(s);
+    debug_close();
+    checkpoint_stop();
+    checkpoint_forget(back_state);
+    journal_close();
+    checkpoint_every = 0;
+}
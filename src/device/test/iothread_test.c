@@ -0,0 +1,121 @@
+/*
+ * microsim360 - Host file I/O thread test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef _WIN32
+#include <io.h>
+#endif
+#include "ctest.h"
+#include "iothread.h"
+
+#define BLOCKS   64
+
+/* Reads see writes queued ahead of them */
+CTEST(iothread_test, order) {
+    static uint8_t   out[BLOCKS][512];
+    static uint8_t   in[BLOCKS][512];
+    struct _io_req   wreq[BLOCKS];
+    struct _io_req   rreq[BLOCKS];
+    int              fd;
+    int              i;
+
+    fd = open("iothread_test.bin", O_RDWR|O_CREAT|O_TRUNC, 0660);
+    ASSERT_TRUE(fd >= 0);
+    memset(wreq, 0, sizeof(wreq));
+    memset(rreq, 0, sizeof(rreq));
+    for (i = 0; i < BLOCKS; i++) {
+        memset(out[i], i, sizeof(out[i]));
+        io_start(&wreq[i], IO_WRITE, fd, (long)(BLOCKS - 1 - i) * 512, out[i], 512);
+        io_start(&rreq[i], IO_READ, fd, (long)(BLOCKS - 1 - i) * 512, in[i], 512);
+    }
+    for (i = BLOCKS - 1; i >= 0; i--) {
+        ASSERT_EQUAL(512, io_wait(&rreq[i]));
+        ASSERT_EQUAL(IO_IDLE, rreq[i].state);
+        ASSERT_DATA(out[i], 512, in[i], 512);
+    }
+    for (i = 0; i < BLOCKS; i++)
+        ASSERT_EQUAL(512, io_wait(&wreq[i]));
+    /* Past end of file reads nothing */
+    io_start(&rreq[0], IO_READ, fd, BLOCKS * 512, in[0], 512);
+    ASSERT_EQUAL(0, io_wait(&rreq[0]));
+    close(fd);
+    remove("iothread_test.bin");
+}
+
+/* Posted writes go at the file position, then the file is closed */
+CTEST(iothread_test, post) {
+    uint8_t         *buf;
+    uint8_t          in[16];
+    FILE            *f;
+    int              fd;
+    int              i;
+
+    fd = open("iothread_test.bin", O_RDWR|O_CREAT|O_TRUNC, 0660);
+    ASSERT_TRUE(fd >= 0);
+    for (i = 0; i < 4; i++) {
+        buf = (uint8_t *)malloc(4);
+        ASSERT_NOT_NULL(buf);
+        memset(buf, 'a' + i, 4);
+        io_post(IO_WRITE|IO_FREE, fd, -1, buf, 4);
+    }
+    io_post(IO_CLOSE, fd, 0, NULL, 0);
+    io_sync();
+    f = fopen("iothread_test.bin", "rb");
+    ASSERT_NOT_NULL(f);
+    ASSERT_EQUAL(16, fread(in, 1, sizeof(in), f));
+    ASSERT_DATA((const unsigned char *)"aaaabbbbccccdddd", 16, in, 16);
+    fclose(f);
+    remove("iothread_test.bin");
+}
+
+/* Starting a request that is still queued waits for it */
+CTEST(iothread_test, restart) {
+    uint8_t          a[4] = { 1, 2, 3, 4 };
+    uint8_t          b[4] = { 5, 6, 7, 8 };
+    uint8_t          in[8];
+    struct _io_req   req;
+    int              fd;
+
+    fd = open("iothread_test.bin", O_RDWR|O_CREAT|O_TRUNC, 0660);
+    ASSERT_TRUE(fd >= 0);
+    memset(&req, 0, sizeof(req));
+    io_start(&req, IO_WRITE, fd, 0, a, 4);
+    io_start(&req, IO_WRITE, fd, 4, b, 4);
+    ASSERT_EQUAL(4, io_wait(&req));
+    io_start(&req, IO_READ, fd, 0, in, 8);
+    ASSERT_EQUAL(8, io_wait(&req));
+    ASSERT_DATA(a, 4, &in[0], 4);
+    ASSERT_DATA(b, 4, &in[4], 4);
+    close(fd);
+    remove("iothread_test.bin");
+}
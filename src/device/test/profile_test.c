@@ -0,0 +1,111 @@
+/*
+ * microsim360 - Microcode profiler test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ctest.h"
+#include "profile.h"
+
+static const char *
+test_note(int addr)
+{
+    static const char *notes[] = { "QA100:A1", "QA100:A2", "QB200:B1", " " };
+    return (addr < 4) ? notes[addr] : NULL;
+}
+
+/* Without a profile file nothing is counted */
+CTEST(profile_test, disabled) {
+    struct _profile *p;
+
+    profile_file = NULL;
+    p = profile_create("none", PROF_ROWS, &test_note);
+    ASSERT_NULL(p);
+    PROFILE(p, 1, 0);
+    PROFILE_INST(p, 0x1a);
+}
+
+/* Counts land in opcode and channel rows */
+CTEST(profile_test, count) {
+    struct _profile *p;
+    int              i;
+
+    profile_file = "profile.out";
+    p = profile_create("cpu", PROF_ROWS, &test_note);
+    ASSERT_NOT_NULL(p);
+    PROFILE_INST(p, 0x1a);
+    for (i = 0; i < 5; i++)
+        PROFILE(p, 1, 0);
+    PROFILE(p, 2, 1);
+    ASSERT_EQUAL(1, p->insts[0x1a]);
+    ASSERT_EQUAL(5, p->count[(0x1a << 12) | 1]);
+    ASSERT_EQUAL(1, p->count[(PROF_CHAN << 12) | 2]);
+    profile_file = NULL;
+}
+
+/* Saved profile reads back into report */
+CTEST(profile_test, report) {
+    struct _profile *p;
+    FILE            *f;
+    FILE            *out;
+    char             line[256];
+    int              found_total = 0;
+    int              found_op = 0;
+    int              found_routine = 0;
+    int              i;
+
+    profile_file = "profile.out";
+    p = profile_create("ctl", 1, &test_note);
+    ASSERT_NOT_NULL(p);
+    for (i = 0; i < 3; i++)
+        PROFILE(p, 0, 0);
+    PROFILE(p, 1, 0);
+    PROFILE(p, 2, 0);
+    ASSERT_TRUE(profile_save());
+    profile_file = NULL;
+
+    f = fopen("profile.out", "r");
+    ASSERT_NOT_NULL(f);
+    out = tmpfile();
+    ASSERT_NOT_NULL(out);
+    ASSERT_TRUE(profile_report(f, out, 10));
+    fclose(f);
+    rewind(out);
+    while (fgets(line, sizeof(line), out) != NULL) {
+        /* From count test */
+        if (strncmp(line, "Model cpu: 6 cycles", 19) == 0)
+            found_total = 1;
+        if (strncmp(line, "  1A AR ", 8) == 0)
+            found_op = 1;
+        if (strncmp(line, "  QA100 ", 8) == 0 && strstr(line, " 4 ") != NULL)
+            found_routine = 1;
+    }
+    fclose(out);
+    (void)remove("profile.out");
+    ASSERT_TRUE(found_total);
+    ASSERT_TRUE(found_op);
+    ASSERT_TRUE(found_routine);
+}
@@ -0,0 +1,170 @@
+/*
+ * microsim360 - Test binary ROS images.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ctest.h"
+#include "rosimg.h"
+
+struct test_ros {
+    uint8_t    a;
+    int        b;
+    uint16_t   c;
+    uint32_t   row;
+    const char *note;
+};
+
+static const struct rosimg_field test_fields[] = {
+    ROSIMG_FIELD(struct test_ros, a), ROSIMG_FIELD(struct test_ros, b),
+    ROSIMG_FIELD(struct test_ros, c), ROSIMG_FIELD(struct test_ros, row),
+    ROSIMG_STR(struct test_ros, note)
+};
+
+#define NFIELDS   (int)(sizeof(test_fields) / sizeof(test_fields[0]))
+
+static void
+fill(struct test_ros *ros, int count)
+{
+    static char  notes[64][8];
+    int          i;
+
+    memset(ros, 0, count * sizeof(struct test_ros));
+    for (i = 0; i < count; i++) {
+        ros[i].a = i & 0xf;
+        ros[i].b = (i & 1) ? -1 : i;
+        ros[i].c = i * 3;
+        ros[i].row = 0x80000000 | i;
+        if (i % 3 == 0) {
+            sprintf(notes[i], "W%03x", i & 0xfff);
+            ros[i].note = notes[i];
+        }
+    }
+}
+
+/* Write image to name, return its size */
+static long
+write_image(const char *name, int model, struct test_ros *ros, int count)
+{
+    FILE  *f;
+    long   len;
+
+    f = fopen(name, "wb");
+    if (f == NULL)
+        return 0;
+    if (!rosimg_write(f, model, ros, sizeof(struct test_ros), count,
+                      test_fields, NFIELDS)) {
+        fclose(f);
+        return 0;
+    }
+    len = ftell(f);
+    fclose(f);
+    return len;
+}
+
+/* Image reads back the same as was written */
+CTEST(rosimg_test, round_trip) {
+    struct test_ros  in[64];
+    struct test_ros  out[64];
+    char            *strtab = NULL;
+    long             len;
+    int              i;
+
+    fill(in, 64);
+    len = write_image("rosimg.ros", 30, in, 64);
+    ASSERT_NOT_EQUAL(0, len);
+    /* Words are packed smaller than the structure */
+    ASSERT_TRUE(len < (long)sizeof(in));
+    /* Clear padding, then put junk in each field */
+    memset(out, 0, sizeof(out));
+    for (i = 0; i < 64; i++) {
+        out[i].a = out[i].b = out[i].c = out[i].row = 0x55;
+        out[i].note = "junk";
+    }
+    ASSERT_EQUAL(ROSIMG_OK, rosimg_load("rosimg.ros", 30, out, sizeof(struct test_ros),
+                                        64, test_fields, NFIELDS, &strtab));
+    ASSERT_NOT_NULL(strtab);
+    for (i = 0; i < 64; i++) {
+        ASSERT_EQUAL(in[i].a, out[i].a);
+        ASSERT_EQUAL(in[i].b, out[i].b);
+        ASSERT_EQUAL(in[i].c, out[i].c);
+        ASSERT_EQUAL(in[i].row, out[i].row);
+        /* Empty notes come back as empty strings in the table */
+        ASSERT_STR((in[i].note == NULL) ? "" : in[i].note, out[i].note);
+    }
+    free(strtab);
+    (void)remove("rosimg.ros");
+}
+
+/* Bad images are refused and leave ROS alone */
+CTEST(rosimg_test, errors) {
+    struct test_ros  in[16];
+    struct test_ros  out[16];
+    struct test_ros  save[16];
+    char            *strtab = NULL;
+    FILE            *f;
+    long             len;
+    int              c;
+
+    fill(in, 16);
+    fill(out, 16);
+    out[3].a = 0xff;
+    memcpy(save, out, sizeof(out));
+    ASSERT_EQUAL(ROSIMG_OPEN, rosimg_load("nofile.ros", 30, out, sizeof(struct test_ros),
+                                          16, test_fields, NFIELDS, &strtab));
+    len = write_image("rosimg.ros", 30, in, 16);
+    ASSERT_NOT_EQUAL(0, len);
+    ASSERT_EQUAL(ROSIMG_MODEL, rosimg_load("rosimg.ros", 50, out, sizeof(struct test_ros),
+                                           16, test_fields, NFIELDS, &strtab));
+    ASSERT_EQUAL(ROSIMG_MODEL, rosimg_load("rosimg.ros", 30, out, sizeof(struct test_ros),
+                                           8, test_fields, NFIELDS, &strtab));
+    ASSERT_EQUAL(ROSIMG_MODEL, rosimg_load("rosimg.ros", 30, out, sizeof(struct test_ros),
+                                           16, test_fields, NFIELDS - 1, &strtab));
+
+    /* Flip a bit in the packed words */
+    f = fopen("rosimg.ros", "r+b");
+    ASSERT_NOT_NULL(f);
+    (void)fseek(f, ROSIMG_HEADER + NFIELDS + 2, SEEK_SET);
+    c = fgetc(f);
+    (void)fseek(f, ROSIMG_HEADER + NFIELDS + 2, SEEK_SET);
+    fputc(c ^ 0x10, f);
+    fclose(f);
+    ASSERT_EQUAL(ROSIMG_CHECK, rosimg_load("rosimg.ros", 30, out, sizeof(struct test_ros),
+                                           16, test_fields, NFIELDS, &strtab));
+
+    /* Not an image at all */
+    f = fopen("rosimg.ros", "wb");
+    ASSERT_NOT_NULL(f);
+    fprintf(f, "#AAA  CN CH   CL   CM  CU CA   CB CK   CD   CF\n");
+    fclose(f);
+    ASSERT_EQUAL(ROSIMG_FORMAT, rosimg_load("rosimg.ros", 30, out, sizeof(struct test_ros),
+                                            16, test_fields, NFIELDS, &strtab));
+    ASSERT_DATA((unsigned char *)save, sizeof(save), (unsigned char *)out, sizeof(out));
+    ASSERT_NULL(strtab);
+    ASSERT_TRUE(rosimg_name("ccros2030.ros"));
+    ASSERT_FALSE(rosimg_name("model2030_ros.h"));
+    (void)remove("rosimg.ros");
+}
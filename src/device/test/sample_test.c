@@ -0,0 +1,117 @@
+/*
+ * microsim360 - Instruction address sampler test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ctest.h"
+#include "sample.h"
+
+/* Without a sample file nothing is counted */
+CTEST(sample_test, disabled) {
+    struct _sample  *s;
+    int              calls = 0;
+
+    sample_file = NULL;
+    s = sample_create("none");
+    ASSERT_NULL(s);
+    /* Address is not worked out when not sampling */
+    SAMPLE(s, calls++, 0);
+    ASSERT_EQUAL(0, calls);
+}
+
+/* Address is taken once every interval cycles */
+CTEST(sample_test, interval) {
+    struct _sample  *s;
+    int              calls = 0;
+    int              i;
+
+    sample_file = "sample.out";
+    sample_interval = 10;
+    s = sample_create("cpu");
+    ASSERT_NOT_NULL(s);
+    for (i = 0; i < 100; i++)
+        SAMPLE(s, (calls++, 0x1234), i >= 90);
+    ASSERT_EQUAL(10, calls);
+    ASSERT_EQUAL(10, s->total);
+    ASSERT_EQUAL(1, s->wait);
+    ASSERT_NOT_NULL(s->page[0]);
+    ASSERT_EQUAL(9, s->page[0][0x1234 >> 1]);
+    sample_file = NULL;
+    sample_interval = 997;
+}
+
+/* Saved samples read back into report with symbols */
+CTEST(sample_test, report) {
+    struct _sample  *s;
+    FILE            *f;
+    FILE            *map;
+    FILE            *out;
+    char             line[256];
+    int              found_total = 0;
+    int              found_addr = 0;
+    int              found_routine = 0;
+    int              i;
+
+    sample_file = "sample.out";
+    sample_interval = 1;
+    s = sample_create("cpu2");
+    ASSERT_NOT_NULL(s);
+    for (i = 0; i < 6; i++)
+        SAMPLE(s, 0x10402, 0);
+    for (i = 0; i < 3; i++)
+        SAMPLE(s, 0x10408, 0);
+    SAMPLE(s, 0x500, 0);
+    ASSERT_TRUE(sample_save());
+    sample_file = NULL;
+    sample_interval = 997;
+
+    map = tmpfile();
+    ASSERT_NOT_NULL(map);
+    fprintf(map, "010400 LOOP\n010500 DONE\n");
+    rewind(map);
+    f = fopen("sample.out", "r");
+    ASSERT_NOT_NULL(f);
+    out = tmpfile();
+    ASSERT_NOT_NULL(out);
+    ASSERT_TRUE(sample_report(f, map, out, 10));
+    fclose(f);
+    fclose(map);
+    rewind(out);
+    while (fgets(line, sizeof(line), out) != NULL) {
+        if (strncmp(line, "Model cpu2: 10 samples every 1 cycles", 37) == 0)
+            found_total = 1;
+        if (strncmp(line, "  010402 LOOP+2 ", 16) == 0 && strstr(line, " 6 ") != NULL)
+            found_addr = 1;
+        if (strncmp(line, "  010400 LOOP ", 14) == 0 && strstr(line, " 9 ") != NULL)
+            found_routine = 1;
+    }
+    fclose(out);
+    (void)remove("sample.out");
+    ASSERT_TRUE(found_total);
+    ASSERT_TRUE(found_addr);
+    ASSERT_TRUE(found_routine);
+}
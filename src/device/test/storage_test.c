@@ -0,0 +1,193 @@
+/*
+ * microsim360 - Storage load and dump test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ctest.h"
+#include "xlat.h"
+#include "cpu.h"
+#include "storage.h"
+
+static uint32_t   mem[0x4000];
+static uint32_t  *save_M;
+static uint32_t   save_max;
+
+/* Give storage of size bytes held bytes to an entry */
+static void
+set_storage(int size, int bytes)
+{
+    save_M = M;
+    save_max = mem_max;
+    memset(mem, 0, sizeof(mem));
+    M = mem;
+    mem_max = size - 1;
+    storage_track(size / bytes, bytes);
+    M_dirty[0] = 0;
+}
+
+static void
+put_storage()
+{
+    M = save_M;
+    mem_max = save_max;
+}
+
+/* Make an object card of type with address and count */
+static void
+card(uint8_t *c, const uint8_t *type, uint32_t addr, int cnt)
+{
+    memset(c, 0x40, 80);
+    c[0] = 0x02;
+    memcpy(&c[1], type, 3);
+    c[5] = (addr >> 16) & 0xff;
+    c[6] = (addr >> 8) & 0xff;
+    c[7] = addr & 0xff;
+    c[10] = 0;
+    c[11] = cnt;
+    c[14] = 0;
+    c[15] = 1;
+}
+
+/* Bytes get parity, one to an entry */
+CTEST(storage_test, bytes) {
+    uint8_t   data[3] = { 0x00, 0x01, 0xff };
+    uint8_t   back[3];
+
+    set_storage(0x4000, 1);
+    ASSERT_EQUAL(3, storage_write(0x1000, data, 3));
+    ASSERT_EQUAL(0x100, mem[0x1000]);
+    ASSERT_EQUAL(0x001, mem[0x1001]);
+    ASSERT_EQUAL(0x1ff, mem[0x1002]);
+    ASSERT_EQUAL(0x4, M_dirty[0]);
+    ASSERT_EQUAL(3, storage_read(0x1000, back, 3));
+    ASSERT_DATA(data, 3, back, 3);
+    /* Only what fits */
+    ASSERT_EQUAL(2, storage_write(0x3ffe, data, 3));
+    ASSERT_EQUAL(0, storage_write(0x4000, data, 3));
+    put_storage();
+}
+
+/* Bytes are packed four to a word */
+CTEST(storage_test, words) {
+    uint8_t   data[7] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 };
+    uint8_t   back[7];
+
+    set_storage(0x4000, 4);
+    mem[0x400] = 0xaaaaaaaa;
+    mem[0x402] = 0xbbbbbbbb;
+    ASSERT_EQUAL(7, storage_write(0x1003, data, 7));
+    ASSERT_EQUAL_X(0xaaaaaa11, mem[0x400]);
+    ASSERT_EQUAL_X(0x22334455, mem[0x401]);
+    ASSERT_EQUAL_X(0x6677bbbb, mem[0x402]);
+    ASSERT_EQUAL(0x4, M_dirty[0]);
+    ASSERT_EQUAL(7, storage_read(0x1003, back, 7));
+    ASSERT_DATA(data, 7, back, 7);
+    put_storage();
+}
+
+/* Raw file loads at address, dump writes it back */
+CTEST(storage_test, raw_dump) {
+    uint8_t   data[300];
+    uint8_t   back[300];
+    FILE     *f;
+    int       i;
+
+    for (i = 0; i < (int)sizeof(data); i++)
+        data[i] = (uint8_t)(i * 7);
+    f = fopen("storage_test.bin", "wb");
+    ASSERT_NOT_NULL(f);
+    fwrite(data, 1, sizeof(data), f);
+    fclose(f);
+    set_storage(0x4000, 4);
+    ASSERT_TRUE(storage_load("storage_test.bin", STORAGE_AUTO, 0x2001));
+    ASSERT_EQUAL(300, storage_read(0x2001, back, 300));
+    ASSERT_DATA(data, 300, back, 300);
+    ASSERT_TRUE(storage_dump_add("storage_test.dmp", 0x2001, 300));
+    storage_dump_all();
+    f = fopen("storage_test.dmp", "rb");
+    ASSERT_NOT_NULL(f);
+    memset(back, 0, sizeof(back));
+    ASSERT_EQUAL(300, fread(back, 1, sizeof(back), f));
+    fclose(f);
+    ASSERT_DATA(data, 300, back, 300);
+    /* Image goes at 0 and must fit */
+    ASSERT_TRUE(storage_load("storage_test.bin", STORAGE_IMAGE, 0x2001));
+    ASSERT_EQUAL_X(0x00070e15, mem[0]);
+    ASSERT_FALSE(storage_load("storage_test.bin", STORAGE_RAW, 0x3f00));
+    ASSERT_FALSE(storage_load("storage_test.none", STORAGE_RAW, 0));
+    remove("storage_test.bin");
+    remove("storage_test.dmp");
+    put_storage();
+}
+
+/* Object deck is moved to where it is loaded */
+CTEST(storage_test, object) {
+    static const uint8_t esd[3] = { 0xC5, 0xE2, 0xC4 };
+    static const uint8_t txt[3] = { 0xE3, 0xE7, 0xE3 };
+    static const uint8_t rld[3] = { 0xD9, 0xD3, 0xC4 };
+    static const uint8_t end[3] = { 0xC5, 0xD5, 0xC4 };
+    static const uint8_t code[12] = { 0x05, 0xc0, 0x47, 0xf0,
+                                      0x00, 0x00, 0x10, 0x08,
+                                      0x07, 0xfe, 0x00, 0x00 };
+    uint8_t   c[80];
+    uint8_t   back[12];
+    FILE     *f;
+
+    f = fopen("storage_test.obj", "wb");
+    ASSERT_NOT_NULL(f);
+    card(c, esd, 0, 16);
+    memset(&c[16], 0xC1, 8);
+    c[24] = 0x00;                   /* SD at 1000 */
+    c[25] = 0x00; c[26] = 0x10; c[27] = 0x00;
+    fwrite(c, 1, 80, f);
+    card(c, txt, 0x1000, 12);
+    memcpy(&c[16], code, 12);
+    fwrite(c, 1, 80, f);
+    card(c, rld, 0, 8);
+    c[16] = 0; c[17] = 1; c[18] = 0; c[19] = 1;
+    c[20] = 0x0c;                   /* A type, 4 bytes */
+    c[21] = 0x00; c[22] = 0x10; c[23] = 0x04;
+    fwrite(c, 1, 80, f);
+    card(c, end, 0x1000, 0);
+    fwrite(c, 1, 80, f);
+    fclose(f);
+
+    set_storage(0x4000, 1);
+    ASSERT_TRUE(storage_load("storage_test.obj", STORAGE_AUTO, STORAGE_ASSEMBLED));
+    ASSERT_EQUAL(12, storage_read(0x1000, back, 12));
+    ASSERT_DATA(code, 12, back, 12);
+    ASSERT_TRUE(storage_load("storage_test.obj", STORAGE_OBJECT, 0x2000));
+    ASSERT_EQUAL(12, storage_read(0x2000, back, 12));
+    ASSERT_EQUAL(0x00, back[4]);
+    ASSERT_EQUAL(0x00, back[5]);
+    ASSERT_EQUAL(0x20, back[6]);
+    ASSERT_EQUAL(0x08, back[7]);
+    ASSERT_EQUAL(0x05, back[0]);
+    ASSERT_EQUAL(0x07, back[8]);
+    remove("storage_test.obj");
+    put_storage();
+}
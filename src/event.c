@@ -26,8 +26,9 @@
 #include <stdlib.h>
 #include "logger.h"
 #include "event.h"
+#include "stats.h"
 
-struct _event *event_head, *event_tail;
+MACHINE_LOCAL struct _event *event_head, *event_tail;
 
 /* Initialize event system */
 void
@@ -44,8 +45,10 @@ add_event(struct _device *dev, _callback func, int time, void *arg, int iarg)
     struct _event *ptr_event;
 
     log_event("Add event %d: %x %d\n", time, arg, iarg);
+    stats.events_added++;
     /* If event time is zero, generate callback immediately */
     if (time == 0) {
+         stats.events_fired++;
          (*func)(dev, arg, iarg);
          return 0;
     }
@@ -122,7 +125,7 @@ cancel_event(struct _device *dev, _callback func)
            }
            /* Point previous event next to next */
            if (ptr_event->prev != NULL) {
-               ptr_event->next = ptr_event->next;
+               ptr_event->prev->next = ptr_event->next;
            } else {
                /* No previous, at head of list */
                event_head = ptr_event->next;
@@ -150,6 +153,7 @@ advance()
     log_event("Advance event %d\n", ptr_event->time);
     ptr_event->time--;
     while (ptr_event != NULL && ptr_event->time == 0) {
+         stats.events_fired++;
          (*ptr_event->func)(ptr_event->dev, ptr_event->arg, ptr_event->iarg);
          event_head = ptr_event->next;
          free(ptr_event);
@@ -163,3 +167,50 @@ advance()
 }
 
 
+
+/* Copy pending events into new array, return number copied or -1 */
+int
+save_events(struct _event **list)
+{
+    struct _event *ptr_event;
+    int            n = 0;
+
+    *list = NULL;
+    for (ptr_event = event_head; ptr_event != NULL; ptr_event = ptr_event->next)
+        n++;
+    if (n == 0)
+        return 0;
+    if ((*list = (struct _event *)malloc(n * sizeof(struct _event))) == NULL)
+        return -1;
+    n = 0;
+    for (ptr_event = event_head; ptr_event != NULL; ptr_event = ptr_event->next)
+        (*list)[n++] = *ptr_event;
+    return n;
+}
+
+/* Replace pending events with ones copied by save_events */
+void
+restore_events(struct _event *list, int n)
+{
+    struct _event *new_event;
+    int            i;
+
+    while (event_head != NULL) {
+        new_event = event_head->next;
+        free(event_head);
+        event_head = new_event;
+    }
+    event_tail = NULL;
+    for (i = 0; i < n; i++) {
+        if ((new_event = (struct _event *)malloc(sizeof(struct _event))) == NULL)
+            return;
+        *new_event = list[i];
+        new_event->next = NULL;
+        new_event->prev = event_tail;
+        if (event_tail == NULL)
+            event_head = new_event;
+        else
+            event_tail->next = new_event;
+        event_tail = new_event;
+    }
+}
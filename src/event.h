@@ -53,4 +53,10 @@ void advance();
 /* Initialize event system */
 void init_event();
 
+/* Copy pending events into new array, return number copied or -1 */
+int save_events(struct _event **list);
+
+/* Replace pending events with ones copied by save_events */
+void restore_events(struct _event *list, int n);
+
 #endif
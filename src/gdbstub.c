@@ -0,0 +1,534 @@
+/*
+ * microsim360 - GDB remote stub.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#define closesocket close
+#define SOCKET int
+#else
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+#include "logger.h"
+#include "conf.h"
+#include "device.h"
+#include "cpu.h"
+#include "debugger.h"
+#include "gdbstub.h"
+
+#define GDB_PKT       4096          /* Largest packet */
+#define GDB_REGS      51            /* Registers in s390 order */
+
+/* Shared between stub thread and machine, under gdb_lock */
+static SDL_mutex    *gdb_lock;
+static SDL_cond     *gdb_cond;
+static char          in_pkt[GDB_PKT];   /* Packet for machine */
+static int           in_ready;
+static char          out_pkt[GDB_PKT];  /* Reply for debugger */
+static int           out_ready;
+static int           intr;              /* Signal for stop debugger wants */
+static int           detach;            /* Debugger went away */
+
+/* Stub thread only */
+static SDL_Thread   *thrd;
+static int           running;
+static SOCKET        listener = -1;
+static SOCKET        client = -1;
+
+/* Machine only */
+static int           resumed;           /* Debugger waits for a stop */
+static int           stop_sig;          /* Signal to report at stop */
+
+static const char    hex[] = "0123456789abcdef";
+
+/* Send packet with checksum */
+static void
+send_pkt(const char *data)
+{
+    char      buf[GDB_PKT + 4];
+    uint8_t   sum = 0;
+    int       len = 0;
+
+    buf[len++] = '$';
+    while (*data != '\0' && len < GDB_PKT) {
+        sum += (uint8_t)*data;
+        buf[len++] = *data++;
+    }
+    buf[len++] = '#';
+    buf[len++] = hex[sum >> 4];
+    buf[len++] = hex[sum & 0xf];
+    (void)send(client, buf, len, 0);
+}
+
+static int
+from_hex(int ch)
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+/* Hand packet to machine, and give it a little time to answer */
+static void
+post_pkt(const char *pkt)
+{
+    SDL_LockMutex(gdb_lock);
+    strcpy(in_pkt, pkt);
+    in_ready = 1;
+    SDL_CondBroadcast(gdb_cond);
+    SDL_CondWaitTimeout(gdb_cond, gdb_lock, 10);
+    SDL_UnlockMutex(gdb_lock);
+}
+
+/* Thread to take connection and frame packets */
+static int
+gdb_thrd(void *data)
+{
+    struct timeval  tv;
+    fd_set          read_set;
+    SOCKET          s;
+    char            buf[512];
+    char            pkt[GDB_PKT];
+    char            reply[GDB_PKT];
+    int             len = 0;
+    int             state = 0;
+    uint8_t         sum = 0;
+    int             chk = 0;
+    int             on = 1;
+    int             r;
+    int             i;
+
+    while (running) {
+        FD_ZERO(&read_set);
+        FD_SET(listener, &read_set);
+        if (client >= 0)
+            FD_SET(client, &read_set);
+        tv.tv_sec = 0;
+        tv.tv_usec = 10000;
+        r = select(((client > listener) ? client : listener) + 1, &read_set,
+                   NULL, NULL, &tv);
+
+        if (r > 0 && FD_ISSET(listener, &read_set)) {
+            if ((s = accept(listener, NULL, NULL)) >= 0) {
+                if (client >= 0) {
+                    closesocket(s);
+                } else {
+                    /* Small packets, answer each at once */
+                    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char *)&on,
+                               sizeof(on));
+                    client = s;
+                    state = 0;
+                    log_info("GDB connected\n");
+                    /* Debugger expects machine stopped */
+                    SDL_LockMutex(gdb_lock);
+                    intr = 5;
+                    SDL_UnlockMutex(gdb_lock);
+                }
+            }
+        }
+
+        if (r > 0 && client >= 0 && FD_ISSET(client, &read_set)) {
+            if ((r = recv(client, buf, sizeof(buf), 0)) <= 0) {
+                log_info("GDB disconnected\n");
+                closesocket(client);
+                client = -1;
+                SDL_LockMutex(gdb_lock);
+                detach = 1;
+                in_ready = out_ready = 0;
+                SDL_UnlockMutex(gdb_lock);
+                continue;
+            }
+            for (i = 0; i < r; i++) {
+                int ch = buf[i] & 0xff;
+
+                switch (state) {
+                case 0:              /* Between packets */
+                     if (ch == '$') {
+                         len = 0;
+                         sum = 0;
+                         state = 1;
+                     } else if (ch == 0x03) {
+                         SDL_LockMutex(gdb_lock);
+                         intr = 2;
+                         SDL_UnlockMutex(gdb_lock);
+                     }
+                     break;
+                case 1:              /* Packet data */
+                     if (ch == '#') {
+                         state = 2;
+                     } else {
+                         sum += ch;
+                         if (len < GDB_PKT - 1)
+                             pkt[len++] = ch;
+                     }
+                     break;
+                case 2:              /* First checksum digit */
+                     chk = from_hex(ch) << 4;
+                     state = 3;
+                     break;
+                case 3:              /* Second checksum digit */
+                     chk |= from_hex(ch);
+                     state = 0;
+                     pkt[len] = '\0';
+                     if (chk != sum) {
+                         (void)send(client, "-", 1, 0);
+                         break;
+                     }
+                     (void)send(client, "+", 1, 0);
+                     post_pkt(pkt);
+                     break;
+                }
+            }
+        }
+
+        /* Send answer from machine */
+        reply[0] = '\0';
+        SDL_LockMutex(gdb_lock);
+        if (out_ready) {
+            strcpy(reply, out_pkt);
+            out_ready = 0;
+            r = 1;
+        } else {
+            r = 0;
+        }
+        SDL_UnlockMutex(gdb_lock);
+        if (r && client >= 0)
+            send_pkt(reply);
+    }
+    return 0;
+}
+
+/* Registers in s390 order, as hex */
+static void
+get_regs(char *out)
+{
+    struct _debug_regs  regs;
+    int                 i;
+
+    (*debug_regs)(&regs);
+    /* Stopped at start of instruction */
+    regs.ia = debug_addr;
+    out += sprintf(out, "%08x%08x", (regs.mask << 24) | (regs.key << 20) |
+                          (regs.amwp << 16) | (regs.cc << 12) | (regs.pm << 8),
+                          regs.ia & 0xffffff);
+    for (i = 0; i < 16; i++)
+        out += sprintf(out, "%08x", regs.gpr[i]);
+    for (i = 0; i < 17; i++)
+        out += sprintf(out, "%08x", 0);
+    for (i = 0; i < 16; i++) {
+        if ((i & 1) == 0 && i < 8)
+            out += sprintf(out, "%08x%08x", (uint32_t)(regs.fpr[i >> 1] >> 32),
+                                 (uint32_t)regs.fpr[i >> 1]);
+        else
+            out += sprintf(out, "%016x", 0);
+    }
+}
+
+/* Stop reply for debugger */
+static void
+stop_reply(char *out)
+{
+    const char  *kind = NULL;
+
+    switch (debug_stopped) {
+    case DEBUG_WRITE:              kind = "watch"; break;
+    case DEBUG_READ:               kind = "rwatch"; break;
+    case DEBUG_READ|DEBUG_WRITE:   kind = "awatch"; break;
+    }
+    if (kind != NULL)
+        sprintf(out, "T%02x%s:%x;", stop_sig, kind, debug_data);
+    else
+        sprintf(out, "S%02x", stop_sig);
+}
+
+/* Run one packet, return 0 if answer comes later */
+static int
+command(char *pkt, char *out)
+{
+    char        regs[GDB_REGS * 16 + 1];
+    uint32_t    addr;
+    uint32_t    len;
+    uint32_t    reg;
+    uint8_t     byte;
+    int         type;
+    int         n;
+    int         i;
+
+    out[0] = '\0';
+    switch (pkt[0]) {
+    case '?':
+         stop_reply(out);
+         break;
+
+    case 'g':
+         if (debug_regs == NULL) {
+             strcpy(out, "E01");
+             break;
+         }
+         get_regs(out);
+         break;
+
+    case 'p':
+         if (debug_regs == NULL || sscanf(&pkt[1], "%x", &reg) != 1 ||
+                  reg >= GDB_REGS) {
+             strcpy(out, "E01");
+             break;
+         }
+         get_regs(regs);
+         /* f0 and up are 64 bits */
+         if (reg < 35)
+             sprintf(out, "%.8s", &regs[reg * 8]);
+         else
+             sprintf(out, "%.16s", &regs[35 * 8 + (reg - 35) * 16]);
+         break;
+
+    case 'm':
+         if (sscanf(&pkt[1], "%x,%x", &addr, &len) != 2) {
+             strcpy(out, "E01");
+             break;
+         }
+         if (len > (GDB_PKT - 1) / 2)
+             len = (GDB_PKT - 1) / 2;
+         for (i = 0; i < (int)len; i++) {
+             if (!debug_read_byte(addr + i, &byte))
+                 break;
+             out[i * 2] = hex[byte >> 4];
+             out[i * 2 + 1] = hex[byte & 0xf];
+         }
+         out[i * 2] = '\0';
+         if (i == 0 && len != 0)
+             strcpy(out, "E01");
+         break;
+
+    case 'M':
+         strcpy(out, "E01");
+         break;
+
+    case 'c':
+         stop_sig = 5;
+         resumed = 1;
+         debug_resume();
+         return 0;
+
+    case 's':
+         stop_sig = 5;
+         resumed = 1;
+         debug_resume();
+         debug_next_inst(DEBUG_REQUEST);
+         return 0;
+
+    case 'Z':
+    case 'z':
+         if (sscanf(&pkt[1], "%d,%x,%x", &type, &addr, &len) != 3) {
+             strcpy(out, "E01");
+             break;
+         }
+         switch (type) {
+         case 0:
+         case 1:  type = DEBUG_INST;  len = 1; break;
+         case 2:  type = DEBUG_WRITE; break;
+         case 3:  type = DEBUG_READ; break;
+         case 4:  type = DEBUG_READ|DEBUG_WRITE; break;
+         default: return 1;              /* Not supported */
+         }
+         n = debug_find(type, addr, len);
+         if (pkt[0] == 'Z' && n == 0)
+             n = debug_add(type, addr, len);
+         else if (pkt[0] == 'z' && n != 0)
+             debug_delete(n);
+         else
+             n = 1;
+         strcpy(out, (n != 0) ? "OK" : "E01");
+         break;
+
+    case 'D':
+         debug_delete(0);
+         debug_resume();
+         strcpy(out, "OK");
+         break;
+
+    case 'k':
+         debug_delete(0);
+         debug_resume();
+         return 0;
+
+    case 'H':
+    case 'T':
+         strcpy(out, "OK");
+         break;
+
+    case 'q':
+         if (strncmp(pkt, "qSupported", 10) == 0)
+             sprintf(out, "PacketSize=%x", GDB_PKT - 1);
+         else if (strcmp(pkt, "qAttached") == 0)
+             strcpy(out, "1");
+         break;
+    }
+    return 1;
+}
+
+/* Called by machine between steps */
+static void
+gdb_serve(int wait)
+{
+    SDL_LockMutex(gdb_lock);
+    if (detach) {
+        detach = 0;
+        intr = 0;
+        resumed = 0;
+        debug_delete(0);
+        debug_resume();
+    }
+    if (intr) {
+        if (!debug_stopped) {
+            stop_sig = intr;
+            debug_next_inst(DEBUG_REQUEST);
+        }
+        intr = 0;
+    }
+    if (wait) {
+        if (resumed) {
+            resumed = 0;
+            stop_reply(out_pkt);
+            out_ready = 1;
+            SDL_CondBroadcast(gdb_cond);
+        }
+        if (in_ready && !out_ready) {
+            in_ready = 0;
+            if (command(in_pkt, out_pkt))
+                out_ready = 1;
+            SDL_CondBroadcast(gdb_cond);
+        } else {
+            SDL_CondWaitTimeout(gdb_cond, gdb_lock, 100);
+        }
+    }
+    SDL_UnlockMutex(gdb_lock);
+}
+
+int
+gdb_open(int port)
+{
+    struct sockaddr_in   addr;
+    int                  on = 1;
+#ifdef _WIN32
+    WSADATA              wsa;
+
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+        return 0;
+#endif
+    gdb_close();
+    if ((listener = socket(PF_INET, SOCK_STREAM, 0)) < 0)
+        return 0;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (char *)&on, sizeof(on));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(listener, 1) < 0) {
+        closesocket(listener);
+        listener = -1;
+        return 0;
+    }
+    gdb_lock = SDL_CreateMutex();
+    gdb_cond = SDL_CreateCond();
+    running = 1;
+    if ((thrd = SDL_CreateThread(gdb_thrd, "GDB", NULL)) == NULL) {
+        gdb_close();
+        return 0;
+    }
+    debug_serve = &gdb_serve;
+    debug_watch_inst = 1;
+    debug_active = 1;
+    log_info("GDB stub on port %d\n", port);
+    return 1;
+}
+
+void
+gdb_close()
+{
+    running = 0;
+    if (thrd != NULL)
+        SDL_WaitThread(thrd, NULL);
+    thrd = NULL;
+    if (client >= 0)
+        closesocket(client);
+    client = -1;
+    if (listener >= 0)
+        closesocket(listener);
+    listener = -1;
+    if (gdb_cond != NULL)
+        SDL_DestroyCond(gdb_cond);
+    if (gdb_lock != NULL)
+        SDL_DestroyMutex(gdb_lock);
+    gdb_cond = NULL;
+    gdb_lock = NULL;
+}
+
+int
+simGDB_create(struct _option *opt)
+{
+    struct _option   opts;
+    int              port = 0;
+
+    while (get_option(&opts)) {
+        if (strcmp(opts.opt, "PORT") == 0 && opts.flags == 1) {
+            if (!get_integer(&opts, &port) || port <= 0 || port > 65535) {
+                fprintf(stderr, "GDB port needs a number\n");
+                return 0;
+            }
+        } else {
+            fprintf(stderr, "Invalid option %s to gdb\n", opts.opt);
+            return 0;
+        }
+    }
+    if (port == 0) {
+        fprintf(stderr, "GDB needs port=\n");
+        return 0;
+    }
+    if (!gdb_open(port)) {
+        fprintf(stderr, "Unable to open GDB port %d\n", port);
+        return 0;
+    }
+    return 1;
+}
+
+SIM_OPT_STRUCT(GDB);
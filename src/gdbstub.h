@@ -0,0 +1,49 @@
+/*
+ * microsim360 - GDB remote stub.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _GDBSTUB_H_
+#define _GDBSTUB_H_
+
+/*
+ * GDB remote serial protocol stub.  A thread takes the connection and
+ * frames packets; the machine runs each packet between steps, only
+ * while it is stopped at the start of an instruction.  With no packet
+ * waiting the machine only looks at a flag every few thousand steps.
+ *
+ * Registers are sent in the s390 (31 bit) order: pswm, pswa, r0-r15,
+ * acr0-acr15, fpc, f0-f15.  pswm holds the system mask, key, AMWP, CC
+ * and program mask of the BC mode PSW, pswa the instruction address.
+ * Only f0, f2, f4 and f6 are used, the access registers and fpc are 0.
+ * Registers and storage may be read but not changed.
+ *
+ * Configured with:  gdb port=<port>
+ */
+
+/* Open stub on port, return 0 if it can't be */
+int  gdb_open(int port);
+
+void gdb_close();
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * microsim360 - Interval timer source.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "conf.h"
+#include "event.h"
+#include "cpu.h"
+#include "itimer.h"
+
+MACHINE_LOCAL int  timer_event;
+MACHINE_LOCAL int  timer_rate = 50;
+MACHINE_LOCAL int  timer_realtime = 0;
+
+static MACHINE_LOCAL int  timer_running;
+
+int
+timer_period()
+{
+    return TIMER_STEPS_SEC / timer_rate;
+}
+
+/* Raise the tick and schedule the next one */
+static void
+timer_tick(struct _device *unit, void *arg, int iarg)
+{
+    timer_event = 1;
+    add_event(NULL, &timer_tick, timer_period(), NULL, 0);
+}
+
+void
+timer_start()
+{
+    if (timer_realtime || timer_running)
+        return;
+    timer_running = 1;
+    add_event(NULL, &timer_tick, timer_period(), NULL, 0);
+}
+
+void
+timer_stop()
+{
+    if (!timer_running)
+        return;
+    timer_running = 0;
+    cancel_event(NULL, &timer_tick);
+}
+
+int
+simTIMER_create(struct _option *opt)
+{
+    struct _option   opts;
+    int              rate;
+
+    while (get_option(&opts)) {
+        if (strcmp(opts.opt, "RATE") == 0 && opts.flags == 1) {
+            if (!get_integer(&opts, &rate))
+                return 0;
+            if (rate != 50 && rate != 300) {
+                fprintf(stderr, "Timer rate must be 50 or 300\n");
+                return 0;
+            }
+            timer_rate = rate;
+        } else if (strcmp(opts.opt, "REALTIME") == 0) {
+            timer_realtime = 1;
+        } else {
+            fprintf(stderr, "Invalid option %s to timer\n", opts.opt);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+SIM_OPT_STRUCT(TIMER);
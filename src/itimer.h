@@ -0,0 +1,56 @@
+/*
+ * microsim360 - Interval timer source.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _ITIMER_H_
+#define _ITIMER_H_
+
+#include "machine.h"
+
+/*
+ * The CPUs update the interval timer when timer_event is set.  It is
+ * set by an event every timer_period steps, a step being one
+ * microsecond of machine time, so guest time follows simulated time
+ * however fast the host runs.  With timer_realtime set the panel's
+ * wall clock timer sets it instead, as on the real machine.
+ *
+ * Configured with:  timer rate=50|300 [realtime]
+ */
+
+#define TIMER_STEPS_SEC   1000000      /* Steps per simulated second */
+
+extern MACHINE_LOCAL int  timer_event;     /* Tick pending for the CPU */
+extern MACHINE_LOCAL int  timer_rate;      /* Ticks per second */
+extern MACHINE_LOCAL int  timer_realtime;  /* Tick from host clock */
+
+/* Start ticks from simulated time, unless timer_realtime */
+void timer_start();
+
+/* Stop simulated time ticks */
+void timer_stop();
+
+/* Steps between ticks */
+int  timer_period();
+
+#endif
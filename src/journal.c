@@ -0,0 +1,352 @@
+/*
+ * microsim360 - Record and replay of external inputs.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "config.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef _WIN32
+#include <io.h>
+#define ftruncate _chsize
+#define fileno _fileno
+#endif
+#include "logger.h"
+#include "journal.h"
+
+#define JOURNAL_WATCHES  64           /* Variables that can be watched */
+#define JOURNAL_SRC      16           /* Longest source name */
+
+struct _watch {
+    char              src[JOURNAL_SRC];
+    void             *value;        /* Variable watched */
+    int               size;         /* Size of variable */
+    uint32_t          last;         /* Value last recorded */
+};
+
+struct _entry {
+    uint64_t          step;         /* Step input was taken */
+    char              src[JOURNAL_SRC];
+    uint32_t          value;
+    int               used;         /* Already replayed */
+    long              pos;          /* Where written in journal file */
+};
+
+MACHINE_LOCAL int  journal_mode = JOURNAL_OFF;
+MACHINE_LOCAL int  journal_changed;
+MACHINE_LOCAL int  journal_keep;
+
+static MACHINE_LOCAL struct _watch  watch[JOURNAL_WATCHES];
+static MACHINE_LOCAL int            watches;
+static MACHINE_LOCAL FILE          *journal;     /* File being recorded */
+static MACHINE_LOCAL struct _entry *entry;       /* Inputs being replayed */
+static MACHINE_LOCAL int            entries;
+static MACHINE_LOCAL int            entry_size;  /* Room in entry */
+static MACHINE_LOCAL int            next_entry;  /* First not replayed */
+static MACHINE_LOCAL int            rewound;     /* Replaying own record */
+
+static uint32_t
+get_value(struct _watch *w)
+{
+    switch (w->size) {
+    case 1:  return *((uint8_t *)w->value);
+    case 2:  return *((uint16_t *)w->value);
+    default: return *((uint32_t *)w->value);
+    }
+}
+
+static void
+set_value(struct _watch *w, uint32_t value)
+{
+    switch (w->size) {
+    case 1:  *((uint8_t *)w->value) = (uint8_t)value; break;
+    case 2:  *((uint16_t *)w->value) = (uint16_t)value; break;
+    default: *((uint32_t *)w->value) = value; break;
+    }
+}
+
+/* Add input to end of entries */
+static int
+add_entry(uint64_t step, const char *src, uint32_t value, int used, long pos)
+{
+    struct _entry *n;
+
+    if (entries == entry_size) {
+        int   size = (entry_size == 0) ? 256 : entry_size * 2;
+
+        if ((n = (struct _entry *)realloc(entry, size * sizeof(struct _entry))) == NULL)
+            return 0;
+        entry = n;
+        entry_size = size;
+    }
+    n = &entry[entries++];
+    n->step = step;
+    strncpy(n->src, src, JOURNAL_SRC - 1);
+    n->src[JOURNAL_SRC - 1] = '\0';
+    n->value = value;
+    n->used = used;
+    n->pos = pos;
+    return 1;
+}
+
+void
+journal_watch(const char *src, void *value, int size)
+{
+    int     i;
+
+    for (i = 0; i < watches; i++) {
+        if (strcmp(watch[i].src, src) == 0)
+            break;
+    }
+    if (i == JOURNAL_WATCHES) {
+        log_error("Journal has no room for %s\n", src);
+        return;
+    }
+    strncpy(watch[i].src, src, JOURNAL_SRC - 1);
+    watch[i].value = value;
+    watch[i].size = size;
+    watch[i].last = get_value(&watch[i]);
+    if (i == watches)
+        watches++;
+}
+
+int
+journal_record(const char *name)
+{
+    int     i;
+
+    if (name != NULL && (journal = fopen(name, "w")) == NULL) {
+        log_error("Unable to create journal %s\n", name);
+        return 0;
+    }
+    entries = 0;
+    next_entry = 0;
+    for (i = 0; i < watches; i++)
+        watch[i].last = get_value(&watch[i]);
+    journal_mode = JOURNAL_RECORD;
+    /* Catch anything set between now and the first step */
+    journal_changed = 1;
+    return 1;
+}
+
+int
+journal_replay(const char *name)
+{
+    FILE         *f;
+    char          line[100];
+    unsigned long long step;
+    unsigned long value;
+    char          src[JOURNAL_SRC];
+
+    if ((f = fopen(name, "r")) == NULL) {
+        log_error("Unable to open journal %s\n", name);
+        return 0;
+    }
+    entries = 0;
+    next_entry = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "%llu %15s %lu", &step, src, &value) != 3) {
+            log_error("Journal %s bad line: %s", name, line);
+            continue;
+        }
+        if (!add_entry((uint64_t)step, src, (uint32_t)value, 0, -1L)) {
+            fclose(f);
+            return 0;
+        }
+    }
+    fclose(f);
+    journal_mode = JOURNAL_REPLAY;
+    log_info("Journal %s has %d inputs\n", name, entries);
+    return 1;
+}
+
+void
+journal_close()
+{
+    if (journal != NULL)
+        fclose(journal);
+    journal = NULL;
+    free(entry);
+    entry = NULL;
+    entries = 0;
+    entry_size = 0;
+    rewound = 0;
+    journal_mode = JOURNAL_OFF;
+}
+
+/* Machine may have changed a watched variable since it was recorded */
+void
+journal_mark()
+{
+    int     i;
+
+    for (i = 0; i < watches; i++)
+        watch[i].last = get_value(&watch[i]);
+}
+
+void
+journal_input(const char *src, uint32_t value)
+{
+    long     pos = -1L;
+
+    if (journal_mode != JOURNAL_RECORD)
+        return;
+    if (journal != NULL) {
+        pos = ftell(journal);
+        fprintf(journal, "%" PRIu64 " %s %u\n", step_count, src, (unsigned int)value);
+        fflush(journal);
+    }
+    /* Kept so a checkpoint restore can take them again */
+    if (journal_keep)
+        (void)add_entry(step_count, src, value, 1, pos);
+}
+
+/* First entry after step */
+static int
+find_after(uint64_t step)
+{
+    int     i = entries;
+
+    while (i > 0 && entry[i - 1].step > step)
+        i--;
+    return i;
+}
+
+void
+journal_rewind(uint64_t step)
+{
+    int     i;
+
+    next_entry = find_after(step);
+    for (i = next_entry; i < entries; i++)
+        entry[i].used = 0;
+    if (journal_mode == JOURNAL_RECORD) {
+        journal_mode = JOURNAL_REPLAY;
+        rewound = 1;
+    }
+}
+
+void
+journal_truncate(uint64_t step)
+{
+    int     i;
+
+    if (!rewound)
+        return;
+    rewound = 0;
+    journal_mode = JOURNAL_RECORD;
+    i = find_after(step);
+    if (i == entries)
+        return;
+    if (journal != NULL && entry[i].pos >= 0) {
+        fflush(journal);
+        (void)ftruncate(fileno(journal), entry[i].pos);
+        (void)fseek(journal, entry[i].pos, SEEK_SET);
+    }
+    entries = i;
+    next_entry = i;
+}
+
+void
+journal_discard(uint64_t step)
+{
+    int     i;
+
+    for (i = 0; i < entries && entry[i].step < step && entry[i].used; i++);
+    if (i == 0)
+        return;
+    memmove(&entry[0], &entry[i], (entries - i) * sizeof(struct _entry));
+    entries -= i;
+    next_entry = (next_entry > i) ? next_entry - i : 0;
+}
+
+/* Find next unused input for src at this step */
+static struct _entry *
+find_entry(const char *src)
+{
+    int     i;
+
+    for (i = next_entry; i < entries && entry[i].step <= step_count; i++) {
+        if (!entry[i].used && entry[i].step == step_count &&
+            strcmp(entry[i].src, src) == 0)
+            return &entry[i];
+    }
+    return NULL;
+}
+
+int
+journal_next(const char *src, uint32_t *value)
+{
+    struct _entry  *e;
+
+    if (next_entry >= entries || entry[next_entry].step != step_count)
+        return 0;
+    if ((e = find_entry(src)) == NULL)
+        return 0;
+    e->used = 1;
+    *value = e->value;
+    return 1;
+}
+
+void
+journal_step()
+{
+    struct _entry  *e;
+    int             i;
+
+    if (journal_mode == JOURNAL_RECORD) {
+        if (!journal_changed)
+            return;
+        journal_changed = 0;
+        for (i = 0; i < watches; i++) {
+            uint32_t   v = get_value(&watch[i]);
+
+            if (v != watch[i].last) {
+                journal_input(watch[i].src, v);
+                watch[i].last = v;
+            }
+        }
+        return;
+    }
+
+    /* Anything left from before this step was not asked for, the run
+       has gone a different way than when it was recorded */
+    while (next_entry < entries && entry[next_entry].step < step_count) {
+        e = &entry[next_entry++];
+        if (!e->used)
+            log_warn("Journal %s at %" PRIu64 " not replayed\n", e->src, e->step);
+    }
+    if (next_entry >= entries || entry[next_entry].step != step_count)
+        return;
+    for (i = 0; i < watches; i++) {
+        if ((e = find_entry(watch[i].src)) != NULL) {
+            e->used = 1;
+            set_value(&watch[i], e->value);
+        }
+    }
+}
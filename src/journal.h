@@ -0,0 +1,96 @@
+/*
+ * microsim360 - Record and replay of external inputs.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#include <stdint.h>
+#include "machine.h"
+
+/*
+ * Everything from outside the simulated machine, panel switches,
+ * console keys and wall clock timer ticks, can be written to a journal
+ * with the step at which the CPU thread took it.  Replaying the journal
+ * feeds the same inputs in at the same steps, so a run can be repeated
+ * exactly, as fast as the host allows.
+ *
+ * A journal is a text file, one input per line:
+ *
+ *     step source value
+ *
+ * Inputs that are variables, like the panel switches, are registered
+ * with journal_watch.  While recording the panel calls journal_mark
+ * before it changes one and sets journal_changed after, and journal_step
+ * writes the ones that changed.  While replaying journal_step stores
+ * them back.  Inputs that arrive as a stream, like console keys, are
+ * written by the device with journal_input and read back with
+ * journal_next.
+ */
+
+#define JOURNAL_OFF       0
+#define JOURNAL_RECORD    1         /* Writing inputs to journal */
+#define JOURNAL_REPLAY    2         /* Taking inputs from journal */
+
+extern MACHINE_LOCAL int  journal_mode;
+extern MACHINE_LOCAL int  journal_changed;  /* Watched input may have changed */
+extern MACHINE_LOCAL int  journal_keep;     /* Keep recorded inputs in memory */
+
+/* Start writing inputs to file, NULL to only keep them in memory.
+   Return 0 if it can't be created */
+int  journal_record(const char *name);
+
+/* Start replaying inputs from file, return 0 if it can't be read */
+int  journal_replay(const char *name);
+
+/* Finish with journal */
+void journal_close();
+
+/* Register a variable set from outside the machine, size 1, 2 or 4 */
+void journal_watch(const char *src, void *value, int size);
+
+/* Note watched variables before the panel changes them */
+void journal_mark();
+
+/* Record or replay watched variables, called before each step */
+void journal_step();
+
+/* Record an input from src taken at this step */
+void journal_input(const char *src, uint32_t value);
+
+/* Get next input for src replayed at this step, return 0 if none */
+int  journal_next(const char *src, uint32_t *value);
+
+/*
+ * Used by checkpoints.  After the machine is put back to step, inputs
+ * taken after it are replayed from memory.  When the machine gets to
+ * where it should go live again, journal_truncate forgets any inputs
+ * after step and goes back to recording.  Inputs older than the oldest
+ * checkpoint are dropped with journal_discard.
+ */
+void journal_rewind(uint64_t step);
+void journal_truncate(uint64_t step);
+void journal_discard(uint64_t step);
+
+#endif
@@ -33,7 +33,7 @@
 #include "device.h"
 
 int log_level = 0;
-extern uint64_t     step_count;
+extern MACHINE_LOCAL uint64_t     step_count;
 int log_enable = 0;
 
 FILE *log_file = NULL;
@@ -0,0 +1,52 @@
+/*
+ * microsim360 - Per machine state.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _MACHINE_H_
+#define _MACHINE_H_
+
+#include <stdint.h>
+
+/*
+ * Everything that makes up one simulated machine, the CPU latches,
+ * storage, channels, the event list and the panel switches, is
+ * declared MACHINE_LOCAL.  Normally this is nothing and there is one
+ * machine per process.  Built with MACHINE_THREADS each thread gets
+ * its own copy, so a batch run can load a configuration and run a
+ * machine on each of several threads.  The front panel reads the
+ * state from the display thread, so it only works with one machine.
+ */
+#ifdef MACHINE_THREADS
+#ifdef _MSC_VER
+#define MACHINE_LOCAL  __declspec(thread)
+#else
+#define MACHINE_LOCAL  _Thread_local
+#endif
+#else
+#define MACHINE_LOCAL
+#endif
+
+extern MACHINE_LOCAL uint64_t  step_count;     /* Steps run by machine */
+
+#endif
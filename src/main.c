@@ -77,6 +77,8 @@
 
 #include "config.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <ctype.h>
 #ifdef HAVE_UNISTD_H
@@ -88,10 +90,56 @@
 #include "widgets.h"
 #include "conf.h"
 #include "cpu.h"
+#include "profile.h"
+#include "sample.h"
+#include "stats.h"
+#include "batch.h"
+#include "journal.h"
+#include "checkpoint.h"
+#include "gdbstub.h"
+#include "storage.h"
 #ifdef _WIN32
 #include "getopt.h"
 #endif
 
+/* Load storage from "file[:addr]" */
+static int
+load_arg(char *arg)
+{
+    char      *p = strrchr(arg, ':');
+    char      *e;
+    uint32_t   addr = STORAGE_ASSEMBLED;
+
+    if (p != NULL) {
+        addr = (uint32_t)strtoul(p + 1, &e, 16);
+        if (e == p + 1 || *e != '\0') {
+            fprintf(stderr, "Bad load address in %s\n", arg);
+            return 0;
+        }
+        *p = '\0';
+    }
+    return storage_load(arg, STORAGE_AUTO, addr);
+}
+
+/* Dump storage at end to "file[:addr[:len]]" */
+static int
+dump_arg(char *arg)
+{
+    char      *p;
+    uint32_t   addr = 0;
+    uint32_t   len = 0;
+
+    if ((p = strchr(arg, ':')) != NULL) {
+        *p++ = '\0';
+        addr = (uint32_t)strtoul(p, &p, 16);
+        if (*p == ':')
+            len = (uint32_t)strtoul(p + 1, &p, 16);
+        if (*p != '\0')
+            return 0;
+    }
+    return *arg != '\0' && storage_dump_add(arg, addr, len);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -100,20 +148,116 @@ main(int argc, char *argv[])
     char  *log_file = NULL;
     struct _device   *dev;
     int               i;
+    int               batch_mode = 0;
+    int               r = 0;
+    struct _batch_job job[64];      /* One per -f, run at once with -b */
+    int               njobs = 0;
+    char             *until = NULL;
+    const char       *name = NULL;
+    char             *record = NULL;
+    char             *replay = NULL;
+    uint64_t          back = 0;         /* Step to go back to after run */
+    char             *loads[16];        /* Files to load in storage */
+    int               nloads = 0;
+    int               dumped = 0;
+    uint64_t          end;
+    int               level;
 
     opterr = 0;
 
-    while((c = getopt(argc, argv, "l:f:")) != -1) {
+    while((c = getopt(argc, argv, "l:f:p:s:i:m:M:b:e:c:n:j:J:x:L:D:")) != -1) {
        switch (c) {
        case 'l':
             log_file = optarg;
             break;
        case 'f':
             conf_file = optarg;
+            if (njobs == (int)(sizeof(job) / sizeof(job[0]))) {
+                fprintf(stderr, "Too many configurations.\n");
+                exit(1);
+            }
+            job[njobs].conf = optarg;
+            job[njobs].until = NULL;
+            job[njobs].name = NULL;
+            njobs++;
+            break;
+       case 'p':
+            profile_file = optarg;
+            break;
+       case 's':
+            sample_file = optarg;
+            break;
+       case 'i':
+            sample_interval = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+       case 'm':
+            stats_file = optarg;
+            break;
+       case 'M':
+            stats_period = atoi(optarg);
+            break;
+       case 'b':
+            batch.unit = (uint16_t)strtoul(optarg, NULL, 16);
+            batch_mode = 1;
+            break;
+       case 'e':
+            if (batch_until(optarg) == 0) {
+                fprintf(stderr, "Option -e requires file:text.\n");
+                exit(1);
+            }
+            /* After a -f it is for that machine only */
+            if (njobs > 0)
+                job[njobs - 1].until = optarg;
+            else
+                until = optarg;
+            break;
+       case 'c':
+            batch.max_cycles = strtoull(optarg, NULL, 0);
+            break;
+       case 'n':
+            batch.name = optarg;
+            if (njobs > 0)
+                job[njobs - 1].name = optarg;
+            else
+                name = optarg;
+            break;
+       case 'j':
+            record = optarg;
+            break;
+       case 'J':
+            replay = optarg;
+            break;
+       case 'x':
+            back = strtoull(optarg, NULL, 0);
+            break;
+       case 'L':
+            if (nloads == (int)(sizeof(loads) / sizeof(loads[0]))) {
+                fprintf(stderr, "Too many files to load.\n");
+                exit(1);
+            }
+            loads[nloads++] = optarg;
+            break;
+       case 'D':
+            if (!dump_arg(optarg)) {
+                fprintf(stderr, "Option -D requires file[:addr[:len]].\n");
+                exit(1);
+            }
+            dumped = 1;
             break;
        case '?':
-            if (optopt == 'f')
+            if (optopt == 'f' || optopt == 'p' || optopt == 's' || optopt == 'm' ||
+                optopt == 'j' || optopt == 'J' || optopt == 'L' || optopt == 'D')
                 fprintf(stderr, "Option -%c requires a file name.\n", optopt);
+            else if (optopt == 'i')
+                fprintf(stderr, "Option -i requires a number of cycles.\n");
+            else if (optopt == 'M')
+                fprintf(stderr, "Option -M requires a number of seconds.\n");
+            else if (optopt == 'b')
+                fprintf(stderr, "Option -b requires a unit address.\n");
+            else if (optopt == 'c' || optopt == 'x')
+                fprintf(stderr, "Option -%c requires a number of cycles.\n", optopt);
+            else if (optopt == 'e' || optopt == 'n')
+                fprintf(stderr, "Option -%c requires an argument.\n", optopt);
             else if (isprint (optopt))
                 fprintf(stderr, "Unknown option '-%c'.\n", optopt);
             else
@@ -128,6 +272,31 @@ main(int argc, char *argv[])
        log_init(log_file);
        log_level = LOG_INFO|LOG_WARN|LOG_ERROR;
     }
+    if (njobs > 1) {
+        if (!batch_mode) {
+            fprintf(stderr, "Several configurations need option -b.\n");
+            exit(1);
+        }
+        if (record != NULL || replay != NULL || back != 0) {
+            fprintf(stderr, "No journal with several configurations.\n");
+            exit(1);
+        }
+        if (nloads != 0 || dumped) {
+            fprintf(stderr, "Load and dump storage from the configurations.\n");
+            exit(1);
+        }
+        for (i = 0; i < njobs; i++) {
+            if (job[i].until == NULL)
+                job[i].until = until;
+            if (job[i].name == NULL)
+                job[i].name = name;
+        }
+        r = run_farm(job, njobs) != njobs;
+        profile_save();
+        sample_save();
+        stats_save();
+        return r;
+    }
     if (conf_file != NULL) {
        if (load_config(conf_file) == 0) {
           fprintf(stderr, "error in configuration: %s\n", conf_file);
@@ -139,9 +308,66 @@ main(int argc, char *argv[])
              log_info("Device %03x %s\n", dev->addr, dev->type_name);
         }
     }
-    if (title != NULL) {
+    for (i = 0; i < nloads; i++) {
+        if (!load_arg(loads[i]))
+            exit(1);
+    }
+    if (record != NULL && replay != NULL) {
+        fprintf(stderr, "Journal can not be recorded while replayed.\n");
+        exit(1);
+    }
+    if (record != NULL || replay != NULL) {
+        journal_switches();
+        if ((record != NULL && !journal_record(record)) ||
+            (replay != NULL && !journal_replay(replay))) {
+            exit(1);
+        }
+    }
+    if (back != 0) {
+        if (!batch_mode) {
+            fprintf(stderr, "Option -x needs option -b.\n");
+            exit(1);
+        }
+        if (checkpoint_every == 0)
+            checkpoint_every = 10000000;
+    }
+    if (batch_mode) {
+        /* Only trace the part of the run after going back */
+        level = log_level;
+        if (back != 0)
+            log_level &= LOG_INFO|LOG_WARN|LOG_ERROR;
+        r = !run_batch();
+        if (back != 0) {
+            end = step_count;
+            if (checkpoint_back(back, &batch_step)) {
+                log_level = level;
+                while (step_count < end)
+                    batch_step();
+            } else {
+                r = 1;
+            }
+        }
+        system_shutdown();
+    } else if (title != NULL) {
+#ifdef MACHINE_THREADS
+        /* Panel would be looking at the display thread's machine */
+        fprintf(stderr, "No front panel in a MACHINE_THREADS build, use -b.\n");
+        r = 1;
+#else
+        if (!checkpoint_start())
+            exit(1);
         SDL_Setup(title);
         run_sim();
+#endif
     }
+    storage_dump_all();
+    checkpoint_stop();
+    debug_close();
+    gdb_close();
+    journal_close();
+    profile_save();
+    sample_save();
+    stats_save();
+    return r;
 }
 
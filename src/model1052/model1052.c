@@ -27,6 +27,7 @@
 #include <SDL_thread.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #ifndef _WIN32
 #include <unistd.h>
 #include <sys/socket.h>
@@ -40,6 +41,8 @@
 #include "logger.h"
 #include "event.h"
 #include "device.h"
+#include "journal.h"
+#include "checkpoint.h"
 #include "model1052.h"
 #include "xlat.h"
 
@@ -70,6 +73,16 @@ DEV_LIST_STRUCT(1052, DEV_TYPE, 0);
 #define TNS_SKIP        004                             /* skip next cmd */
 #define TNS_CRPAD       005                             /* CR padding */
 
+/* Input deck lines to raise attention and to wait a number of steps */
+#define DECK_ATTN       "%attn"
+#define DECK_WAIT       "%wait"
+
+/* Console thread to CPU queue entries other than characters */
+#define CONS_ONLINE     0x100                           /* Connected */
+#define CONS_OFFLINE    0x101                           /* Disconnected */
+
+#define CONS_PRINT      1000                            /* Steps to print character */
+
 /*
  *  Commands.
  *
@@ -93,12 +106,9 @@ struct _1052_context {
     int                    data_rdy;     /* Data is valid */
     int                    data_end;     /* Data transfer over */
     int                    cmd_done;     /* Command done */
-    SOCKET                 sock;         /* Socket to wait for connection on */
-    SOCKET                 cons;         /* Socket to send data over */
     int                    key_buf[256]; /* Buffer holding input record */
-    char                   out_buf;      /* Character to output */
-    int                    out_flg;      /* Output character full */
-    int                    out_cr;       /* Output carrage return when no charater in buffer */
+    int                    out_flg;      /* Characters still printing */
+    int                    online;       /* Console connected */
     int                    in_flg;       /* Accept input */
     int                    in_ptr;       /* Pointer to where to insert data */
     int                    out_ptr;      /* Pointer to where to grab data */
@@ -107,15 +117,33 @@ struct _1052_context {
     int                    attn_flg;     /* Attention key pressed */
     int                    cancel_flg;   /* Cancel key pressed */
     int                    eob_flg;      /* Eob key pressed */
+    int                    deck_pos;     /* Next line of input deck */
+    int                    deck_typed;   /* Deck line typed for this read */
+    uint64_t               deck_time;    /* Step input deck waits for */
+    /* Rest is shared with console thread, not checkpointed */
+    SOCKET                 sock;         /* Socket to wait for connection on */
+    SOCKET                 cons;         /* Socket to send data over */
+    char                   out_buf[256]; /* Printed characters for console thread */
+    SDL_atomic_t           out_in;       /* Where CPU puts next character */
+    SDL_atomic_t           out_out;      /* Where console thread takes next */
+    int                    in_buf[256];  /* Keys and connects from console thread */
+    SDL_atomic_t           in_in;        /* Where console thread puts next */
+    SDL_atomic_t           in_out;       /* Where CPU takes next */
+    char                   src[16];      /* Name in journal */
     fd_set                 fds_socks;    /* Current scaning sockets */
     SDL_Thread             *thrd;        /* Pointer to thread */
     int                    running;      /* Device running. */
+    char                   *deck;        /* Operator input deck */
+    int                    deck_len;     /* Size of input deck */
 };
 
 #ifdef _WIN32
 WSADATA  wsaData = { 0 };
 #endif
 int model1052_thrd(void *data);
+static void print_char(struct _1052_context *ctx, char ch);
+static void take_input(struct _1052_context *ctx);
+static void deck_input(struct _1052_context *ctx);
 
 #define SENSE_CMDREJ    BIT0  /* Invalid command */
 #define SENSE_INTERV    BIT1  /* Operator intervention, test empty */
@@ -144,7 +172,7 @@ poll_callback(struct _device *unit, void *arg, int iarg)
        log_console("1052: data_end\n");
        if ((out_tags & BIT0) != 0) {
           ctx->status |= SNS_UNITEXP;
-          ctx->out_cr = 1;
+          print_char(ctx, '\r');
        }
        ctx->data_end = 1;
        ctx->cmd_done = 1;
@@ -251,7 +279,7 @@ void
 model1052_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *bus_in)
 {
     struct _1052_context *ctx = (struct _1052_context *)unit->dev;
-    static   uint16_t last_tags = 0;
+    static MACHINE_LOCAL uint16_t last_tags = 0;
     uint16_t       out_tags;
 
     if (last_tags != *tags || unit->selected) {
@@ -302,7 +330,8 @@ model1052_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
                 log_device("1052: %03x port request\n",unit->addr);
                 if ((*tags & (CHAN_SUP_OUT|CHAN_ADR_OUT)) == 0) {
                     *tags |= CHAN_REQ_IN;
-                } else {
+                } else if ((*tags & CHAN_SEL_OUT) == 0) {
+                    /* A poll may be for someone further down */
                     *tags &= ~CHAN_REQ_IN;
                 }
             }
@@ -736,6 +765,8 @@ model1052_init_ctx(uint16_t port)
 #endif
     FD_ZERO(&ctx->fds_socks);
     ctx->cons = 0;
+    snprintf(ctx->src, sizeof(ctx->src), "CONS%d", port);
+    checkpoint_area(ctx->src, ctx, offsetof(struct _1052_context, sock));
     if ((ctx->sock = socket(PF_INET, SOCK_STREAM, 0)) < 0) {
         perror("Socket Open");
         return NULL;
@@ -761,14 +792,45 @@ model1052_init_ctx(uint16_t port)
     return ctx;
 }
 
+/*
+ * Load operator input deck, the console is online from now on.
+ */
+int
+model1052_deck(void *data, char *file_name)
+{
+    struct _1052_context *ctx = (struct _1052_context *)data;
+    FILE     *file;
+    long      size;
+
+    if ((file = fopen(file_name, "rb")) == NULL) {
+        fprintf(stderr, "Can't open console deck %s\n", file_name);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    free(ctx->deck);
+    if (size < 0 || (ctx->deck = (char *)malloc(size + 1)) == NULL) {
+        fclose(file);
+        ctx->deck = NULL;
+        return 0;
+    }
+    ctx->deck_len = (int)fread(ctx->deck, 1, size, file);
+    ctx->deck[ctx->deck_len] = '\0';
+    fclose(file);
+    ctx->deck_pos = 0;
+    ctx->deck_time = 0;
+    ctx->online = 1;
+    return 1;
+}
+
 void
 model1052_out(void *data, uint16_t out_char)
 {
    struct _1052_context *ctx = (struct _1052_context *)data;
    char    ch = ebcdic_to_ascii[out_char & 0xff];
    log_console("send out %02x\n", ch);
-   ctx->out_buf = ch;
-   ctx->out_flg = 1;
+   print_char(ctx, ch);
 }
 
 /*
@@ -823,7 +885,8 @@ model1052_func(void *data, uint16_t *tags_out, uint16_t tags_in, uint16_t *t_req
        *t_request = 0;
    }
    *tags_out = 0;
-   if (ctx->cons != 0) {
+   take_input(ctx);
+   if (ctx->online) {
        /* Set default tags out */
        *tags_out = BIT3;
 
@@ -835,6 +898,7 @@ model1052_func(void *data, uint16_t *tags_out, uint16_t tags_in, uint16_t *t_req
           ctx->cancel_flg = 0;
           ctx->eob_flg = 0;
           ctx->home_loop = 0;
+          ctx->deck_typed = 0;
        }
 
        /* Clear attention signal */
@@ -858,7 +922,7 @@ model1052_func(void *data, uint16_t *tags_out, uint16_t tags_in, uint16_t *t_req
        }
 
        /* Check if sending characters and finished */
-       if (ctx->home_loop != 0 && ctx->out_flg == 0 && ctx->out_cr == 0) {
+       if (ctx->home_loop != 0 && ctx->out_flg == 0) {
            *tags_out |= BIT1;
        }
 
@@ -882,7 +946,7 @@ model1052_func(void *data, uint16_t *tags_out, uint16_t tags_in, uint16_t *t_req
 
        /* If request CR signal to send one */
        if ((tags_in & BIT5) != 0) {
-           ctx->out_cr = 1;
+           print_char(ctx, '\r');
        }
 
        /* Check if we need to notify the CPU of anything */
@@ -908,6 +972,7 @@ model1052_done(void *data)
 #ifdef _WIN32
    WSACleanup();
 #endif
+   free(ctx->deck);
    free(ctx);
 }
 
@@ -930,17 +995,165 @@ push_char(struct _1052_context *ctx, char in_char)
        } else if (in_char == '\r') {
            log_console("Cons eob\n");
            ctx->eob_flg = 1;
-           ctx->out_cr = 1;
-       } else {
+           print_char(ctx, '\r');
+       } else if (ctx->in_len < 256) {
            ctx->key_buf[ctx->in_ptr++] = in_char;
            ctx->in_ptr &= 0xff;
            ctx->in_len++;
            log_console("Cons push_char(%02x)\n", in_char);
-           send(ctx->cons, &in_char, 1, 0);
+           print_char(ctx, in_char);
        }
     }
 }
 
+/* Printing of a character finished */
+static void
+print_done(struct _device *unit, void *arg, int iarg)
+{
+    struct _1052_context *ctx = (struct _1052_context *)arg;
+
+    ctx->out_flg--;
+}
+
+/*
+ * Give character to console thread to send.  How long printing takes
+ * is counted in steps, not by when the console thread gets to it, so
+ * runs are the same every time.
+ */
+static void
+print_char(struct _1052_context *ctx, char ch)
+{
+    int    in = SDL_AtomicGet(&ctx->out_in);
+
+    if (((in + 1) & 0xff) != SDL_AtomicGet(&ctx->out_out)) {
+        ctx->out_buf[in] = ch;
+        SDL_AtomicSet(&ctx->out_in, (in + 1) & 0xff);
+    }
+    ctx->out_flg++;
+    add_event(NULL, &print_done, CONS_PRINT, ctx, 0);
+}
+
+/* Queue key or connect change for the CPU side */
+static void
+queue_input(struct _1052_context *ctx, int value)
+{
+    int    in = SDL_AtomicGet(&ctx->in_in);
+
+    if (((in + 1) & 0xff) == SDL_AtomicGet(&ctx->in_out))
+        return;
+    ctx->in_buf[in] = value;
+    SDL_AtomicSet(&ctx->in_in, (in + 1) & 0xff);
+}
+
+static void
+console_input(struct _1052_context *ctx, int value)
+{
+    switch (value) {
+    case CONS_ONLINE:
+         ctx->online = 1;
+         ctx->in_ptr = 0;
+         ctx->out_ptr = 0;
+         ctx->in_len = 0;
+         break;
+    case CONS_OFFLINE:
+         ctx->online = (ctx->deck != NULL);
+         break;
+    default:
+         push_char(ctx, (char)value);
+         break;
+    }
+}
+
+/* Give one key from the input deck, journaled like typed keys */
+static void
+deck_key(struct _1052_context *ctx, int value)
+{
+    if (journal_mode == JOURNAL_RECORD)
+        journal_input(ctx->src, (uint32_t)value);
+    console_input(ctx, value);
+}
+
+/*
+ * Type the input deck as the operator would.  Each line is typed when
+ * the CPU does a read, followed by EOB.  A line of %attn presses the
+ * request key, %wait n holds off the rest of the deck for n steps.
+ * Lines starting with # are skipped.
+ */
+static void
+deck_input(struct _1052_context *ctx)
+{
+    char     *line;
+    int       len;
+    int       i;
+
+    while (ctx->deck != NULL && ctx->deck_pos < ctx->deck_len) {
+        if (step_count < ctx->deck_time)
+            return;
+        line = &ctx->deck[ctx->deck_pos];
+        for (len = 0; ctx->deck_pos + len < ctx->deck_len; len++) {
+            if (line[len] == '\n')
+                break;
+        }
+        if (line[0] == '#') {
+            ctx->deck_pos += len + 1;
+            continue;
+        }
+        if (len >= 5 && strncmp(line, DECK_WAIT, 5) == 0) {
+            ctx->deck_time = step_count + strtoul(&line[5], NULL, 10);
+            ctx->deck_pos += len + 1;
+            continue;
+        }
+        if (len >= 5 && strncmp(line, DECK_ATTN, 5) == 0) {
+            if (ctx->in_flg)
+                return;
+            deck_key(ctx, '\033');
+            ctx->deck_pos += len + 1;
+            continue;
+        }
+        /* Wait for a read with nothing typed yet */
+        if (!ctx->in_flg || ctx->deck_typed || ctx->in_len != 0 ||
+             ctx->eob_flg || ctx->cancel_flg)
+            return;
+        for (i = 0; i < len; i++) {
+            if (line[i] != '\r')
+                deck_key(ctx, line[i] & 0xff);
+        }
+        deck_key(ctx, '\r');
+        ctx->deck_typed = 1;
+        ctx->deck_pos += len + 1;
+        return;
+    }
+}
+
+/*
+ * Take input queued by the console thread.  This is the only place
+ * input gets into the machine, so it can be journaled.  When replaying
+ * a journal the console is ignored.
+ */
+static void
+take_input(struct _1052_context *ctx)
+{
+    int       out;
+    uint32_t  value;
+
+    if (journal_mode == JOURNAL_REPLAY) {
+        SDL_AtomicSet(&ctx->in_out, SDL_AtomicGet(&ctx->in_in));
+        while (journal_next(ctx->src, &value))
+            console_input(ctx, (int)value);
+        return;
+    }
+    out = SDL_AtomicGet(&ctx->in_out);
+    while (out != SDL_AtomicGet(&ctx->in_in)) {
+        value = (uint32_t)ctx->in_buf[out];
+        out = (out + 1) & 0xff;
+        if (journal_mode == JOURNAL_RECORD)
+            journal_input(ctx->src, value);
+        console_input(ctx, (int)value);
+    }
+    SDL_AtomicSet(&ctx->in_out, out);
+    deck_input(ctx);
+}
+
 static char init_string[] = {
         TN_IAC, TN_WILL, TN_LINE,
         TN_IAC, TN_WILL, TN_SGA,
@@ -984,9 +1197,7 @@ model1052_thrd(void *data)
                ctx->cons = newsock;
                FD_SET(newsock, &ctx->fds_socks);
                send(newsock, init_string, 15, 0);
-               ctx->in_ptr = 0;
-               ctx->out_ptr = 0;
-               ctx->in_len = 0;
+               queue_input(ctx, CONS_ONLINE);
                t_state = TNS_NORM;
            } else {
                static char *msg = "console already connected\n\r";
@@ -996,17 +1207,20 @@ model1052_thrd(void *data)
         }
 
         /* Send any data ready to send */
-        if (ctx->out_flg) {
-            send(ctx->cons, &ctx->out_buf, 1, 0);
-            log_console("Cons send socket char(%02x)\n", ctx->out_buf);
-            ctx->out_flg = 0;
-            if (ctx->out_buf == '\r')
-               send(ctx->cons, "\n", 1, 0);
-        }
-        if (ctx->out_cr) {
-            send(ctx->cons, "\r\n", 2, 0);
-            ctx->out_cr = 0;
+        k = SDL_AtomicGet(&ctx->out_out);
+        while (k != SDL_AtomicGet(&ctx->out_in)) {
+            char  ch = ctx->out_buf[k];
+
+            k = (k + 1) & 0xff;
+            if (ctx->cons <= 0)
+                continue;
+            log_console("Cons send socket char(%02x)\n", ch);
+            if (ch == '\r')
+                send(ctx->cons, "\r\n", 2, 0);
+            else
+                send(ctx->cons, &ch, 1, 0);
         }
+        SDL_AtomicSet(&ctx->out_out, k);
 
         /* Collect any waiting input */
         if (FD_ISSET(ctx->cons, &read_set)) {
@@ -1016,9 +1230,10 @@ model1052_thrd(void *data)
                FD_CLR(ctx->cons, &ctx->fds_socks);
                close(ctx->cons);
                ctx->cons = 0;
+               queue_input(ctx, CONS_OFFLINE);
             }
             k = 0;
-            while(k < j && ctx->in_len < 256) {
+            while(k < j) {
                char t;
 
                t = buffer[k++];
@@ -1027,11 +1242,11 @@ model1052_thrd(void *data)
                     if (t == TN_IAC)
                        t_state = TNS_IAC;
                     else
-                       push_char(ctx, t);
+                       queue_input(ctx, t & 0xff);
                     break;
                case TNS_IAC:
                     if (t == TN_IAC) {
-                       push_char(ctx, t);
+                       queue_input(ctx, t & 0xff);
                        t_state = TNS_NORM;
                     } else if (t == TN_BRK) {
                        t_state = TNS_NORM;
@@ -1060,6 +1275,7 @@ model1052_create(struct _option *opt)
     struct _device  *dev1052;
     struct _1052_context *ctx;
     uint16_t         port = 3270;
+    char             deck[1024] = "";
     struct _option   opts;
 
     while (get_option(&opts)) {
@@ -1076,6 +1292,8 @@ model1052_create(struct _option *opt)
                  }
              }
              port = v;
+         } else if (strcmp(opts.opt, "DECK") == 0 && opts.flags == 1) {
+             strncpy(deck, opts.string, sizeof(deck) - 1);
          } else {
              fprintf(stderr, "Invalid option %s\n", opts.opt);
              return 0;
@@ -1087,6 +1305,10 @@ model1052_create(struct _option *opt)
          free(dev1052);
          return 0;
     }
+    if (deck[0] != '\0' && !model1052_deck(ctx, deck)) {
+         free(dev1052);
+         return 0;
+    }
 
     dev1052->bus_func = &model1052_dev;
     dev1052->dev = (void *)ctx;
@@ -26,6 +26,7 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <ctype.h>
 #include <string.h>
 #include "logger.h"
@@ -35,6 +36,7 @@
 #include "card.h"
 #include "xlat.h"
 #include "model1442.h"
+#include "checkpoint.h"
 
 DEV_LIST_STRUCT(1442, DEV_TYPE, 0);
 /*
@@ -306,7 +308,7 @@ void
 model1442_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *bus_in)
 {
     struct _1442_context *ctx = (struct _1442_context *)unit->dev;
-    static   uint16_t last_tags = 0;
+    static MACHINE_LOCAL uint16_t last_tags = 0;
 
     if (last_tags != *tags || unit->selected) {
         print_tags("1442", ctx->state, *tags, bus_out);
@@ -358,7 +360,9 @@ model1442_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
                 log_device("1442: %03x port request\n",unit->addr);
                 if ((*tags & (CHAN_SUP_OUT|CHAN_ADR_OUT)) == 0 || ctx->data_rdy) {
                     *tags |= CHAN_REQ_IN;
-                } else {
+                } else if ((*tags & CHAN_SEL_OUT) == 0) {
+                    /* Only drop it outside a poll, the printer may be
+                       asking for data while our status is suppressed */
                     *tags &= ~CHAN_REQ_IN;
                 }
             }
@@ -795,6 +799,21 @@ log_device("intervent\n");
     }
 }
 
+/*
+ * Return what device image shows, deck sizes as drawn.
+ */
+uint64_t
+model1442_state(struct _device *unit, int u)
+{
+     struct _1442_context *ctx = (struct _1442_context *)unit->dev;
+     uint64_t              state;
+
+     state = (uint64_t)(hopper_size(ctx->feed) / 30);
+     state |= (uint64_t)(stack_size(ctx->stack[0]) / 30) << 16;
+     state |= (uint64_t)(stack_size(ctx->stack[1]) / 30) << 32;
+     return state;
+}
+
 struct _device *
 model1442_init(uint16_t addr)
 {
@@ -813,6 +832,7 @@ model1442_init(uint16_t addr)
      dev1442->bus_func = &model1442_dev;
      dev1442->dev = (void *)card;
      dev1442->draw_model = &model1442_draw;
+     dev1442->draw_state = &model1442_state;
      dev1442->create_ctrl = &model1442_control;
      dev1442->init_device = &model1442_init_graphics;
      dev1442->type_name = "1442";
@@ -833,6 +853,11 @@ model1442_init(uint16_t addr)
      card->hop_cnt = hopper_size(card->feed);
      card->stk_cnt[0] = stack_size(card->stack[0]);
      card->stk_cnt[1] = stack_size(card->stack[1]);
+     /* Panel input fields are not machine state */
+     checkpoint_area("1442", card, offsetof(struct _1442_context, input));
+     checkpoint_card(card->feed, "1442 hopper");
+     checkpoint_card(card->stack[0], "1442 stack 1");
+     checkpoint_card(card->stack[1], "1442 stack 2");
      add_chan(dev1442, addr);
      return dev1442;
 }
@@ -82,6 +82,8 @@ void *model1442_control(struct _device *unit, int u, int x, int y);
 
 void model1442_draw(struct _device *unit, void *rend, int u);
 
+uint64_t model1442_state(struct _device *unit, int u);
+
 void model1442_init_graphics(struct _device *unit, void *rend);
 
 struct _device *model1442_init(uint16_t addr);
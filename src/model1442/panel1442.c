@@ -49,6 +49,8 @@
 
 static SDL_Texture *model1442_img = NULL;
 
+static void model1442_update(void *arg, int iarg);
+
 /*
  * Initialize device graphics.
  */
@@ -76,6 +78,7 @@ model1442_create(struct _option *opt)
      struct _1442_context *ctx;
      struct _option       opts;
      int             i;
+     int             start = 0;
 
      /* Check for valid address */
      if (opt->addr == 0) {
@@ -101,6 +104,10 @@ model1442_create(struct _option *opt)
                if (get_integer(&opts, &num) != 0)
                    return 0;
                blank_deck(ctx->feed, num);
+           } else if (strcmp(opts.opt, "START") == 0) {
+               start = 1;
+           } else if (strcmp(opts.opt, "EOF") == 0) {
+               ctx->eof_flag = 1;
            } else if (strcmp(opts.opt, "FORMAT") == 0) {
                i = get_index(&opts, card_fmt_type);
                if (i >= 0)
@@ -113,6 +120,9 @@ model1442_create(struct _option *opt)
            }
      }
 
+     /* Press start so reader is ready without the panel */
+     if (start)
+         model1442_update((void *)ctx, 1);
      return 1;
 }
 
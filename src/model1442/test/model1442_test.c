@@ -40,7 +40,7 @@
 #include "xlat.h"
 #include "model1442.h"
 
-uint64_t   step_count = 0;
+MACHINE_LOCAL uint64_t   step_count = 0;
 int        verbose = 0;
 char       *test_log_file = "model1442_debug.log";
 char       *test_log_level = "info warn error trace device card";
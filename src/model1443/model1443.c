@@ -27,11 +27,14 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <stddef.h>
 #include "logger.h"
 #include "device.h"
 #include "config.h"
 #include "event.h"
 #include "xlat.h"
+#include "stats.h"
+#include "checkpoint.h"
 #include "model1443.h"
 
 /*
@@ -155,6 +158,68 @@ const static uint8_t ebcdic_to_out[256] = {
 
 int print_line(struct _1443_context *ctx);
 
+/*
+ * Write out anything held in the spool buffer.
+ */
+void
+model1443_flush(struct _1443_context *ctx)
+{
+    if (ctx->spool_len != 0 && ctx->file != NULL) {
+        checkpoint_file(fileno(ctx->file), -1, 0);
+        fwrite(ctx->spool, 1, ctx->spool_len, ctx->file);
+        fflush(ctx->file);
+    }
+    ctx->spool_len = 0;
+}
+
+/*
+ * Place text into spool buffer, writing it out if full.
+ */
+static void
+spool_write(struct _1443_context *ctx, const char *buf, int len)
+{
+    if ((ctx->spool_len + len) > SPOOL_SIZE)
+        model1443_flush(ctx);
+    memcpy(&ctx->spool[ctx->spool_len], buf, len);
+    ctx->spool_len += len;
+}
+
+/*
+ * Move paper up one line in preview.
+ */
+static void
+feed_paper(struct _1443_context *ctx)
+{
+    memset(&ctx->output[ctx->out_top][0], 0, 120);
+    ctx->out_top = (ctx->out_top + 1) % OUT_ROWS;
+}
+
+/*
+ * Periodically write out spooled output.
+ */
+static void
+spool_callback(struct _device *unit, void *arg, int iarg)
+{
+    struct _1443_context *ctx = (struct _1443_context *)unit->dev;
+    ctx->spool_timer = 0;
+    model1443_flush(ctx);
+}
+
+/*
+ * Print the current line and make sure spool will get flushed.
+ */
+static int
+print_spool(struct _device *unit, struct _1443_context *ctx)
+{
+    int    time = print_line(ctx);
+
+    if (!ctx->spool_timer) {
+        ctx->spool_timer = 1;
+        add_event(unit, spool_callback, SPOOL_TIME, NULL, 0);
+    }
+    return time;
+}
+
 static void
 done_callback(struct _device *unit, void *arg, int iarg)
 {
@@ -166,7 +231,7 @@ void
 model1443_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *bus_in)
 {
     struct _1443_context *ctx = (struct _1443_context *)unit->dev;
-    static   uint16_t last_tags = 0;
+    static MACHINE_LOCAL uint16_t last_tags = 0;
 
     if (last_tags != *tags) {
         print_tags("Printer", ctx->state, *tags, bus_out);
@@ -307,7 +372,7 @@ model1443_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
                             ctx->sense = SENSE_CMDREJ;
                             break;
                         }
-                        add_event(unit, done_callback, 2000 * print_line(ctx), NULL, 0);
+                        add_event(unit, done_callback, 2000 * print_spool(unit, ctx), NULL, 0);
                         ctx->status = (SNS_CHNEND);
                         ctx->data_end = 1;
                         break;
@@ -492,7 +557,7 @@ model1443_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
                 }
 
                 if ((ctx->cmd & 07) == 1) { /* If write, print the line */
-                    add_event(unit, done_callback, 2000 * print_line(ctx), NULL, 0);
+                    add_event(unit, done_callback, 2000 * print_spool(unit, ctx), NULL, 0);
                     ctx->status |= SNS_CHNEND;
                 }
 
@@ -958,7 +1023,7 @@ print_line(struct _1443_context *ctx)
            int         ch = ctx->buf[i];
 
            if (i < 120)
-               ctx->output[14][i] = ebcdic_to_out[ch];
+               OUT_ROW(ctx, OUT_ROWS - 1)[i] = ebcdic_to_out[ch];
            ch = ebcdic_to_ascii[ch];
            if (!isprint(ch))
               ch = '.';
@@ -970,19 +1035,18 @@ print_line(struct _1443_context *ctx)
         out[++i] = '\0';
 
         /* Print out buffer */
-        fwrite(&out, 1, i, ctx->file);
+        spool_write(ctx, out, i);
         log_device( " Printer: %s\n", out);
         memset(ctx->buf, 0x40, sizeof(ctx->buf));
+        stats.lines_printed++;
         time = 11;
     }
-    fflush(ctx->file);
 
     f = 1;  /* Indicate we need to output a new line */
     if (l < 4) {
         while(l != 0) {
-            fwrite("\r\n", 1, 2, ctx->file);
-            memcpy(&ctx->output[0][0], &ctx->output[1][0], 14 * 120);
-            memset(&ctx->output[14][0], 0, 120);
+            spool_write(ctx, "\r\n", 2);
+            feed_paper(ctx);
             r++;
             f = 0;
             log_device( " Printer fcb: %04x\n", ctx->fcb[ctx->row]);
@@ -998,11 +1062,10 @@ print_line(struct _1443_context *ctx)
             l--;
         }
         if (ctx->row > ctx->lpp) {
-           memcpy(&ctx->output[0][0], &ctx->output[1][0], 14 * 120);
-           memset(&ctx->output[14][0], 0, 120);
+           feed_paper(ctx);
            if (f)
-               fwrite("\r\n", 1, 2, ctx->file);
-           fwrite("\f", 1, 1, ctx->file);
+               spool_write(ctx, "\r\n", 2);
+           spool_write(ctx, "\f", 1);
            ctx->row = 0;
         }
         if (ch9 && (ctx->cmd & 0x3) == 0x1) {
@@ -1025,9 +1088,8 @@ print_line(struct _1443_context *ctx)
          r++;
          if (i > ctx->lpp) {
              log_device("printer skip2 %d > %d\n", i, ctx->lpp);
-             fwrite("\r\n\f", 1, 3, ctx->file);
-             memcpy(&ctx->output[0][0], &ctx->output[1][0], 14 * 120);
-             memset(&ctx->output[14][0], 0, 120);
+             spool_write(ctx, "\r\n\f", 3);
+             feed_paper(ctx);
              f = 1;
              r = 0;
          }
@@ -1040,13 +1102,12 @@ print_line(struct _1443_context *ctx)
 
     if (ctx->fcb[i] & mask) {
         while (r-- > 0) {
-           fwrite("\r\n", 1, 2, ctx->file);
-           memcpy(&ctx->output[0][0], &ctx->output[1][0], 14 * 120);
-           memset(&ctx->output[14][0], 0, 120);
+           spool_write(ctx, "\r\n", 2);
+           feed_paper(ctx);
            ctx->row++;
            if (ctx->row > ctx->lpp) {
                log_device("printer skip %d > %d\n", ctx->row, ctx->lpp);
-               fwrite("\f", 1, 1, ctx->file);
+               spool_write(ctx, "\f", 1);
                ctx->row = 0;
            }
         }
@@ -1055,6 +1116,41 @@ print_line(struct _1443_context *ctx)
     return l;
 }
 
+/*
+ * Return what device image shows, hash of paper position and the
+ * part of the last lines which is visible.
+ */
+uint64_t
+model1443_state(struct _device *unit, int u)
+{
+    struct _1443_context *ctx = (struct _1443_context *)unit->dev;
+    uint64_t              state = 0xcbf29ce484222325ULL;
+    int                   i, j;
+
+    state = (state ^ (uint64_t)ctx->row) * 0x100000001b3ULL;
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 94; j++) {
+            state = (state ^ (uint8_t)OUT_ROW(ctx, i)[j]) * 0x100000001b3ULL;
+        }
+    }
+    return state;
+}
+
+/*
+ * Write out any remaining output on shutdown.
+ */
+void
+model1443_close(struct _device *unit)
+{
+    struct _1443_context *ctx = (struct _1443_context *)unit->dev;
+
+    model1443_flush(ctx);
+    if (ctx->file != NULL) {
+        fclose(ctx->file);
+        ctx->file = NULL;
+    }
+}
+
 int
 model1443_create(struct _option *opt)
 {
@@ -1072,8 +1168,10 @@ model1443_create(struct _option *opt)
      dev1443->bus_func = &model1443_dev;
      dev1443->dev = (void *)lpr;
      dev1443->draw_model = (void *)&model1443_draw;
+     dev1443->draw_state = &model1443_state;
      dev1443->create_ctrl = (void *)&model1443_control;
      dev1443->init_device = (void *)&model1443_init;
+     dev1443->close_device = &model1443_close;
      dev1443->type_name = "1443";
      dev1443->rect[0].x = 305;
      dev1443->rect[0].y = 0;
@@ -1090,6 +1188,10 @@ model1443_create(struct _option *opt)
      lpr->form = 1;
      lpr->fcb = &cctape_legacy[0];
      lpr->lpp = 66;
+     /* File is replaced from the panel, which drops checkpoints */
+     checkpoint_area("1443", lpr, offsetof(struct _1443_context, file));
+     checkpoint_area("1443 buffer", &lpr->buf[0],
+                     sizeof(struct _1443_context) - offsetof(struct _1443_context, buf));
      add_chan(dev1443, opt->addr);
 
      /* Parse options given on definition */
@@ -1098,6 +1200,7 @@ model1443_create(struct _option *opt)
                lpr->ready = 1;
            } else if (strcmp(opts.opt, "FILE") == 0 && opts.flags == 1) {
                if (lpr->file != NULL) {
+                   model1443_flush(lpr);
                    fclose(lpr->file);
                    lpr->form = 1;
                }
@@ -38,6 +38,13 @@
 #define _MODEL1443_H_
 #include "device.h"
 
+#define SPOOL_SIZE      65536         /* Size of output spool buffer */
+#define SPOOL_TIME      1000000       /* Cycles before spool is flushed */
+#define OUT_ROWS        15            /* Number of preview rows kept */
+
+/* Row r of preview, 0 is oldest line */
+#define OUT_ROW(ctx, r) ((ctx)->output[((ctx)->out_top + (r)) % OUT_ROWS])
+
 struct _1443_context {
     int                    addr;         /* Device address */
     int                    chan;         /* Channel address */
@@ -68,21 +75,31 @@ struct _1443_context {
     int                    cnt;          /* Transfer count */
     int                    fcb_num;      /* Forms control number */
     const uint16_t        *fcb;          /* Form control block */
-    uint8_t                output[15][120];
+    uint8_t                output[OUT_ROWS][120]; /* Preview ring */
+    int                    out_top;      /* Oldest row in preview ring */
+    int                    spool_len;    /* Number of bytes in spool */
+    int                    spool_timer;  /* Spool flush event pending */
+    char                   spool[SPOOL_SIZE]; /* Output spool buffer */
 };
 
 
 int print_line(struct _1443_context *ctx);
 
+void model1443_flush(struct _1443_context *ctx);
+
 int model1443_create(struct _option *opt);
 
 void model1443_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *bus_in);
 
 void model1443_draw(struct _device *unit, void *rend, int u);
 
+uint64_t model1443_state(struct _device *unit, int u);
+
 void *model1443_control(struct _device *unit, int u, int x, int y);
 
 void model1443_init(struct _device *unit, void *rend);
 
+void model1443_close(struct _device *unit);
+
 int model1443_create(struct _option *opt);
 #endif
@@ -42,6 +42,7 @@
 #include "logger.h"
 #include "event.h"
 #include "xlat.h"
+#include "checkpoint.h"
 #include "model1443.h"
 #include "model1443.xpm"
 
@@ -118,7 +119,7 @@ model1443_draw(struct _device *unit, void *rend, int u)
         rect.x = x + 89;
         rect.y = y + 23 + 42 + (2 * i) ;
         for (j = 0; j < 94; j++) {
-            uint8_t  ch = ctx->output[i][j];
+            uint8_t  ch = OUT_ROW(ctx, i)[j];
             if (ch != 0) {
                 rect2.x = ch * 2;
                 SDL_RenderCopy(render, model1443_img, &rect2, &rect);
@@ -164,6 +165,7 @@ static void
           ctx->stop = 1;
           ctx->single = 0;
           ctx->ready = 0;
+          model1443_flush(ctx);
           break;
 
     case 3: /* Carriage Space */
@@ -190,7 +192,9 @@ static void
           break;
 
     case 6: /* Save paper */
+          checkpoint_changed();
           if (ctx->file != NULL) {
+              model1443_flush(ctx);
               fclose(ctx->file);
               ctx->form = 1;
           }
@@ -39,7 +39,7 @@
 #include "xlat.h"
 #include "model1443.h"
 
-uint64_t   step_count = 0;
+MACHINE_LOCAL uint64_t   step_count = 0;
 int        verbose = 0;
 char       *test_log_file = "model1443_debug.log";
 char       *test_log_level = "info warn error trace device";
@@ -181,6 +181,58 @@ CTEST2(model1443_test, sense) {
      ASSERT_EQUAL_X(0xffffffff, get_mem(0x700));
 }
 
+/* Print lines go to spool until flushed */
+CTEST2(model1443_test, spool) {
+     struct _1443_context *ctx = (struct _1443_context *)(data->dev->dev);
+     FILE    *f;
+     char     buffer[100];
+     int      i;
+
+     log_trace("Spool\n");
+     ASSERT_NOT_NULL(ctx->file = fopen("print1.txt", "w"));
+     ctx->row = 0;
+     ctx->cmd = 0x09;            /* Write and space 1 line */
+     for (i = 0; i < 3; i++)
+         ctx->buf[i] = 0xc1;     /* A */
+     ctx->col = 3;
+     (void)print_line(ctx);
+     ASSERT_EQUAL(5, ctx->spool_len);
+     ASSERT_EQUAL(0, ftell(ctx->file));
+     /* Printed line should now be one up from bottom of preview */
+     ASSERT_NOT_EQUAL(0x00, OUT_ROW(ctx, OUT_ROWS - 2)[0]);
+     ASSERT_EQUAL(0x00, OUT_ROW(ctx, OUT_ROWS - 1)[0]);
+     model1443_flush(ctx);
+     ASSERT_EQUAL(0, ctx->spool_len);
+     fclose(ctx->file);
+     ctx->file = NULL;
+     ctx->cmd = 0;
+     ASSERT_NOT_NULL(f = fopen("print1.txt", "r"));
+     memset(buffer, 0, sizeof(buffer));
+     ASSERT_EQUAL(5, fread(buffer, 1, sizeof(buffer), f));
+     fclose(f);
+     ASSERT_STR("AAA\r\n", buffer);
+     (void)remove("print1.txt");
+}
+
+/* Device image only changes when printed output changes */
+CTEST2(model1443_test, draw_state) {
+     struct _1443_context *ctx = (struct _1443_context *)(data->dev->dev);
+     uint64_t state;
+     int      i;
+
+     log_trace("Draw state\n");
+     state = model1443_state(data->dev, 0);
+     ASSERT_EQUAL(state, model1443_state(data->dev, 0));
+     ctx->cmd = 0x09;            /* Write and space 1 line */
+     for (i = 0; i < 3; i++)
+         ctx->buf[i] = 0xc1;     /* A */
+     ctx->col = 3;
+     (void)print_line(ctx);
+     ctx->cmd = 0;
+     ASSERT_NOT_EQUAL(state, model1443_state(data->dev, 0));
+     ctx->spool_len = 0;
+}
+
 #if 0
 /* Try to read a card */
 CTEST2(model1442_test, read) {
@@ -34,8 +34,14 @@
 #include "cpu.h"
 #include "model2030.h"
 #include "model1052.h"
+#include "profile.h"
+#include "sample.h"
+#include "stats.h"
+#include "checkpoint.h"
 
-struct CPU_2030 cpu_2030;
+MACHINE_LOCAL struct CPU_2030 cpu_2030;
+MACHINE_LOCAL struct _profile *prof_2030;
+MACHINE_LOCAL struct _sample *samp_2030;
 
 /* Machine check bits */
 #define AREG    0x80
@@ -132,72 +138,73 @@ static char *cs_name[] = {
 static char hex[] = {
      '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
 
-static int        suppr_half_trap_lch;  /* Holds Machine check flag 03AA3 */
-static int        start_sw_rst;         /* Reset from start switch 03CA3 */
-static int        e_cy_stop_sample;     /* Cycle Stop sample flag 03CB3 */
-static int        clock_stop;           /* Indicate clock to stop 03CB4 */
-static int        clock_rst;            /* Reset clock start 03CB4 */
-static int        set_ic_allowed;       /* Set IC switch pressed 03CC3 */
-static int        set_ic_start;         /* Start of set IC */
-static int        cf_stop;
-static int        stop_req;
-static int        process_stop;         /* Stop CPU */
-static int        read_call;
-static int        proc_stop_loop_active;
-static int        protect_loc_cpu_or_mpx;
-static int        interrupt;            /* Interrupt pending */
-static int        any_mach_chk;
-static int        chk_restart;
-static int        priority;
-static int        priority_bus;
-static int        priority_stack_reg;
-static int        priority_lch;
-static int        any_priority_lch;
-static int        any_priority_pulse;
-static int        force_ij_req;
-static int        hard_stop;
-static int        second_err_stop;
-static int        gate_sw_to_wx;
-static int        allow_a_reg_chk;
-static int        first_mach_chk_req;
-static int        suppr_a_reg_chk;
-static int        mach_chk_pulse;
-static int        stg_prot_req;
-static int        inh_stg_prot;
-static int        mem_wrap_req;
-static int        i_wrap_cpu;
-static int        u_wrap_cpu;
-static int        u_wrap_mpx;
-static int        wrap_buf;
-static int        alu_chk;
-static int        mpx_share_pulse;
-static int        mpx_cmd_start;
-static int        mpx_start_sel;
-static int        mpx_supr_out_lch;
-static int        chk_or_diag_stop_sw;
-static int        even_parity;
-static int        mem_prot;
-static int        timer_update;
-static int        tc;
-static int        sel_ros_req;
-static int        sel_chnl_chk;
-static int        sel_chain_pulse;
-static int        sel_share_req;
-static int        sel_read_cycle[2];
-static int        sel_write_cycle[2];
-static int        sel_gr_full[2];
-static int        sel_halt_io[2];
-static int        sel_poll_ctrl[2];
-static int        sel_cnt_rdy_not_zero[2];
-static int        sel_cnt_rdy_zero[2];
-static int        sel_diag_tag_ctrl[2];
-static int        sel_diag_mode[2];
-static int        sel_bus_out_ctrl[2];
-static int        sel_chan_busy[2];
-static int        sel_intrp_lch[2];
-static int        sel_status_stop_cond[2];
-static int        sel_chain_req[2];
-static int        sel_chain_det[2];
+static MACHINE_LOCAL int suppr_half_trap_lch;  /* Holds Machine check flag 03AA3 */
+static MACHINE_LOCAL int start_sw_rst;         /* Reset from start switch 03CA3 */
+static MACHINE_LOCAL int e_cy_stop_sample;     /* Cycle Stop sample flag 03CB3 */
+static MACHINE_LOCAL int clock_stop;           /* Indicate clock to stop 03CB4 */
+static MACHINE_LOCAL int clock_rst;            /* Reset clock start 03CB4 */
+static MACHINE_LOCAL int set_ic_allowed;       /* Set IC switch pressed 03CC3 */
+static MACHINE_LOCAL int set_ic_start;         /* Start of set IC */
+static MACHINE_LOCAL int cf_stop;
+static MACHINE_LOCAL int stop_req;
+static MACHINE_LOCAL int process_stop;         /* Stop CPU */
+static MACHINE_LOCAL int read_call;
+static MACHINE_LOCAL int proc_stop_loop_active;
+static MACHINE_LOCAL int protect_loc_cpu_or_mpx;
+static MACHINE_LOCAL int interrupt;            /* Interrupt pending */
+static MACHINE_LOCAL int any_mach_chk;
+static MACHINE_LOCAL int chk_restart;
+static MACHINE_LOCAL int priority;
+static MACHINE_LOCAL int priority_bus;
+static MACHINE_LOCAL int priority_stack_reg;
+static MACHINE_LOCAL int priority_lch;
+static MACHINE_LOCAL int any_priority_lch;
+static MACHINE_LOCAL int any_priority_pulse;
+static MACHINE_LOCAL int force_ij_req;
+static MACHINE_LOCAL int hard_stop;
+static MACHINE_LOCAL int second_err_stop;
+static MACHINE_LOCAL int gate_sw_to_wx;
+static MACHINE_LOCAL int allow_a_reg_chk;
+static MACHINE_LOCAL int first_mach_chk_req;
+static MACHINE_LOCAL int suppr_a_reg_chk;
+static MACHINE_LOCAL int mach_chk_pulse;
+static MACHINE_LOCAL int stg_prot_req;
+static MACHINE_LOCAL int inh_stg_prot;
+static MACHINE_LOCAL int mem_wrap_req;
+static MACHINE_LOCAL int i_wrap_cpu;
+static MACHINE_LOCAL int u_wrap_cpu;
+static MACHINE_LOCAL int u_wrap_mpx;
+static MACHINE_LOCAL int wrap_buf;
+static MACHINE_LOCAL int alu_chk;
+static MACHINE_LOCAL int mpx_share_pulse;
+static MACHINE_LOCAL int mpx_cmd_start;
+static MACHINE_LOCAL int mpx_start_sel;
+static MACHINE_LOCAL int mpx_supr_out_lch;
+static MACHINE_LOCAL int chk_or_diag_stop_sw;
+static MACHINE_LOCAL int even_parity;
+static MACHINE_LOCAL int mem_prot;
+static MACHINE_LOCAL int timer_update;
+static MACHINE_LOCAL int tc;
+static MACHINE_LOCAL int sel_ros_req;
+static MACHINE_LOCAL int sel_chnl_chk;
+static MACHINE_LOCAL int sel_chain_pulse;
+static MACHINE_LOCAL int sel_share_req;
+static MACHINE_LOCAL int sel_read_cycle[2];
+static MACHINE_LOCAL int sel_write_cycle[2];
+static MACHINE_LOCAL int sel_gr_full[2];
+static MACHINE_LOCAL int sel_halt_io[2];
+static MACHINE_LOCAL int sel_poll_ctrl[2];
+static MACHINE_LOCAL int sel_cnt_rdy_not_zero[2];
+static MACHINE_LOCAL int sel_cnt_rdy_zero[2];
+static MACHINE_LOCAL int sel_diag_tag_ctrl[2];
+static MACHINE_LOCAL int sel_diag_mode[2];
+static MACHINE_LOCAL int sel_bus_out_ctrl[2];
+static MACHINE_LOCAL int sel_chan_busy[2];
+static MACHINE_LOCAL int sel_intrp_lch[2];
+static MACHINE_LOCAL int sel_status_stop_cond[2];
+static MACHINE_LOCAL int sel_chain_req[2];
+static MACHINE_LOCAL int sel_chain_det[2];
+static MACHINE_LOCAL uint16_t carries;         /* Carries out of last ALU add */
 
 static int        cg_mask[4] = { 0x00, 0x0f, 0xf0, 0xff };
 
@@ -238,10 +245,86 @@ static int        cg_mask[4] = { 0x00, 0x0f, 0xf0, 0xff };
    2     ROS SCAN
 */
 
-static char  dis_buffer[1024];
+static MACHINE_LOCAL char dis_buffer[1024];
 
 DEV_LIST_STRUCT(2030, CPU_TYPE, CHAR_OPT|NUM_MOD);
 
+/* Everything the 2030 keeps between cycles */
+#define SAVE(v)    checkpoint_area(#v, &v, sizeof(v))
+
+void
+checkpoint_2030()
+{
+    SAVE(cpu_2030);
+    SAVE(suppr_half_trap_lch);
+    SAVE(start_sw_rst);
+    SAVE(e_cy_stop_sample);
+    SAVE(clock_stop);
+    SAVE(clock_rst);
+    SAVE(set_ic_allowed);
+    SAVE(set_ic_start);
+    SAVE(cf_stop);
+    SAVE(stop_req);
+    SAVE(process_stop);
+    SAVE(read_call);
+    SAVE(proc_stop_loop_active);
+    SAVE(protect_loc_cpu_or_mpx);
+    SAVE(interrupt);
+    SAVE(any_mach_chk);
+    SAVE(chk_restart);
+    SAVE(priority);
+    SAVE(priority_bus);
+    SAVE(priority_stack_reg);
+    SAVE(priority_lch);
+    SAVE(any_priority_lch);
+    SAVE(any_priority_pulse);
+    SAVE(force_ij_req);
+    SAVE(hard_stop);
+    SAVE(second_err_stop);
+    SAVE(gate_sw_to_wx);
+    SAVE(allow_a_reg_chk);
+    SAVE(first_mach_chk_req);
+    SAVE(suppr_a_reg_chk);
+    SAVE(mach_chk_pulse);
+    SAVE(stg_prot_req);
+    SAVE(inh_stg_prot);
+    SAVE(mem_wrap_req);
+    SAVE(i_wrap_cpu);
+    SAVE(u_wrap_cpu);
+    SAVE(u_wrap_mpx);
+    SAVE(wrap_buf);
+    SAVE(alu_chk);
+    SAVE(mpx_share_pulse);
+    SAVE(mpx_cmd_start);
+    SAVE(mpx_start_sel);
+    SAVE(mpx_supr_out_lch);
+    SAVE(chk_or_diag_stop_sw);
+    SAVE(even_parity);
+    SAVE(mem_prot);
+    SAVE(timer_update);
+    SAVE(tc);
+    SAVE(sel_ros_req);
+    SAVE(sel_chnl_chk);
+    SAVE(sel_chain_pulse);
+    SAVE(sel_share_req);
+    SAVE(sel_read_cycle);
+    SAVE(sel_write_cycle);
+    SAVE(sel_gr_full);
+    SAVE(sel_halt_io);
+    SAVE(sel_poll_ctrl);
+    SAVE(sel_cnt_rdy_not_zero);
+    SAVE(sel_cnt_rdy_zero);
+    SAVE(sel_diag_tag_ctrl);
+    SAVE(sel_diag_mode);
+    SAVE(sel_bus_out_ctrl);
+    SAVE(sel_chan_busy);
+    SAVE(sel_intrp_lch);
+    SAVE(sel_status_stop_cond);
+    SAVE(sel_chain_req);
+    SAVE(sel_chain_det);
+    SAVE(carries);
+}
+
 void
 cycle_2030()
 {
@@ -251,7 +334,6 @@ cycle_2030()
    int               carry_in;
    uint16_t          abus_f;
    uint16_t          bbus_f;
-   static uint16_t   carries;
    int               i;
    struct _device   *dev;
 
@@ -419,6 +501,7 @@ cycle_2030()
       /* Set memory parity to valid */
       for (i = 0; i <= mem_max; i++)
           M[i] = odd_parity[M[i]&0xff] | (M[i]&0xff);
+      storage_all_dirty();
       for (i = 0; i < 2048; i++)
           cpu_2030.LS[i] = odd_parity[cpu_2030.LS[i]&0xff] | (cpu_2030.LS[i]&0xff);
       /* Reset MPX channel */
@@ -635,7 +718,7 @@ cycle_2030()
                    cpu_2030.N_REG |= odd_parity[cpu_2030.N_REG];
                    cpu_2030.MN_REG = ((cpu_2030.M_REG & 0xff) << 8) | (cpu_2030.N_REG & 0xff);
                    if (E_SW == 0x20) {
-                       M[cpu_2030.MN_REG] = cpu_2030.R_REG ^ 0x100;
+                       store_main(cpu_2030.MN_REG, cpu_2030.R_REG ^ 0x100);
                        cpu_2030.store = MAIN;
                    }
                    if (E_SW == 0x21) {
@@ -797,7 +880,7 @@ cycle_2030()
            cpu_2030.GU[i] = cpu_2030.GHY | odd_parity[cpu_2030.GHY];
            /* If output and GR empty */
            if (sel_cnt_rdy_zero[i] == 0 && (cpu_2030.GG[i] & 1) == 1 && sel_gr_full[i] == 0) {
-               cpu_2030.GR[i] = M[cpu_2030.MN_REG];
+               cpu_2030.GR[i] = load_main(cpu_2030.MN_REG);
                log_mem("Read main sel%d %04x %03x\n", i, cpu_2030.MN_REG, cpu_2030.GR[i]);
            }
            /* Update Q with selector memory protection */
@@ -836,12 +919,12 @@ cycle_2030()
                if ((cpu_2030.GK[i] & 0xf0) != 0 &&
                          (((cpu_2030.GK[i] >> 4) ^ cpu_2030.Q_REG) & 0xf) != 0) {
                    cpu_2030.GE[i] |= BIT3;
-                   cpu_2030.GR[i] = M[cpu_2030.MN_REG];
+                   cpu_2030.GR[i] = load_main(cpu_2030.MN_REG);
                    log_mem("Read main sel%d %04x %03x\n", i, cpu_2030.MN_REG, cpu_2030.GR[i]);
                }
                /* Check skip flag */
                if ((cpu_2030.GF[i] & BIT3) == 0) {
-                   M[cpu_2030.MN_REG] = cpu_2030.GR[i];
+                   store_main(cpu_2030.MN_REG, cpu_2030.GR[i]);
                    log_mem("Read write sel%d %04x %03x\n", i, cpu_2030.MN_REG, cpu_2030.GR[i]);
                }
                sel_gr_full[i] = 0;
@@ -877,11 +960,28 @@ cycle_2030()
         }
         /* Otherwise see if CPU clock is running */
         if (cpu_2030.clock_start_lch) {
+           /* Hold clock at ROS breakpoint */
+           if (debug_ros_check(cpu_2030.WX))
+               goto chan_scan;
            sal = &ros_2030[cpu_2030.WX];
            cpu_2030.ros_row1 = sal->row1;
            cpu_2030.ros_row2 = sal->row2;
            cpu_2030.ros_row3 = sal->row3;
 
+          /* Opcode is decoded at 109, channel microcode runs between
+             saving and restoring the CPU ROS address */
+          if (cpu_2030.WX == 0x109) {
+              stats.insts++;
+              debug_inst_check(cpu_2030.MN_REG);
+              if (cpu_2030.MN_REG <= mem_max)
+                  PROFILE_INST(prof_2030, M[cpu_2030.MN_REG]);
+          }
+          PROFILE(prof_2030, cpu_2030.WX, cpu_2030.mpx_ros_rest | cpu_2030.sel_ros_rest);
+          /* I and J hold address of next byte of instruction */
+          SAMPLE(samp_2030, ((((cpu_2030.I_REG & 0xff) << 8) |
+                              (cpu_2030.J_REG & 0xff)) - 1) & 0xffff,
+                 cpu_2030.wait);
+
           /* Print instruction and registers */
           if (cpu_2030.WX == 0x109 && (log_level & LOG_ITRACE) != 0) {
              int        cc = 0;
@@ -1075,13 +1175,13 @@ cycle_2030()
                    switch (cpu_2030.store) {
                    case MAIN:
                         if (sal->CU == 1) {
-                            cpu_2030.GR[cpu_2030.ch_sel] = M[cpu_2030.MN_REG];
+                            cpu_2030.GR[cpu_2030.ch_sel] = load_main(cpu_2030.MN_REG);
                         } else {
-                            cpu_2030.R_REG = M[cpu_2030.MN_REG];
+                            cpu_2030.R_REG = load_main(cpu_2030.MN_REG);
                             log_mem("Read main %04x %03x %x %d\n", cpu_2030.MN_REG, cpu_2030.R_REG,
                                    cpu_2030.Q_REG & 0xf, inh_stg_prot);
                         }
-                        M[cpu_2030.MN_REG] = 0x00;
+                        store_main(cpu_2030.MN_REG, 0x00);
                         break;
                    case MPX:
                    case LOCAL:
@@ -1112,9 +1212,9 @@ cycle_2030()
                           switch (cpu_2030.store) {
                           case MAIN:
                                if (sal->CU == 1) {
-                                   M[cpu_2030.MN_REG] = cpu_2030.GR[cpu_2030.ch_sel];
+                                   store_main(cpu_2030.MN_REG, cpu_2030.GR[cpu_2030.ch_sel]);
                                } else {
-                                   M[cpu_2030.MN_REG] = cpu_2030.R_REG;
+                                   store_main(cpu_2030.MN_REG, cpu_2030.R_REG);
                                    log_mem("Write main %04x %03x\n", cpu_2030.MN_REG, cpu_2030.R_REG);
                                }
                                cpu_2030.MP[cpu_2030.SA_REG] = cpu_2030.Q_REG & 0x0f;
@@ -2449,6 +2549,7 @@ chan_scan:
         cpu_2030.MPX_TI |= cpu_2030.MPX_TAGS;  /* Copy current tags to output */
         cpu_2030.FI = 0;
         print_tags("CPU", 0, cpu_2030.MPX_TI, cpu_2030.O_REG);
+        STATS_CHAN(0, cpu_2030.MPX_TI);
         for (dev = chan[0]; dev != NULL; dev = dev->next) {
              dev->bus_func(dev, &cpu_2030.MPX_TI, cpu_2030.O_REG, &cpu_2030.FI);
         }
@@ -2514,6 +2615,7 @@ chan_scan:
              }
              cpu_2030.SEL_TI[i] &= IN_TAGS;               /* Clear outbound tags */
              cpu_2030.SEL_TI[i] |= cpu_2030.SEL_TAGS[i];  /* Copy current tags to output */
+             STATS_CHAN(i + 1, cpu_2030.SEL_TI[i]);
 
              for (dev = chan[i+1]; dev != NULL; dev = dev->next) {
                   dev->bus_func(dev, &cpu_2030.SEL_TI[i], cpu_2030.GO[i], &cpu_2030.GI[i]);
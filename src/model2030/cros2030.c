@@ -28,8 +28,10 @@
 #include <stdint.h>
 
 #include "model2030.h"
+#include "rosimg.h"
 
 struct ROS_2030 ros_2030[4096];
+static char     notes[4096][16];
 
 uint16_t const odd_parity[256] = {
     /*    0    1    2    3    4    5    6    7 */
@@ -90,7 +92,7 @@ main(int argc, char *argv[])
            perror("");
            exit(1);
        }
-       if ((out = fopen(argv[2], "w")) == NULL) {
+       if ((out = fopen(argv[2], "wb")) == NULL) {
            fprintf(stderr, "Unable to create: %s, ", argv[2]);
            perror("");
            exit(1);
@@ -200,9 +202,10 @@ loop:
            for (i = 0; i < 15; i++) {
               if (*p == '\n' || *p == '\0')
                  break;
-              ros_2030[addr].note[i] = *p++;
+              notes[addr][i] = *p++;
            }
-           ros_2030[addr].note[i] = '\0';
+           notes[addr][i] = '\0';
+           ros_2030[addr].note = notes[addr];
         }
     }
 
@@ -239,6 +242,19 @@ loop:
         r->row3 |= (x != 0) << 19;
     }
 
+    /* Write binary image if output is a .ros file */
+    if (argc > 2 && rosimg_name(argv[2])) {
+        static const struct rosimg_field fields[] = { ROS_2030_FIELDS };
+
+        if (!rosimg_write(out, 2030, ros_2030, sizeof(struct ROS_2030), 4096, fields,
+                          sizeof(fields) / sizeof(fields[0]))) {
+            fprintf(stderr, "Unable to write: %s\n", argv[2]);
+            exit(1);
+        }
+        fclose(out);
+        return 0;
+    }
+
     /* Dump out the ros image to a C file. */
     fprintf(out, "/*  CN   CH   CL   CM   CU    CA   CB    CK   CD    CF  CG   CV   CC    CS   PK        R1        R2        R3  Note  */\n");
     for (i = 0; i < 4096; i++) {
@@ -250,7 +266,7 @@ loop:
         fprintf(out, "0x%x, 0x%x, 0x%x, 0x%x, 0x%x, 0x%02x, 0x%x, ",
                   r->CD, r->CF, r->CG, r->CV, r->CC, r->CS, r->PK);
         fprintf(out, "0x%06x, 0x%06x, 0x%06x, \"%s\" }, \n",
-                  r->row1, r->row2, r->row3, (r->note[0] == '\0') ? " ": r->note);
+                  r->row1, r->row2, r->row3, (r->note == NULL) ? " ": r->note);
     }
 }
 
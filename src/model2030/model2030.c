@@ -33,6 +33,57 @@
 #include "cpu.h"
 #include "model2030.h"
 #include "model1052.h"
+#include "profile.h"
+#include "sample.h"
+#include "journal.h"
+#include "checkpoint.h"
+
+/* Note of ROS word for profile */
+static const char *
+note_2030(int addr)
+{
+    return ros_2030[addr].note;
+}
+
+/* Load unit is dialed on switches G, H and J */
+static void
+load_unit_2030(uint16_t addr)
+{
+    G_SW = (addr >> 8) & 0xf;
+    H_SW = (addr >> 4) & 0xf;
+    J_SW = addr & 0xf;
+}
+
+/* Registers are in local storage, PSW fields at 7B8 to 7BB */
+static void
+regs_2030(struct _debug_regs *regs)
+{
+    int     i, j;
+
+    for (i = 0; i < 16; i++) {
+        regs->gpr[i] = 0;
+        for (j = 0; j < 4; j++)
+            regs->gpr[i] = (regs->gpr[i] << 8) |
+                           (cpu_2030.LS[0x700 + (i << 4) + j] & 0xff);
+    }
+    for (i = 0; i < 4; i++) {
+        regs->fpr[i] = 0;
+        for (j = 0; j < 8; j++)
+            regs->fpr[i] = (regs->fpr[i] << 8) |
+                           (cpu_2030.LS[0x708 + (i << 5) + j] & 0xff);
+    }
+    regs->mask = cpu_2030.LS[0x7b8] & 0xff;
+    regs->key = (cpu_2030.LS[0x7b9] >> 4) & 0xf;
+    regs->amwp = cpu_2030.LS[0x7b9] & 0xf;
+    switch (cpu_2030.LS[0x7bb] & 0xf0) {
+    case 0x80: regs->cc = 0; break;
+    case 0x40: regs->cc = 1; break;
+    case 0x20: regs->cc = 2; break;
+    default:   regs->cc = 3; break;
+    }
+    regs->pm = cpu_2030.LS[0x7bb] & 0xf;
+    regs->ia = ((cpu_2030.I_REG & 0xff) << 8) | (cpu_2030.J_REG & 0xff);
+}
 
 struct _device *
 model2030_init(void *render, uint16_t addr)
@@ -48,6 +99,8 @@ model2030_create(struct _option *opt)
     extern  void *setup_fp2030(char *title);
     int     msize;
     uint16_t         port = 3270;
+    char             deck[1024] = "";
+    int              ros = 0;
     struct _option   opts;
 
     if (title != NULL) {
@@ -57,17 +110,27 @@ model2030_create(struct _option *opt)
     title = "IBM360/30";
     setup_cpu = &setup_fp2030;
     step_cpu = &cycle_2030;
+    set_load_unit = &load_unit_2030;
+    debug_regs = &regs_2030;
 
     while (get_option(&opts)) {
          int       v;
 
          if (strcmp(opts.opt, "PORT") == 0 && get_integer(&opts, &v)) {
              port = v;
+         } else if (strcmp(opts.opt, "ROS") == 0 && opts.flags == 1) {
+             if (!model2030_load_ros(opts.string))
+                 return 0;
+             ros = 1;
+         } else if (strcmp(opts.opt, "DECK") == 0 && opts.flags == 1) {
+             strncpy(deck, opts.string, sizeof(deck) - 1);
          } else {
              fprintf(stderr, "Invalid option %s\n", opts.opt);
              return 0;
          }
     }
+    if (!ros && !model2030_load_ros(NULL))
+        return 0;
 
     if (opt->model != '\0') {
         msize = 2048 << (opt->model - 'A');
@@ -82,6 +145,18 @@ model2030_create(struct _option *opt)
     mem_max = msize - 1;
     log_info("Model 30 configured %d %04x mem\n", msize, mem_max);
     cpu_2030.console = model1052_init_ctx(port);
+    if (deck[0] != '\0' && (cpu_2030.console == NULL ||
+                 !model1052_deck(cpu_2030.console, deck)))
+        return 0;
+    prof_2030 = profile_create("2030", PROF_ROWS, &note_2030);
+    samp_2030 = sample_create("2030");
+    journal_watch("STORE_DIAL", &cpu_2030.store, sizeof(cpu_2030.store));
+    /* Track all that MN can address */
+    if (!storage_track(64 * 1024, 1))
+        return 0;
+    checkpoint_area("storage", M, msize * sizeof(uint32_t));
+    checkpoint_dirty(M, M_dirty, M_shift + 2);
+    checkpoint_2030();
     INT_TMR = 1;   /* By default enable interval timer */
     return 1;
 }
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include "device.h"
 #include "conf.h"
+#include "machine.h"
 
 #ifndef _MODEL30_H_
 #define _MODEL30_H_
@@ -51,10 +52,23 @@ extern struct ROS_2030 {
     uint32_t   row1;
     uint32_t   row2;
     uint32_t   row3;
-    char        note[16];
+    const char *note;
 } ros_2030[4096];
 
-extern struct CPU_2030 {
+/* Fields of ROS word saved in a binary ROS image */
+#define ROS_2030_FIELDS \
+    ROSIMG_FIELD(struct ROS_2030, CN), ROSIMG_FIELD(struct ROS_2030, CH), \
+    ROSIMG_FIELD(struct ROS_2030, CL), ROSIMG_FIELD(struct ROS_2030, CM), \
+    ROSIMG_FIELD(struct ROS_2030, CU), ROSIMG_FIELD(struct ROS_2030, CA), \
+    ROSIMG_FIELD(struct ROS_2030, CB), ROSIMG_FIELD(struct ROS_2030, CK), \
+    ROSIMG_FIELD(struct ROS_2030, CD), ROSIMG_FIELD(struct ROS_2030, CF), \
+    ROSIMG_FIELD(struct ROS_2030, CG), ROSIMG_FIELD(struct ROS_2030, CV), \
+    ROSIMG_FIELD(struct ROS_2030, CC), ROSIMG_FIELD(struct ROS_2030, CS), \
+    ROSIMG_FIELD(struct ROS_2030, PK), ROSIMG_FIELD(struct ROS_2030, row1), \
+    ROSIMG_FIELD(struct ROS_2030, row2), \
+    ROSIMG_FIELD(struct ROS_2030, row3), ROSIMG_STR(struct ROS_2030, note)
+
+extern MACHINE_LOCAL struct CPU_2030 {
 int         count;
 uint16_t    LS[4096];           /* Local storage and BUMP storage */
 uint8_t     MP[256];            /* Protection storage. 4 bits */
@@ -334,10 +348,15 @@ struct _1052_context  *console;         /* Console device */
 #define LOCAL  2
 #define MPX    4
 
+extern MACHINE_LOCAL struct _profile *prof_2030;     /* Microcode profile, if enabled */
+extern MACHINE_LOCAL struct _sample *samp_2030;    /* Address sampler, if enabled */
+
 void            cycle_2030();
+void            checkpoint_2030();
 
 struct _device *model2030_init(void *render, uint16_t addr);
 int             model2030_create(struct _option *opt);
+int             model2030_load_ros(const char *name);
 
 
 /* Select channel I/O sequence.
@@ -23,8 +23,49 @@
  *
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "logger.h"
 #include "model2030.h"
+#include "rosimg.h"
 
+/* The tests run from the C tables, the simulator loads an image */
+#ifdef ROS_TABLES
 struct ROS_2030 ros_2030[4096] = {
 #include "model2030_ros.h"
 };
+#else
+struct ROS_2030 ros_2030[4096];
+#endif
+
+static char *ros_strings;      /* Notes of loaded image */
+
+/*
+ * Load ROS from binary image name, NULL gives the default image.
+ */
+int
+model2030_load_ros(const char *name)
+{
+    static const struct rosimg_field fields[] = { ROS_2030_FIELDS };
+    char  *strings = NULL;
+    int    r;
+
+    if (name == NULL) {
+#ifdef ROS_TABLES
+        return 1;
+#else
+        name = ROS_PATH "/ccros2030.ros";
+#endif
+    }
+    r = rosimg_load(name, 2030, ros_2030, sizeof(struct ROS_2030), 4096, fields,
+                    sizeof(fields) / sizeof(fields[0]), &strings);
+    if (r != ROSIMG_OK) {
+        fprintf(stderr, "%s: %s\n", name, rosimg_error(r));
+        return 0;
+    }
+    free(ros_strings);
+    ros_strings = strings;
+    log_info("Model 30 ROS loaded from %s\n", name);
+    return 1;
+}
@@ -8,6 +8,7 @@
 #include "model2030.h"
 
 struct ROS_2030 ros_2030[4096];
+char            notes[4096][17];
 
 u_int16_t const odd_parity[256] = {
     /*    0    1    2    3    4    5    6    7 */
@@ -150,9 +151,11 @@ main(int argc, char *argv[])
     int   addr;
     int   ros_sort[4096];
     char  page[200][240];
-    char  *curr_page;
+    const char *curr_page;
     int   x, y;
 
+    for (i = 0; i < 4096; i++)
+        ros_2030[i].note = notes[i];
     base = 16;
     shift = 4;
 loop:
@@ -249,9 +252,9 @@ loop:
            for (i = 0; i < 16; i++) {
               if (*p == '\n' || *p == '\0')
                  break;
-              ros_2030[addr].note[i] = *p++;
+              notes[addr][i] = *p++;
            }
-           ros_2030[addr].note[i] = '\0';
+           notes[addr][i] = '\0';
         }
 #if 0
         i = addr;
@@ -0,0 +1,216 @@
+/*
+ * microsim360 - Model 2030 interface for lockstep runner.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "device.h"
+#include "logger.h"
+#include "cpu.h"
+#include "conf.h"
+#include "xlat.h"
+#include "model2030.h"
+#include "model1052.h"
+#include "lockstep.h"
+
+#define MAX_CYCLES     100000     /* Longest instruction allowed */
+
+/* The following functions are referenced by the 2030 simulator,
+   but do not need to preform any function in the lockstep runner.
+*/
+void
+setup_fp2030(void *rend)
+{
+}
+
+void
+model1052_out(void *ctx, uint16_t out_char)
+{
+}
+
+void
+model1052_in(void *ctx, uint16_t *in_char)
+{
+}
+
+void
+model1052_func(void *ctx, uint16_t *tags_out, uint16_t tags_in, uint16_t *t_request)
+{
+}
+
+void *
+model1052_init_ctx(uint16_t port)
+{
+    return NULL;
+}
+
+int
+model1052_deck(void *ctx, char *file_name)
+{
+    return 1;
+}
+
+/* Set local storage byte with parity */
+static void
+set_ls(int addr, uint8_t data)
+{
+    cpu_2030.LS[addr] = data | odd_parity[data];
+}
+
+static int    need_reset;         /* CPU must be reset before next case */
+
+/* Reset CPU, like init_cpu() */
+static void
+reset_2030()
+{
+    int    max = 0;
+
+    SYS_RST = 1;
+    CHK_SW = 2;
+    RATE_SW = 1;
+    PROC_SW = 1;
+    mem_max = 0xffff;
+    do {
+        cycle_2030();
+    } while (cpu_2030.WX != 0x328 && ++max < MAX_CYCLES);
+    need_reset = 0;
+}
+
+static void
+init_2030()
+{
+    load_line("2030F/1");
+    model2030_init(NULL, 0);
+    reset_2030();
+}
+
+/* Load registers and storage, each step restarts the CPU so a reset
+   is only needed if the last case hung */
+static void
+load_2030(struct lockstep_state *st, uint8_t *mem, int len)
+{
+    int    i, j;
+
+    if (need_reset)
+        reset_2030();
+    for (i = 0; i < len && i <= (int)mem_max; i++) {
+        M[i] = mem[i] | odd_parity[mem[i]];
+    }
+    for (i = 0; i < 16; i++) {
+        for (j = 0; j < 4; j++) {
+            set_ls(0x700 + (i << 4) + j, (st->gpr[i] >> (24 - (8 * j))) & 0xff);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 8; j++) {
+            set_ls(0x708 + (i << 5) + j, (st->fpr[i] >> (56 - (8 * j))) & 0xff);
+        }
+    }
+    /* Key 0, EBCDIC, supervisor state, all interrupts masked */
+    cpu_2030.MASK = 0;
+    cpu_2030.ASCII = 0;
+    cpu_2030.Q_REG &= 0x0f;
+    set_ls(0x7b8, 0);
+    set_ls(0x7b9, 0);
+    set_ls(0x7bb, (0x80 >> st->cc) | (st->pm & 0xf));
+}
+
+/* Run one instruction, like test_inst() */
+static void
+step_inst_2030(struct lockstep_state *st)
+{
+    uint8_t  hi = (st->ia >> 8) & 0xff;
+    uint8_t  lo = st->ia & 0xff;
+    int      max = 0;
+    int      i, j;
+
+    set_ls(0x7a9, hi);
+    set_ls(0x7aa, lo);
+    st->trap = 0;
+    cpu_2030.WX = 0x102;
+    START = 1;
+    cpu_2030.I_REG = hi | odd_parity[hi];
+    cpu_2030.J_REG = lo | odd_parity[lo];
+    do {
+        cycle_2030();
+        LS_COVER(cpu_2030.WX);
+        if (cpu_2030.WX == 0x147)
+           st->trap = 1;
+    } while (cpu_2030.WX != 0x100 && ++max < MAX_CYCLES);
+    do {
+        cycle_2030();
+        LS_COVER(cpu_2030.WX);
+        if (cpu_2030.WX == 0x147)
+           st->trap = 1;
+    } while (cpu_2030.WX != 0x100 && ++max < MAX_CYCLES);
+    st->hung = (max >= MAX_CYCLES);
+    need_reset |= st->hung;
+
+    for (i = 0; i < 16; i++) {
+        st->gpr[i] = 0;
+        for (j = 0; j < 4; j++) {
+            st->gpr[i] = (st->gpr[i] << 8) |
+                         (cpu_2030.LS[0x700 + (i << 4) + j] & 0xff);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        st->fpr[i] = 0;
+        for (j = 0; j < 8; j++) {
+            st->fpr[i] = (st->fpr[i] << 8) |
+                         (cpu_2030.LS[0x708 + (i << 5) + j] & 0xff);
+        }
+    }
+    switch (cpu_2030.LS[0x7bb] & 0xf0) {
+    case 0x80: st->cc = 0; break;
+    case 0x40: st->cc = 1; break;
+    case 0x20: st->cc = 2; break;
+    default:   st->cc = 3; break;
+    }
+    st->pm = cpu_2030.LS[0x7bb] & 0x0f;
+    st->ia = ((cpu_2030.I_REG & 0xff) << 8) | (cpu_2030.J_REG & 0xff);
+}
+
+static void
+save_mem_2030(uint8_t *mem, int len)
+{
+    int    i;
+
+    for (i = 0; i < len && i <= (int)mem_max; i++) {
+        mem[i] = M[i] & 0xff;
+    }
+}
+
+static const char *
+note_2030(int addr)
+{
+    const char *n = ros_2030[addr & (LS_ROS_SIZE - 1)].note;
+
+    return (n[0] == '\0' || n[0] == ' ') ? NULL : n;
+}
+
+struct lockstep_model lockstep_2030 = {
+    "2030", &init_2030, &load_2030, &step_inst_2030, &save_mem_2030, &note_2030
+};
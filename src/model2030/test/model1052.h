@@ -30,6 +30,7 @@
 #include "device.h"
 
 void *model1052_init_ctx(uint16_t port);
+int   model1052_deck(void *data, char *file_name);
 void  model1052_out(void *data, uint16_t out_char);
 void  model1052_in(void *data, uint16_t *in_char);
 void  model1052_func(void *data, uint16_t *tags_out, uint16_t tags_in, uint16_t *t_request);
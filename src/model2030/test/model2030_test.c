@@ -35,6 +35,7 @@
 #include "cpu.h"
 #include "model_test.h"
 #include "test_device.h"
+#include "bench.h"
 
 
 #include "cpu.h"
@@ -42,7 +43,11 @@
 #include "model2030.h"
 #include "model1052.h"
 
-uint64_t         step_count;
+MACHINE_LOCAL uint64_t         step_count;
+uint64_t         bench_cycles;
+uint64_t         bench_insts;
+uint64_t         bench_ns;
+uint64_t         bench_overrun;
 int              testcycles = 100;
 
 
@@ -75,6 +80,12 @@ model1052_init_ctx(uint16_t port)
     return NULL;
 }
 
+int
+model1052_deck(void *ctx, char *file_name)
+{
+    return 1;
+}
+
 int       verbose = 0;
 
 char     *test_log_file = "debug.log";
@@ -364,6 +375,8 @@ int trap_flag;
 void
 test_inst(int mask)
 {
+    uint64_t   start;
+
     cpu_2030.LS[0x7AA] = 0x100;
     cpu_2030.LS[0x7A9] = 0x04;
     cpu_2030.LS[0x7BB] = mask | (cpu_2030.LS[0x7BB] & 0xf0);
@@ -380,12 +393,16 @@ test_inst(int mask)
            trap_flag = 1;
     } while (cpu_2030.WX != 0x100);
     log_trace("first\n");
+    start = bench_now();
     do {
         cycle_2030();
         step_count++;
+        bench_cycles++;
         if (cpu_2030.WX == 0x147)
            trap_flag = 1;
     } while (cpu_2030.WX != 0x100);
+    bench_ns += bench_now() - start;
+    bench_insts++;
     log_trace("second\n");
 }
 
@@ -393,6 +410,8 @@ test_inst(int mask)
 void
 test_inst2()
 {
+    uint64_t   start;
+
     cpu_2030.LS[0x7AA] = 0x100;
     cpu_2030.LS[0x7A9] = 0x04;
     cpu_2030.LS[0x7BB] = 0x100;
@@ -409,9 +428,11 @@ test_inst2()
            trap_flag = 1;
     } while (cpu_2030.WX != 0x100);
     log_trace("first\n");
+    start = bench_now();
     do {
         cycle_2030();
         step_count++;
+        bench_cycles++;
         if (cpu_2030.WX == 0x147)
            trap_flag = 1;
     } while (cpu_2030.WX != 0x100);
@@ -419,9 +440,12 @@ test_inst2()
     do {
         cycle_2030();
         step_count++;
+        bench_cycles++;
         if (cpu_2030.WX == 0x147)
            trap_flag = 1;
     } while (cpu_2030.WX != 0x100);
+    bench_ns += bench_now() - start;
+    bench_insts += 2;
     log_trace("third\n");
 }
 
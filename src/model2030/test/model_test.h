@@ -35,7 +35,7 @@
 
 #define IAR   (((cpu_2030.I_REG & 0xff) << 8) | (cpu_2030.J_REG & 0xff))
 
-extern uint64_t         step_count;
+extern MACHINE_LOCAL uint64_t         step_count;
 extern int              testcycles;
 extern int              verbose;
 
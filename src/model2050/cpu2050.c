@@ -31,6 +31,11 @@
 #include "xlat.h"
 #include "cpu.h"
 #include "model2050.h"
+#include "profile.h"
+#include "sample.h"
+#include "stats.h"
+#include "journal.h"
+#include "checkpoint.h"
 
 DEV_LIST_STRUCT(2050, CPU_TYPE, CHAR_OPT|NUM_MOD);
 
@@ -67,15 +72,17 @@ uint32_t    BS_MASK[16] = {
 #define CPOS1 0x40000000  /* Carry from position 1 */
 #define CPOS8 0x00800000  /* Carry from position 8 */
 
-struct CPU_2050 cpu_2050;
+MACHINE_LOCAL struct CPU_2050 cpu_2050;
+MACHINE_LOCAL struct _profile *prof_2050;
+MACHINE_LOCAL struct _sample *samp_2050;
 
-static int         timer_update;         /* Flag that timer update triggered */
-static uint32_t    SA;                   /* Address of last memory reference */
-static uint8_t     stop_mode = 0;        /* Issue stop at MANUAL->STOP instruction */
-static int         timer_irq = 0;        /* Timer Interrupt request */
-static int         dtc_latch = 0;
-static int         dtc1 = 0;             /* DTC1 option */
-static int         dtc2 = 0;             /* DTC2 option */
+static MACHINE_LOCAL int         timer_update;         /* Flag that timer update triggered */
+static MACHINE_LOCAL uint32_t    SA;                   /* Address of last memory reference */
+static MACHINE_LOCAL uint8_t     stop_mode = 0;        /* Issue stop at MANUAL->STOP instruction */
+static MACHINE_LOCAL int         timer_irq = 0;        /* Timer Interrupt request */
+static MACHINE_LOCAL int         dtc_latch = 0;
+static MACHINE_LOCAL int         dtc1 = 0;             /* DTC1 option */
+static MACHINE_LOCAL int         dtc2 = 0;             /* DTC2 option */
 
 
 static uint32_t tr_interloc = 0x3043bf50;
@@ -769,7 +776,23 @@ cycle_2050()
         ROAR_RST = 0;
     }
 
+    /* Hold clock at ROS breakpoint */
+    if (debug_ros_check(cpu_2050.ROAR))
+        goto channel;
+
     sal = &ros_2050[cpu_2050.ROAR];
+    /* Instructions start where itrace prints them, I/O words are
+       channel microcode */
+    if (cpu_2050.ROAR == 0x188 || cpu_2050.ROAR == 0x187 || cpu_2050.ROAR == 0x19B) {
+        stats.insts++;
+        debug_inst_check(cpu_2050.IA_REG);
+        if (prof_2050 != NULL && cpu_2050.IA_REG <= mem_max) {
+            uint32_t mm = M[cpu_2050.IA_REG >> 2];
+            PROFILE_INST(prof_2050, mm >> (8 * (3 - (cpu_2050.IA_REG & 3))));
+        }
+    }
+    PROFILE(prof_2050, cpu_2050.ROAR, sal->io);
+    SAMPLE(samp_2050, cpu_2050.IA_REG, cpu_2050.wait);
     cpu_2050.ros_row1 = sal->row1;
     cpu_2050.ros_row2 = sal->row2;
     cpu_2050.ros_row3 = sal->row3;
@@ -809,7 +832,7 @@ cycle_2050()
                      uint32_t ba = (((SA >> 6) & 0x0f00) | (SA & 0x0Fc)) >> 2;
                      cpu_2050.SDR_REG = cpu_2050.BUMP[ba];
                  } else {
-                     cpu_2050.SDR_REG = M[SA >> 2];
+                     cpu_2050.SDR_REG = load_main(SA >> 2);
                 }
              }
              log_mem("mem cycle read 2 %06X %08x i=%d ib=%d b=%d\n", cpu_2050.SAR_REG,
@@ -837,13 +860,13 @@ cycle_2050()
                      uint32_t ba = (((SA >> 6) & 0x0f00) | (SA & 0x0Fc)) >> 2;
                      cpu_2050.BUMP[ba] = cpu_2050.SDR_REG;
                  } else {
-                     M[SA >> 2] = cpu_2050.SDR_REG;
+                     store_main(SA >> 2, cpu_2050.SDR_REG);
                  }
              }
              break;
 
     case 0:  /* Memory cycle at system reset */
-             cpu_2050.SDR_REG = M[SA >> 2];
+             cpu_2050.SDR_REG = load_main(SA >> 2);
              cpu_2050.mem_state = W1;
     case W1:
              /* Fall through */
@@ -854,7 +877,7 @@ cycle_2050()
                      uint32_t ba = (((SA >> 6) & 0x0f00) | (SA & 0x0Fc)) >> 2;
                      cpu_2050.BUMP[ba] = cpu_2050.SDR_REG;
                  } else {
-                    M[SA >> 2] = cpu_2050.SDR_REG;
+                    store_main(SA >> 2, cpu_2050.SDR_REG);
                     if ((SA >> 2) == (cpu_2050.IA_REG >> 2)) {
                         cpu_2050.REFETCH = 1;
                     }
@@ -5105,6 +5128,7 @@ channel:
     }
     cpu_2050.TAGS_IN[0] &= IN_TAGS;
     cpu_2050.TAGS_IN[0] |= cpu_2050.TAGS[0];
+    STATS_CHAN(0, cpu_2050.TAGS_IN[0]);
     for (dev = chan[0]; dev != NULL; dev = dev->next) {
          dev->bus_func(dev, &cpu_2050.TAGS_IN[0], cpu_2050.BUS_OUT[0], &cpu_2050.BUS_IN[0]);
     }
@@ -5274,6 +5298,7 @@ channel:
         int   inst = cpu_2050.inst_latch & (cpu_2050.CH == i);
         cpu_2050.TAGS_IN[ch] &= IN_TAGS;
         cpu_2050.TAGS_IN[ch] |= cpu_2050.TAGS[ch];
+        STATS_CHAN(ch, cpu_2050.TAGS_IN[ch]);
         for (dev = chan[ch]; dev != NULL; dev = dev->next) {
              dev->bus_func(dev, &cpu_2050.TAGS_IN[ch], cpu_2050.BUS_OUT[ch], &cpu_2050.BUS_IN[ch]);
         }
@@ -6295,18 +6320,58 @@ step_2050()
     cycle_2050();
 }
 
+/* Note of ROS word for profile */
+static const char *
+note_2050(int addr)
+{
+    return ros_2050[addr].note;
+}
+
+/* Load unit is dialed on switches A, B and C */
+static void
+load_unit_2050(uint16_t addr)
+{
+    A_SW = (addr >> 8) & 0xf;
+    B_SW = (addr >> 4) & 0xf;
+    C_SW = addr & 0xf;
+}
+
 struct _device *
 model2050_init(void *render, uint16_t addr)
 {
     return NULL;
 }
 
+/* Everything the 2050 keeps between cycles */
+#define SAVE(v)    checkpoint_area(#v, &v, sizeof(v))
+
+/* Registers are in local storage, PSW fields in CPU */
+static void
+regs_2050(struct _debug_regs *regs)
+{
+    int     i;
+
+    for (i = 0; i < 16; i++)
+        regs->gpr[i] = cpu_2050.LS[0x30 + i];
+    for (i = 0; i < 4; i++)
+        regs->fpr[i] = ((uint64_t)cpu_2050.LS[0x20 + (i << 1)] << 32) |
+                       cpu_2050.LS[0x21 + (i << 1)];
+    regs->mask = cpu_2050.MASK;
+    regs->key = cpu_2050.KEY;
+    regs->amwp = cpu_2050.AMWP;
+    regs->cc = cpu_2050.CC;
+    regs->pm = cpu_2050.PMASK;
+    regs->ia = cpu_2050.IA_REG;
+}
+
 /* Create a 2050 cpu system. */
 int
 model2050_create(struct _option *opt)
 {
     extern  void *setup_fp2050(char *title);
     int     msize;
+    int     ros = 0;
+    struct _option   opts;
 
     if (title != NULL) {
         fprintf(stderr, "CPU already defined, can't support more then one\n");
@@ -6315,6 +6380,21 @@ model2050_create(struct _option *opt)
     title = "IBM360/50";
     setup_cpu = &setup_fp2050;
     step_cpu = &step_2050;
+    set_load_unit = &load_unit_2050;
+    debug_regs = &regs_2050;
+
+    while (get_option(&opts)) {
+         if (strcmp(opts.opt, "ROS") == 0 && opts.flags == 1) {
+             if (!model2050_load_ros(opts.string))
+                 return 0;
+             ros = 1;
+         } else {
+             fprintf(stderr, "Invalid option %s\n", opts.opt);
+             return 0;
+         }
+    }
+    if (!ros && !model2050_load_ros(NULL))
+        return 0;
 
     if (opt->model != '\0') {
         msize = 2048 << (opt->model - 'A');
@@ -6327,6 +6407,24 @@ model2050_create(struct _option *opt)
     if ((M = (uint32_t *)calloc(msize/4, sizeof(uint32_t))) == NULL)
         return 0;
     mem_max = msize - 1;
+    prof_2050 = profile_create("2050", PROF_ROWS, &note_2050);
+    samp_2050 = sample_create("2050");
+    journal_watch("DKEYS", &cpu_2050.DKEYS, sizeof(cpu_2050.DKEYS));
+    journal_watch("AKEYS", &cpu_2050.AKEYS, sizeof(cpu_2050.AKEYS));
+    journal_watch("SEL_CHAN", &cpu_2050.SEL_CHAN_SEL, sizeof(cpu_2050.SEL_CHAN_SEL));
+    /* Track all that SA can address */
+    if (!storage_track(((msize > 0x40000) ? msize : 0x40000) / 4, 4))
+        return 0;
+    checkpoint_area("storage", M, (msize / 4) * sizeof(uint32_t));
+    checkpoint_dirty(M, M_dirty, M_shift + 2);
+    SAVE(cpu_2050);
+    SAVE(timer_update);
+    SAVE(SA);
+    SAVE(stop_mode);
+    SAVE(timer_irq);
+    SAVE(dtc_latch);
+    SAVE(dtc1);
+    SAVE(dtc2);
     return 1;
 }
 
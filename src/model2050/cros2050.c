@@ -35,8 +35,10 @@
 #endif
 
 #include "model2050.h"
+#include "rosimg.h"
 
 struct ROS_2050 ros_2050[4096];
+static char     notes[4096][20];
 
 int
 main(int argc, char *argv[])
@@ -62,7 +64,7 @@ main(int argc, char *argv[])
            perror("");
            exit(1);
        }
-       if ((out = fopen(argv[2], "w")) == NULL) {
+       if ((out = fopen(argv[2], "wb")) == NULL) {
            fprintf(stderr, "Unable to create: %s, ", argv[2]);
            perror("");
            exit(1);
@@ -147,7 +149,8 @@ loop:
         ros_2050[addr1].io = io;
         p += 5;
         while (*p == ' ') p++;
-        strcpy(&ros_2050[addr1].note[0], &note[0]);
+        strcpy(&notes[addr1][0], &note[0]);
+        ros_2050[addr1].note = notes[addr1];
         /* Grab rest of line */
         j = b = 0;
         parity = 1;
@@ -222,6 +225,19 @@ loop:
         ros_2050[addr1].ss = (bits[3] >> 8) & 0x3f;
         ros_2050[addr1].row4 = bits[3];
     }
+    /* Write binary image if output is a .ros file */
+    if (argc > 2 && rosimg_name(argv[2])) {
+        static const struct rosimg_field fields[] = { ROS_2050_FIELDS };
+
+        if (!rosimg_write(out, 2050, ros_2050, sizeof(struct ROS_2050), 4096, fields,
+                          sizeof(fields) / sizeof(fields[0]))) {
+            fprintf(stderr, "Unable to write: %s\n", argv[2]);
+            exit(1);
+        }
+        fclose(out);
+        return 0;
+    }
+
     for (addr1 = 0; addr1 < 4096; addr1++) {
                           /*       io    lu     mv    zp   zn    zf    tr */
         fprintf(out, "/* %03x */ { 0x%x, 0x%x, 0x%x, 0x%x, 0x%x, 0x%x, 0x%x, "
@@ -244,7 +260,8 @@ loop:
                          ros_2050[addr1].ad, ros_2050[addr1].ab, ros_2050[addr1].bb,
                          ros_2050[addr1].ux, ros_2050[addr1].ss, ros_2050[addr1].extra,
                          ros_2050[addr1].row1, ros_2050[addr1].row2, ros_2050[addr1].row3,
-                         ros_2050[addr1].row4, ros_2050[addr1].note);
+                         ros_2050[addr1].row4,
+                         (ros_2050[addr1].note == NULL) ? "" : ros_2050[addr1].note);
     }
     return 0;
 }
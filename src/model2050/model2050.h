@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "conf.h"
+#include "machine.h"
 
 #ifndef _MODEL50_H_
 #define _MODEL50_H_
@@ -65,9 +66,31 @@ extern struct ROS_2050 {
     uint32_t row2;
     uint32_t row3;
     uint32_t row4;
-    char     note[20];
+    const char *note;
 } ros_2050[4096];
 
+/* Fields of ROS word saved in a binary ROS image */
+#define ROS_2050_FIELDS \
+    ROSIMG_FIELD(struct ROS_2050, io), ROSIMG_FIELD(struct ROS_2050, lu), \
+    ROSIMG_FIELD(struct ROS_2050, mv), ROSIMG_FIELD(struct ROS_2050, zp), \
+    ROSIMG_FIELD(struct ROS_2050, zn), ROSIMG_FIELD(struct ROS_2050, zf), \
+    ROSIMG_FIELD(struct ROS_2050, tr), ROSIMG_FIELD(struct ROS_2050, zr), \
+    ROSIMG_FIELD(struct ROS_2050, ws), ROSIMG_FIELD(struct ROS_2050, sf), \
+    ROSIMG_FIELD(struct ROS_2050, iv), ROSIMG_FIELD(struct ROS_2050, al), \
+    ROSIMG_FIELD(struct ROS_2050, wm), ROSIMG_FIELD(struct ROS_2050, up), \
+    ROSIMG_FIELD(struct ROS_2050, md), ROSIMG_FIELD(struct ROS_2050, lb), \
+    ROSIMG_FIELD(struct ROS_2050, mb), ROSIMG_FIELD(struct ROS_2050, dg), \
+    ROSIMG_FIELD(struct ROS_2050, ul), ROSIMG_FIELD(struct ROS_2050, ur), \
+    ROSIMG_FIELD(struct ROS_2050, ce), ROSIMG_FIELD(struct ROS_2050, lx), \
+    ROSIMG_FIELD(struct ROS_2050, tc), ROSIMG_FIELD(struct ROS_2050, ry), \
+    ROSIMG_FIELD(struct ROS_2050, ad), ROSIMG_FIELD(struct ROS_2050, ab), \
+    ROSIMG_FIELD(struct ROS_2050, bb), ROSIMG_FIELD(struct ROS_2050, ux), \
+    ROSIMG_FIELD(struct ROS_2050, ss), ROSIMG_FIELD(struct ROS_2050, extra), \
+    ROSIMG_FIELD(struct ROS_2050, row1), \
+    ROSIMG_FIELD(struct ROS_2050, row2), \
+    ROSIMG_FIELD(struct ROS_2050, row3), \
+    ROSIMG_FIELD(struct ROS_2050, row4), ROSIMG_STR(struct ROS_2050, note)
+
 #define R1  8                    /* Start of read cycle */
 #define R2  4                    /* Data ready during this cycle */
 #define R3  2                    /* Data can be modified in SDR */
@@ -94,7 +117,7 @@ extern struct ROS_2050 {
  */
 
 
-extern struct CPU_2050 {
+extern MACHINE_LOCAL struct CPU_2050 {
 int         count;
 uint32_t    LS[64];             /* Local storage */
 uint32_t    BUMP[4096];         /* Bump storage */
@@ -267,9 +290,13 @@ uint16_t    t_request;            /* Request from console */
 uint16_t    match;                /* Address matched switches */
 } cpu_2050;
 
+extern MACHINE_LOCAL struct _profile *prof_2050;     /* Microcode profile, if enabled */
+extern MACHINE_LOCAL struct _sample *samp_2050;    /* Address sampler, if enabled */
+
 void  cycle_2050();
 void  step_2050();
 struct _device *model2050_init(void *render, uint16_t addr);
 int             model2050_create(struct _option *opt);
+int             model2050_load_ros(const char *name);
 
 #endif
@@ -23,8 +23,49 @@
  *
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "logger.h"
 #include "model2050.h"
+#include "rosimg.h"
 
+/* The tests run from the C tables, the simulator loads an image */
+#ifdef ROS_TABLES
 struct ROS_2050 ros_2050[4096] = {
 #include "model2050_ros.h"
 };
+#else
+struct ROS_2050 ros_2050[4096];
+#endif
+
+static char *ros_strings;      /* Notes of loaded image */
+
+/*
+ * Load ROS from binary image name, NULL gives the default image.
+ */
+int
+model2050_load_ros(const char *name)
+{
+    static const struct rosimg_field fields[] = { ROS_2050_FIELDS };
+    char  *strings = NULL;
+    int    r;
+
+    if (name == NULL) {
+#ifdef ROS_TABLES
+        return 1;
+#else
+        name = ROS_PATH "/model2050.ros";
+#endif
+    }
+    r = rosimg_load(name, 2050, ros_2050, sizeof(struct ROS_2050), 4096, fields,
+                    sizeof(fields) / sizeof(fields[0]), &strings);
+    if (r != ROSIMG_OK) {
+        fprintf(stderr, "%s: %s\n", name, rosimg_error(r));
+        return 0;
+    }
+    free(ros_strings);
+    ros_strings = strings;
+    log_info("Model 50 ROS loaded from %s\n", name);
+    return 1;
+}
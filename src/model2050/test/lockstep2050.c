@@ -0,0 +1,170 @@
+/*
+ * microsim360 - Model 2050 interface for lockstep runner.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "device.h"
+#include "logger.h"
+#include "cpu.h"
+#include "conf.h"
+#include "model2050.h"
+#include "lockstep.h"
+
+#define MAX_CYCLES     100000     /* Longest instruction allowed */
+
+void
+setup_fp2050(void *rend)
+{
+}
+
+static int    need_reset;         /* CPU must be reset before next case */
+
+/* Reset CPU, like init_cpu() */
+static void
+reset_2050()
+{
+    int    max = 0;
+
+    SYS_RST = 1;
+    CHK_SW = 2;
+    RATE_SW = 1;
+    PROC_SW = 1;
+    do {
+        cycle_2050();
+    } while (cpu_2050.ROAR != 0x150 && ++max < MAX_CYCLES);
+    need_reset = 0;
+}
+
+static void
+init_2050()
+{
+    load_line("2050F");
+    RATE_SW = 1;
+    reset_2050();
+}
+
+/* Load registers and storage, each step restarts the CPU so a reset
+   is only needed if the last case hung */
+static void
+load_2050(struct lockstep_state *st, uint8_t *mem, int len)
+{
+    int    i;
+
+    if (need_reset)
+        reset_2050();
+    for (i = 0; (i + 3) < len && i <= (int)mem_max; i += 4) {
+        M[i >> 2] = ((uint32_t)mem[i] << 24) | ((uint32_t)mem[i+1] << 16) |
+                    ((uint32_t)mem[i+2] << 8) | (uint32_t)mem[i+3];
+    }
+    for (i = 0; i < 16; i++) {
+        cpu_2050.LS[0x30 + i] = st->gpr[i];
+    }
+    for (i = 0; i < 4; i++) {
+        cpu_2050.LS[0x20 + (i << 1)] = (uint32_t)(st->fpr[i] >> 32);
+        cpu_2050.LS[0x21 + (i << 1)] = (uint32_t)(st->fpr[i] & 0xffffffff);
+    }
+    /* Key 0, EBCDIC, supervisor state, all interrupts masked */
+    cpu_2050.LS[0x17] = 0;
+    cpu_2050.MASK = 0;
+    cpu_2050.AMWP = 0;
+    cpu_2050.KEY = 0;
+    cpu_2050.CC = st->cc;
+    cpu_2050.PMASK = st->pm & 0xf;
+}
+
+/* Run one instruction, like test_inst() */
+static void
+step_inst_2050(struct lockstep_state *st)
+{
+    int      max = 0;
+    int      started = 0;
+    int      i;
+
+    cpu_2050.IA_REG = st->ia;
+    cpu_2050.ROAR = 0x190;
+    cpu_2050.REFETCH = 1;
+    cpu_2050.mem_state = 0;
+    /* Without START the CPU stops after the first instruction */
+    START = 1;
+    st->trap = 0;
+    do {
+        cycle_2050();
+        LS_COVER(cpu_2050.ROAR);
+        if ((cpu_2050.ROAR & 0xffc) == 0x148)
+           break;
+        /* Branches and interrupts don't pass 0x148, so also stop when
+           the next instruction starts, same places itrace uses */
+        if (cpu_2050.ROAR == 0x187 || cpu_2050.ROAR == 0x188 ||
+            cpu_2050.ROAR == 0x19B) {
+           if (started)
+               break;
+           started = 1;
+        }
+        if (cpu_2050.ROAR == 0x10e)
+           st->trap = 1;
+    } while (++max < MAX_CYCLES);
+    st->hung = (max >= MAX_CYCLES);
+    need_reset |= st->hung;
+
+    for (i = 0; i < 16; i++) {
+        st->gpr[i] = cpu_2050.LS[0x30 + i];
+    }
+    for (i = 0; i < 4; i++) {
+        st->fpr[i] = ((uint64_t)cpu_2050.LS[0x20 + (i << 1)] << 32) |
+                     (uint64_t)cpu_2050.LS[0x21 + (i << 1)];
+    }
+    st->cc = cpu_2050.CC;
+    st->pm = cpu_2050.PMASK;
+    st->ia = cpu_2050.IA_REG;
+}
+
+static void
+save_mem_2050(uint8_t *mem, int len)
+{
+    int       i;
+    uint32_t  w;
+
+    for (i = 0; (i + 3) < len && i <= (int)mem_max; i += 4) {
+        w = M[i >> 2];
+        mem[i] = (w >> 24) & 0xff;
+        mem[i+1] = (w >> 16) & 0xff;
+        mem[i+2] = (w >> 8) & 0xff;
+        mem[i+3] = w & 0xff;
+    }
+}
+
+static const char *
+note_2050(int addr)
+{
+    const char *n = ros_2050[addr & (LS_ROS_SIZE - 1)].note;
+
+    return (n[0] == '\0' || n[0] == ' ') ? NULL : n;
+}
+
+struct lockstep_model lockstep_2050 = {
+    "2050", &init_2050, &load_2050, &step_inst_2050, &save_mem_2050, &note_2050
+};
@@ -34,6 +34,7 @@
 #include "conf.h"
 #include "model2050.h"
 #include "xlat.h"
+#include "bench.h"
 #include "model_test.h"
 #include "test_device.h"
 
@@ -60,7 +61,11 @@ setup_fp2050(void *rend)
 #define DTEST(a, b)   CTEST(a, b)
 #define MTEST(a, b)   CTEST(a, b)
 
-uint64_t         step_count;         /** Current step number */
+MACHINE_LOCAL uint64_t         step_count;         /** Current step number */
+uint64_t         bench_cycles;       /** Cycles of instructions run */
+uint64_t         bench_insts;        /** Instructions run */
+uint64_t         bench_ns;           /** Host time running them */
+uint64_t         bench_overrun;      /** Runs that hit the cycle limit */
 int              testcycles = 100;   /** Number of test cycles for random tests */
 int              trap_flag;          /** Indicates if CPU traped */
 
@@ -306,6 +311,7 @@ void
 test_inst(int mask)
 {
     int      max = 0;
+    uint64_t start;
     cpu_2050.IA_REG = 0x400;
     cpu_2050.PMASK = (mask & 0xf);
     trap_flag = 0;
@@ -313,6 +319,7 @@ test_inst(int mask)
     cpu_2050.REFETCH = 1;
     cpu_2050.mem_state = 0;
         log_trace("Start inst\n");
+    start = bench_now();
     do {
         cycle_2050();
         step_count++;
@@ -327,6 +334,14 @@ test_inst(int mask)
     } while (max < 1000);
     if (max > 900)
         log_trace("overrun\n");
+    /* A run that hits the limit did not end on an instruction */
+    if (max >= 1000) {
+        bench_overrun++;
+        return;
+    }
+    bench_ns += bench_now() - start;
+    bench_cycles += max;
+    bench_insts++;
 
 }
 
@@ -340,6 +355,7 @@ test_inst2()
 {
     int      max = 0;
     int      count = 0;
+    uint64_t start;
 
     cpu_2050.IA_REG = 0x400;
     START = 1;
@@ -347,6 +363,7 @@ test_inst2()
     cpu_2050.REFETCH = 1;
     cpu_2050.mem_state = 0;
     trap_flag = 0;
+    start = bench_now();
     do {
         cycle_2050();
         step_count++;
@@ -361,6 +378,13 @@ test_inst2()
         if (cpu_2050.ROAR == 0x10e)
            trap_flag = 1;
     } while (max < 1000);
+    if (max >= 1000) {
+        bench_overrun++;
+        return;
+    }
+    bench_ns += bench_now() - start;
+    bench_cycles += max;
+    bench_insts += (count != 0) ? count : 1;
 }
 
 /** Run CPU and channels until 00 instruction.
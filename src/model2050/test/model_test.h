@@ -45,7 +45,7 @@
 
 #define set_cc(n)     cpu_2050.CC = n
 
-extern uint64_t         step_count;
+extern MACHINE_LOCAL uint64_t         step_count;
 extern int              testcycles;
 extern int              verbose;
 
@@ -23,11 +23,16 @@
  *
  */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "logger.h"
 #include "device.h"
+#include "cpu.h"
 #include "model2065.h"
+#include "checkpoint.h"
+
+DEV_LIST_STRUCT(2065, CPU_TYPE, CHAR_OPT|NUM_MOD);
 
 #define STAA  BIT0
 #define STAB  BIT1
@@ -209,19 +214,22 @@ char *sg_feild[] = { "", "SCANOUT-RTWD", "", "", "SCANOUT-LTWD", "", "", "",
                      "]7>ADR-SQCR", "]MACH-RESET", "0>SCAN-MODE", "SCAN-IN",
                      "]23>ADR-SQCR" };
 
-struct CPU_2065 cpu_2065;
+MACHINE_LOCAL struct CPU_2065 cpu_2065;
 
 void
 cycle_2065()
 {
-    struct ROS_2065 *sal;
+    struct ROS_2065_PACK *sal;
     uint16_t    next_roar;
     int         a_bit;
     int         b_bit;
     uint64_t    carry_in;
-    uint64_t    carries;
 
-    sal = &ros_2065[cpu_2065.ROAR];
+    /* Hold clock at ROS breakpoint */
+    if (debug_ros_check(cpu_2065.ROAR))
+        return;
+
+    sal = &ros_pack_2065[cpu_2065.ROAR];
     next_roar = sal->NX;
 
     a_bit = b_bit = 0;
@@ -1250,7 +1258,7 @@ cycle_2065()
                break;
     }
 
-    cpu_2065.padder = (cpu_2065.paa + cpu_2065.pab);
+    cpu_2065.padder = (cpu_2065.paa + cpu_2065.pab + carry_in);
     cpu_2065.pcarries = (cpu_2065.paa & cpu_2065.pab) |
                   ((cpu_2065.paa ^ cpu_2065.pab) & ~cpu_2065.padder);
 
@@ -1571,6 +1579,9 @@ cycle_2065()
             break;
     };
 
+    /* J and K branch conditions set ROSAR 11 and 10 */
+    cpu_2065.ROAR = next_roar | (b_bit << 1) | a_bit;
+
 #if 0
     /* Scan mode */
 
@@ -1608,4 +1619,73 @@ cycle_2065()
 #endif
 }
 
+/*
+ * The 65 runs a 200ns cycle, step_cpu is called once per microsecond.
+ */
+static void
+step_2065()
+{
+    cycle_2065();
+    cycle_2065();
+    cycle_2065();
+    cycle_2065();
+    cycle_2065();
+}
+
+/* Load unit is dialed on switches A, B and C */
+static void
+load_unit_2065(uint16_t addr)
+{
+    A_SW = (addr >> 8) & 0xf;
+    B_SW = (addr >> 4) & 0xf;
+    C_SW = addr & 0xf;
+}
 
+/* Create a 2065 cpu system. */
+int
+model2065_create(struct _option *opt)
+{
+    extern  void *setup_fp2065(char *title);
+    int     msize;
+    int     ros = 0;
+    struct _option   opts;
+
+    if (title != NULL) {
+        fprintf(stderr, "CPU already defined, can't support more then one\n");
+        return 0;
+    }
+    /* Build only for now, the microcode does not reach storage */
+    fprintf(stderr, "Model 65 is not usable yet, instructions do not execute\n");
+    title = "IBM360/65";
+    setup_cpu = &setup_fp2065;
+    step_cpu = &step_2065;
+    set_load_unit = &load_unit_2065;
+
+    while (get_option(&opts)) {
+         if (strcmp(opts.opt, "ROS") == 0 && opts.flags == 1) {
+             if (!model2065_load_ros(opts.string))
+                 return 0;
+             ros = 1;
+         } else {
+             fprintf(stderr, "Invalid option %s\n", opts.opt);
+             return 0;
+         }
+    }
+    if (!ros && !model2065_load_ros(NULL))
+        return 0;
+
+    /* Main storage is held in the CPU, channels see it through M */
+    if (opt->model != '\0') {
+        msize = 2048 << (opt->model - 'A');
+        if (msize < (64 * 1024) || msize > (int)sizeof(cpu_2065.M)) {
+            return 0;
+        }
+    } else {
+        msize = 64 * 1024;
+    }
+    M = &cpu_2065.M[0];
+    mem_max = msize - 1;
+    /* Storage is in the CPU, so this gets both */
+    checkpoint_area("cpu_2065", &cpu_2065, sizeof(cpu_2065));
+    return 1;
+}
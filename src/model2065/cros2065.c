@@ -35,8 +35,11 @@
 #endif
 
 #include "model2065.h"
+#include "rosimg.h"
 
 struct ROS_2065 ros_2065[4096];
+static char     notes[4096][20];
+static char     ecs[4096][20];
 
 int
 main(int argc, char *argv[])
@@ -63,7 +66,7 @@ main(int argc, char *argv[])
            perror("");
            exit(1);
        }
-       if ((out = fopen(argv[2], "w")) == NULL) {
+       if ((out = fopen(argv[2], "wb")) == NULL) {
            fprintf(stderr, "Unable to create: %s, ", argv[2]);
            perror("");
            exit(1);
@@ -145,7 +148,8 @@ loop:
         ros_2065[addr1].MODE = io;
         p += 5;
         while (*p == ' ') p++;
-        strcpy(&ros_2065[addr1].note[0], &note[0]);
+        strcpy(&notes[addr1][0], &note[0]);
+        ros_2065[addr1].note = notes[addr1];
         /* Grab rest of line */
         j = b = 0;
         parity = 1;
@@ -180,7 +184,8 @@ loop:
         /* Grab EC */
         while ((*p != ' ' && *p != '\n')) *q++ = *p++;
         *q++ = '\0';
-        strcpy(&ros_2065[addr1].ec[0], &ec[0]);
+        strcpy(&ecs[addr1][0], &ec[0]);
+        ros_2065[addr1].ec = ecs[addr1];
 
         ros_2065[addr1].A = (bits[0] >> 10) & 0xf;
         ros_2065[addr1].B = (bits[0] >> 8) & 0x3;
@@ -208,6 +213,19 @@ loop:
         ros_2065[addr1].row3 = bits[2];
         ros_2065[addr1].row4 = bits[3];
     }
+    /* Write binary image if output is a .ros file */
+    if (argc > 2 && rosimg_name(argv[2])) {
+        static const struct rosimg_field fields[] = { ROS_2065_FIELDS };
+
+        if (!rosimg_write(out, 2065, ros_2065, sizeof(struct ROS_2065), 4096, fields,
+                          sizeof(fields) / sizeof(fields[0]))) {
+            fprintf(stderr, "Unable to write: %s\n", argv[2]);
+            exit(1);
+        }
+        fclose(out);
+        return 0;
+    }
+
     for (addr1 = 0; addr1 < 4096; addr1++) {
                           /*       MODE    A     B     C     D     E */
         fprintf(out, "/* %03x */ { 0x%x, 0x%x, 0x%x, 0x%x, 0x%x, 0x%x, "
@@ -226,7 +244,8 @@ loop:
                          ros_2065[addr1].U, ros_2065[addr1].V, ros_2065[addr1].W,
                          ros_2065[addr1].NX, ros_2065[addr1].row1, ros_2065[addr1].row2,
                          ros_2065[addr1].row3, ros_2065[addr1].row4,
-                         ros_2065[addr1].note, ros_2065[addr1].ec);
+                         (ros_2065[addr1].note == NULL) ? "" : ros_2065[addr1].note,
+                         (ros_2065[addr1].ec == NULL) ? "" : ros_2065[addr1].ec);
     }
     return 0;
 }
@@ -25,42 +25,44 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include "conf.h"
+#include "machine.h"
 
 #ifndef _MODEL65_H_
 #define _MODEL65_H_
 
-extern int SYS_RST;
-extern int ROAR_RST;
-extern int START;
-extern int SET_IC;
-extern int CHECK_RST;
-extern int STOP;
-extern int INT_TMR;
-extern int STORE;
-extern int DISPLAY;
-extern int LAMP_TEST;
-extern int POWER;
-extern int INTR;
-extern int LOAD;
-extern int timer_event;
-
-extern uint8_t  A_SW;
-extern uint8_t  B_SW;
-extern uint8_t  C_SW;
-extern uint8_t  D_SW;
-extern uint8_t  E_SW;
-extern uint8_t  F_SW;
-extern uint8_t  G_SW;
-extern uint8_t  H_SW;
-extern uint8_t  J_SW;
-
-extern uint8_t  PROC_SW;
-extern uint8_t  RATE_SW;
-extern uint8_t  CHK_SW;
-extern uint8_t  MATCH_SW;
+extern MACHINE_LOCAL int SYS_RST;
+extern MACHINE_LOCAL int ROAR_RST;
+extern MACHINE_LOCAL int START;
+extern MACHINE_LOCAL int SET_IC;
+extern MACHINE_LOCAL int CHECK_RST;
+extern MACHINE_LOCAL int STOP;
+extern MACHINE_LOCAL int INT_TMR;
+extern MACHINE_LOCAL int STORE;
+extern MACHINE_LOCAL int DISPLAY;
+extern MACHINE_LOCAL int LAMP_TEST;
+extern MACHINE_LOCAL int POWER;
+extern MACHINE_LOCAL int INTR;
+extern MACHINE_LOCAL int LOAD;
+extern MACHINE_LOCAL int timer_event;
+
+extern MACHINE_LOCAL uint8_t  A_SW;
+extern MACHINE_LOCAL uint8_t  B_SW;
+extern MACHINE_LOCAL uint8_t  C_SW;
+extern MACHINE_LOCAL uint8_t  D_SW;
+extern MACHINE_LOCAL uint8_t  E_SW;
+extern MACHINE_LOCAL uint8_t  F_SW;
+extern MACHINE_LOCAL uint8_t  G_SW;
+extern MACHINE_LOCAL uint8_t  H_SW;
+extern MACHINE_LOCAL uint8_t  J_SW;
+
+extern MACHINE_LOCAL uint8_t  PROC_SW;
+extern MACHINE_LOCAL uint8_t  RATE_SW;
+extern MACHINE_LOCAL uint8_t  CHK_SW;
+extern MACHINE_LOCAL uint8_t  MATCH_SW;
 
 extern uint16_t const odd_parity[256];
-extern uint8_t     load_mode;
+extern MACHINE_LOCAL uint8_t     load_mode;
 extern struct ROS_2065 {
     int      MODE;
     int      A;          /* Bits 06-09 Ingate to A,B,IC */
@@ -94,10 +96,29 @@ extern struct ROS_2065 {
     uint32_t row2;
     uint32_t row3;
     uint32_t row4;
-    char    note[20];
-    char    ec[20];
+    const char *note;
+    const char *ec;
 } ros_2065[4096];
 
+/* Fields of ROS word saved in a binary ROS image */
+#define ROS_2065_FIELDS \
+    ROSIMG_FIELD(struct ROS_2065, MODE), ROSIMG_FIELD(struct ROS_2065, A), \
+    ROSIMG_FIELD(struct ROS_2065, B), ROSIMG_FIELD(struct ROS_2065, C), \
+    ROSIMG_FIELD(struct ROS_2065, D), ROSIMG_FIELD(struct ROS_2065, E), \
+    ROSIMG_FIELD(struct ROS_2065, F), ROSIMG_FIELD(struct ROS_2065, G), \
+    ROSIMG_FIELD(struct ROS_2065, H), ROSIMG_FIELD(struct ROS_2065, J), \
+    ROSIMG_FIELD(struct ROS_2065, K), ROSIMG_FIELD(struct ROS_2065, L), \
+    ROSIMG_FIELD(struct ROS_2065, M), ROSIMG_FIELD(struct ROS_2065, N), \
+    ROSIMG_FIELD(struct ROS_2065, P), ROSIMG_FIELD(struct ROS_2065, Q), \
+    ROSIMG_FIELD(struct ROS_2065, R), ROSIMG_FIELD(struct ROS_2065, T), \
+    ROSIMG_FIELD(struct ROS_2065, U), ROSIMG_FIELD(struct ROS_2065, V), \
+    ROSIMG_FIELD(struct ROS_2065, W), ROSIMG_FIELD(struct ROS_2065, NX), \
+    ROSIMG_FIELD(struct ROS_2065, row1), \
+    ROSIMG_FIELD(struct ROS_2065, row2), \
+    ROSIMG_FIELD(struct ROS_2065, row3), \
+    ROSIMG_FIELD(struct ROS_2065, row4), ROSIMG_STR(struct ROS_2065, note), \
+    ROSIMG_STR(struct ROS_2065, ec)
+
 #define STAA  BIT0
 #define STAB  BIT1
 #define STAC  BIT2
@@ -107,7 +128,7 @@ extern struct ROS_2065 {
 #define STAG  BIT6
 #define STAH  BIT7
 
-extern struct CPU_2065 {
+extern MACHINE_LOCAL struct CPU_2065 {
 int          count;
 uint32_t    M[64 * 1024];
 uint8_t     MP[1024];
@@ -169,10 +190,24 @@ extern uint16_t    store;
 extern uint16_t    allow_write;
 extern uint16_t    match;
 extern uint8_t     allow_man_operation;
-extern uint8_t     wait;
-extern uint8_t     test_mode;
+extern MACHINE_LOCAL uint8_t     wait;
+extern MACHINE_LOCAL uint8_t     test_mode;
 extern uint8_t     clock_start_lch;
 
+/* ROS word as used by the cycle loop, packed from ros_2065 */
+extern struct ROS_2065_PACK {
+    uint8_t  A, B, C, D, E, F, G, H, J, K, L, M, N, P, Q, R, T, U, V, W;
+    uint16_t NX;
+} ros_pack_2065[4096];
+
 void  cycle_2065();
 
+int   model2065_create(struct _option *opt);
+
+/* Build ros_pack_2065 from ros_2065 */
+void  model2065_pack_ros();
+
+/* Load ROS from binary image */
+int   model2065_load_ros(const char *name);
+
 #endif
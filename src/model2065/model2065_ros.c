@@ -23,8 +23,89 @@
  *
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "logger.h"
 #include "model2065.h"
+#include "rosimg.h"
 
+/* The tests run from the C tables, the simulator loads an image */
+#ifdef ROS_TABLES
 struct ROS_2065 ros_2065[4096] = {
 #include "model2065_ros.h"
 };
+#else
+struct ROS_2065 ros_2065[4096];
+#endif
+
+static char *ros_strings;      /* Notes and EC levels of loaded image */
+
+struct ROS_2065_PACK ros_pack_2065[4096];
+
+/* Copy the fields the cycle loop uses into the packed table, so that
+ * a ROS word is one cache line rather than three. */
+void
+model2065_pack_ros()
+{
+    struct ROS_2065      *ros;
+    struct ROS_2065_PACK *pk;
+    int                   i;
+
+    for (i = 0; i < 4096; i++) {
+        ros = &ros_2065[i];
+        pk = &ros_pack_2065[i];
+        pk->A = ros->A;
+        pk->B = ros->B;
+        pk->C = ros->C;
+        pk->D = ros->D;
+        pk->E = ros->E;
+        pk->F = ros->F;
+        pk->G = ros->G;
+        pk->H = ros->H;
+        pk->J = ros->J;
+        pk->K = ros->K;
+        pk->L = ros->L;
+        pk->M = ros->M;
+        pk->N = ros->N;
+        pk->P = ros->P;
+        pk->Q = ros->Q;
+        pk->R = ros->R;
+        pk->T = ros->T;
+        pk->U = ros->U;
+        pk->V = ros->V;
+        pk->W = ros->W;
+        pk->NX = ros->NX;
+    }
+}
+
+/*
+ * Load ROS from binary image name, NULL gives the default image.
+ */
+int
+model2065_load_ros(const char *name)
+{
+    static const struct rosimg_field fields[] = { ROS_2065_FIELDS };
+    char  *strings = NULL;
+    int    r;
+
+    if (name == NULL) {
+#ifdef ROS_TABLES
+        model2065_pack_ros();
+        return 1;
+#else
+        name = ROS_PATH "/model2065.ros";
+#endif
+    }
+    r = rosimg_load(name, 2065, ros_2065, sizeof(struct ROS_2065), 4096, fields,
+                    sizeof(fields) / sizeof(fields[0]), &strings);
+    if (r != ROSIMG_OK) {
+        fprintf(stderr, "%s: %s\n", name, rosimg_error(r));
+        return 0;
+    }
+    free(ros_strings);
+    ros_strings = strings;
+    model2065_pack_ros();
+    log_info("Model 65 ROS loaded from %s\n", name);
+    return 1;
+}
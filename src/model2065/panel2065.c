@@ -0,0 +1,150 @@
+/*
+ * microsim360 - Model 2065 front panel.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdio.h>
+
+#include "widgets.h"
+#include "cpu.h"
+#include "model2065.h"
+#include "area.h"
+#include "button.h"
+#include "label.h"
+#include "reg_row.h"
+#include "hex_dial.h"
+#include "dial.h"
+
+/*
+ * Operator section of the 65 console.  The maintenance rollers are not
+ * shown, only the controls needed to IPL and run the system.
+ */
+void *
+setup_fp2065(char *title)
+{
+    int      i;
+    int      s, p;
+    int      hx, wx;
+    int      pos_reg[3];
+    int      pos_roar[8];
+    dial_label label;
+    reg_row  reg;
+    Panel    cpu_panel;
+
+    /* Compute size of fonts */
+    if (TTF_SizeText(font10, "M", &wx, &hx) != 0) {
+        return NULL;
+    }
+
+    cpu_panel = create_window(title, 700, 400, 0);
+    if (cpu_panel == NULL) {
+        return NULL;
+    }
+
+    add_area(cpu_panel, 0, 0, 400, 700, &c_label);
+
+    /* Rate and check control knobs */
+    s = 20;
+    p = 40;
+    for (i = 0; i < 12; i++) {
+        label.upper[i] = NULL;
+        label.lower[i] = NULL;
+        label.value[i] = -1;
+    }
+    label.upper[0] = "PROCESS";
+    label.value[0] = 1;
+    label.upper[1] = "SINGLE";
+    label.lower[1] = "CYCLE";
+    label.value[1] = 2;
+    label.upper[11] = "INSN";
+    label.lower[11] = "STEP";
+    label.value[11] = 0;
+    add_dial(cpu_panel, s+60, p + (hx*3), 100, 100, 25, &label, &RATE_SW, 1, 0, font1, &c_black);
+    add_label(cpu_panel, s+60-(2*wx), p + (hx*6), "RATE", font10, &c_black);
+
+    for (i = 0; i < 12; i++) {
+        label.upper[i] = NULL;
+        label.lower[i] = NULL;
+        label.value[i] = -1;
+    }
+    label.upper[0] = "PROCESS";
+    label.value[0] = 1;
+    label.upper[1] = "DISABLE";
+    label.value[1] = 0;
+    label.upper[5] = "STOP";
+    label.value[5] = 2;
+    add_dial(cpu_panel, s+260, p + (hx*3), 100, 100, 25, &label, &CHK_SW, 1, 0, font1, &c_black);
+    add_label(cpu_panel, s+240-(2*wx), p + (hx*6), "CHECK CONTROL", font10, &c_black);
+
+    /* Load unit switches */
+    s = 440;
+    for (i = 0; i < 3; i++) {
+        pos_reg[i] = s + (i * 80);
+    }
+    add_hex_dial(cpu_panel, pos_reg[0], p, &A_SW);
+    add_hex_dial(cpu_panel, pos_reg[1], p, &B_SW);
+    add_hex_dial(cpu_panel, pos_reg[2], p, &C_SW);
+
+    /* ROS address register */
+    p = 180;
+    reg.upper = "8421|8421|8421";
+    reg.lower = NULL;
+    reg.c_on = &c_on;
+    reg.c_off = &c_off;
+    reg.start_bit[0] = 11;
+    reg.value[0] = &cpu_2065.ROAR;
+    add_area(cpu_panel, 20, p - 1, (hx * 2) + 6, 660, &c_black);
+    add_reg_row(cpu_panel, 40, p + hx, &reg, font10, pos_roar, &c_white);
+    add_label(cpu_panel, 40, p, "ROAR", font1, &c_white);
+
+    /* Operator buttons */
+    p = 250;
+    s = 20;
+    add_button(cpu_panel, s, p, hx * 2, wx * 10, "SYSTEM", "RESET",
+               &SYS_RST, font10, &c_white, &c_blue, 0);
+    add_button(cpu_panel, s, p + (hx * 3), hx * 2, wx * 10, "START", NULL,
+               &START, font10, &c_white, &c_blue, 0);
+    s += wx * 12;
+    add_button(cpu_panel, s, p, hx * 2, wx * 10, "SET IC", NULL,
+               &SET_IC, font10, &c_white, &c_blue, 0);
+    add_button(cpu_panel, s, p + (hx * 3), hx * 2, wx * 10, "STOP", NULL,
+               &STOP, font10, &c_white, &c_red, 0);
+    s += wx * 12;
+    add_button(cpu_panel, s, p, hx * 2, wx * 10, "STORE", NULL,
+               &STORE, font10, &c_white, &c_blue, 0);
+    add_button(cpu_panel, s, p + (hx * 3), hx * 2, wx * 10, "DISPLAY", NULL,
+               &DISPLAY, font10, &c_white, &c_blue, 0);
+
+    add_button(cpu_panel, pos_reg[0], p, hx * 2, wx * 10, "POWER", "ON",
+               &POWER, font10, &c_black, &c_white, 0);
+    add_button(cpu_panel, pos_reg[2], p, hx * 2, wx * 10, "POWER", "OFF",
+               &POWER, font10, &c_white, &c_red, 0);
+    add_button(cpu_panel, pos_reg[0], p + (hx * 3), hx * 2, wx * 10, "INTERRUPT", NULL,
+               &INTR, font1, &c_white, &c_red, 0);
+    add_button(cpu_panel, pos_reg[2], p + (hx * 3), hx * 2, wx * 10, "LOAD", NULL,
+               &LOAD, font10, &c_white, &c_blue, 0);
+
+    return (void *)cpu_panel;
+}
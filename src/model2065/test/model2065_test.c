@@ -28,10 +28,33 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "ctest.h"
-#include "xlat.h"
+#include "device.h"
 #include "logger.h"
+#include "ctest.h"
+#include "cpu.h"
+#include "conf.h"
 #include "model2065.h"
+#include "xlat.h"
+
+int       verbose = 0;
+
+char     *test_log_file = "debug.log";
+char     *test_log_level = "info warn error trace itrace micro reg mem mpxchn selchn device";
+
+
+void
+init_tests()
+{
+    load_line("2065");
+    RATE_SW = 1;
+}
+
+
+void *
+setup_fp2065(char *title)
+{
+    return NULL;
+}
 
 #define CC_REG cpu_2065.CC
 #define CC0    0x0
@@ -41,11 +64,10 @@
 
 #define FTEST(a, b)   CTEST(a, b)
 #define DTEST(a, b)   CTEST(a, b)
+#define MTEST(a, b)   CTEST(a, b)
 
 #define IAR  (cpu_2065.IC_REG)
 
-#define MASK cpu_2065.MASK
-
 #define PM            cpu_2065.PMASK
 
 #define set_ilc(n)    cpu_2065.ILC = n
@@ -63,17 +85,38 @@ set_amwp(int n) {
 
 void
 set_key(int n) {
-    cpu_2065.LS[0x17] = (MASK << 24) | (n << 20);
+    cpu_2065.LS[0x17] = (cpu_2065.MASK << 24) | (n << 20);
     cpu_2065.KEY = n;
 }
 
 #define get_key()     cpu_2065.KEY
 
 #define set_cc(n)     CC_REG = n
-uint64_t         step_count;
+MACHINE_LOCAL uint64_t         step_count;
 int              testcycles = 100;
 int              irq_mask = 0xff;
 
+/* Set MASK */
+void set_mask(uint8_t mask)
+{
+    cpu_2065.LS[0x17] &= 0x00ffffff;
+    cpu_2065.LS[0x17] |= (mask << 24);
+    cpu_2065.MASK = mask;
+}
+
+/* Get MASK */
+uint8_t get_mask()
+{
+    return cpu_2065.MASK;
+}
+
+/* Get program counter */
+uint32_t
+get_pc()
+{
+     return cpu_2065.IC_REG;
+}
+
 /* Read register */
 uint32_t
 get_reg(int num)
@@ -309,4 +352,17 @@ test_inst2()
     } while (max < 500);
 }
 
+/* No channels on the 65 yet, run as a plain instruction */
+void
+test_io_inst(int mask)
+{
+    test_inst(mask);
+}
+
+void
+test_io_inst2()
+{
+    test_inst(0);
+}
+
 #include "inst_test_cases.h"
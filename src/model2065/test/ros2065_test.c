@@ -0,0 +1,109 @@
+/*
+ * microsim360 - Model 2065 packed ROS test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ctest.h"
+#include "model2065.h"
+#include "rosimg.h"
+
+/* Find first word with the given branch fields */
+static int
+find_word(int j, int k)
+{
+    int     i;
+
+    for (i = 0; i < 4096; i++) {
+        if (ros_2065[i].J == j && ros_2065[i].K == k)
+            return i;
+    }
+    return -1;
+}
+
+CTEST(ros2065, pack) {
+    int     i;
+
+    for (i = 0; i < 4096; i++) {
+        ASSERT_EQUAL(ros_2065[i].A, ros_pack_2065[i].A);
+        ASSERT_EQUAL(ros_2065[i].E, ros_pack_2065[i].E);
+        ASSERT_EQUAL(ros_2065[i].H, ros_pack_2065[i].H);
+        ASSERT_EQUAL(ros_2065[i].J, ros_pack_2065[i].J);
+        ASSERT_EQUAL(ros_2065[i].K, ros_pack_2065[i].K);
+        ASSERT_EQUAL(ros_2065[i].U, ros_pack_2065[i].U);
+        ASSERT_EQUAL(ros_2065[i].W, ros_pack_2065[i].W);
+        ASSERT_EQUAL(ros_2065[i].NX, ros_pack_2065[i].NX);
+    }
+}
+
+/* Unconditional branch bits go to ROSAR 10 and 11 */
+CTEST(ros2065, sequence) {
+    int     addr;
+
+    addr = find_word(0, 0);
+    ASSERT_NOT_EQUAL(-1, addr);
+    cpu_2065.ROAR = addr;
+    cycle_2065();
+    ASSERT_EQUAL_X(ros_2065[addr].NX, cpu_2065.ROAR);
+
+    addr = find_word(1, 0);
+    ASSERT_NOT_EQUAL(-1, addr);
+    cpu_2065.ROAR = addr;
+    cycle_2065();
+    ASSERT_EQUAL_X(ros_2065[addr].NX | 1, cpu_2065.ROAR);
+
+    addr = find_word(0, 1);
+    ASSERT_NOT_EQUAL(-1, addr);
+    cpu_2065.ROAR = addr;
+    cycle_2065();
+    ASSERT_EQUAL_X(ros_2065[addr].NX | 2, cpu_2065.ROAR);
+}
+
+/* Loading an image replaces both tables */
+CTEST(ros2065, load) {
+    static const struct rosimg_field fields[] = { ROS_2065_FIELDS };
+    char    name[] = "ros2065_test.ros";
+    FILE   *f;
+    char    note[20];
+    int     addr;
+    int     nx;
+
+    f = fopen(name, "wb");
+    ASSERT_NOT_NULL(f);
+    ASSERT_TRUE(rosimg_write(f, 2065, ros_2065, sizeof(struct ROS_2065), 4096,
+                       fields, sizeof(fields) / sizeof(fields[0])));
+    fclose(f);
+    addr = find_word(0, 0);
+    nx = ros_2065[addr].NX;
+    strncpy(note, ros_2065[addr].note, sizeof(note) - 1);
+    note[sizeof(note) - 1] = '\0';
+    ros_2065[addr].NX = 0;
+    ASSERT_TRUE(model2065_load_ros(name));
+    ASSERT_EQUAL(nx, ros_2065[addr].NX);
+    ASSERT_STR(note, ros_2065[addr].note);
+    ASSERT_EQUAL(nx, ros_pack_2065[addr].NX);
+    remove(name);
+}
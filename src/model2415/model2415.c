@@ -31,6 +31,7 @@
 #include "device.h"
 #include "xlat.h"
 #include "tape.h"
+#include "checkpoint.h"
 #include "model2415.h"
 
 DEV_LIST_STRUCT(2415, CTRL_TYPE, CHAR_OPT|NUM_MOD);
@@ -641,14 +642,14 @@ device_cmd(struct _device *unit, uint8_t bus_out)
            }
            /* Do a write start */
            r = tape_write_start(ctx->tape[ctx->cur_unit]);
-           if (r == 1) {
+           if (r == TAPE_STATUS_OK) {
               ctx->sense[0] = SENSE_WCZERO;
               ctx->sense[1] |= SENSE_WRITE;
               add_event(unit, &tape_callback, START_DELAY,
                        (void *)ctx->tape[ctx->cur_unit], ctx->cur_unit);
               ctx->cmd_done = 0;
               ctx->data_rdy = 1;
-           } else if (r == 2) {
+           } else if (r == TAPE_STATUS_WRP) {
                ctx->sense[0] = SENSE_CMDREJ;
            } else {
                ctx->sense[0] = SENSE_INTERV;
@@ -879,7 +880,7 @@ void
 model2415_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *bus_in)
 {
     struct _2415_context *ctx = (struct _2415_context *)unit->dev;
-    static   uint16_t  last_tags = 0;
+    static MACHINE_LOCAL uint16_t last_tags = 0;
 
     if (last_tags != *tags || unit->selected) {
         print_tags("2415", ctx->state, *tags, bus_out);
@@ -939,7 +940,9 @@ model2415_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
                 log_device("2415: %03x port request\n",unit->addr);
                 if ((*tags & (CHAN_SUP_OUT|CHAN_ADR_OUT)) == 0) {
                     *tags |= CHAN_REQ_IN;
-                } else {
+                } else if ((*tags & CHAN_SEL_OUT) == 0) {
+                    /* Leave request in alone while polling, a device
+                       further down may be the one asking */
                     *tags &= ~CHAN_REQ_IN;
                 }
             }
@@ -981,7 +984,10 @@ model2415_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
                  if ((*tags & CHAN_SUP_OUT) == 0 && (unit->request || unit->stacked)) {
                      *tags &= ~(CHAN_SEL_OUT|CHAN_REQ_IN);
                      *tags |= CHAN_OPR_IN;      /* Put our address on bus */
-                     if ((ctx->rdy_flags & (1 << ctx->t_scan)) == 0) {
+                     /* Status for the current unit goes first, a unit
+                        that came ready only gets device end */
+                     if (ctx->status == 0 &&
+                         (ctx->rdy_flags & (1 << ctx->t_scan)) != 0) {
                          *bus_in = (unit->addr & 0xf8) | ctx->t_scan;
                          *bus_in |= odd_parity[*bus_in];
                          ctx->cur_unit = ctx->t_scan;
@@ -1014,7 +1020,8 @@ model2415_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
             unit->request = 0;
 
             log_device("2415: %03x waiting command %02x\n",unit->addr, ctx->status);
-            *bus_in = (unit->addr & 0xff) | odd_parity[unit->addr & 0xff];
+            *bus_in = (unit->addr & 0xf8) | ctx->cur_unit;
+            *bus_in |= odd_parity[*bus_in];
             /* we get command out, process command */
             if ((*tags & (CHAN_CMD_OUT)) != 0) {
                 *tags &= ~(CHAN_ADR_IN);        /* Command out, drop addressin */
@@ -1329,6 +1336,39 @@ model2415_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
     }
 }
 
+/*
+ * Return what device image shows, lamps and reel positions.
+ */
+uint64_t
+model2415_state(struct _device *unit, int u)
+{
+    struct _2415_context *ctx = (struct _2415_context *)unit->dev;
+    struct _tape_buffer  *tape = ctx->tape[u];
+    struct _tape_image   *supply;
+    struct _tape_image   *takeup;
+    uint64_t              state;
+    int                   j, k;
+
+    if (tape->file_name == NULL) {
+        return 0;
+    }
+    supply = tape_supply_image(tape, &j);
+    takeup = tape_takeup_image(tape, &k);
+    state = 1;
+    state |= (uint64_t)(tape_is_selected(tape) != 0) << 1;
+    state |= (uint64_t)(tape_ready(tape) != 0) << 2;
+    state |= (uint64_t)(tape_ring(tape) != 0) << 3;
+    state |= (uint64_t)(ctx->supply_color[u] & 3) << 4;
+    state |= (uint64_t)(ctx->takeup_color[u] & 3) << 6;
+    state |= (uint64_t)(ctx->supply_label[u] != 0) << 8;
+    state |= (uint64_t)(ctx->takeup_label[u] != 0) << 9;
+    state |= (uint64_t)(j & 0x3f) << 10;
+    state |= (uint64_t)(k & 0x3f) << 16;
+    state |= (uint64_t)(supply - tape_position) << 22;
+    state |= (uint64_t)(takeup - tape_position) << 42;
+    return state;
+}
+
 /*
  * Create a 2415 tape device.
  */
@@ -1356,6 +1396,7 @@ model2415_create(struct _option *opt)
          tape = (struct _2415_context *)dev2415->dev;
          tape->tape[i] = (struct _tape_buffer *)calloc(1, sizeof(struct _tape_buffer));
          tape->tape[i]->format = TRACK9;
+         checkpoint_area("2415 unit", tape->tape[i], sizeof(struct _tape_buffer));
          tape->supply_color[i] = 2;
          tape->supply_label[i] = 1;
          tape->takeup_color[i] = 1;
@@ -1383,6 +1424,7 @@ model2415_create(struct _option *opt)
                    den = 1;
                } else {
                    fprintf(stderr, "Invalid option %s to 2415 Unit\n", opts.opt);
+                   checkpoint_forget(tape->tape[i]);
                    free(tape->tape[i]);
                    tape->tape[i] = NULL;
                    return 0;
@@ -1410,6 +1452,7 @@ model2415_create(struct _option *opt)
          dev2415->bus_func = &model2415_dev;
          dev2415->dev = (void *)tape;
          dev2415->draw_model = (void *)&model2415_draw;
+         dev2415->draw_state = &model2415_state;
          dev2415->create_ctrl = (void *)&model2415_control;
          dev2415->init_device = (void *)&model2415_init;
          dev2415->type_name = "2415";
@@ -1435,6 +1478,7 @@ model2415_create(struct _option *opt)
          tape->state = STATE_IDLE;
          tape->selected = 0;
          tape->nunits = dev2415->n_units;
+         checkpoint_area("2415", tape, sizeof(struct _2415_context));
          /* Parse options given on definition */
          while (get_option(&opts)) {
                if (strcmp(opts.opt, "7TRACK") == 0) {
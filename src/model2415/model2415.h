@@ -131,5 +131,7 @@ void model2415_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint1
 
 void model2415_draw(struct _device *unit, void *rend, int u);
 
+uint64_t model2415_state(struct _device *unit, int u);
+
 void model2415_init(struct _device *unit, void *rend);
 #endif
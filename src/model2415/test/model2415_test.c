@@ -40,7 +40,7 @@
 #include "tape.h"
 #include "model2415.h"
 
-uint64_t   step_count = 0;
+MACHINE_LOCAL uint64_t   step_count = 0;
 int        verbose = 0;
 char       *test_log_file = "model2415_debug.log";
 char       *test_log_level = "info warn error trace device tape";
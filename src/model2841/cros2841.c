@@ -31,8 +31,10 @@
 #include <sys/types.h>
 #define CROS2841
 #include "model2841.h"
+#include "rosimg.h"
 
 struct ROS_2841 ros_2841[4096];
+static char     notes[4096][20];
 
 #if 0
  hex   address       number             ca   cb ck        cl   ch   pa ps cn     pn cd   cda cv cc  cs   pc aa bp
@@ -63,7 +65,7 @@ main(int argc, char *argv[])
            perror("");
            exit(1);
        }
-       if ((out = fopen(argv[2], "w")) == NULL) {
+       if ((out = fopen(argv[2], "wb")) == NULL) {
            fprintf(stderr, "Unable to create: %s, ", argv[2]);
            perror("");
            exit(1);
@@ -119,7 +121,8 @@ loop:
 
         /* Skip a blank */
         while (*p == ' ') p++;
-        q = ros_2841[addr1].NOTE;
+        q = notes[addr1];
+        ros_2841[addr1].NOTE = q;
         if (*p != '-') {
             /* Grab sheet and box */
             while ((*p != ' ' && *p != '\n')) *q++ = *p++;
@@ -224,6 +227,19 @@ loop:
         }
      }
 
+     /* Write binary image if output is a .ros file */
+     if (argc > 2 && rosimg_name(argv[2])) {
+         static const struct rosimg_field fields[] = { ROS_2841_FIELDS };
+
+         if (!rosimg_write(out, 2841, ros_2841, sizeof(struct ROS_2841), 4096, fields,
+                           sizeof(fields) / sizeof(fields[0]))) {
+             fprintf(stderr, "Unable to write: %s\n", argv[2]);
+             exit(1);
+         }
+         fclose(out);
+         return 0;
+     }
+
      fprintf(out, "/*  CA   CB  CK  CL  CH  PA  PS  CN  PN  CD  CV  CC  CS  PC  BP  NOTE */\n");
      for (addr1 = 0; addr1 < 4096; addr1++) {
          struct ROS_2841  *r = &ros_2841[addr1];
@@ -235,7 +251,7 @@ loop:
                        " \"%s\" },\n",
                        r->CA,  r->CB, r->CK, r->CL, r->CH, r->PA, r->PS,
                        r->CN,  r->PN, r->CD, r->CV, r->CC, r->CS, r->PC, r->BP,
-                       r->NOTE);
+                       (r->NOTE == NULL) ? "" : r->NOTE);
     }
     return 0;
 }
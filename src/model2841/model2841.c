@@ -34,6 +34,8 @@
 #include "device.h"
 #include "xlat.h"
 #include "model2841.h"
+#include "profile.h"
+#include "checkpoint.h"
 
 #define STATE_IDLE      0     /* Device in Idle state */
 #define STATE_SEL       1     /* Device now selected */
@@ -85,6 +87,26 @@ static char *cs_name[16] =
                      { "",      "0->ST0", "1->ST0", "0->ST1", "1->ST1", "0->ST2", "DNST21", "0->ST3",
                      "1->ST3", "0->ST4", "0->ST5", "1->ST5", "0->ST6", "1->ST6", "0->ST7", "1->ST7" };
 
+static MACHINE_LOCAL struct _profile *prof_2841;    /* Shared by all controllers */
+
+/* Note of ROS word for profile */
+static const char *
+note_2841(int addr)
+{
+    return ros_2841[addr].NOTE;
+}
+
+/*
+ * Return what device image shows, only if the drive exists.
+ */
+uint64_t
+model2311_state(struct _device *unit, int u)
+{
+     struct _2841_context *ctx = (struct _2841_context *)unit->dev;
+
+     return (uint64_t)(ctx->disk[u] != NULL);
+}
+
 void
 step_2841(void *data)
 {
@@ -140,6 +162,7 @@ step_2841(void *data)
    }
 
    sal = &ros_2841[ctx->WX];
+   PROFILE(prof_2841, ctx->WX, 0);
 
    /* Disassemble micro instruction */
    if (log_level & LOG_DMICRO) {
@@ -773,7 +796,7 @@ void
 model2841_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *bus_in)
 {
     struct _2841_context *ctx = (struct _2841_context *)unit->dev;
-    static   uint16_t last_tags = 0;
+    static MACHINE_LOCAL uint16_t last_tags = 0;
 
     if (last_tags != *tags) {
         print_tags("Disk", 0, *tags, bus_out);
@@ -955,13 +978,13 @@ model2841_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
          /* If TR1 & IG Bit 2 (Read), request service */
          /* If no request & BIT 1 (Write), request data */
          if (((ctx->IG_REG & BIT2) != 0 && ctx->tr_1) ||
-             ((ctx->IG_REG & BIT0) != 0 && ctx->srv_in == 0)) {
+             ((ctx->IG_REG & BIT0) != 0 && (ctx->srv_in == 0 || ctx->tr_1))) {
              ctx->svc_req = 1;
              log_trace("Raise svc request %d\n", ctx->svc_req);
          }
 
          /* If TR2 set, tell Channel we have data */
-         if (ctx->tr_2) {
+         if (ctx->tr_2 && ctx->srv_in == 0) {
              ctx->srv_in = 1;
              *tags |= CHAN_SRV_IN;
              *bus_in = ctx->DW_REG | odd_parity[ctx->DW_REG];
@@ -970,7 +993,8 @@ model2841_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *
 
          /* Clear service in when data taken */
          if ((ctx->tr_1 && (ctx->IG_REG & BIT2) == 0) || ctx->srv_in == 0 ||
-             ((ctx->IG_REG & BIT2) != 0 && (*tags & CHAN_SRV_OUT) != 0 && ctx->tr_2 == 0)) {
+             ((ctx->IG_REG & BIT2) != 0 && (*tags & CHAN_SRV_OUT) != 0 && ctx->tr_2 == 0) ||
+             ((ctx->IG_REG & BIT2) == 0 && (*tags & CHAN_CMD_OUT) != 0 && ctx->srv_in)) {
              ctx->srv_in = 0;
              *tags &= ~CHAN_SRV_IN;
              log_trace("Clear Service in\n");
@@ -1020,8 +1044,11 @@ model2841_init(void *rend, uint16_t addr)
      ctx->WX = 0;
      for (i = 0; i < 8; i++)
          ctx->disk[i] = NULL;
+     checkpoint_area("2841", ctx, sizeof(struct _2841_context));
      add_chan(dev2841, addr);
      add_disk(&step_2841, (void *)ctx);
+     if (prof_2841 == NULL)
+         prof_2841 = profile_create("2841", 1, &note_2841);
      return dev2841;
 }
 
@@ -1030,8 +1057,23 @@ model2841_create(struct _option *opt)
 {
      struct  _device *dev2841;
      struct  _2841_context *ctx;
+     struct _option   opts;
+     int              ros = 0;
      int              i;
 
+     while (get_option(&opts)) {
+         if (strcmp(opts.opt, "ROS") == 0 && opts.flags == 1) {
+             if (!model2841_load_ros(opts.string))
+                 return 0;
+             ros = 1;
+         } else {
+             fprintf(stderr, "Invalid option %s to 2841\n", opts.opt);
+             return 0;
+         }
+     }
+     if (!ros && !model2841_load_ros(NULL))
+         return 0;
+
      if ((dev2841 = (struct _device *)calloc(1, sizeof(struct _device))) == NULL)
          return 0;
 
@@ -1042,8 +1084,10 @@ model2841_create(struct _option *opt)
 
      dev2841->bus_func = &model2841_dev;
      dev2841->dev = (void *)ctx;
-     dev2841->draw_model = (void *)&model2311_draw;
-     dev2841->create_ctrl = (void *)&model2311_control;
+     dev2841->draw_model = &model2311_draw;
+     dev2841->draw_state = &model2311_state;
+     dev2841->create_ctrl = &model2311_control;
+     dev2841->init_device = &model2311_init_graphics;
      dev2841->type_name = "2841";
      dev2841->n_units = 8;
      ctx->addr = opt->addr & 0xff;;
@@ -1056,8 +1100,11 @@ model2841_create(struct _option *opt)
          dev2841->rect[i].w = 0;
          dev2841->rect[i].h = 0;
      }
+     checkpoint_area("2841", ctx, sizeof(struct _2841_context));
      add_chan(dev2841, opt->addr);
      add_disk(&step_2841, (void *)ctx);
+     if (prof_2841 == NULL)
+         prof_2841 = profile_create("2841", 1, &note_2841);
      return 1;
 }
 
@@ -1105,7 +1152,7 @@ model2311_create(struct _option *opt)
          } else if (strcmp(opts.opt, "VOLID") == 0) {
              vol = strdup(opts.string);
          } else {
-             fprintf(stderr, "Invalid option %s to 2415 Unit\n", opts.opt);
+             fprintf(stderr, "Invalid option %s to 2311 Unit\n", opts.opt);
              free(ctx->disk[i]);
              ctx->disk[i] = NULL;
              return 0;
@@ -1147,7 +1194,7 @@ model2302_create(struct _option *opt)
          return 0;
      }
      ctx->disk[i] = (struct _dasd_t *)calloc(1, sizeof(struct _dasd_t));
-     if (ctx->disk[i] != NULL) {
+     if (ctx->disk[i] == NULL) {
          fprintf(stderr, "Unable to create device %s %03x\n", opt->opt, opt->addr);
          return 0;
      }
@@ -43,9 +43,23 @@ extern struct ROS_2841 {
       int    CS;   /* Status */
       int    PC;   /* Parity of CD,CD Alternate, CV, CC, CS, BP */
       int    BP;   /* Bypass ALU */
-      char   NOTE[20];
+      const char *NOTE;
 } ros_2841[4096];
 
+/* Fields of ROS word saved in a binary ROS image */
+#define ROS_2841_FIELDS \
+    ROSIMG_FIELD(struct ROS_2841, CA), ROSIMG_FIELD(struct ROS_2841, CB), \
+    ROSIMG_FIELD(struct ROS_2841, CK), ROSIMG_FIELD(struct ROS_2841, CL), \
+    ROSIMG_FIELD(struct ROS_2841, CH), ROSIMG_FIELD(struct ROS_2841, PA), \
+    ROSIMG_FIELD(struct ROS_2841, PS), ROSIMG_FIELD(struct ROS_2841, CN), \
+    ROSIMG_FIELD(struct ROS_2841, PN), ROSIMG_FIELD(struct ROS_2841, CD), \
+    ROSIMG_FIELD(struct ROS_2841, CV), ROSIMG_FIELD(struct ROS_2841, CC), \
+    ROSIMG_FIELD(struct ROS_2841, CS), ROSIMG_FIELD(struct ROS_2841, PC), \
+    ROSIMG_FIELD(struct ROS_2841, BP), ROSIMG_STR(struct ROS_2841, NOTE)
+
+/* Load ROS from binary image, NULL gives the default image */
+int   model2841_load_ros(const char *name);
+
 
 
 #ifndef CROS2841
@@ -177,8 +191,10 @@ void    model2841_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, ui
 struct _device *model2841_init(void *render, uint16_t addr);
 
 /* Panel display functions */
-void   model2311_draw(struct _device *unit, void *rend);
-struct _popup *model2311_control(struct _device *unit, int hd, int wd, int u);
+void   model2311_draw(struct _device *unit, void *rend, int u);
+uint64_t model2311_state(struct _device *unit, int u);
+void   *model2311_control(struct _device *unit, int u, int x, int y);
+void    model2311_init_graphics(struct _device *unit, void *rend);
 
 
 int     model2841_create(struct _option *opt);
@@ -31,6 +31,8 @@
 #include "device.h"
 #include "xlat.h"
 #include "model2844.h"
+#include "profile.h"
+#include "checkpoint.h"
 
 DEV_LIST_STRUCT(2314, UNIT_TYPE, 0);
 DEV_LIST_STRUCT(2844, CTRL_TYPE, 0);
@@ -70,6 +72,26 @@ static char *cs_name[16] =
 
 
 
+/*
+ * Return what device image shows, only if the drive exists.
+ */
+uint64_t
+model2314_state(struct _device *unit, int u)
+{
+     struct _2844_context *ctx = (struct _2844_context *)unit->dev;
+
+     return (uint64_t)(ctx->disk[u] != NULL);
+}
+
+static MACHINE_LOCAL struct _profile *prof_2844;    /* Shared by all controllers */
+
+/* Note of ROS word for profile */
+static const char *
+note_2844(int addr)
+{
+    return ros_2844[addr].NOTE;
+}
+
 struct _device *
 model2844_init(uint16_t addr)
 {
@@ -89,6 +111,7 @@ model2844_init(uint16_t addr)
 
      dev2844->bus_func = &model2844_dev;
      dev2844->draw_model = &model2314_draw;
+     dev2844->draw_state = &model2314_state;
      dev2844->create_ctrl = &model2314_control;
      dev2844->init_device = &model2314_init_graphics;
      dev2844->dev = (void *)ctx;
@@ -105,8 +128,11 @@ model2844_init(uint16_t addr)
          dev2844->rect[i].w = 0;
          dev2844->rect[i].h = 0;
      }
+     checkpoint_area("2844", ctx, sizeof(struct _2844_context));
      add_chan(dev2844, addr);
      add_disk(&step_2844, (void *)ctx);
+     if (prof_2844 == NULL)
+         prof_2844 = profile_create("2844", 1, &note_2844);
      return dev2844;
 }
 
@@ -181,6 +207,7 @@ step_2844(void *data)
 
 
    sal = &ros_2844[nextWX];
+   PROFILE(prof_2844, nextWX, 0);
 
    /* Disassemble micro instruction */
    if (log_level & LOG_DMICRO) {
@@ -810,7 +837,7 @@ void
 model2844_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint16_t *bus_in)
 {
     struct _2844_context *ctx = (struct _2844_context *)unit->dev;
-    static   uint16_t last_tags = 0;
+    static MACHINE_LOCAL uint16_t last_tags = 0;
 
     if (last_tags != *tags) {
         print_tags("Disk", 0, *tags, bus_out);
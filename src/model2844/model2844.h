@@ -43,9 +43,23 @@ extern struct ROS_2844 {
       int    CS;   /* Status */
       int    PC;   /* Parity of CD,CD Alternate, CV, CC, CS, BP */
       int    BP;   /* Bypass ALU */
-      char   NOTE[20];
+      const char *NOTE;
 } ros_2844[4096];
 
+/* Fields of ROS word saved in a binary ROS image */
+#define ROS_2844_FIELDS \
+    ROSIMG_FIELD(struct ROS_2844, CA), ROSIMG_FIELD(struct ROS_2844, CB), \
+    ROSIMG_FIELD(struct ROS_2844, CK), ROSIMG_FIELD(struct ROS_2844, CL), \
+    ROSIMG_FIELD(struct ROS_2844, CH), ROSIMG_FIELD(struct ROS_2844, PA), \
+    ROSIMG_FIELD(struct ROS_2844, PS), ROSIMG_FIELD(struct ROS_2844, CN), \
+    ROSIMG_FIELD(struct ROS_2844, PN), ROSIMG_FIELD(struct ROS_2844, CD), \
+    ROSIMG_FIELD(struct ROS_2844, CV), ROSIMG_FIELD(struct ROS_2844, CC), \
+    ROSIMG_FIELD(struct ROS_2844, CS), ROSIMG_FIELD(struct ROS_2844, PC), \
+    ROSIMG_FIELD(struct ROS_2844, BP), ROSIMG_STR(struct ROS_2844, NOTE)
+
+/* Load ROS from binary image, NULL gives the default image */
+int   model2844_load_ros(const char *name);
+
 
 
 #ifndef CROS2844
@@ -206,6 +220,7 @@ void model2844_dev(struct _device *unit, uint16_t *tags, uint16_t bus_out, uint1
 
 /* Panel display functions */
 void   model2314_draw(struct _device *unit, void *rend, int u);
+uint64_t model2314_state(struct _device *unit, int u);
 void   *model2314_control(struct _device *unit, int u, int x, int y);
 void    model2314_init_graphics(struct _device *unit, void *rend);
 
@@ -23,9 +23,55 @@
  *
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "logger.h"
+#include "rosimg.h"
 #include "model2844.h"
 
+/* The tests run from the C tables, the simulator loads an image */
+#ifdef ROS_TABLES
 struct ROS_2844 ros_2844[4096] = {
 #include "model2844_ros.h"
 };
+#else
+struct ROS_2844 ros_2844[4096];
+#endif
+
+static char *ros_strings;      /* Notes of loaded image */
+static int   ros_loaded;       /* Shared by all controllers */
+
+/*
+ * Load ROS from binary image name, NULL gives the default image
+ * unless one is already loaded.
+ */
+int
+model2844_load_ros(const char *name)
+{
+    static const struct rosimg_field fields[] = { ROS_2844_FIELDS };
+    char  *strings = NULL;
+    int    r;
+
+    if (name == NULL) {
+#ifdef ROS_TABLES
+        return 1;
+#else
+        if (ros_loaded)
+            return 1;
+        name = ROS_PATH "/model2844.ros";
+#endif
+    }
+    r = rosimg_load(name, 2844, ros_2844, sizeof(struct ROS_2844), 4096, fields,
+                    sizeof(fields) / sizeof(fields[0]), &strings);
+    if (r != ROSIMG_OK) {
+        fprintf(stderr, "%s: %s\n", name, rosimg_error(r));
+        return 0;
+    }
+    free(ros_strings);
+    ros_strings = strings;
+    ros_loaded = 1;
+    log_info("2844 ROS loaded from %s\n", name);
+    return 1;
+}
 
@@ -105,6 +105,8 @@ int
 model2844_create(struct _option *opt)
 {
      struct  _device *dev2844;
+     struct _option   opts;
+     int              ros = 0;
 
      /* Check for valid address */
      if (opt->addr == 0) {
@@ -112,6 +114,19 @@ model2844_create(struct _option *opt)
          return 0;
      }
 
+     while (get_option(&opts)) {
+         if (strcmp(opts.opt, "ROS") == 0 && opts.flags == 1) {
+             if (!model2844_load_ros(opts.string))
+                 return 0;
+             ros = 1;
+         } else {
+             fprintf(stderr, "Invalid option %s to 2844\n", opts.opt);
+             return 0;
+         }
+     }
+     if (!ros && !model2844_load_ros(NULL))
+         return 0;
+
      dev2844 = model2844_init(opt->addr);
 
      return 1;
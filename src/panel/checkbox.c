@@ -73,6 +73,18 @@ display_checkbox(Widget wid, SDL_Renderer *render)
    }
 }
 
+static int
+changed_checkbox(Widget wid)
+{
+   struct _checkbox_t *box = (struct _checkbox_t *)wid->data;
+   uint64_t state = 0;
+
+   if (box->value != 0) {
+       state = (*box->value >> box->shft) & 1;
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_checkbox(Widget wid)
 {
@@ -138,6 +150,7 @@ add_checkbox(Panel win, int x, int y, int h, int w, char *label,
    }
 
    nwid->draw = display_checkbox;
+   nwid->changed = changed_checkbox;
    nwid->close = close_checkbox;
    nwid->click = click_checkbox;
    nwid->data = (void *)box;
@@ -58,6 +58,12 @@ display_hex_dial(Widget wid, SDL_Renderer *render)
 
 }
 
+static int
+changed_hex_dial(Widget wid)
+{
+   return widget_changed(wid, *((uint8_t *)wid->data));
+}
+
 static void
 click_hex_dial(Widget wid, int x, int y)
 {
@@ -87,6 +93,7 @@ add_hex_dial(Panel win, int x, int y, uint8_t *value)
    nwid->rect.h = 64;
    nwid->data = (void *)value;
    nwid->draw = display_hex_dial;
+   nwid->changed = changed_hex_dial;
    nwid->click = click_hex_dial;
    add_widget(win, nwid);
    return nwid;
@@ -24,6 +24,7 @@
  */
 
 #include "indicator.h"
+#include "snapshot.h"
 
 struct _indicator_t {
     SDL_Rect     recth;
@@ -69,6 +70,18 @@ display_indicator(Widget wid, SDL_Renderer *render)
 }
 
 
+static int
+changed_indicator(Widget wid)
+{
+   struct _indicator_t *ind = (struct _indicator_t *)wid->data;
+   uint64_t  state = 0;
+
+   if (ind->value != NULL) {
+       state = (*ind->value >> ind->shft) & 1;
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_indicator(Widget wid)
 {
@@ -110,7 +123,7 @@ add_indicator(Panel win, int x, int y, int h, int w, char *label1, char *label2,
    nwid->rect.y = y;
    nwid->rect.w = w;
    nwid->rect.h = h;
-   ind->value = value;
+   ind->value = (int *)snapshot_add(value, sizeof(int));
    ind->shft = shft;
    ind->color[1] = *col_on;
    ind->color[0] = *col_off;
@@ -155,6 +168,7 @@ add_indicator(Panel win, int x, int y, int h, int w, char *label1, char *label2,
    ind->recth.y += (h/2) - (hh/2);
 
    nwid->draw = display_indicator;
+   nwid->changed = changed_indicator;
    nwid->close = close_indicator;
    nwid->data = (void *)ind;
    add_widget(win, nwid);
@@ -0,0 +1,185 @@
+/*
+ * microsim360 - GUI Lamp intensity sampling.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "intensity.h"
+
+static SDL_atomic_t  front;           /* Buffer display is reading */
+static void         *lamp_list;       /* Registers being sampled */
+static int           countdown = INTENSITY_STRIDE;
+
+/*
+ * Register a lamp register, if already sampled return the existing one.
+ * Only called from the display thread, the CPU thread only walks the list.
+ */
+static Intensity
+intensity_add(void *value, int width)
+{
+    Intensity   lamp;
+
+    if (value == NULL) {
+        return NULL;
+    }
+    for (lamp = SDL_AtomicGetPtr(&lamp_list); lamp != NULL; lamp = lamp->next) {
+        if (lamp->value == value) {
+            return lamp;
+        }
+    }
+    if ((lamp = (Intensity)calloc(1, sizeof(intensity))) == NULL) {
+        return NULL;
+    }
+    lamp->value = value;
+    lamp->width = width;
+    lamp->next = SDL_AtomicGetPtr(&lamp_list);
+    /* Publish only once fully filled in */
+    SDL_AtomicSetPtr(&lamp_list, lamp);
+    return lamp;
+}
+
+Intensity
+intensity_add16(uint16_t *value)
+{
+    return intensity_add((void *)value, 16);
+}
+
+Intensity
+intensity_add32(uint32_t *value)
+{
+    return intensity_add((void *)value, 32);
+}
+
+int
+intensity_level(Intensity lamp, int bit)
+{
+    if (lamp == NULL) {
+        return 0;
+    }
+    return lamp->level[SDL_AtomicGet(&front)][bit];
+}
+
+uint32_t
+intensity_value(Intensity lamp)
+{
+    if (lamp == NULL) {
+        return 0;
+    }
+    return lamp->shown[SDL_AtomicGet(&front)];
+}
+
+/*
+ * Hash brightness of every bit, lamps only need redrawing when it differs.
+ */
+uint64_t
+intensity_state(Intensity lamp)
+{
+    uint64_t    hash = 0xcbf29ce484222325ULL;
+    uint8_t    *level;
+    int         i;
+
+    if (lamp == NULL) {
+        return 0;
+    }
+    level = lamp->level[SDL_AtomicGet(&front)];
+    for (i = 0; i < lamp->width; i++) {
+        hash = (hash ^ level[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/*
+ * Draw the off image, then the on image on top faded by brightness.
+ */
+void
+draw_intensity(SDL_Renderer *render, SDL_Texture *on, SDL_Rect *src_on,
+               SDL_Texture *off, SDL_Rect *src_off, SDL_Rect *dst, int level)
+{
+    if (level <= 0) {
+        SDL_RenderCopy(render, off, src_off, dst);
+        return;
+    }
+    if (level >= (INTENSITY_LEVELS - 1)) {
+        SDL_RenderCopy(render, on, src_on, dst);
+        return;
+    }
+    SDL_RenderCopy(render, off, src_off, dst);
+    SDL_SetTextureAlphaMod(on, (level * 255) / (INTENSITY_LEVELS - 1));
+    SDL_RenderCopy(render, on, src_on, dst);
+    SDL_SetTextureAlphaMod(on, 255);
+}
+
+/*
+ * Convert on counts to brightness in back buffer and show it.
+ */
+void
+intensity_publish()
+{
+    Intensity   list = SDL_AtomicGetPtr(&lamp_list);
+    Intensity   lamp;
+    int         back = SDL_AtomicGet(&front) ^ 1;
+    int         i;
+
+    for (lamp = list; lamp != NULL; lamp = lamp->next) {
+        lamp->shown[back] = lamp->last;
+        for (i = 0; i < lamp->width; i++) {
+            if (lamp->samples == 0) {
+                lamp->level[back][i] = ((lamp->last >> i) & 1) ?
+                                              INTENSITY_LEVELS - 1 : 0;
+            } else {
+                lamp->level[back][i] = ((lamp->on[i] * (INTENSITY_LEVELS - 1))
+                                          + (lamp->samples / 2)) / lamp->samples;
+            }
+            lamp->on[i] = 0;
+        }
+        lamp->samples = 0;
+    }
+    SDL_AtomicSet(&front, back);
+}
+
+/*
+ * Sample every register, counting the bits which are set.
+ */
+void
+intensity_sample()
+{
+    Intensity   lamp;
+    uint32_t    value;
+    uint32_t   *on;
+
+    if (--countdown > 0) {
+        return;
+    }
+    countdown = INTENSITY_STRIDE;
+    for (lamp = SDL_AtomicGetPtr(&lamp_list); lamp != NULL; lamp = lamp->next) {
+        if (lamp->width == 16) {
+            value = *((uint16_t *)lamp->value);
+        } else {
+            value = *((uint32_t *)lamp->value);
+        }
+        lamp->last = value;
+        lamp->samples++;
+        for (on = &lamp->on[0]; value != 0; on++, value >>= 1) {
+            *on += value & 1;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * microsim360 - GUI Lamp intensity sampling.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#ifndef _INTENSITY_H_
+#define _INTENSITY_H_
+#include "widgets.h"
+
+#define INTENSITY_LEVELS  16    /* Brightness steps a lamp can show */
+#define INTENSITY_STRIDE  8     /* Cycles between samples */
+
+/*
+ * On time of each bit of a register the panel displays. The CPU thread
+ * samples the register and counts how often each bit was set, once per
+ * frame it converts the counts into brightness in the back buffer and
+ * flips it to the front. The display only reads the front buffer.
+ */
+typedef struct _intensity {
+      struct _intensity *next;
+      void        *value;          /* Live register, CPU thread only */
+      int          width;          /* Bits in register, 16 or 32 */
+      uint32_t     last;           /* Value at last sample */
+      uint32_t     samples;        /* Samples taken this frame */
+      uint32_t     on[32];         /* Samples each bit was set */
+      uint32_t     shown[2];       /* Value at end of frame */
+      uint8_t      level[2][32];   /* Brightness of each bit */
+} intensity, *Intensity;
+
+/* Display side, find or create sampler for a register */
+Intensity intensity_add16(uint16_t *value);
+Intensity intensity_add32(uint32_t *value);
+
+/* Display side, brightness of bit 0 to INTENSITY_LEVELS-1 */
+int intensity_level(Intensity lamp, int bit);
+
+/* Display side, value of register at end of last frame */
+uint32_t intensity_value(Intensity lamp);
+
+/* Display side, summary of what lamps show for changed callbacks */
+uint64_t intensity_state(Intensity lamp);
+
+/* Display side, draw lamp blending on image over off image */
+void draw_intensity(SDL_Renderer *render, SDL_Texture *on, SDL_Rect *src_on,
+                    SDL_Texture *off, SDL_Rect *src_off, SDL_Rect *dst,
+                    int level);
+
+/* CPU side, called once per cycle */
+void intensity_sample();
+
+/* CPU side, end of frame, only when display is not drawing */
+void intensity_publish();
+
+#endif
@@ -24,6 +24,7 @@
  */
 
 #include "lamp.h"
+#include "snapshot.h"
 
 struct _lamp_t {
     SDL_Rect     rect_label;
@@ -59,6 +60,18 @@ display_lamp(Widget wid, SDL_Renderer *render)
    }
 }
 
+static int
+changed_lamp(Widget wid)
+{
+   struct _lamp_t *l = (struct _lamp_t *)wid->data;
+   uint64_t       state = (LAMP_TEST != 0);
+
+   if (l->value != 0 && *l->value != 0) {
+       state = 1;
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_lamp(Widget wid)
 {
@@ -92,7 +105,7 @@ add_lamp(Panel win, int x, int y, char *label1,
        return NULL;
    }
 
-   l->value = value;
+   l->value = (uint16_t *)snapshot_add(value, sizeof(uint16_t));
    l->color = color;
    l->lamp.x = x;
    l->lamp.y = y;
@@ -117,6 +130,7 @@ add_lamp(Panel win, int x, int y, char *label1,
    nwid->rect.h = 15;
 
    nwid->draw = display_lamp;
+   nwid->changed = changed_lamp;
    nwid->close = close_lamp;
    nwid->data = (void *)l;
    add_widget(win, nwid);
@@ -29,13 +29,14 @@
 #include "lamp.h"
 #include "area.h"
 #include "xlat.h"
+#include "intensity.h"
 
 struct _lamp_data_t {
     int          h[5];
     int          w[5];
     SDL_Texture *label[5];
     int          color;
-    uint32_t    *value;
+    Intensity    lamp;
     int          start;
     int          offsets[36];
 };
@@ -46,42 +47,49 @@ static void
 display_lamp_data(Widget wid, SDL_Renderer *render)
 {
    struct _lamp_data_t *row = (struct _lamp_data_t *)wid->data;
-   SDL_Rect   rect;
+   SDL_Rect   rect_on;
+   SDL_Rect   rect_off;
    SDL_Rect   rect_lamp;
    SDL_Rect   rect_label;
    int        i, j;
    int        parity;
-   uint32_t   bit;
+   int        level;
+   uint32_t   value;
 
    rect_lamp.x = wid->rect.x;
    rect_lamp.y = wid->rect.y;
    rect_lamp.w = 15;
    rect_lamp.h = 15;
-   rect.x = row->color * 15;
-   rect.w = 15;
-   rect.h = 15;
-   if (row->value == NULL) {
+   rect_off.x = row->color * 15;
+   rect_off.y = 0;
+   rect_off.w = 15;
+   rect_off.h = 15;
+   rect_on = rect_off;
+   rect_on.y = 15;
+   if (row->lamp == NULL) {
        return;
    }
 
+   /* Parity is shown for value at end of frame */
+   value = intensity_value(row->lamp);
    j = 0;
    for (i = 31; i >= 0; i--) {
        parity = 0;
        switch (i) {
        case 31:
-              bit = odd_parity[(*row->value >> 24) & 0xff] != 0;
+              level = odd_parity[(value >> 24) & 0xff] != 0;
               parity = 1;
               break;
        case 23:
-              bit = odd_parity[(*row->value >> 16) & 0xff] != 0;
+              level = odd_parity[(value >> 16) & 0xff] != 0;
               parity = 2;
               break;
        case 15:
-              bit = odd_parity[(*row->value >> 8) & 0xff] != 0;
+              level = odd_parity[(value >> 8) & 0xff] != 0;
               parity = 3;
               break;
        case 7:
-              bit = odd_parity[*row->value & 0xff] != 0;
+              level = odd_parity[value & 0xff] != 0;
               parity = 4;
               break;
        }
@@ -89,13 +97,15 @@ display_lamp_data(Widget wid, SDL_Renderer *render)
        if (parity != 0) {
            rect_lamp.x = row->offsets[j++];
            if (i <= row->start) {
-               bit |= LAMP_TEST;
+               if (LAMP_TEST || level) {
+                   level = INTENSITY_LEVELS - 1;
+               }
                rect_label.x = rect_lamp.x;
                rect_label.y = rect_lamp.y + 15;
                rect_label.h = 15;
                rect_label.w = 15;
-               rect.y = (int)(15 * bit);
-               SDL_RenderCopy(render, lamps, &rect, &rect_lamp);
+               draw_intensity(render, lamps, &rect_on, lamps, &rect_off,
+                              &rect_lamp, level);
                if (row->label[parity] != NULL) {
                    SDL_RenderCopy( render, row->label[parity], NULL, &rect_label);
                }
@@ -103,13 +113,28 @@ display_lamp_data(Widget wid, SDL_Renderer *render)
        }
        rect_lamp.x = row->offsets[j++];
        if (i <= row->start) {
-           bit = ((*row->value >> i) & 1) | LAMP_TEST;
-           rect.y = (int)(15 * bit);
-           SDL_RenderCopy(render, lamps, &rect, &rect_lamp);
+           level = INTENSITY_LEVELS - 1;
+           if (!LAMP_TEST) {
+               level = intensity_level(row->lamp, i);
+           }
+           draw_intensity(render, lamps, &rect_on, lamps, &rect_off,
+                          &rect_lamp, level);
        }
    }
 }
 
+static int
+changed_lamp_data(Widget wid)
+{
+   struct _lamp_data_t *row = (struct _lamp_data_t *)wid->data;
+
+   if (LAMP_TEST) {
+       return widget_changed(wid, ~((uint64_t)0));
+   }
+   return widget_changed(wid, intensity_state(row->lamp) ^
+                                 intensity_value(row->lamp));
+}
+
 static void
 close_lamp_data(Widget wid)
 {
@@ -159,7 +184,7 @@ add_lamp_data(Panel win, int x, int y, uint32_t *value, int start,
    }
 
    row_data->start = start;
-   row_data->value = value;
+   row_data->lamp = intensity_add32(value);
    row_data->color = color;
    for (i = 1; i < 5; i++) {
        surf = TTF_RenderText_Blended(font, labels[i], *lab_color);
@@ -284,6 +309,7 @@ add_lamp_data(Panel win, int x, int y, uint32_t *value, int start,
    nwid->rect.h = 20 + hh;
    nwid->data = (void *)row_data;
    nwid->draw = display_lamp_data;
+   nwid->changed = changed_lamp_data;
    nwid->close = close_lamp_data;
    add_widget(win, nwid);
    return nwid;
@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include "lamp_row.h"
+#include "snapshot.h"
 #include "lamp.h"
 
 struct _lamp_row_t {
@@ -73,6 +74,24 @@ display_lamp_row(Widget wid, SDL_Renderer *render)
    }
 }
 
+static int
+changed_lamp_row(Widget wid)
+{
+   struct _lamp_row_t *row = (struct _lamp_row_t *)wid->data;
+   uint64_t   state = 0;
+   uint64_t   bit;
+   int        i;
+
+   for (i = 0; i < row->num; i++) {
+       bit = (LAMP_TEST != 0);
+       if (row->value[i] != NULL) {
+           bit = (*row->value[i] >> row->shft[i]) & 1;
+       }
+       state |= bit << i;
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_lamp_row(Widget wid)
 {
@@ -177,7 +196,8 @@ add_lamp_row(Panel win, int x, int y, Lamp_row row, int num,
            row_data->rect_label2[i].x -= 7;
            row_data->rect_label3[i].x -= 7;
        }
-       row_data->value[i] = row[i].value;
+       row_data->value[i] = (uint16_t *)snapshot_add(row[i].value,
+                                                     sizeof(uint16_t));
        row_data->shft[i] = row[i].shft;
        row_data->color[i] = row[i].color;
        row_data->rect_lamp[i].x = px;
@@ -188,10 +208,11 @@ add_lamp_row(Panel win, int x, int y, Lamp_row row, int num,
 
    nwid->rect.x = x;
    nwid->rect.y = y;
-   nwid->rect.w = px - x;
-   nwid->rect.h = py + 20;
+   nwid->rect.w = px + 15 - x;
+   nwid->rect.h = py + 20 - y;
    nwid->data = (void *)row_data;
    nwid->draw = display_lamp_row;
+   nwid->changed = changed_lamp_row;
    nwid->close = close_lamp_row;
    add_widget(win, nwid);
    return nwid;
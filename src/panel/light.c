@@ -24,6 +24,7 @@
  */
 
 #include "light.h"
+#include "intensity.h"
 
 struct _light_t {
     SDL_Rect     recth;
@@ -32,7 +33,7 @@ struct _light_t {
     SDL_Texture *digitl_on;
     SDL_Texture *digith_off;
     SDL_Texture *digitl_off;
-    uint16_t    *value;
+    Intensity    lamp;
     int          shift;
 };
 
@@ -41,20 +42,31 @@ static void
 display_light(Widget wid, SDL_Renderer *render)
 {
    struct _light_t *l = (struct _light_t *)wid->data;
-   int     bit = 0;
+   int     level = INTENSITY_LEVELS - 1;
 
-   if (l->value != 0) {
-       bit = (*l->value >> l->shift) & 1;
+   if (!LAMP_TEST) {
+       level = intensity_level(l->lamp, l->shift);
    }
-   if (LAMP_TEST || bit) {
-      SDL_RenderCopy(render, l->digith_on, NULL, &l->recth);
-      SDL_RenderCopy(render, l->digitl_on, NULL, &l->rectl);
-   } else {
-      SDL_RenderCopy(render, l->digith_off, NULL, &l->recth);
-      SDL_RenderCopy(render, l->digitl_off, NULL, &l->rectl);
+   draw_intensity(render, l->digith_on, NULL, l->digith_off, NULL,
+                  &l->recth, level);
+   if (l->digitl_on != NULL) {
+       draw_intensity(render, l->digitl_on, NULL, l->digitl_off, NULL,
+                      &l->rectl, level);
    }
 }
 
+static int
+changed_light(Widget wid)
+{
+   struct _light_t *l = (struct _light_t *)wid->data;
+   uint64_t        state = INTENSITY_LEVELS;
+
+   if (!LAMP_TEST) {
+       state = intensity_level(l->lamp, l->shift);
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_light(Widget wid)
 {
@@ -91,7 +103,7 @@ add_light(Panel win, int x, int y, char *label1, char *label2,
        return NULL;
    }
 
-   l->value = value;
+   l->lamp = intensity_add16(value);
    l->shift = shift;
    l->recth.x = x;
    l->recth.y = y;
@@ -133,12 +145,11 @@ add_light(Panel win, int x, int y, char *label1, char *label2,
        l->recth.y -= (hh/2) + 2;
    }
 
-   nwid->rect.x = x;
-   nwid->rect.y = y;
-   nwid->rect.w = l->recth.w;
-   nwid->rect.h = l->recth.h+l->rectl.h;
+   /* Cover both labels */
+   SDL_UnionRect(&l->recth, &l->rectl, &nwid->rect);
 
    nwid->draw = display_light;
+   nwid->changed = changed_light;
    nwid->close = close_light;
    nwid->data = (void *)l;
    add_widget(win, nwid);
@@ -25,6 +25,7 @@
 
 
 #include "number.h"
+#include "snapshot.h"
 
 struct _number_t {
     TTF_Font    *font;
@@ -72,6 +73,17 @@ display_number(Widget wid, SDL_Renderer *render)
     }
 }
 
+static int
+changed_number(Widget wid)
+{
+   struct _number_t *num = (struct _number_t *)wid->data;
+
+   if (num->value == NULL) {
+       return 0;
+   }
+   return widget_changed(wid, (uint32_t)*num->value);
+}
+
 static void
 close_number(Widget wid)
 {
@@ -99,7 +111,7 @@ add_number(Panel win, int x, int y, int h, int w, int *value,
    }
 
    num->font = font;
-   num->value = value;
+   num->value = (int *)snapshot_add(value, sizeof(int));
    nwid->rect.x = x;
    nwid->rect.y = y;
    nwid->rect.w = w;
@@ -107,6 +119,7 @@ add_number(Panel win, int x, int y, int h, int w, int *value,
    nwid->fore_color = cf;
    nwid->back_color = cb;
    nwid->draw = display_number;
+   nwid->changed = changed_number;
    nwid->close = close_number;
    nwid->data = (void *)num;
    add_widget(win, nwid);
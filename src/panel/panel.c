@@ -44,7 +44,13 @@
 #include "widgets.h"
 #include "panel.h"
 #include "number.h"
+#include "intensity.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "itimer.h"
 #include "cpu.h"
+#include "journal.h"
+#include "checkpoint.h"
 #include "panel_device.h"
 #include "lamps_img.xpm"
 #include "hex_dial_img.xpm"
@@ -53,6 +59,7 @@
 
 int process(void *data);
 uint32_t timer_callback(uint32_t interval, void *param);
+uint32_t tick_callback(uint32_t interval, void *param);
 
 
 #define inrect(px, py, r) ((px > r.x) && (px < (r.x + r.w)) && (py > r.y) && (py < (r.y + r.h)))
@@ -83,10 +90,13 @@ int          fps;
 SDL_bool over_cycle = SDL_FALSE;     /* Indicates over number of count cycles */
 SDL_mutex  *display_mutex;           /* Lock for display update */
 SDL_cond   *display_wait;            /* Display waiting for update */
+SDL_mutex  *input_mutex;             /* Hold CPU while input is recorded */
+SDL_atomic_t tick_pending;           /* Timer tick waiting for CPU */
 
 
-uint64_t step_count;
+MACHINE_LOCAL uint64_t step_count;
 int      cpu_count;
+int      render_resets;
 
 /* Add widget to window list */
 void
@@ -99,6 +109,47 @@ add_widget(Panel win, Widget wid)
        win->last_item->next = wid;
    }
    win->last_item = wid;
+   win->redraw = 1;
+}
+
+/*
+ * Save state widget is showing, return true if it differs from last draw.
+ */
+int
+widget_changed(Widget wid, uint64_t state)
+{
+   if (wid->state == state) {
+       return 0;
+   }
+   wid->state = state;
+   return 1;
+}
+
+/*
+ * Widgets that can't tell what they show are always redrawn.
+ */
+int
+widget_always(Widget wid)
+{
+   return 1;
+}
+
+/* Widgets that never change are drawn once into window background */
+#define static_widget(wp) ((wp)->changed == NULL && (wp)->click == NULL)
+
+/*
+ * Check if widget needs to be redrawn.
+ */
+static int
+widget_dirty(Widget wp)
+{
+   int   dirty = wp->redraw;
+
+   wp->redraw = 0;
+   if (wp->changed != NULL && (*wp->changed)(wp)) {
+       dirty = 1;
+   }
+   return dirty;
 }
 
 Window    win_list_head, win_list_tail;
@@ -139,6 +190,22 @@ create_window(char *title, int w, int h, int popup)
    return win->panel;
 }
 
+/*
+ * Release cached images of window.
+ */
+static void
+free_textures(Window win)
+{
+    if (win->back != NULL) {
+        SDL_DestroyTexture(win->back);
+    }
+    if (win->frame != NULL) {
+        SDL_DestroyTexture(win->frame);
+    }
+    win->back = NULL;
+    win->frame = NULL;
+}
+
 /*
  * Close a window and remove it from list of windows.
  * Call each widgets close routine to clean up house.
@@ -189,6 +256,7 @@ close_window(Window win)
        }
     }
 
+    free_textures(win);
     free(win->title);
     free(win->panel);
     SDL_DestroyRenderer(win->render);
@@ -211,6 +279,7 @@ SDL_Setup(char *title)
     /* Create display locks */
     display_mutex = SDL_CreateMutex();
     display_wait = SDL_CreateCond();
+    input_mutex = SDL_CreateMutex();
     win_list_head = NULL;
     win_list_tail = NULL;
 
@@ -265,25 +334,124 @@ close_windows()
 }
 
 /*
- * Refresh all windows.
+ * Show frame on screen.
+ */
+static void
+present_window(Window winp)
+{
+    if (winp->frame != NULL) {
+        SDL_SetRenderTarget(winp->render, NULL);
+        SDL_RenderCopy(winp->render, winp->frame, NULL, NULL);
+    }
+    SDL_RenderPresent(winp->render);
+}
+
+/*
+ * Redraw whole window. Widgets which never change are drawn into
+ * background image, rest are drawn on top of it.
+ */
+static void
+draw_window(Window winp)
+{
+    SDL_Renderer *render = winp->render;
+    Widget        wp;
+    int           w, h;
+
+    winp->panel->redraw = 0;
+    /* Create cached images if renderer can draw into them */
+    if (winp->back == NULL && SDL_RenderTargetSupported(render)) {
+        SDL_GetRendererOutputSize(render, &w, &h);
+        winp->back = SDL_CreateTexture(render, SDL_PIXELFORMAT_RGBA8888,
+                                       SDL_TEXTUREACCESS_TARGET, w, h);
+        winp->frame = SDL_CreateTexture(render, SDL_PIXELFORMAT_RGBA8888,
+                                       SDL_TEXTUREACCESS_TARGET, w, h);
+        if (winp->back == NULL || winp->frame == NULL) {
+            free_textures(winp);
+        } else {
+            SDL_SetTextureBlendMode(winp->back, SDL_BLENDMODE_NONE);
+            SDL_SetTextureBlendMode(winp->frame, SDL_BLENDMODE_NONE);
+        }
+    }
+
+    /* Clear display */
+    SDL_SetRenderTarget(render, winp->back);
+    SDL_SetRenderDrawColor(render, 0x00, 0x00, 0x00, 0xFF);
+    SDL_RenderClear(render);
+
+    /* Render background */
+    for (wp = winp->panel->list; wp != NULL; wp = wp->next) {
+         if (wp->draw != NULL && static_widget(wp))
+             wp->draw(wp, render);
+    }
+
+    if (winp->frame != NULL) {
+        SDL_SetRenderTarget(render, winp->frame);
+        SDL_RenderCopy(render, winp->back, NULL, NULL);
+    }
+
+    /* Render everything that can change */
+    for (wp = winp->panel->list; wp != NULL; wp = wp->next) {
+         if (static_widget(wp))
+             continue;
+         (void)widget_dirty(wp);
+         if (wp->draw != NULL)
+             wp->draw(wp, render);
+    }
+    present_window(winp);
+}
+
+/*
+ * Refresh all windows. Only widgets which have changed since the last
+ * refresh are drawn, windows with no changes are left alone.
  */
 void
 draw_screen()
 {
-    Window       winp;
-    Widget       wp;
+    SDL_Renderer *render;
+    Window        winp;
+    Widget        wp, wp2;
+    int           dirty;
 
     for (winp = win_list_head; winp != NULL; winp = winp->next) {
-        /* Clear display */
-        SDL_SetRenderDrawColor( winp->render, 0x00, 0x00, 0x00, 0xFF);
-        SDL_RenderClear( winp->render);
+        render = winp->render;
+        if (winp->panel->redraw) {
+            draw_window(winp);
+            continue;
+        }
 
-        /* Render all panels */
+        /* If no saved frame, redraw everything if anything changed */
+        if (winp->frame == NULL || winp->panel->whole) {
+            dirty = 0;
+            for (wp = winp->panel->list; wp != NULL; wp = wp->next) {
+                 if (!static_widget(wp) && widget_dirty(wp))
+                     dirty = 1;
+            }
+            if (dirty)
+                draw_window(winp);
+            continue;
+        }
+
+        dirty = 0;
+        SDL_SetRenderTarget(render, winp->frame);
         for (wp = winp->panel->list; wp != NULL; wp = wp->next) {
-             if (wp->draw != NULL)
-                 wp->draw(wp, winp->render);
+             if (static_widget(wp) || !widget_dirty(wp))
+                 continue;
+             dirty = 1;
+             /* Restore background and redraw anything over it */
+             SDL_RenderSetClipRect(render, &wp->rect);
+             SDL_RenderCopy(render, winp->back, &wp->rect, &wp->rect);
+             for (wp2 = winp->panel->list; wp2 != NULL; wp2 = wp2->next) {
+                  if (wp2->draw != NULL && !static_widget(wp2) &&
+                      SDL_HasIntersection(&wp->rect, &wp2->rect))
+                      wp2->draw(wp2, render);
+             }
+        }
+        SDL_RenderSetClipRect(render, NULL);
+        if (dirty) {
+            present_window(winp);
+        } else {
+            SDL_SetRenderTarget(render, NULL);
         }
-        SDL_RenderPresent( winp->render );
     }
 }
 
@@ -304,17 +472,35 @@ timer_callback(uint32_t interval, void *param)
 
     event.type = SDL_USEREVENT;
     event.user = userevent;
-    timer_event = 1;
 
     SDL_PushEvent(&event);
     return interval;
 }
 
+/*
+ * Interval timer ticks from the host clock, when timer realtime is set.
+ * Milliseconds between ticks are varied so they average timer_rate.
+ */
+uint32_t
+tick_callback(uint32_t interval, void *param)
+{
+    static int    ticks;
+
+    /* Journal needs to know which step took the tick */
+    if (journal_mode == JOURNAL_OFF)
+        timer_event = 1;
+    else
+        SDL_AtomicSet(&tick_pending, 1);
+    ticks = (ticks + 1) % timer_rate;
+    return (((ticks + 1) * 1000) / timer_rate) - ((ticks * 1000) / timer_rate);
+}
+
 void
 run_sim()
 {
     SDL_Thread *thrd;
     SDL_TimerID  disp_timer;
+    SDL_TimerID  tick_timer = 0;
     SDL_Event event;
     Window       winp;
     Widget       wp;
@@ -322,8 +508,11 @@ run_sim()
 
     POWER = 1;
     SYS_RST = 1;  /* Force system reset */
+    timer_start();
     thrd = SDL_CreateThread(process, "CPU", NULL);
     disp_timer = SDL_AddTimer(20, &timer_callback, NULL);
+    if (timer_realtime)
+        tick_timer = SDL_AddTimer(1000 / timer_rate, &tick_callback, NULL);
     while(POWER) {
         while(SDL_PollEvent(&event)) {
            if (event.type == SDL_WINDOWEVENT) {
@@ -337,6 +526,28 @@ run_sim()
                            }
                        }
                 }
+                /* Window uncovered or resized, redraw all of it */
+                if (event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                    event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                       for (winp = win_list_head; winp != NULL; winp = winp->next) {
+                           if (winp->windowID == event.window.windowID) {
+                               if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                                   free_textures(winp);
+                               }
+                               winp->panel->redraw = 1;
+                               break;
+                           }
+                       }
+                }
+                continue;
+           }
+           /* Cached images lost, redraw everything */
+           if (event.type == SDL_RENDER_TARGETS_RESET ||
+               event.type == SDL_RENDER_DEVICE_RESET) {
+                render_resets++;
+                for (winp = win_list_head; winp != NULL; winp = winp->next) {
+                    winp->panel->redraw = 1;
+                }
                 continue;
            }
            for (winp = win_list_head; winp != NULL; winp = winp->next) {
@@ -345,9 +556,20 @@ run_sim()
                }
            }
 
+           /* Panel is driven by the journal */
+           if (winp != NULL && journal_mode == JOURNAL_REPLAY) {
+               continue;
+           }
+
            if (winp != NULL) {
+               if (journal_mode == JOURNAL_RECORD) {
+                   SDL_LockMutex(input_mutex);
+                   journal_mark();
+               }
                switch(event.type) {
                case SDL_MOUSEBUTTONDOWN:
+                    /* Clicks can change other widgets, redraw window */
+                    winp->panel->redraw = 1;
                     /* Check for click */
                     for (wp = winp->panel->list; wp != NULL; wp = wp->next) {
                          if (wp->click != NULL) {
@@ -369,6 +591,7 @@ run_sim()
                     break;
 
                case SDL_MOUSEBUTTONUP:
+                    winp->panel->redraw = 1;
                     /* Check for release */
                     for (wp = winp->panel->list; wp != NULL; wp = wp->next) {
                          if (wp->active) {
@@ -383,12 +606,14 @@ run_sim()
                case SDL_KEYDOWN:
                     if (winp->panel->focus != NULL && winp->panel->focus->keypress != NULL) {
                          winp->panel->focus->keypress(winp->panel->focus, &event.key);
+                         winp->panel->focus->redraw = 1;
                     }
                     break;
 
                case SDL_TEXTINPUT:
                     if (winp->panel->focus != NULL && winp->panel->focus->input != NULL) {
                          winp->panel->focus->input(winp->panel->focus, &event.text);
+                         winp->panel->focus->redraw = 1;
                     }
                     break;
 
@@ -399,19 +624,25 @@ run_sim()
                     if (winp->panel->focus != NULL && winp->panel->focus->motion != NULL) {
                         Widget w = winp->panel->focus;
                         w->motion(w, event.button.x - w->rect.x, event.button.y - w->rect.y);
+                        w->redraw = 1;
                     }
                     break;
 
                default:
                     break;
                }
+               if (journal_mode == JOURNAL_RECORD) {
+                   journal_changed = 1;
+                   SDL_UnlockMutex(input_mutex);
+               }
            } else {
                switch(event.type) {
                case SDL_USEREVENT:
                     ticks = SDL_GetTicks();
+                    snapshot_acquire();
                     draw_screen();
                     SDL_LockMutex(display_mutex);
-                    cpu_count = 0;
+                    snapshot_request();
                     SDL_CondSignal(display_wait);
                     SDL_UnlockMutex(display_mutex);
                     fps = (int)(SDL_GetTicks() - ticks);
@@ -437,7 +668,6 @@ run_sim()
                case SDL_QUIT:
                     log_trace("Quit\n");
                     POWER = 0;
-                    cpu_count = 0;
                     break;
                default:
                     break;
@@ -452,6 +682,8 @@ run_sim()
 
     SDL_WaitThread(thrd, NULL);
     SDL_RemoveTimer(disp_timer);
+    if (tick_timer != 0)
+        SDL_RemoveTimer(tick_timer);
     TTF_CloseFont(font1);
     TTF_CloseFont(font10);
     TTF_CloseFont(font12);
@@ -459,25 +691,82 @@ run_sim()
     TTF_Quit();
     SDL_DestroyCond(display_wait);
     SDL_DestroyMutex(display_mutex);
+    SDL_DestroyMutex(input_mutex);
     SDL_Quit();
 	return;
 }
 
 
+/*
+ * Step while recording or replaying a journal.  Recording holds off the
+ * panel for the step, so every input is taken at a known step.
+ */
+static void
+journal_process()
+{
+    uint32_t    v;
+
+    /* Wait on debugger before holding off the panel */
+    debug_step();
+    if (journal_mode == JOURNAL_RECORD) {
+        SDL_LockMutex(input_mutex);
+        if (SDL_AtomicSet(&tick_pending, 0)) {
+            timer_event = 1;
+            journal_input("TIMER", 1);
+        }
+        journal_step();
+    } else {
+        journal_step();
+        if (journal_next("TIMER", &v))
+            timer_event = 1;
+    }
+    (*step_cpu)();
+    intensity_sample();
+    step_disk();
+    step_disk();
+    advance();
+    checkpoint_step();
+    if (journal_mode == JOURNAL_RECORD)
+        SDL_UnlockMutex(input_mutex);
+}
+
+/* One step when running forward to where the debugger went back to */
+static void
+back_step()
+{
+    step_count++;
+    journal_process();
+}
+
 int process(void *data) {
     log_info("Process start %d\n", cpu_count);
     cpu_count = 0;
     while(POWER) {
+       if (debug_back != 0)
+           debug_go_back(&back_step);
        cpu_count++;
        step_count++;
        if (cpu_count > 20000) {
           SDL_LockMutex(display_mutex);
-          while (cpu_count > 20000 && POWER) {
+          while (!snapshot_wanted() && POWER) {
                SDL_CondWaitTimeout(display_wait, display_mutex, 50);
           }
           SDL_UnlockMutex(display_mutex);
        }
+       /* Display is done with last frame, give it this one */
+       if (snapshot_wanted()) {
+          intensity_publish();
+          snapshot_publish();
+          stats_poll();
+          cpu_count = 0;
+       }
+       if (journal_mode != JOURNAL_OFF) {
+           journal_process();
+           continue;
+       }
+       debug_step();
        (*step_cpu)();
+       intensity_sample();
        step_disk();
        step_disk();
        advance();
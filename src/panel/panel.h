@@ -28,6 +28,7 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <stdint.h>
+#include "machine.h"
 
 
 /* Structure of device control popup */
@@ -48,10 +49,13 @@ typedef struct _window_t {
       Panel         panel;
       char         *title;
       int           popup;
+      SDL_Texture  *back;            /* Static widgets */
+      SDL_Texture  *frame;           /* Last frame drawn */
 } window, *Window;
 
 void run_sim();
 
-extern uint64_t    step_count;
+extern MACHINE_LOCAL uint64_t    step_count;
+extern int         render_resets;   /* Target textures lost contents */
 
 #endif
@@ -45,6 +45,10 @@ struct _device_win_t {
     void    (*display_device)(struct _device *unit, void *render, int u);
     void    *(*create_control)(struct _device *unit, int u, int x, int y);
     struct  _device *unit;
+    SDL_Texture *cache;       /* Image of device as last drawn */
+    int      resets;          /* Render resets when cache drawn */
+    int      cached;          /* Cache holds image for state */
+    uint64_t state;           /* State image shows */
     Panel    popup;
     int      popupID;
     int      parentID;
@@ -66,17 +70,90 @@ close_child(Panel panel, int windowID)
     }
 }
 
+/*
+ * Draw device into its own image if what it shows has changed. Returns
+ * false if the renderer can't draw into images.
+ */
+static int
+cache_device(struct _device_win_t *ctrl, uint64_t state, SDL_Renderer *render)
+{
+    struct _rect *r = &ctrl->unit->rect[ctrl->u];
+    SDL_Texture  *target;
+    int           x, y;
+
+    if (ctrl->cached && ctrl->state == state && ctrl->resets == render_resets) {
+        return 1;
+    }
+    if (ctrl->cache == NULL) {
+        if (!SDL_RenderTargetSupported(render)) {
+            return 0;
+        }
+        ctrl->cache = SDL_CreateTexture(render, SDL_PIXELFORMAT_RGBA8888,
+                                     SDL_TEXTUREACCESS_TARGET, r->w, r->h);
+        if (ctrl->cache == NULL) {
+            return 0;
+        }
+        SDL_SetTextureBlendMode(ctrl->cache, SDL_BLENDMODE_NONE);
+    }
+    target = SDL_GetRenderTarget(render);
+    SDL_SetRenderTarget(render, ctrl->cache);
+    SDL_SetRenderDrawColor(render, 0x00, 0x00, 0x00, 0xff);
+    SDL_RenderClear(render);
+    /* Devices draw at their place in window, move it to corner of image */
+    x = r->x;
+    y = r->y;
+    r->x = 0;
+    r->y = 0;
+    (*ctrl->display_device)(ctrl->unit, (void *)render, ctrl->u);
+    r->x = x;
+    r->y = y;
+    SDL_SetRenderTarget(render, target);
+    ctrl->state = state;
+    ctrl->resets = render_resets;
+    ctrl->cached = 1;
+    return 1;
+}
+
 static void
 display_device(Widget wid, SDL_Renderer *render)
 {
     struct _device_win_t *ctrl = (struct _device_win_t *)wid->data;
-    
+    struct _rect *r = &ctrl->unit->rect[ctrl->u];
+    SDL_Rect      rect;
+
+    if (ctrl->unit->draw_state != NULL && cache_device(ctrl, wid->state, render)) {
+        rect.x = r->x;
+        rect.y = r->y;
+        rect.w = r->w;
+        rect.h = r->h;
+        SDL_RenderCopy(render, ctrl->cache, NULL, &rect);
+        return;
+    }
     (*ctrl->display_device)(ctrl->unit, (void *)render, ctrl->u);
 }
 
+/*
+ * Devices which can say what they show only redraw when that changes.
+ */
+static int
+changed_device(Widget wid)
+{
+    struct _device_win_t *ctrl = (struct _device_win_t *)wid->data;
+
+    if (ctrl->unit->draw_state == NULL) {
+        return 1;
+    }
+    return widget_changed(wid, (*ctrl->unit->draw_state)(ctrl->unit, ctrl->u));
+}
+
 static void
 close_device(Widget wid)
 {
+     struct _device_win_t *ctrl = (struct _device_win_t *)wid->data;
+
+     if (ctrl->cache != NULL) {
+         SDL_DestroyTexture(ctrl->cache);
+     }
      free(wid->data);
 }
 
@@ -230,6 +307,8 @@ create_device_window()
    screen_height += row_height;
 //printf("size=%d %d\n", min_width, min_height);
    panel = create_window("Devices", min_width, screen_height, 0);
+   /* Device widget sizes do not match their images, redraw all on change */
+   panel->whole = 1;
 
    /* Create widgets for each window */
    for (p = perph; p != NULL; p = p->next) {
@@ -257,6 +336,7 @@ create_device_window()
        nwid->rect.h = p->dev->rect[p->unit].w;
        nwid->back_color = &c_black;
        nwid->draw = display_device;
+       nwid->changed = changed_device;
        nwid->click = click_device;
        nwid->close = close_device;
        nwid->data = (void *)ndev;
@@ -26,6 +26,7 @@
 
 #include "reg_row.h"
 #include "line.h"
+#include "intensity.h"
 
 struct _reg_bits_w {
       int          sz;
@@ -36,7 +37,7 @@ struct _reg_bits_w {
       SDL_Texture *label[40];
       int          start[4];
       int          index[4];
-      uint16_t    *value[4];
+      Intensity    lamp[4];
 };
 
 /*
@@ -46,22 +47,19 @@ static void
 display_reg(Widget wid, SDL_Renderer *render)
 {
    struct  _reg_bits_w *row_ptr = (struct _reg_bits_w *)wid->data;
-   uint16_t bits = 0;
+   int      level;
    int      i;
    int      shift;
    int      lab_index = 0;
 
    shift = row_ptr->start[lab_index];
    for (i = 0; i < row_ptr->sz; i++) {
-       bits = 0;
-       if (row_ptr->value[lab_index] != NULL) {
-           bits = *row_ptr->value[lab_index];
-       }
-       if (LAMP_TEST || (bits & (1 << shift)) != 0) {
-          SDL_RenderCopy(render, row_ptr->digit_on[i], NULL, &row_ptr->rect_bit[i]);
-       } else {
-          SDL_RenderCopy(render, row_ptr->digit_off[i], NULL, &row_ptr->rect_bit[i]);
+       level = INTENSITY_LEVELS - 1;
+       if (!LAMP_TEST) {
+           level = intensity_level(row_ptr->lamp[lab_index], shift);
        }
+       draw_intensity(render, row_ptr->digit_on[i], NULL, row_ptr->digit_off[i],
+                      NULL, &row_ptr->rect_bit[i], level);
        if (row_ptr->label[i] != NULL) {
           SDL_RenderCopy( render, row_ptr->label[i], NULL, &row_ptr->rect_label[i]);
        }
@@ -73,6 +71,26 @@ display_reg(Widget wid, SDL_Renderer *render)
    }
 }
 
+/*
+ * Check if any register in row changed. Lamp test lights everything
+ * just like all ones would.
+ */
+static int
+changed_reg(Widget wid)
+{
+   struct  _reg_bits_w *row_ptr = (struct _reg_bits_w *)wid->data;
+   uint64_t state = 0;
+   int      i;
+
+   if (LAMP_TEST) {
+       return widget_changed(wid, ~((uint64_t)0));
+   }
+   for (i = 0; i < 4; i++) {
+       state = (state * 31) + intensity_state(row_ptr->lamp[i]);
+   }
+   return widget_changed(wid, state);
+}
+
 /*
  * Cleanup row of Registers.
  */
@@ -124,7 +142,6 @@ add_reg_row(Panel win, int x, int y, Reg_row row,
     nwid->rect.x = x;
     nwid->rect.y = y;
     nwid->rect.w = wx;
-    row_ptr->value[lab_index] = row->value[lab_index];
     row_ptr->start[lab_index] = row->start_bit[lab_index];
     if (row->lower == NULL) {
        hd = hx;
@@ -171,11 +188,14 @@ add_reg_row(Panel win, int x, int y, Reg_row row,
         surf = TTF_RenderText_Blended(font, lab, *row->c_off);
         row_ptr->digit_off[digit] = SDL_CreateTextureFromSurface(win->render, surf);
         SDL_FreeSurface(surf);
+        /* Only sample registers which have lamps */
+        if (row_ptr->lamp[lab_index] == NULL) {
+            row_ptr->lamp[lab_index] = intensity_add16(row->value[lab_index]);
+        }
         shift--;
         if (shift < 0) {
            lab_index++;
-           row_ptr->value[lab_index] = row->value[lab_index];
-           row_ptr->start[lab_index] = row->start_bit[lab_index];
+                  row_ptr->start[lab_index] = row->start_bit[lab_index];
            shift = row_ptr->start[lab_index];
        }
 
@@ -200,6 +220,7 @@ add_reg_row(Panel win, int x, int y, Reg_row row,
    nwid->fore_color = NULL;
    nwid->back_color = NULL;
    nwid->draw = display_reg;
+   nwid->changed = changed_reg;
    nwid->close = close_reg;
    nwid->data = (void *)row_ptr;
    add_widget(win, nwid);
@@ -263,7 +284,6 @@ add_reg_row_large(Panel win, int x, int y, Reg_row row,
     nwid->rect.x = x;
     nwid->rect.y = y;
     nwid->rect.w = wx;
-    row_ptr->value[lab_index] = row->value[lab_index];
     row_ptr->start[lab_index] = row->start_bit[lab_index];
     if (row->lower == NULL) {
        hd = hx;
@@ -311,11 +331,14 @@ add_reg_row_large(Panel win, int x, int y, Reg_row row,
         surf = TTF_RenderText_Blended(font, lab, *row->c_off);
         row_ptr->digit_off[digit] = SDL_CreateTextureFromSurface(win->render, surf);
         SDL_FreeSurface(surf);
+        /* Only sample registers which have lamps */
+        if (row_ptr->lamp[lab_index] == NULL) {
+            row_ptr->lamp[lab_index] = intensity_add16(row->value[lab_index]);
+        }
         shift--;
         if (shift < 0) {
            lab_index++;
-           row_ptr->value[lab_index] = row->value[lab_index];
-           row_ptr->start[lab_index] = row->start_bit[lab_index];
+                  row_ptr->start[lab_index] = row->start_bit[lab_index];
            shift = row_ptr->start[lab_index];
        }
 
@@ -340,6 +363,7 @@ add_reg_row_large(Panel win, int x, int y, Reg_row row,
    nwid->fore_color = NULL;
    nwid->back_color = NULL;
    nwid->draw = display_reg;
+   nwid->changed = changed_reg;
    nwid->close = close_reg;
    nwid->data = (void *)row_ptr;
    add_widget(win, nwid);
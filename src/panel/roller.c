@@ -78,6 +78,17 @@ display_roller(Widget wid, SDL_Renderer *render)
    }
 }
 
+static int
+changed_roller(Widget wid)
+{
+   struct _roller_t *rol = (struct _roller_t *)wid->data;
+
+   if (LAMP_TEST) {
+       return widget_changed(wid, ~((uint64_t)0));
+   }
+   return widget_changed(wid, (*rol->get_row)(rol->pos));
+}
+
 static void
 click_roller(Widget wid, int x, int y)
 {
@@ -139,6 +150,7 @@ add_roller(Panel win, int x, int y, SDL_Rect *r_rect, SDL_Texture *rollers,
    nwid->rect.h = (r_rect->h * 2) + 15;
    nwid->data = (void *)rol;
    nwid->draw = display_roller;
+   nwid->changed = changed_roller;
    nwid->click = click_roller;
    nwid->close = close_roller;
    add_widget(win, nwid);
@@ -25,6 +25,7 @@
 
 
 #include "ros_row.h"
+#include "snapshot.h"
 #include "line.h"
 
 struct _ros_bits_w {
@@ -67,6 +68,20 @@ display_ros(Widget wid, SDL_Renderer *render)
 /*
  * Cleanup row of ROS.
  */
+static int
+changed_ros(Widget wid)
+{
+   struct  _ros_bits_w *row_ptr = (struct _ros_bits_w *)wid->data;
+   uint64_t state = 0;
+
+   if (LAMP_TEST) {
+       state = ~((uint64_t)0);
+   } else if (row_ptr->value != NULL) {
+       state = *row_ptr->value;
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_ros(Widget wid)
 {
@@ -112,7 +127,7 @@ add_ros_row(Panel win, int x, int y, Ros_row row,
     nwid->rect.x = x;
     nwid->rect.y = y;
     nwid->rect.w = wx;
-    row_ptr->value = bits;
+    row_ptr->value = (uint32_t *)snapshot_add(bits, sizeof(uint32_t));
     if (row->lower == NULL) {
        hd = hx;
     } else {
@@ -182,6 +197,7 @@ add_ros_row(Panel win, int x, int y, Ros_row row,
    nwid->fore_color = NULL;
    nwid->back_color = NULL;
    nwid->draw = display_ros;
+   nwid->changed = changed_ros;
    nwid->close = close_ros;
    nwid->data = (void *)row_ptr;
    add_widget(win, nwid);
@@ -0,0 +1,120 @@
+/*
+ * microsim360 - GUI Snapshot of machine state for display.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "snapshot.h"
+
+#define SNAP_FRESH   4                /* Middle buffer has new state */
+
+static void         *snap_list;       /* State being copied */
+static int           back = 0;        /* Buffer CPU is filling */
+static int           front = 1;       /* Buffer display took last */
+static SDL_atomic_t  middle = { 2 };  /* Buffer passed between them */
+static SDL_atomic_t  want;            /* Display wants a new frame */
+
+/*
+ * Find view for state, or start copying it. If the state is part of
+ * something already copied return a pointer into that view.
+ */
+void *
+snapshot_add(void *live, size_t len)
+{
+    Snapshot    snap;
+    uint8_t    *ptr = (uint8_t *)live;
+    uint8_t    *buf;
+    int         i;
+
+    if (live == NULL) {
+        return NULL;
+    }
+    for (snap = SDL_AtomicGetPtr(&snap_list); snap != NULL; snap = snap->next) {
+        if (ptr >= snap->live && (ptr + len) <= (snap->live + snap->len)) {
+            return (void *)(snap->view + (ptr - snap->live));
+        }
+    }
+    if ((snap = (Snapshot)calloc(1, sizeof(snapshot))) == NULL) {
+        return live;
+    }
+    if ((buf = (uint8_t *)calloc(4, len)) == NULL) {
+        free(snap);
+        return live;
+    }
+    snap->live = ptr;
+    snap->len = len;
+    for (i = 0; i < 3; i++) {
+        snap->copy[i] = buf + (i * len);
+        memcpy(snap->copy[i], ptr, len);
+    }
+    snap->view = buf + (3 * len);
+    memcpy(snap->view, ptr, len);
+    snap->next = SDL_AtomicGetPtr(&snap_list);
+    /* Publish only once fully filled in */
+    SDL_AtomicSetPtr(&snap_list, snap);
+    return (void *)snap->view;
+}
+
+/*
+ * If CPU has finished a new frame swap it for the one we had and
+ * update the views.
+ */
+void
+snapshot_acquire()
+{
+    Snapshot    snap;
+
+    if ((SDL_AtomicGet(&middle) & SNAP_FRESH) == 0) {
+        return;
+    }
+    front = SDL_AtomicSet(&middle, front) & 3;
+    for (snap = SDL_AtomicGetPtr(&snap_list); snap != NULL; snap = snap->next) {
+        memcpy(snap->view, snap->copy[front], snap->len);
+    }
+}
+
+void
+snapshot_request()
+{
+    SDL_AtomicSet(&want, 1);
+}
+
+int
+snapshot_wanted()
+{
+    return SDL_AtomicGet(&want);
+}
+
+/*
+ * Copy state into back buffer and swap it for the middle one.
+ */
+void
+snapshot_publish()
+{
+    Snapshot    snap;
+
+    for (snap = SDL_AtomicGetPtr(&snap_list); snap != NULL; snap = snap->next) {
+        memcpy(snap->copy[back], snap->live, snap->len);
+    }
+    back = SDL_AtomicSet(&middle, back | SNAP_FRESH) & 3;
+    SDL_AtomicSet(&want, 0);
+}
@@ -0,0 +1,61 @@
+/*
+ * microsim360 - GUI Snapshot of machine state for display.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+#include "widgets.h"
+
+/*
+ * Machine state shown by the display is copied by the CPU thread at the
+ * end of each frame into one of three buffers. The display takes the
+ * latest complete buffer when it starts a frame and copies it into a
+ * view that widgets point at, so neither thread ever waits on the other
+ * and the display never reads state the CPU thread is changing.
+ */
+typedef struct _snapshot {
+      struct _snapshot *next;
+      uint8_t     *live;           /* State being copied, CPU thread only */
+      size_t       len;            /* Size of state */
+      uint8_t     *copy[3];        /* Buffers passed between threads */
+      uint8_t     *view;           /* What display reads */
+} snapshot, *Snapshot;
+
+/* Display side, return pointer to view of live state */
+void *snapshot_add(void *live, size_t len);
+
+/* Display side, start of frame take latest state */
+void snapshot_acquire();
+
+/* Display side, frame is drawn, ask CPU for the next one */
+void snapshot_request();
+
+/* CPU side, true if display wants a new frame */
+int snapshot_wanted();
+
+/* CPU side, copy state and hand it to display */
+void snapshot_publish();
+
+#endif
@@ -61,6 +61,12 @@ display_store_dial(Widget wid, SDL_Renderer *render)
 
 }
 
+static int
+changed_store_dial(Widget wid)
+{
+   return widget_changed(wid, *((uint8_t *)wid->data));
+}
+
 static void
 click_store_dial(Widget wid, int x, int y)
 {
@@ -111,6 +117,7 @@ add_store_dial(Panel win, int x, int y, uint8_t *value)
    nwid->rect.h = 80;
    nwid->data = (void *)value;
    nwid->draw = display_store_dial;
+   nwid->changed = changed_store_dial;
    nwid->click = click_store_dial;
    add_widget(win, nwid);
    return nwid;
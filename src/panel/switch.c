@@ -73,6 +73,18 @@ display_switch(Widget wid, SDL_Renderer *render)
    SDL_RenderCopy(render, toggle_pic, &rect, &rect2);
 }
 
+static int
+changed_switch(Widget wid)
+{
+   struct _switch_t *sw = (struct _switch_t *)wid->data;
+   uint64_t     state = 0;
+
+   if (sw->value != 0) {
+       state = ((*sw->value) >> sw->shift) & 3;
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_switch(Widget wid)
 {
@@ -162,6 +174,7 @@ add_switch_on_off(Panel win, int x, int y, int w, uint32_t *value, int shift)
    nwid->rect.h = 32;
 
    nwid->draw = display_switch;
+   nwid->changed = changed_switch;
    nwid->close = close_switch;
    nwid->click = click_switch;
    nwid->release = release_switch;
@@ -197,6 +210,7 @@ add_switch_momentary(Panel win, int x, int y, int w, uint32_t *value, int shift)
    nwid->rect.h = 32;
 
    nwid->draw = display_switch;
+   nwid->changed = changed_switch;
    nwid->close = close_switch;
    nwid->click = click_switch;
    nwid->release = release_switch;
@@ -232,6 +246,7 @@ add_switch_three(Panel win, int x, int y, int w, uint32_t *value, int shift)
    nwid->rect.h = 32;
 
    nwid->draw = display_switch;
+   nwid->changed = changed_switch;
    nwid->close = close_switch;
    nwid->click = click_switch;
    nwid->release = release_switch;
@@ -461,6 +461,7 @@ set_textbuffer(Widget wid, char *source)
    data->len = strlen(data->text);
    data->cpos = data->len;
    data->cpos_x = text_width(data->text, data->cpos);
+   wid->redraw = 1;
 }
 
 Widget
@@ -83,6 +83,18 @@ display_timer(Widget wid, SDL_Renderer *render)
    }
 }
 
+static int
+changed_timer(Widget wid)
+{
+   struct _timer_t *sw = (struct _timer_t *)wid->data;
+   uint64_t   state = 0;
+
+   if (sw->value != NULL) {
+      state = (*sw->value != 0);
+   }
+   return widget_changed(wid, state);
+}
+
 static void
 close_timer(Widget wid)
 {
@@ -165,6 +177,7 @@ add_timer(Panel win, int x, int y, int h, int w, char *label1, int *value,
    l->rect_off.h = hh;
 
    nwid->draw = display_timer;
+   nwid->changed = changed_timer;
    nwid->close = close_timer;
    nwid->click = click_timer;
    nwid->data = (void *)l;
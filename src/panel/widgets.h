@@ -28,6 +28,7 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <stdint.h>
+#include "machine.h"
 
 struct _labels {
       char       *upper;
@@ -41,11 +42,16 @@ typedef struct _widget_t {
     SDL_Color   *back_color;     /* Background color */
     int         active;          /* Current widget active */
     int         focus;           /* Widget that has focus */
+    int         redraw;          /* Widget must be redrawn */
+    uint64_t    state;           /* State widget was last drawn with */
     void        *data;           /* Private data */
 
     /* Called to draw the image */
     void        (*draw)(struct _widget_t *w, SDL_Renderer *render);
 
+    /* Returns non-zero if widget needs redrawing, NULL if never changes */
+    int         (*changed)(struct _widget_t *w);
+
     /* Called when the control is updated */
     void        (*update)(struct _widget_t *w);
 
@@ -78,13 +84,15 @@ typedef struct _panel_t {
     int         parentID;        /* ID for window that created up */
     void       (*notify_parent_close)(struct _panel_t *panel, int windowID);
     widget     *focus;           /* Window that currently has focus */
+    int         redraw;          /* Whole panel must be redrawn */
+    int         whole;           /* Redraw whole panel on any change */
     SDL_Window *screen;          /* Pointer to screen. */
     SDL_Renderer *render;        /* Pointer to renderer */
 } panel, *Panel;
 
 void run_sim();
 
-extern uint64_t    step_count;
+extern MACHINE_LOCAL uint64_t    step_count;
 
 void SDL_Setup(char *title);
 
@@ -92,7 +100,11 @@ Panel create_window(char *title, int w, int h, int popup);
 
 void add_widget(Panel win, Widget wid);
 
-extern int LAMP_TEST;
+int widget_changed(Widget wid, uint64_t state);
+
+int widget_always(Widget wid);
+
+extern MACHINE_LOCAL int LAMP_TEST;
 
 extern TTF_Font   *font0;
 extern TTF_Font   *font1;
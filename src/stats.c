@@ -0,0 +1,140 @@
+/*
+ * microsim360 - Performance counters.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "logger.h"
+#include "stats.h"
+
+MACHINE_LOCAL struct _stats stats;
+MACHINE_LOCAL char  *stats_file = NULL;
+MACHINE_LOCAL int    stats_period = 5;
+
+static MACHINE_LOCAL time_t    stats_start;   /* Time of first poll */
+static MACHINE_LOCAL time_t    stats_last;    /* Time of last write */
+static MACHINE_LOCAL struct _stats last;      /* Counters at last write */
+static MACHINE_LOCAL uint64_t  last_cycles;   /* Cycles at last write */
+
+static void
+rate(FILE *f, const char *name, uint64_t now, uint64_t then, double secs)
+{
+    fprintf(f, "%s %llu\n", name, (unsigned long long)now);
+    fprintf(f, "%s_per_sec %.0f\n", name,
+            (secs > 0.0) ? (double)(now - then) / secs : 0.0);
+}
+
+/*
+ * Format is a line per counter of a name and a value.  Each counter is
+ * followed by its rate since the last write, with _per_sec added to its
+ * name.  Channel counters have the channel number after the name.
+ */
+void
+stats_write(FILE *f, double secs)
+{
+    int        i;
+
+    fprintf(f, "# microsim360 stats\n");
+    fprintf(f, "uptime %.0f\n", (stats_start == 0) ? 0.0 :
+                               difftime(time(NULL), stats_start));
+    rate(f, "cycles", step_count, last_cycles, secs);
+    rate(f, "insts", stats.insts, last.insts, secs);
+    rate(f, "events_added", stats.events_added, last.events_added, secs);
+    rate(f, "events_fired", stats.events_fired, last.events_fired, secs);
+    for (i = 0; i < STATS_CHANS; i++) {
+        fprintf(f, "chan_bytes %d %llu\n", i,
+                (unsigned long long)stats.chan_bytes[i]);
+        fprintf(f, "chan_bytes_per_sec %d %.0f\n", i, (secs > 0.0) ?
+                (double)(stats.chan_bytes[i] - last.chan_bytes[i]) / secs : 0.0);
+    }
+    rate(f, "dasd_seeks", stats.dasd_seeks, last.dasd_seeks, secs);
+    rate(f, "dasd_reads", stats.dasd_reads, last.dasd_reads, secs);
+    rate(f, "dasd_writes", stats.dasd_writes, last.dasd_writes, secs);
+    rate(f, "tape_reads", stats.tape_reads, last.tape_reads, secs);
+    rate(f, "tape_writes", stats.tape_writes, last.tape_writes, secs);
+    rate(f, "cards_read", stats.cards_read, last.cards_read, secs);
+    rate(f, "cards_stacked", stats.cards_stacked, last.cards_stacked, secs);
+    rate(f, "lines_printed", stats.lines_printed, last.lines_printed, secs);
+}
+
+/* Write to temporary file and rename it, so readers never see part of
+   a write */
+int
+stats_save()
+{
+    FILE      *f;
+    char      *tmp;
+    time_t     now;
+    double     secs;
+
+    if (stats_file == NULL)
+        return 1;
+    now = time(NULL);
+    if (stats_start == 0)
+        stats_start = stats_last = now;
+    secs = difftime(now, stats_last);
+    if ((tmp = (char *)malloc(strlen(stats_file) + 5)) == NULL)
+        return 0;
+    strcpy(tmp, stats_file);
+    strcat(tmp, ".tmp");
+    if ((f = fopen(tmp, "w")) == NULL) {
+        log_error("Unable to create stats %s\n", tmp);
+        free(tmp);
+        return 0;
+    }
+    stats_write(f, secs);
+    fclose(f);
+#ifdef _WIN32
+    (void)remove(stats_file);
+#endif
+    if (rename(tmp, stats_file) != 0) {
+        log_error("Unable to rename stats %s\n", tmp);
+        free(tmp);
+        return 0;
+    }
+    free(tmp);
+    last = stats;
+    last_cycles = step_count;
+    stats_last = now;
+    return 1;
+}
+
+void
+stats_poll()
+{
+    time_t     now;
+
+    if (stats_file == NULL)
+        return;
+    now = time(NULL);
+    if (stats_start == 0) {
+        stats_start = stats_last = now;
+        return;
+    }
+    if (difftime(now, stats_last) >= stats_period)
+        (void)stats_save();
+}
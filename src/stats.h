@@ -0,0 +1,84 @@
+/*
+ * microsim360 - Performance counters.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "device.h"
+#include "machine.h"
+
+/*
+ * Counters of work done by the simulator.  They are always kept, each
+ * costs an increment where the work is done.  CPU cycles are taken
+ * from step_count.
+ *
+ * When stats_file is set the counters are written to it every
+ * stats_period seconds of host time, with rates since the last write,
+ * as lines of a name and a value.
+ */
+
+#define STATS_CHANS     6           /* Channels counted */
+
+struct _stats {
+    uint64_t          insts;        /* S/360 instructions started */
+    uint64_t          events_added; /* Events scheduled */
+    uint64_t          events_fired; /* Events called back */
+    uint64_t          chan_bytes[STATS_CHANS];  /* Bytes over each channel */
+    uint16_t          chan_tags[STATS_CHANS];   /* Last tags on channel */
+    uint64_t          dasd_seeks;   /* Seeks completed */
+    uint64_t          dasd_reads;   /* Tracks read from disk files */
+    uint64_t          dasd_writes;  /* Tracks written to disk files */
+    uint64_t          tape_reads;   /* Tape frames read */
+    uint64_t          tape_writes;  /* Tape frames written */
+    uint64_t          cards_read;   /* Cards read from hopper */
+    uint64_t          cards_stacked;  /* Cards put in stacker */
+    uint64_t          lines_printed;  /* Lines printed */
+};
+
+extern MACHINE_LOCAL struct _stats  stats;
+extern MACHINE_LOCAL char  *stats_file;    /* Where to write counters */
+extern MACHINE_LOCAL int    stats_period;  /* Seconds between writes */
+
+/* Count a byte on channel ch when service out is raised in answer to
+   service in.  Called with the tags going out to the devices */
+#define STATS_CHAN(ch, tags)  do { \
+              if (((tags) & (CHAN_SRV_OUT|CHAN_SRV_IN)) == \
+                          (CHAN_SRV_OUT|CHAN_SRV_IN) && \
+                  (stats.chan_tags[(ch)] & CHAN_SRV_OUT) == 0) \
+                  stats.chan_bytes[(ch)]++; \
+              stats.chan_tags[(ch)] = (tags); } while (0)
+
+/* Write counters if stats_period has passed since last write */
+void stats_poll();
+
+/* Write counters to stats_file now */
+int stats_save();
+
+/* Write counters in f, rates are over secs seconds since last */
+void stats_write(FILE *f, double secs);
+
+#endif
@@ -1,7 +1,7 @@
 /*
- * microsim360 - Test framework caller function.
+ * microsim360 - Instruction timing counters for benchmarks.
  *
- * Copyright 2022, Richard Cornwell
+ * Copyright 2025, Richard Cornwell
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -23,53 +23,28 @@
  *
  */
 
-#include <stdio.h>
-#include "device.h"
-#include "logger.h"
+#ifndef _BENCH_H_
+#define _BENCH_H_
+#include <stdint.h>
+#include <time.h>
 
-#define CTEST_MAIN
-
-//#define CTEST_SEGFAULT
-#define CTEST_NO_COLORS
-
-#include "ctest.h"
-
-uint8_t load_mode;
-
-int SYS_RST;
-int ROAR_RST;
-int START;
-int SET_IC;
-int CHECK_RST;
-int STOP;
-int INT_TMR;
-int STORE;
-int DISPLAY;
-int LAMP_TEST;
-int POWER;
-int INTR;
-int LOAD;
-int timer_event;
-
-uint8_t  A_SW;
-uint8_t  B_SW;
-uint8_t  C_SW;
-uint8_t  D_SW;
-uint8_t  E_SW;
-uint8_t  F_SW;
-uint8_t  G_SW;
-uint8_t  H_SW;
-uint8_t  J_SW;
-
-uint8_t  PROC_SW;
-uint8_t  RATE_SW;
-uint8_t  CHK_SW;
-uint8_t  MATCH_SW;
-
-int main(int argc, const char *argv[])
+/*
+ * Counters kept by test_inst()/test_inst2() of each model, read by the
+ * benchmark driver.
+ */
+extern uint64_t         bench_cycles;   /* Cycles of instructions run */
+extern uint64_t         bench_insts;    /* Instructions run */
+extern uint64_t         bench_ns;       /* Host time running them */
+extern uint64_t         bench_overrun;  /* Runs stopped by cycle limit */
+
+/* Host time in nanoseconds */
+static inline uint64_t
+bench_now()
 {
-    log_level = 0xfff;
-    log_init("debug.log");
-    int result = ctest_main(argc, argv);
-    return result;
+    struct timespec  ts;
+
+    timespec_get(&ts, TIME_UTC);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
 }
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * microsim360 - Instruction timing benchmark.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+/*
+ * Runs the instruction test cases and reports for each one the number of
+ * instructions run by test_inst()/test_inst2(), the micro cycles they
+ * took, and the host time spent stepping those cycles.  Test setup such
+ * as clearing storage is not counted, nor are runs that hit the harness
+ * cycle limit.
+ *
+ *   inst2030_bench [-n repeat] [-j] [-o file] [suite]
+ *
+ * Output is CSV unless -j is given, then JSON.
+ */
+
+#include <stdio.h>
+
+#define CTEST_MAIN
+#define CTEST_NO_COLORS
+
+#include "ctest.h"
+#include "device.h"
+#include "conf.h"
+#include "logger.h"
+#include "bench.h"
+
+extern void init_tests();
+
+
+/* Run one test, return 0 if it failed */
+static int
+run_test(struct ctest *test)
+{
+    ctest_errorbuffer[0] = 0;
+    ctest_errorsize = MSG_SIZE-1;
+    ctest_errormsg = ctest_errorbuffer;
+    if (setjmp(ctest_err) != 0) {
+        return 0;
+    }
+    if (test->setup && *test->setup) (*test->setup)(test->data);
+    if (test->data)
+        test->run.unary(test->data);
+    else
+        test->run.nullary();
+    if (test->teardown && *test->teardown) (*test->teardown)(test->data);
+    return 1;
+}
+
+int
+main(int argc, const char *argv[])
+{
+    struct ctest *begin = &CTEST_IMPL_TNAME(suite, test);
+    struct ctest *end = &CTEST_IMPL_TNAME(suite, test);
+    struct ctest *test;
+    const char   *suite = NULL;
+    FILE         *out = stdout;
+    int           json = 0;
+    int           repeat = 1;
+    int           first = 1;
+    int           ok;
+    int           i;
+
+    for (i = 1; i < argc; i++) {
+       if (strcmp(argv[i], "-j") == 0) {
+           json = 1;
+       } else if (strcmp(argv[i], "-n") == 0 && (i + 1) < argc) {
+           repeat = atoi(argv[++i]);
+           if (repeat < 1)
+               repeat = 1;
+       } else if (strcmp(argv[i], "-o") == 0 && (i + 1) < argc) {
+           if ((out = fopen(argv[++i], "w")) == NULL) {
+               fprintf(stderr, "Unable to open %s\n", argv[i]);
+               return 1;
+           }
+       } else {
+           suite = argv[i];
+       }
+    }
+
+    /* Find test cases, same way ctest_main does */
+    while ((begin - 1)->magic == CTEST_IMPL_MAGIC)
+        begin--;
+    while ((end + 1)->magic == CTEST_IMPL_MAGIC)
+        end++;
+    end++;
+
+    init_tests();
+    if (json) {
+        fprintf(out, "[\n");
+    } else {
+        fprintf(out, "model,suite,test,instructions,cycles,cpi,host_ns,ns_per_cycle\n");
+    }
+    for (test = begin; test != end; test++) {
+        if (test == &CTEST_IMPL_TNAME(suite, test) || test->skip)
+            continue;
+        if (suite != NULL && strncmp(suite, test->ssname, strlen(suite)) != 0)
+            continue;
+        bench_cycles = 0;
+        bench_insts = 0;
+        bench_ns = 0;
+        bench_overrun = 0;
+        ok = 1;
+        for (i = 0; i < repeat && ok; i++) {
+            ok = run_test(test);
+        }
+        /* Only tests which run instructions through test_inst are timed */
+        if (bench_insts == 0 || bench_cycles == 0)
+            continue;
+        if (bench_overrun != 0) {
+            fprintf(stderr, "%s:%s %llu runs hit the cycle limit, not counted\n",
+                          test->ssname, test->ttname,
+                          (unsigned long long)bench_overrun);
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%s failed, timing is partial\n", test->ssname,
+                          test->ttname);
+        }
+        if (json) {
+            fprintf(out, "%s  {\"model\": \"%s\", \"suite\": \"%s\", \"test\": \"%s\", "
+                         "\"instructions\": %llu, \"cycles\": %llu, \"cpi\": %.3f, "
+                         "\"host_ns\": %llu, \"ns_per_cycle\": %.3f}",
+                    first ? "" : ",\n", BENCH_MODEL, test->ssname, test->ttname,
+                    (unsigned long long)bench_insts,
+                    (unsigned long long)bench_cycles,
+                    (double)bench_cycles / (double)bench_insts,
+                    (unsigned long long)bench_ns,
+                    (double)bench_ns / (double)bench_cycles);
+        } else {
+            fprintf(out, "%s,%s,%s,%llu,%llu,%.3f,%llu,%.3f\n",
+                    BENCH_MODEL, test->ssname, test->ttname,
+                    (unsigned long long)bench_insts,
+                    (unsigned long long)bench_cycles,
+                    (double)bench_cycles / (double)bench_insts,
+                    (unsigned long long)bench_ns,
+                    (double)bench_ns / (double)bench_cycles);
+        }
+        first = 0;
+    }
+    if (json) {
+        fprintf(out, "\n]\n");
+    }
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
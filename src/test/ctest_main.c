@@ -24,6 +24,9 @@
  */
 
 #include <stdio.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
 
 #define CTEST_MAIN
 //#ifndef _WIN32
@@ -43,6 +46,250 @@ extern char *test_log_level;
 
 extern int       verbose;
 
+#ifndef _WIN32
+/*
+ * Parallel runner.
+ *
+ * The tests share the simulated machine, so they can't run as threads.
+ * Instead fork one worker per job, each calls init_tests() on its own
+ * copy of the globals and runs its share of the tests in order.  Tests
+ * within a suite may rely on state left by the ones before, so a suite
+ * is never split between workers; the largest suites are handed out
+ * first to the worker with the fewest tests.  Results are written to a
+ * temporary file per worker, and printed in test order once all workers
+ * have finished.
+ */
+
+#define RES_OK      0
+#define RES_FAIL    1
+#define RES_SKIP    2
+
+struct _result {
+    int         index;         /* Test number */
+    int         status;        /* RES_OK/RES_FAIL/RES_SKIP */
+    uint64_t    usec;          /* Time test took */
+    int         len;           /* Length of error text following */
+};
+
+/* Run one test in worker, write result to file */
+static void
+worker_test(struct ctest *test, int index, FILE *res)
+{
+    struct _result   r;
+    uint64_t         t1;
+
+    ctest_errorbuffer[0] = 0;
+    ctest_errorsize = MSG_SIZE-1;
+    ctest_errormsg = ctest_errorbuffer;
+    r.index = index;
+    r.status = RES_SKIP;
+    t1 = getCurrentTime();
+    if (!test->skip) {
+        if (setjmp(ctest_err) == 0) {
+            if (test->setup && *test->setup) (*test->setup)(test->data);
+            if (test->data)
+                test->run.unary(test->data);
+            else
+                test->run.nullary();
+            if (test->teardown && *test->teardown) (*test->teardown)(test->data);
+            r.status = RES_OK;
+        } else {
+            r.status = RES_FAIL;
+        }
+    }
+    r.usec = getCurrentTime() - t1;
+    r.len = (ctest_errorsize != MSG_SIZE-1) ? strlen(ctest_errorbuffer) : 0;
+    fwrite(&r, sizeof(r), 1, res);
+    fwrite(ctest_errorbuffer, 1, r.len, res);
+    /* Keep results of finished tests if a later one crashes the worker */
+    fflush(res);
+}
+
+static int
+run_parallel(int jobs, const char *suite)
+{
+    struct ctest  *begin = &CTEST_IMPL_TNAME(suite, test);
+    struct ctest  *end = &CTEST_IMPL_TNAME(suite, test);
+    struct ctest  *test;
+    struct ctest **list;
+    int           *size;
+    int           *owner;
+    int           *load;
+    struct _result r;
+    FILE         **res;
+    pid_t         *pid;
+    int           *status;
+    uint64_t      *usec;
+    char         **msg;
+    int            total = 0;
+    int            num_ok = 0;
+    int            num_fail = 0;
+    int            num_skip = 0;
+    int            wstat;
+    int            suites = 0;
+    int            i, j, w;
+    uint64_t       t1, t2;
+
+    t1 = getCurrentTime();
+    while ((begin - 1)->magic == CTEST_IMPL_MAGIC)
+        begin--;
+    while ((end + 1)->magic == CTEST_IMPL_MAGIC)
+        end++;
+    end++;
+
+    list = (struct ctest **)calloc(end - begin, sizeof(struct ctest *));
+    for (test = begin; test != end; test++) {
+        if (test == &CTEST_IMPL_TNAME(suite, test))
+            continue;
+        if (suite != NULL && strncmp(suite, test->ssname, strlen(suite)) != 0)
+            continue;
+        list[total++] = test;
+    }
+
+    /* Size of each suite, kept on its first test */
+    size = (int *)calloc(total + 1, sizeof(int));
+    owner = (int *)calloc(total + 1, sizeof(int));
+    for (i = 0; i < total; i++) {
+        for (j = 0; j < i; j++) {
+            if (strcmp(list[i]->ssname, list[j]->ssname) == 0)
+                break;
+        }
+        if (j == i)
+            suites++;
+        size[j]++;
+        owner[i] = -1;
+    }
+    if (jobs > suites)
+        jobs = suites;
+    if (jobs < 1)
+        jobs = 1;
+
+    /* Give biggest remaining suite to least loaded worker */
+    load = (int *)calloc(jobs, sizeof(int));
+    while (1) {
+        for (j = -1, i = 0; i < total; i++) {
+            if (owner[i] < 0 && size[i] != 0 && (j < 0 || size[i] > size[j]))
+                j = i;
+        }
+        if (j < 0)
+            break;
+        for (w = 0, i = 1; i < jobs; i++) {
+            if (load[i] < load[w])
+                w = i;
+        }
+        load[w] += size[j];
+        for (i = j; i < total; i++) {
+            if (strcmp(list[i]->ssname, list[j]->ssname) == 0)
+                owner[i] = w;
+        }
+    }
+
+    res = (FILE **)calloc(jobs, sizeof(FILE *));
+    pid = (pid_t *)calloc(jobs, sizeof(pid_t));
+    status = (int *)calloc(total + 1, sizeof(int));
+    usec = (uint64_t *)calloc(total + 1, sizeof(uint64_t));
+    msg = (char **)calloc(total + 1, sizeof(char *));
+
+    fflush(stdout);
+    for (w = 0; w < jobs; w++) {
+        if ((res[w] = tmpfile()) == NULL || (pid[w] = fork()) < 0) {
+            fprintf(stderr, "Unable to start worker %d\n", w);
+            exit(1);
+        }
+        if (pid[w] == 0) {
+            init_tests();
+            for (i = 0; i < total; i++) {
+                if (owner[i] == w)
+                    worker_test(list[i], i, res[w]);
+            }
+            fflush(stdout);
+            _exit(0);
+        }
+    }
+
+    /* Collect results, anything not reported failed */
+    for (i = 0; i < total; i++)
+        status[i] = -1;
+    for (w = 0; w < jobs; w++) {
+        waitpid(pid[w], &wstat, 0);
+        rewind(res[w]);
+        while (fread(&r, sizeof(r), 1, res[w]) == 1) {
+            if (r.index < 0 || r.index >= total || r.len < 0)
+                break;
+            status[r.index] = r.status;
+            usec[r.index] = r.usec;
+            if (r.len != 0) {
+                msg[r.index] = (char *)calloc(r.len + 1, 1);
+                if (fread(msg[r.index], 1, r.len, res[w]) != (size_t)r.len)
+                    break;
+            }
+        }
+        fclose(res[w]);
+        if (WIFSIGNALED(wstat)) {
+            for (i = 0; i < total; i++) {
+                if (owner[i] == w && status[i] < 0) {
+                    status[i] = RES_FAIL;
+                    msg[i] = (char *)calloc(80, 1);
+                    snprintf(msg[i], 80, "[Worker killed by signal %d]\n",
+                             WTERMSIG(wstat));
+                    break;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < total; i++) {
+        printf("TEST %d/%d %s:%s ", i + 1, total, list[i]->ssname, list[i]->ttname);
+        switch (status[i]) {
+        case RES_OK:
+             printf("[OK]");
+             num_ok++;
+             break;
+        case RES_SKIP:
+             printf("[SKIPPED]");
+             num_skip++;
+             break;
+        case RES_FAIL:
+             printf("[FAIL]");
+             num_fail++;
+             break;
+        default:
+             printf("[NOT RUN]");
+             num_fail++;
+             break;
+        }
+        if (verbose && status[i] >= 0)
+            printf(" %" PRIu64 " us", usec[i]);
+        printf("\n");
+        if (msg[i] != NULL) {
+            printf("%s", msg[i]);
+            free(msg[i]);
+        }
+    }
+    t2 = getCurrentTime();
+    printf("RESULTS: %d tests (%d ok, %d failed, %d skipped) ran in %" PRIu64
+           " ms on %d workers\n", total, num_ok, num_fail, num_skip,
+           (t2 - t1)/1000, jobs);
+    free(list);
+    free(size);
+    free(owner);
+    free(load);
+    free(res);
+    free(pid);
+    free(status);
+    free(usec);
+    free(msg);
+    return num_fail;
+}
+#endif
+
+/*
+ * Options:
+ *   -d       Enable debug log.
+ *   -v       Verbose output.
+ *   -j [n]   Run tests in n worker processes, default one per core.
+ *   suite    Only run tests whose suite starts with this.
+ */
 int
 main(int argc, const char *argv[])
 {
@@ -50,8 +297,10 @@ main(int argc, const char *argv[])
     const char  *args[2];
     int          arg_cnt;
     int          result;
+    int          jobs = 0;
     char         buffer[1024];
     args[0] = argv[0];
+    args[1] = NULL;
     arg_cnt = 1;
     for (i = 1; i < argc; i++) {
        if (strcmp(argv[i], "-d") == 0) {
@@ -61,12 +310,25 @@ main(int argc, const char *argv[])
            log_enable = 1;
        } else if (strcmp(argv[i], "-v") == 0) {
            verbose = 1;
+       } else if (strcmp(argv[i], "-j") == 0) {
+           jobs = -1;
+           if ((i + 1) < argc && argv[i+1][0] >= '0' && argv[i+1][0] <= '9') {
+               jobs = atoi(argv[++i]);
+           }
        } else {
            arg_cnt = 2;
            args[1] = argv[i];
        }
     }
 
+#ifndef _WIN32
+    if (jobs < 0) {
+        jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (jobs > 1) {
+        return run_parallel(jobs, args[1]);
+    }
+#endif
     init_tests();
     result = ctest_main(arg_cnt, args);
     return result;
@@ -35,7 +35,7 @@
 #include "test_chan.h"
 #include "test_device.h"
 
-uint64_t  step_count;
+MACHINE_LOCAL uint64_t  step_count;
 
 int       verbose = 0;
 
@@ -27,7 +27,7 @@
 #include "device.h"
 #include "event.h"
 
-uint64_t   step_count;
+MACHINE_LOCAL uint64_t   step_count;
 
 int        a_time;
 int        b_time;
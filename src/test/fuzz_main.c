@@ -0,0 +1,673 @@
+/*
+ * microsim360 - Coverage guided instruction fuzzer.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+/*
+ * Runs random instruction streams on one model, one instruction at a
+ * time, and records which ROS words each instruction executed.
+ *
+ *   fuzz [-m 2030|2050] [-n cases] [-i insts] [-s seed] [-B]
+ *        [-o file] [-r file] [-v]
+ *
+ * Generation is steered toward microcode not yet seen: every opcode has
+ * a weight that grows each time it reaches new ROS words and decays while
+ * it finds nothing, and instructions that found new words are kept and
+ * mutated to make later ones.
+ *
+ * Each instruction that reaches new words is minimised: it is moved to
+ * 0x400 with only its operands in storage, then registers and storage
+ * words are cleared one at a time while it still reaches the same words.
+ * With -o the result is written as a test in inst_test_cases.h form,
+ * asserting what the model did.  The coverage report, with the used ROS
+ * words never reached, goes to stdout or the -r file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lockstep.h"
+#include "inst_gen.h"
+#include "machine.h"
+
+#define PROG_ADDR       0x400      /* Where instruction stream is placed */
+#define PROG_MAX        0x300      /* Largest stream */
+#define DATA_ADDR       0x1000     /* Operands are placed here */
+#define DATA_SIZE       0x7000
+#define TEST_CLEAR      0x1000     /* init_cpu() clears storage below */
+#define MAX_CORPUS      1024       /* Instructions kept for mutation */
+#define MAX_RANGE       3          /* Storage operands per instruction */
+#define W_START         32         /* Starting opcode weight */
+#define W_MAX           4096
+
+#define MAP_SIZE        (LS_ROS_SIZE / 8)
+
+struct _range {
+    uint32_t    addr;
+    uint32_t    len;
+};
+
+MACHINE_LOCAL uint64_t         step_count;                /* Used by logger */
+uint8_t          lockstep_cover[MAP_SIZE];
+
+static struct lockstep_model *model = &lockstep_2030;
+static int       ninst = 8;
+static int       classes = C_ALL;
+static int       verbose = 0;
+static uint64_t  seed = 1;
+static FILE     *cases = NULL;              /* Reproducers written here */
+static int       ncases = 0;
+static int       nfail = 0;                 /* Finds that did not minimise */
+static uint64_t  insts = 0;
+
+static uint8_t   total[MAP_SIZE];           /* Words seen so far */
+static uint32_t *weight;
+static uint64_t *tries;
+static uint64_t *found;
+static uint8_t   corpus[MAX_CORPUS][6];
+static int       ncorpus = 0;
+
+static uint8_t   mem[LS_MEM_SIZE];
+static uint8_t   pre[LS_MEM_SIZE];
+static uint8_t   post[LS_MEM_SIZE];
+static uint8_t   mini[LS_MEM_SIZE];
+static uint8_t   after[LS_MEM_SIZE];
+
+static int
+count_bits(uint8_t *map)
+{
+    int     n = 0;
+    int     i;
+
+    for (i = 0; i < MAP_SIZE; i++) {
+        n += __builtin_popcount(map[i]);
+    }
+    return n;
+}
+
+/* Set want to words in lockstep_cover not seen before, return count */
+static int
+new_words(uint8_t *want)
+{
+    int     i;
+
+    for (i = 0; i < MAP_SIZE; i++) {
+        want[i] = lockstep_cover[i] & ~total[i];
+    }
+    return count_bits(want);
+}
+
+/* Did the last step reach every word in want */
+static int
+covers(uint8_t *want)
+{
+    int     i;
+
+    for (i = 0; i < MAP_SIZE; i++) {
+        if ((lockstep_cover[i] & want[i]) != want[i])
+            return 0;
+    }
+    return 1;
+}
+
+static uint32_t
+get_word(uint8_t *m, int a)
+{
+    return ((uint32_t)m[a] << 24) | ((uint32_t)m[a+1] << 16) |
+           ((uint32_t)m[a+2] << 8) | (uint32_t)m[a+3];
+}
+
+/* Fill data area, each block gets data some instruction class likes */
+static void
+fill_data(uint64_t *r)
+{
+    static const uint32_t edge[] = {
+         0, 1, 0xffffffff, 0x7fffffff, 0x80000000, 0x0000ffff, 0xffff8000
+    };
+    int     i, j;
+    uint8_t d;
+
+    for (i = DATA_ADDR; i < DATA_ADDR + DATA_SIZE; i += 256) {
+        switch (inst_rand(r) % 5) {
+        case 0:     /* Random bytes */
+             for (j = 0; j < 256; j++)
+                 mem[i+j] = inst_rand(r) & 0xff;
+             break;
+        case 1:     /* Packed decimal, sign every 8 bytes */
+             for (j = 0; j < 256; j++) {
+                 d = ((inst_rand(r) % 10) << 4) | (inst_rand(r) % 10);
+                 if ((j & 7) == 7)
+                     d = (d & 0xf0) | (0xC + (inst_rand(r) & 1));
+                 mem[i+j] = d;
+             }
+             break;
+        case 2:     /* Zoned decimal */
+             for (j = 0; j < 256; j++)
+                 mem[i+j] = 0xF0 | (inst_rand(r) % 10);
+             break;
+        case 3:     /* Edge case words */
+             for (j = 0; j < 256; j += 4) {
+                 uint32_t w = edge[inst_rand(r) % (sizeof(edge)/sizeof(edge[0]))];
+                 mem[i+j] = w >> 24;
+                 mem[i+j+1] = (w >> 16) & 0xff;
+                 mem[i+j+2] = (w >> 8) & 0xff;
+                 mem[i+j+3] = w & 0xff;
+             }
+             break;
+        case 4:     /* Normalized floating point */
+             for (j = 0; j < 256; j++)
+                 mem[i+j] = inst_rand(r) & 0xff;
+             for (j = 0; j < 256; j += 8) {
+                 mem[i+j] = (mem[i+j] & 0x80) | (0x3c + (inst_rand(r) % 8));
+                 mem[i+j+1] |= 0x10;
+             }
+             break;
+        }
+    }
+}
+
+static uint32_t
+address(uint32_t *gpr, int x, int b, int d)
+{
+    uint32_t   a = d;
+
+    if (x != 0)
+        a += gpr[x];
+    if (b != 0)
+        a += gpr[b];
+    return a & 0xffffff;
+}
+
+/* Storage the instruction at p can read, return number of ranges */
+static int
+operands(uint8_t *p, uint32_t *gpr, struct _range *rng)
+{
+    int     r1 = p[1] >> 4;
+    int     r2 = p[1] & 0xf;
+    int     d1 = ((p[2] & 0xf) << 8) | p[3];
+    int     d2 = ((p[4] & 0xf) << 8) | p[5];
+
+    if (p[0] < 0x40)
+        return 0;
+    if (p[0] < 0x80) {
+        rng[0].addr = address(gpr, r2, p[2] >> 4, d1);
+        switch (p[0]) {
+        case 0x41: case 0x45: case 0x46: case 0x47:
+             return 0;
+        case 0x42: case 0x43:
+             rng[0].len = 1;
+             break;
+        case 0x40: case 0x48: case 0x49: case 0x4A: case 0x4B: case 0x4C:
+             rng[0].len = 2;
+             break;
+        default:
+             rng[0].len = (p[0] == 0x4E || p[0] == 0x4F ||
+                           (p[0] >= 0x60 && p[0] < 0x70)) ? 8 : 4;
+             break;
+        }
+        return 1;
+    }
+    if (p[0] < 0xC0) {
+        rng[0].addr = address(gpr, 0, p[2] >> 4, d1);
+        if (p[0] == 0x90 || p[0] == 0x98) {
+            rng[0].len = 4 * (((r2 - r1) & 0xf) + 1);
+            return 1;
+        }
+        if (p[0] >= 0x91 && p[0] <= 0x97) {
+            rng[0].len = 1;
+            return 1;
+        }
+        return 0;
+    }
+    rng[0].addr = address(gpr, 0, p[2] >> 4, d1);
+    rng[1].addr = address(gpr, 0, p[4] >> 4, d2);
+    if (p[0] >= 0xF0) {
+        rng[0].len = r1 + 1;
+        rng[1].len = r2 + 1;
+    } else {
+        rng[0].len = rng[1].len = p[1] + 1;
+        /* Translate table */
+        if (p[0] == 0xDC || p[0] == 0xDD)
+            rng[1].len = 256;
+    }
+    return 2;
+}
+
+/* General registers the instruction at p uses, a base or index of 0 is
+   not a register */
+static uint16_t
+reg_mask(uint8_t *p)
+{
+    struct inst_op *op = inst_find(p[0]);
+    int             r1 = p[1] >> 4;
+    int             r2 = p[1] & 0xf;
+    uint16_t        m = 0;
+    int             i;
+
+    if (op == NULL)
+        return 0;
+    switch (op->fmt) {
+    case F_RR:
+        if (op->cls != C_FLT)
+            m = (3 << (r1 & 0xe)) | (3 << (r2 & 0xe));
+        break;
+    case F_RX:
+        if (op->cls != C_FLT)
+            m = 3 << (r1 & 0xe);
+        m |= ((1 << r2) | (1 << (p[2] >> 4))) & 0xfffe;
+        break;
+    case F_RS:
+        m = (3 << (r1 & 0xe)) | (3 << (r2 & 0xe)) | ((1 << (p[2] >> 4)) & 0xfffe);
+        for (i = r1; p[0] == 0x90 || p[0] == 0x98; i = (i + 1) & 0xf) {
+            m |= 1 << i;
+            if (i == r2)
+                break;
+        }
+        break;
+    case F_SI:
+        m = (1 << (p[2] >> 4)) & 0xfffe;
+        break;
+    case F_SS:
+        m = ((1 << (p[2] >> 4)) | (1 << (p[4] >> 4))) & 0xfffe;
+        if (p[0] == 0xDD || p[0] == 0xDF)
+            m |= 6;
+        break;
+    }
+    return m;
+}
+
+/* Load state and storage, then run one instruction */
+static void
+run(struct lockstep_state *st, uint8_t *image)
+{
+    memset(lockstep_cover, 0, sizeof(lockstep_cover));
+    model->load(st, image, LS_MEM_SIZE);
+    model->step(st);
+}
+
+/* Does the instruction at PROG_ADDR in mini still reach want from ms */
+static int
+reaches(struct lockstep_state *ms, uint8_t *want)
+{
+    struct lockstep_state  t = *ms;
+    struct inst_op        *op = inst_find(mini[PROG_ADDR]);
+
+    run(&t, mini);
+    if (t.hung || !covers(want))
+        return 0;
+    /* test_inst() stops before fetching at the branch address, so
+       can't see a trap there */
+    if (t.trap && op != NULL && op->cls == C_BR)
+        return 0;
+    return 1;
+}
+
+/*
+ * Move instruction p to PROG_ADDR with only its operands from img, then
+ * clear what is not needed to reach the words in want.  Result is left
+ * in ms and mini, return 0 if the words are not reached.
+ */
+static int
+minimise(struct lockstep_state *st, uint8_t *img, uint8_t *p, uint8_t *want,
+         struct lockstep_state *ms)
+{
+    struct _range          rng[MAX_RANGE];
+    uint64_t               fsave;
+    uint32_t               a, save;
+    uint8_t                w[4];
+    int                    n, i;
+
+    memset(mini, 0, sizeof(mini));
+    n = operands(p, st->gpr, rng);
+    for (i = 0; i < n; i++) {
+        for (a = rng[i].addr & ~3; a < rng[i].addr + rng[i].len && a < LS_MEM_SIZE; a++)
+            mini[a] = img[a];
+    }
+    memcpy(&mini[PROG_ADDR], p, inst_length(p[0]));
+    *ms = *st;
+    ms->ia = PROG_ADDR;
+    if (!reaches(ms, want))
+        return 0;
+
+    for (i = 0; i < 16; i++) {
+        if ((save = ms->gpr[i]) == 0)
+            continue;
+        ms->gpr[i] = 0;
+        if (!reaches(ms, want))
+            ms->gpr[i] = save;
+    }
+    for (i = 0; i < 4; i++) {
+        if ((fsave = ms->fpr[i]) == 0)
+            continue;
+        ms->fpr[i] = 0;
+        if (!reaches(ms, want))
+            ms->fpr[i] = fsave;
+    }
+    if ((save = ms->pm) != 0) {
+        ms->pm = 0;
+        if (!reaches(ms, want))
+            ms->pm = save;
+    }
+    for (a = 0; a < LS_MEM_SIZE; a += 4) {
+        if (a >= PROG_ADDR && a < PROG_ADDR + 8)
+            continue;
+        if (get_word(mini, a) == 0)
+            continue;
+        memcpy(w, &mini[a], 4);
+        memset(&mini[a], 0, 4);
+        if (!reaches(ms, want))
+            memcpy(&mini[a], w, 4);
+    }
+    return 1;
+}
+
+/* Write minimised instruction as a test case */
+static void
+emit(struct lockstep_state *ms, uint8_t *p, uint64_t n, int j, int words)
+{
+    static const char *cc_name[4] = { "CC0", "CC1", "CC2", "CC3" };
+    struct lockstep_state  t = *ms;
+    struct _range          rng[MAX_RANGE];
+    struct inst_op        *op = inst_find(p[0]);
+    uint16_t               regs = reg_mask(p);
+    char                   text[64];
+    uint32_t               a, w;
+    int                    nr, i, keep;
+
+    run(&t, mini);
+    model->save_mem(after, LS_MEM_SIZE);
+    nr = operands(p, ms->gpr, rng);
+    inst_format(p, text, sizeof(text));
+
+    fprintf(cases, "\n  /* %s, seed %llu case %llu instruction %d, %d new ROS words */\n",
+            text, (unsigned long long)seed, (unsigned long long)n, j, words);
+    fprintf(cases, "  CTEST(fuzz%s, case_%d) {\n", model->name, ncases++);
+    fprintf(cases, "      init_cpu();\n");
+    fprintf(cases, "      set_mem(0x%x, 0x%08x); /* %s */\n", PROG_ADDR,
+            get_word(mini, PROG_ADDR), text);
+    fprintf(cases, "      set_mem(0x%x, 0x%08x);\n", PROG_ADDR + 4,
+            get_word(mini, PROG_ADDR + 4));
+    for (a = 0; a < LS_MEM_SIZE; a += 4) {
+        if (a >= PROG_ADDR && a < PROG_ADDR + 8)
+            continue;
+        /* Storage above TEST_CLEAR may hold data from earlier tests */
+        keep = get_word(mini, a) != 0;
+        for (i = 0; i < nr && a >= TEST_CLEAR; i++) {
+            if (a + 4 > rng[i].addr && a < rng[i].addr + rng[i].len)
+                keep = 1;
+        }
+        if (keep)
+            fprintf(cases, "      set_mem(0x%x, 0x%08x);\n", a, get_word(mini, a));
+    }
+    for (i = 0; i < 16; i++) {
+        if (ms->gpr[i] != 0 || (regs & (1 << i)))
+            fprintf(cases, "      set_reg(%d, 0x%08x);\n", i, ms->gpr[i]);
+    }
+    for (i = 0; op != NULL && op->cls == C_FLT && i < 4; i++) {
+        fprintf(cases, "      set_fpreg_d(%d, 0x%016llxLL);\n", i * 2,
+                (unsigned long long)ms->fpr[i]);
+    }
+    fprintf(cases, "      set_cc(%s);\n", cc_name[ms->cc & 3]);
+    fprintf(cases, "      test_inst(0x%x);\n", ms->pm);
+    if (t.trap)
+        fprintf(cases, "      ASSERT_TRUE(trap_flag);\n");
+    else
+        fprintf(cases, "      ASSERT_FALSE(trap_flag);\n");
+    for (i = 0; i < 16; i++) {
+        if (t.gpr[i] != ms->gpr[i])
+            fprintf(cases, "      ASSERT_EQUAL_X(0x%08x, get_reg(%d));\n", t.gpr[i], i);
+    }
+    for (i = 0; i < 4; i++) {
+        if (t.fpr[i] != ms->fpr[i])
+            fprintf(cases, "      ASSERT_EQUAL_X(0x%016llxLL, get_fpreg_d(%d));\n",
+                    (unsigned long long)t.fpr[i], i * 2);
+    }
+    for (a = 0; a < LS_MEM_SIZE; a += 4) {
+        /* Interval timer */
+        if (a == 0x50)
+            continue;
+        if ((w = get_word(after, a)) != get_word(mini, a))
+            fprintf(cases, "      ASSERT_EQUAL_X(0x%08x, get_mem(0x%x));\n", w, a);
+    }
+    fprintf(cases, "      ASSERT_EQUAL(%s, CC_REG);\n", cc_name[t.cc & 3]);
+    fprintf(cases, "      ASSERT_EQUAL_X(0x%x, IAR);\n", t.ia);
+    fprintf(cases, "  }\n");
+    fflush(cases);
+}
+
+/* Make instruction at p from one that found new words */
+static int
+mutate(uint64_t *r, uint8_t *p)
+{
+    uint8_t  *c = corpus[inst_rand(r) % ncorpus];
+    int       len = inst_length(c[0]);
+    int       i = 1 + (inst_rand(r) % (len - 1));
+
+    memcpy(p, c, len);
+    switch (inst_rand(r) & 3) {
+    case 0:  p[i] = inst_rand(r) & 0xff; break;
+    case 1:  p[i] ^= 1 << (inst_rand(r) & 7); break;
+    case 2:  p[i] ^= 0x0f << ((inst_rand(r) & 1) * 4); break;
+    case 3:  p[i] = (p[i] << 4) | (p[i] >> 4); break;
+    }
+    if (len == 6 && (p[0] & 0xF0) == 0xD0)
+        p[1] &= 0x3f;
+    return len;
+}
+
+static void
+run_case(uint64_t n)
+{
+    struct lockstep_state  st, before, ms;
+    struct inst_op        *op;
+    uint8_t                want[MAP_SIZE];
+    uint8_t                p[6];
+    uint64_t               r = (seed * 0x9E3779B97F4A7C15ULL) ^ (n + 1);
+    int                    len = 0;
+    int                    words;
+    int                    i, j, k;
+
+    if (r == 0)
+       r = 1;
+    for (i = 0; i < 4; i++)
+       inst_rand(&r);
+    memset(mem, 0, sizeof(mem));
+    memset(&st, 0, sizeof(st));
+    fill_data(&r);
+    for (i = 0; i < ninst && len < (PROG_MAX - 6); i++) {
+        if (ncorpus > 0 && (inst_rand(&r) & 3) == 0)
+            len += mutate(&r, &mem[PROG_ADDR + len]);
+        else
+            len += inst_gen(&r, classes, weight, &mem[PROG_ADDR + len]);
+    }
+    for (i = 0; i < 16; i++) {
+        if ((inst_rand(&r) & 3) == 0) {
+            st.gpr[i] = (uint32_t)inst_rand(&r);
+        } else {
+            st.gpr[i] = DATA_ADDR + (inst_rand(&r) % 0x3000);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        st.fpr[i] = inst_rand(&r);
+    }
+    st.cc = inst_rand(&r) & 3;
+    st.pm = inst_rand(&r) & 0xf;
+    st.ia = PROG_ADDR;
+
+    model->load(&st, mem, LS_MEM_SIZE);
+    for (j = 0; j < ninst; j++) {
+        before = st;
+        model->save_mem(pre, LS_MEM_SIZE);
+        for (i = 0; i < 6; i++)
+            p[i] = pre[(before.ia + i) & (LS_MEM_SIZE - 1)];
+        memset(lockstep_cover, 0, sizeof(lockstep_cover));
+        model->step(&st);
+        insts++;
+        words = new_words(want);
+        for (i = 0; i < MAP_SIZE; i++)
+            total[i] |= lockstep_cover[i];
+        op = inst_find(p[0]);
+        k = (op == NULL) ? -1 : (int)(op - inst_ops);
+        if (k >= 0)
+            tries[k]++;
+        if (words == 0) {
+            if (k >= 0 && weight[k] > 1)
+                weight[k]--;
+        } else {
+            if (k >= 0) {
+                found[k] += words;
+                weight[k] = (weight[k] + W_START > W_MAX) ? W_MAX : weight[k] + W_START;
+                if (ncorpus < MAX_CORPUS)
+                    memcpy(corpus[ncorpus++], p, 6);
+            }
+            if (verbose) {
+                char   text[64];
+
+                inst_format(p, text, sizeof(text));
+                printf("Case %llu instruction %d: %s, %d new words\n",
+                       (unsigned long long)n, j, text, words);
+            }
+            if (cases != NULL && !st.hung) {
+                /* Minimising disturbs the model, put it back after */
+                model->save_mem(post, LS_MEM_SIZE);
+                if (minimise(&before, pre, p, want, &ms))
+                    emit(&ms, p, n, j, words);
+                else
+                    nfail++;
+                model->load(&st, post, LS_MEM_SIZE);
+            }
+        }
+        /* Stop on interrupt, or leaving the stream */
+        if (st.trap || st.hung || st.ia < PROG_ADDR || st.ia >= (uint32_t)(PROG_ADDR + len))
+            break;
+    }
+}
+
+/* Coverage totals, per opcode finds and the used words not reached */
+static void
+report(FILE *f)
+{
+    int     used = 0;
+    int     seen = 0;
+    int     a, b, i;
+
+    for (a = 0; a < LS_ROS_SIZE; a++) {
+        if (model->note(a) == NULL)
+            continue;
+        used++;
+        if (total[a >> 3] & (1 << (a & 7)))
+            seen++;
+    }
+    fprintf(f, "ROS coverage %s: %d of %d used words (%.1f%%), %d words in all\n",
+            model->name, seen, used, used ? (100.0 * seen) / used : 0.0,
+            count_bits(total));
+    fprintf(f, "%llu instructions, %d reproducers, %d not minimised\n\n",
+            (unsigned long long)insts, ncases, nfail);
+    fprintf(f, "Opcode      tries  new words\n");
+    for (i = 0; i < inst_num_ops; i++) {
+        if (tries[i] == 0)
+            continue;
+        fprintf(f, "%02X %-6s %8llu %10llu\n", inst_ops[i].op, inst_ops[i].name,
+                (unsigned long long)tries[i], (unsigned long long)found[i]);
+    }
+    fprintf(f, "\nUnvisited used words:\n");
+    for (a = 0; a < LS_ROS_SIZE; a = b) {
+        b = a + 1;
+        if (model->note(a) == NULL || (total[a >> 3] & (1 << (a & 7))))
+            continue;
+        while (b < LS_ROS_SIZE && model->note(b) != NULL &&
+               (total[b >> 3] & (1 << (b & 7))) == 0)
+            b++;
+        fprintf(f, "  %03X-%03X %4d  %s\n", a, b - 1, b - a, model->note(a));
+    }
+}
+
+int
+main(int argc, const char *argv[])
+{
+    uint64_t        ncase = 1000;
+    uint64_t        n;
+    FILE           *rep = stdout;
+    int             i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "-B") == 0) {
+            classes &= ~C_BR;
+        } else if ((i + 1) < argc && strcmp(argv[i], "-m") == 0) {
+            i++;
+            if (strcmp(argv[i], "2030") == 0) {
+                model = &lockstep_2030;
+            } else if (strcmp(argv[i], "2050") == 0) {
+                model = &lockstep_2050;
+            } else {
+                fprintf(stderr, "Unknown model %s\n", argv[i]);
+                return 1;
+            }
+        } else if ((i + 1) < argc && strcmp(argv[i], "-n") == 0) {
+            ncase = strtoull(argv[++i], NULL, 0);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-i") == 0) {
+            ninst = atoi(argv[++i]);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-s") == 0) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-o") == 0) {
+            if ((cases = fopen(argv[++i], "w")) == NULL) {
+                fprintf(stderr, "Unable to create %s\n", argv[i]);
+                return 1;
+            }
+        } else if ((i + 1) < argc && strcmp(argv[i], "-r") == 0) {
+            if ((rep = fopen(argv[++i], "w")) == NULL) {
+                fprintf(stderr, "Unable to create %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [-m 2030|2050] [-n cases] [-i insts] "
+                            "[-s seed] [-B] [-o file] [-r file] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (ninst < 1)
+        ninst = 1;
+
+    weight = (uint32_t *)calloc(inst_num_ops, sizeof(uint32_t));
+    tries = (uint64_t *)calloc(inst_num_ops, sizeof(uint64_t));
+    found = (uint64_t *)calloc(inst_num_ops, sizeof(uint64_t));
+    for (i = 0; i < inst_num_ops; i++)
+        weight[i] = W_START;
+
+    if (cases != NULL) {
+        fprintf(cases, "/* Generated by fuzz -m %s -s %llu, include after the "
+                       "test helpers */\n", model->name, (unsigned long long)seed);
+    }
+    model->init();
+    for (n = 0; n < ncase; n++)
+        run_case(n);
+    report(rep);
+    if (cases != NULL)
+        fclose(cases);
+    if (rep != stdout)
+        fclose(rep);
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * microsim360 - Random S/360 instruction generator.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "inst_gen.h"
+
+struct inst_op inst_ops[] = {
+    { 0x04, C_FIX, F_RR, "SPM" },  { 0x05, C_BR,  F_RR, "BALR" },
+    { 0x06, C_BR,  F_RR, "BCTR" }, { 0x07, C_BR,  F_RR, "BCR" },
+    { 0x10, C_FIX, F_RR, "LPR" },  { 0x11, C_FIX, F_RR, "LNR" },
+    { 0x12, C_FIX, F_RR, "LTR" },  { 0x13, C_FIX, F_RR, "LCR" },
+    { 0x14, C_FIX, F_RR, "NR" },   { 0x15, C_FIX, F_RR, "CLR" },
+    { 0x16, C_FIX, F_RR, "OR" },   { 0x17, C_FIX, F_RR, "XR" },
+    { 0x18, C_FIX, F_RR, "LR" },   { 0x19, C_FIX, F_RR, "CR" },
+    { 0x1A, C_FIX, F_RR, "AR" },   { 0x1B, C_FIX, F_RR, "SR" },
+    { 0x1C, C_FIX, F_RR, "MR" },   { 0x1D, C_FIX, F_RR, "DR" },
+    { 0x1E, C_FIX, F_RR, "ALR" },  { 0x1F, C_FIX, F_RR, "SLR" },
+    { 0x20, C_FLT, F_RR, "LPDR" }, { 0x21, C_FLT, F_RR, "LNDR" },
+    { 0x22, C_FLT, F_RR, "LTDR" }, { 0x23, C_FLT, F_RR, "LCDR" },
+    { 0x24, C_FLT, F_RR, "HDR" },  { 0x28, C_FLT, F_RR, "LDR" },
+    { 0x29, C_FLT, F_RR, "CDR" },  { 0x2A, C_FLT, F_RR, "ADR" },
+    { 0x2B, C_FLT, F_RR, "SDR" },  { 0x2C, C_FLT, F_RR, "MDR" },
+    { 0x2D, C_FLT, F_RR, "DDR" },  { 0x2E, C_FLT, F_RR, "AWR" },
+    { 0x2F, C_FLT, F_RR, "SWR" },  { 0x30, C_FLT, F_RR, "LPER" },
+    { 0x31, C_FLT, F_RR, "LNER" }, { 0x32, C_FLT, F_RR, "LTER" },
+    { 0x33, C_FLT, F_RR, "LCER" }, { 0x34, C_FLT, F_RR, "HER" },
+    { 0x38, C_FLT, F_RR, "LER" },  { 0x39, C_FLT, F_RR, "CER" },
+    { 0x3A, C_FLT, F_RR, "AER" },  { 0x3B, C_FLT, F_RR, "SER" },
+    { 0x3C, C_FLT, F_RR, "MER" },  { 0x3D, C_FLT, F_RR, "DER" },
+    { 0x3E, C_FLT, F_RR, "AUR" },  { 0x3F, C_FLT, F_RR, "SUR" },
+    { 0x40, C_FIX, F_RX, "STH" },  { 0x41, C_FIX, F_RX, "LA" },
+    { 0x42, C_FIX, F_RX, "STC" },  { 0x43, C_FIX, F_RX, "IC" },
+    { 0x45, C_BR,  F_RX, "BAL" },  { 0x46, C_BR,  F_RX, "BCT" },
+    { 0x47, C_BR,  F_RX, "BC" },   { 0x48, C_FIX, F_RX, "LH" },
+    { 0x49, C_FIX, F_RX, "CH" },   { 0x4A, C_FIX, F_RX, "AH" },
+    { 0x4B, C_FIX, F_RX, "SH" },   { 0x4C, C_FIX, F_RX, "MH" },
+    { 0x4E, C_DEC, F_RX, "CVD" },  { 0x4F, C_DEC, F_RX, "CVB" },
+    { 0x50, C_FIX, F_RX, "ST" },   { 0x54, C_FIX, F_RX, "N" },
+    { 0x55, C_FIX, F_RX, "CL" },   { 0x56, C_FIX, F_RX, "O" },
+    { 0x57, C_FIX, F_RX, "X" },    { 0x58, C_FIX, F_RX, "L" },
+    { 0x59, C_FIX, F_RX, "C" },    { 0x5A, C_FIX, F_RX, "A" },
+    { 0x5B, C_FIX, F_RX, "S" },    { 0x5C, C_FIX, F_RX, "M" },
+    { 0x5D, C_FIX, F_RX, "D" },    { 0x5E, C_FIX, F_RX, "AL" },
+    { 0x5F, C_FIX, F_RX, "SL" },   { 0x60, C_FLT, F_RX, "STD" },
+    { 0x68, C_FLT, F_RX, "LD" },   { 0x69, C_FLT, F_RX, "CD" },
+    { 0x6A, C_FLT, F_RX, "AD" },   { 0x6B, C_FLT, F_RX, "SD" },
+    { 0x6C, C_FLT, F_RX, "MD" },   { 0x6D, C_FLT, F_RX, "DD" },
+    { 0x6E, C_FLT, F_RX, "AW" },   { 0x6F, C_FLT, F_RX, "SW" },
+    { 0x70, C_FLT, F_RX, "STE" },  { 0x78, C_FLT, F_RX, "LE" },
+    { 0x79, C_FLT, F_RX, "CE" },   { 0x7A, C_FLT, F_RX, "AE" },
+    { 0x7B, C_FLT, F_RX, "SE" },   { 0x7C, C_FLT, F_RX, "ME" },
+    { 0x7D, C_FLT, F_RX, "DE" },   { 0x7E, C_FLT, F_RX, "AU" },
+    { 0x7F, C_FLT, F_RX, "SU" },
+    { 0x86, C_BR,  F_RS, "BXH" },  { 0x87, C_BR,  F_RS, "BXLE" },
+    { 0x88, C_FIX, F_RS, "SRL" },  { 0x89, C_FIX, F_RS, "SLL" },
+    { 0x8A, C_FIX, F_RS, "SRA" },  { 0x8B, C_FIX, F_RS, "SLA" },
+    { 0x8C, C_FIX, F_RS, "SRDL" }, { 0x8D, C_FIX, F_RS, "SLDL" },
+    { 0x8E, C_FIX, F_RS, "SRDA" }, { 0x8F, C_FIX, F_RS, "SLDA" },
+    { 0x90, C_FIX, F_RS, "STM" },  { 0x91, C_FIX, F_SI, "TM" },
+    { 0x92, C_FIX, F_SI, "MVI" },  { 0x93, C_FIX, F_SI, "TS" },
+    { 0x94, C_FIX, F_SI, "NI" },   { 0x95, C_FIX, F_SI, "CLI" },
+    { 0x96, C_FIX, F_SI, "OI" },   { 0x97, C_FIX, F_SI, "XI" },
+    { 0x98, C_FIX, F_RS, "LM" },
+    { 0xD1, C_FIX, F_SS, "MVN" },  { 0xD2, C_FIX, F_SS, "MVC" },
+    { 0xD3, C_FIX, F_SS, "MVZ" },  { 0xD4, C_FIX, F_SS, "NC" },
+    { 0xD5, C_FIX, F_SS, "CLC" },  { 0xD6, C_FIX, F_SS, "OC" },
+    { 0xD7, C_FIX, F_SS, "XC" },   { 0xDC, C_FIX, F_SS, "TR" },
+    { 0xDD, C_FIX, F_SS, "TRT" },  { 0xDE, C_DEC, F_SS, "ED" },
+    { 0xDF, C_DEC, F_SS, "EDMK" },
+    { 0xF1, C_DEC, F_SS, "MVO" },  { 0xF2, C_DEC, F_SS, "PACK" },
+    { 0xF3, C_DEC, F_SS, "UNPK" }, { 0xF8, C_DEC, F_SS, "ZAP" },
+    { 0xF9, C_DEC, F_SS, "CP" },   { 0xFA, C_DEC, F_SS, "AP" },
+    { 0xFB, C_DEC, F_SS, "SP" },   { 0xFC, C_DEC, F_SS, "MP" },
+    { 0xFD, C_DEC, F_SS, "DP" },
+};
+
+int inst_num_ops = (int)(sizeof(inst_ops) / sizeof(struct inst_op));
+
+uint64_t
+inst_rand(uint64_t *r)
+{
+    *r ^= *r << 13;
+    *r ^= *r >> 7;
+    *r ^= *r << 17;
+    return *r;
+}
+
+int
+inst_length(uint8_t op)
+{
+    return (op < 0x40) ? 2 : (op < 0xC0) ? 4 : 6;
+}
+
+struct inst_op *
+inst_find(uint8_t op)
+{
+    int     i;
+
+    for (i = 0; i < inst_num_ops; i++) {
+        if (inst_ops[i].op == op)
+            return &inst_ops[i];
+    }
+    return NULL;
+}
+
+int
+inst_gen(uint64_t *r, int classes, uint32_t *weight, uint8_t *p)
+{
+    struct inst_op *op = NULL;
+    uint64_t        total = 0;
+    uint64_t        pick;
+    int             len;
+    int             i;
+
+    if (weight != NULL) {
+        for (i = 0; i < inst_num_ops; i++) {
+            if (inst_ops[i].cls & classes)
+                total += weight[i];
+        }
+    }
+    if (total == 0) {
+        do {
+            op = &inst_ops[inst_rand(r) % inst_num_ops];
+        } while ((op->cls & classes) == 0);
+    } else {
+        pick = inst_rand(r) % total;
+        for (i = 0; i < inst_num_ops; i++) {
+            if ((inst_ops[i].cls & classes) == 0)
+                continue;
+            op = &inst_ops[i];
+            if (pick < weight[i])
+                break;
+            pick -= weight[i];
+        }
+    }
+    p[0] = op->op;
+    len = inst_length(op->op);
+    for (i = 1; i < len; i++) {
+        p[i] = inst_rand(r) & 0xff;
+    }
+    /* Keep SS lengths short so operands stay in data area */
+    if (len == 6 && (op->op & 0xF0) == 0xD0) {
+        p[1] &= 0x3f;
+    }
+    return len;
+}
+
+int
+inst_parse(char *line, uint8_t *p, int max)
+{
+    int     len = 0;
+    int     nib = 0;
+    int     v = 0;
+
+    for (; *line != '\0' && *line != '#'; line++) {
+        if (!isxdigit((unsigned char)*line))
+            continue;
+        v = (v << 4) | (isdigit((unsigned char)*line) ? *line - '0' :
+                         (toupper((unsigned char)*line) - 'A' + 10));
+        if (++nib == 2) {
+            if (len < max)
+                p[len++] = v;
+            nib = v = 0;
+        }
+    }
+    return len;
+}
+
+void
+inst_format(uint8_t *p, char *buf, int len)
+{
+    struct inst_op *op = inst_find(p[0]);
+    int             d1 = ((p[2] & 0xf) << 8) | p[3];
+    int             d2 = ((p[4] & 0xf) << 8) | p[5];
+
+    if (op == NULL) {
+        snprintf(buf, len, "DC X'%02X%02X'", p[0], p[1]);
+        return;
+    }
+    switch (op->fmt) {
+    case F_RR:
+        snprintf(buf, len, "%s %d,%d", op->name, p[1] >> 4, p[1] & 0xf);
+        break;
+    case F_RX:
+        snprintf(buf, len, "%s %d,%d(%d,%d)", op->name, p[1] >> 4, d1,
+                 p[1] & 0xf, p[2] >> 4);
+        break;
+    case F_RS:
+        if (p[0] >= 0x88 && p[0] <= 0x8F) {
+            snprintf(buf, len, "%s %d,%d(%d)", op->name, p[1] >> 4, d1, p[2] >> 4);
+            break;
+        }
+        snprintf(buf, len, "%s %d,%d,%d(%d)", op->name, p[1] >> 4,
+                 p[1] & 0xf, d1, p[2] >> 4);
+        break;
+    case F_SI:
+        snprintf(buf, len, "%s %d(%d),%d", op->name, d1, p[2] >> 4, p[1]);
+        break;
+    case F_SS:
+        if (p[0] < 0xF0) {
+            snprintf(buf, len, "%s %d(%d,%d),%d(%d)", op->name, d1, p[1] + 1,
+                     p[2] >> 4, d2, p[4] >> 4);
+        } else {
+            snprintf(buf, len, "%s %d(%d,%d),%d(%d,%d)", op->name, d1,
+                     (p[1] >> 4) + 1, p[2] >> 4, d2, (p[1] & 0xf) + 1, p[4] >> 4);
+        }
+        break;
+    }
+}
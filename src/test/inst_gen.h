@@ -0,0 +1,76 @@
+/*
+ * microsim360 - Random S/360 instruction generator.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#ifndef _INST_GEN_H_
+#define _INST_GEN_H_
+#include <stdint.h>
+
+/* Instruction classes */
+#define C_FIX           1          /* Fixed point and logical */
+#define C_BR            2          /* Branches */
+#define C_DEC           4          /* Decimal */
+#define C_FLT           8          /* Floating point */
+#define C_ALL           (C_FIX | C_BR | C_DEC | C_FLT)
+
+/* Instruction formats */
+#define F_RR            0
+#define F_RX            1
+#define F_RS            2
+#define F_SI            3
+#define F_SS            4
+
+struct inst_op {
+    uint8_t     op;
+    uint8_t     cls;              /* Instruction class */
+    uint8_t     fmt;              /* Instruction format */
+    const char *name;
+};
+
+/* Problem state instructions, less SVC and EX */
+extern struct inst_op inst_ops[];
+extern int            inst_num_ops;
+
+/* Next random number, xorshift */
+uint64_t inst_rand(uint64_t *r);
+
+/* Length of instruction from opcode */
+int inst_length(uint8_t op);
+
+/* Find opcode in inst_ops, NULL if not there */
+struct inst_op *inst_find(uint8_t op);
+
+/* Generate one random instruction of classes at p, return its length.
+   If weight is not NULL, opcode i is picked in proportion to weight[i]. */
+int inst_gen(uint64_t *r, int classes, uint32_t *weight, uint8_t *p);
+
+/* Parse hex instruction stream, return length */
+int inst_parse(char *line, uint8_t *p, int max);
+
+/* Format instruction at p as assembler into buf */
+void inst_format(uint8_t *p, char *buf, int len);
+
+#endif
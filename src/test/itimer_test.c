@@ -0,0 +1,122 @@
+/*
+ * microsim360 - Interval timer test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ctest.h"
+#include "device.h"
+#include "event.h"
+#include "conf.h"
+#include "itimer.h"
+
+static int  other_fired;
+
+static void
+other_callback(struct _device *unit, void *arg, int iarg)
+{
+    other_fired++;
+}
+
+/* Run n steps, return number of timer ticks seen */
+static int
+timer_steps(int n)
+{
+    int     ticks = 0;
+    int     i;
+
+    timer_event = 0;
+    for (i = 0; i < n; i++) {
+        advance();
+        if (timer_event) {
+            timer_event = 0;
+            ticks++;
+        }
+    }
+    return ticks;
+}
+
+/* Ticks come every period of simulated time */
+CTEST(timer, simulated) {
+    init_event();
+    timer_realtime = 0;
+    timer_rate = 50;
+    timer_start();
+    ASSERT_EQUAL(20000, timer_period());
+    ASSERT_EQUAL(0, timer_steps(19999));
+    ASSERT_EQUAL(1, timer_steps(1));
+    ASSERT_EQUAL(5, timer_steps(100000));
+    timer_stop();
+    ASSERT_EQUAL(0, timer_steps(100000));
+}
+
+/* Stopping leaves other events in place */
+CTEST(timer, stop) {
+    struct _device  dev;
+
+    init_event();
+    other_fired = 0;
+    timer_realtime = 0;
+    timer_rate = 50;
+    add_event(&dev, &other_callback, 10, NULL, 0);
+    timer_start();
+    add_event(&dev, &other_callback, 30000, NULL, 0);
+    timer_stop();
+    ASSERT_EQUAL(0, timer_steps(40000));
+    ASSERT_EQUAL(2, other_fired);
+}
+
+/* 300 Hz ticks */
+CTEST(timer, rate300) {
+    init_event();
+    timer_realtime = 0;
+    timer_rate = 300;
+    timer_start();
+    ASSERT_EQUAL(3333, timer_period());
+    ASSERT_EQUAL(30, timer_steps(30 * 3333));
+    timer_stop();
+    timer_rate = 50;
+}
+
+/* Wall clock ticks leave the event queue alone */
+CTEST(timer, realtime) {
+    init_event();
+    timer_realtime = 1;
+    timer_start();
+    ASSERT_EQUAL(0, timer_steps(100000));
+    timer_stop();
+    timer_realtime = 0;
+}
+
+/* Configuration line */
+CTEST(timer, config) {
+    ASSERT_TRUE(load_line("timer rate=300 realtime"));
+    ASSERT_EQUAL(300, timer_rate);
+    ASSERT_EQUAL(1, timer_realtime);
+    ASSERT_FALSE(load_line("timer rate=60"));
+    ASSERT_EQUAL(300, timer_rate);
+    timer_rate = 50;
+    timer_realtime = 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * microsim360 - Input journal test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ctest.h"
+#include "machine.h"
+#include "journal.h"
+
+extern MACHINE_LOCAL uint64_t step_count;
+
+static uint8_t   sw8;
+static uint32_t  sw32;
+
+/* Panel changes at steps 3 and 7, a key at step 5 */
+static void
+record_run(const char *name)
+{
+    sw8 = 0;
+    sw32 = 0;
+    journal_watch("SW8", &sw8, sizeof(sw8));
+    journal_watch("SW32", &sw32, sizeof(sw32));
+    journal_record(name);
+    for (step_count = 1; step_count <= 10; step_count++) {
+        if (step_count == 3 || step_count == 7) {
+            journal_mark();
+            sw8++;
+            sw32 += 0x10000;
+            journal_changed = 1;
+        }
+        journal_step();
+        if (step_count == 5)
+            journal_input("KEY", 'A');
+    }
+    journal_close();
+}
+
+/* Inputs come back at the steps they were taken */
+CTEST(journal, replay) {
+    char      name[] = "journal_test.jnl";
+    uint8_t   s8[11];
+    uint32_t  s32[11];
+    uint32_t  v;
+    int       key = 0;
+
+    record_run(name);
+    sw8 = 0;
+    sw32 = 0;
+    ASSERT_TRUE(journal_replay(name));
+    for (step_count = 1; step_count <= 10; step_count++) {
+        journal_step();
+        s8[step_count] = sw8;
+        s32[step_count] = sw32;
+        if (journal_next("KEY", &v)) {
+            ASSERT_EQUAL('A', v);
+            ASSERT_EQUAL(5, (int)step_count);
+            key++;
+        }
+    }
+    journal_close();
+    ASSERT_EQUAL(1, key);
+    ASSERT_EQUAL(0, s8[2]);
+    ASSERT_EQUAL(1, s8[3]);
+    ASSERT_EQUAL(1, s8[6]);
+    ASSERT_EQUAL(2, s8[7]);
+    ASSERT_EQUAL_X(0x10000, s32[3]);
+    ASSERT_EQUAL_X(0x20000, s32[10]);
+    remove(name);
+}
+
+/* Machine clearing a switch does not hide the panel setting it again */
+CTEST(journal, reset) {
+    char      name[] = "journal_reset.jnl";
+
+    sw8 = 0;
+    journal_watch("SW8", &sw8, sizeof(sw8));
+    journal_record(name);
+    for (step_count = 1; step_count <= 6; step_count++) {
+        if (step_count == 2 || step_count == 4) {
+            journal_mark();
+            sw8 = 1;
+            journal_changed = 1;
+        }
+        journal_step();
+        sw8 = 0;
+    }
+    journal_close();
+    ASSERT_TRUE(journal_replay(name));
+    for (step_count = 1; step_count <= 6; step_count++) {
+        journal_step();
+        ASSERT_EQUAL((step_count == 2 || step_count == 4), sw8);
+        sw8 = 0;
+    }
+    journal_close();
+    remove(name);
+}
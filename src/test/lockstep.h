@@ -0,0 +1,76 @@
+/*
+ * microsim360 - Lockstep compare of CPU models.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#ifndef _LOCKSTEP_H_
+#define _LOCKSTEP_H_
+#include <stdint.h>
+
+#define LS_MEM_SIZE     (64 * 1024)    /* Storage compared */
+#define LS_ROS_SIZE     4096           /* Control store words */
+
+/* Bitmap of ROS words executed by step, set by the models and cleared
+   by whoever wants coverage */
+extern uint8_t lockstep_cover[LS_ROS_SIZE / 8];
+
+#define LS_COVER(a)     lockstep_cover[((a) & (LS_ROS_SIZE - 1)) >> 3] |= \
+                                       1 << ((a) & 7)
+
+/*
+ * Architected state of the CPU between instructions, in a form
+ * common to all models.
+ */
+struct lockstep_state {
+    uint32_t    gpr[16];        /* General registers */
+    uint64_t    fpr[4];         /* Floating point registers 0,2,4,6 */
+    uint32_t    ia;             /* Next instruction address */
+    uint8_t     cc;             /* Condition code 0-3 */
+    uint8_t     pm;             /* Program mask */
+    uint8_t     trap;           /* Program interrupt taken */
+    uint8_t     hung;           /* Did not reach end of instruction */
+};
+
+/*
+ * Interface each model provides to the lockstep runner.  A model runs in
+ * its own process, so these can use the model globals freely.
+ */
+struct lockstep_model {
+    const char *name;
+    /* Configure model and reset the CPU */
+    void      (*init)(void);
+    /* Load registers, storage is len bytes from 0 */
+    void      (*load)(struct lockstep_state *st, uint8_t *mem, int len);
+    /* Execute instruction at st->ia, then save state back into st */
+    void      (*step)(struct lockstep_state *st);
+    /* Copy len bytes of storage from 0 into mem */
+    void      (*save_mem)(uint8_t *mem, int len);
+    /* Note of ROS word, NULL if word is not used */
+    const char *(*note)(int addr);
+};
+
+extern struct lockstep_model lockstep_2030;
+extern struct lockstep_model lockstep_2050;
+
+#endif
@@ -0,0 +1,488 @@
+/*
+ * microsim360 - Lockstep compare of 2030 and 2050 microcode.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+/*
+ * Runs the same instruction streams on the 2030 and 2050 models and
+ * compares the architected state after every instruction: general and
+ * floating point registers, condition code, program mask, next
+ * instruction address, program interrupts and storage.
+ *
+ *   lockstep [-j pairs] [-n cases] [-i insts] [-s seed] [-c case]
+ *            [-F] [-B] [-f file] [-v]
+ *
+ * -F adds floating point instructions, -B leaves out branches.  Cases
+ * end at the first program interrupt or when the stream is left.
+ *
+ * Both models use the same globals (M, chan[], the panel switches), and
+ * only one CPU can be configured per process.  So each model runs in its
+ * own process, stepped one instruction at a time over a pipe.  With -j
+ * several pairs run at once, each taking every jobs'th case.
+ *
+ * Every case is built from the seed and its number, -c runs just one
+ * case so a divergence can be reproduced.  With -f each line of file
+ * holds the hex bytes of an instruction stream to run instead of random
+ * instructions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "lockstep.h"
+#include "inst_gen.h"
+#include "machine.h"
+
+#define PROG_ADDR       0x400      /* Where instruction stream is placed */
+#define PROG_MAX        0x300      /* Largest stream */
+#define TRAP_ADDR       0x700      /* Program new PSW instruction address */
+#define DATA_ADDR       0x1000     /* Operands are placed here */
+#define DATA_SIZE       0x7000
+#define MAX_DELTA       16         /* Storage changes kept for report */
+
+#define CMD_LOAD        1
+#define CMD_STEP        2
+
+struct _cmd {
+    int                    cmd;
+    struct lockstep_state  st;
+};
+
+struct _delta {
+    uint32_t   addr;
+    uint8_t    data;
+};
+
+struct _reply {
+    struct lockstep_state  st;
+    uint64_t               hash;            /* Hash of changes */
+    int                    num;             /* Number of bytes changed */
+    struct _delta          delta[MAX_DELTA];
+};
+
+/* Results of one pair, sent back to main process */
+struct _total {
+    uint64_t   cases;
+    uint64_t   insts;
+    uint64_t   diverge;
+};
+
+struct _model {
+    struct lockstep_model *model;
+    pid_t                  pid;
+    int                    cmd;             /* Pipe to model */
+    int                    reply;           /* Pipe from model */
+    struct _reply          r;
+};
+
+MACHINE_LOCAL uint64_t         step_count;                /* Used by logger */
+uint8_t          lockstep_cover[LS_ROS_SIZE / 8];
+
+static int       ninst = 16;
+static int       classes = C_FIX | C_BR | C_DEC;
+static int       verbose = 0;
+static uint64_t  seed = 1;
+static char    **streams = NULL;            /* Recorded streams */
+static int       nstreams = 0;
+
+static uint8_t   mem[LS_MEM_SIZE];
+
+static int
+read_all(int fd, void *buf, size_t len)
+{
+    char    *p = (char *)buf;
+    ssize_t  n;
+
+    while (len > 0) {
+        if ((n = read(fd, p, len)) <= 0)
+            return 0;
+        p += n;
+        len -= n;
+    }
+    return 1;
+}
+
+static int
+write_all(int fd, void *buf, size_t len)
+{
+    char    *p = (char *)buf;
+    ssize_t  n;
+
+    while (len > 0) {
+        if ((n = write(fd, p, len)) <= 0)
+            return 0;
+        p += n;
+        len -= n;
+    }
+    return 1;
+}
+
+/*
+ * Model process. Loads cases and steps instructions as told, replying
+ * with the state and storage changes after each.
+ */
+static void
+model_main(struct lockstep_model *model, int cmd, int reply)
+{
+    static uint8_t  last[LS_MEM_SIZE];
+    static uint8_t  now[LS_MEM_SIZE];
+    struct _cmd     c;
+    struct _reply   r;
+    int             i;
+
+    model->init();
+    while (read_all(cmd, &c, sizeof(c))) {
+        if (c.cmd == CMD_LOAD) {
+            if (!read_all(cmd, last, sizeof(last)))
+                break;
+            model->load(&c.st, last, sizeof(last));
+            model->save_mem(last, sizeof(last));
+            continue;
+        }
+        memset(&r, 0, sizeof(r));
+        r.hash = 0xcbf29ce484222325ULL;
+        r.st = c.st;
+        model->step(&r.st);
+        model->save_mem(now, sizeof(now));
+        /* Both start with the same storage, so comparing the changes
+           compares storage.  Interval timer is left out. */
+        for (i = 0; i < LS_MEM_SIZE; i++) {
+            if (now[i] == last[i] || (i >= 0x50 && i < 0x54))
+                continue;
+            r.hash = (r.hash ^ (uint64_t)((i << 8) | now[i])) * 0x100000001b3ULL;
+            if (r.num < MAX_DELTA) {
+                r.delta[r.num].addr = i;
+                r.delta[r.num].data = now[i];
+            }
+            r.num++;
+        }
+        memcpy(last, now, sizeof(last));
+        if (!write_all(reply, &r, sizeof(r)))
+            break;
+    }
+    _exit(0);
+}
+
+/* Start model process, other is a model already started or NULL */
+static int
+start_model(struct _model *m, struct lockstep_model *model, struct _model *other)
+{
+    int     cmd[2];
+    int     reply[2];
+
+    m->model = model;
+    if (pipe(cmd) < 0 || pipe(reply) < 0)
+        return 0;
+    if ((m->pid = fork()) < 0)
+        return 0;
+    if (m->pid == 0) {
+        close(cmd[1]);
+        close(reply[0]);
+        /* Else other model would not see end of file */
+        if (other != NULL) {
+            close(other->cmd);
+            close(other->reply);
+        }
+        model_main(model, cmd[0], reply[1]);
+    }
+    close(cmd[0]);
+    close(reply[1]);
+    m->cmd = cmd[1];
+    m->reply = reply[0];
+    return 1;
+}
+
+static void
+stop_model(struct _model *m)
+{
+    close(m->cmd);
+    close(m->reply);
+    waitpid(m->pid, NULL, 0);
+}
+
+/* Build case number n into storage and st */
+static int
+make_case(uint64_t n, struct lockstep_state *st)
+{
+    uint64_t  r = (seed * 0x9E3779B97F4A7C15ULL) ^ (n + 1);
+    int       len = 0;
+    int       i;
+
+    if (r == 0)
+       r = 1;
+    for (i = 0; i < 4; i++)
+       inst_rand(&r);
+    memset(mem, 0, sizeof(mem));
+    memset(st, 0, sizeof(*st));
+    for (i = DATA_ADDR; i < DATA_ADDR + DATA_SIZE; i++) {
+       mem[i] = inst_rand(&r) & 0xff;
+    }
+    /* Program new PSW, stop at 0 if taken */
+    mem[0x6e] = (TRAP_ADDR >> 8) & 0xff;
+    mem[0x6f] = TRAP_ADDR & 0xff;
+
+    if (streams != NULL) {
+        len = inst_parse(streams[n % nstreams], &mem[PROG_ADDR], PROG_MAX);
+    } else {
+        for (i = 0; i < ninst && len < (PROG_MAX - 6); i++) {
+            len += inst_gen(&r, classes, NULL, &mem[PROG_ADDR + len]);
+        }
+    }
+
+    /* Mostly point registers into data area */
+    for (i = 0; i < 16; i++) {
+        if ((inst_rand(&r) & 3) == 0) {
+            st->gpr[i] = (uint32_t)inst_rand(&r);
+        } else {
+            st->gpr[i] = DATA_ADDR + (inst_rand(&r) % 0x3000);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        st->fpr[i] = inst_rand(&r);
+    }
+    st->cc = inst_rand(&r) & 3;
+    st->pm = inst_rand(&r) & 0xf;
+    st->ia = PROG_ADDR;
+    return len;
+}
+
+static void
+print_state(const char *name, struct _reply *r)
+{
+    int     i;
+
+    printf("  %s: IA=%06x CC=%d PM=%x%s%s storage %d changed\n", name,
+           r->st.ia, r->st.cc, r->st.pm, r->st.trap ? " trap" : "",
+           r->st.hung ? " hung" : "", r->num);
+    for (i = 0; i < 16; i++) {
+        printf("%s%08x", ((i & 7) == 0) ? "   " : " ", r->st.gpr[i]);
+        if ((i & 7) == 7)
+            printf("\n");
+    }
+    printf("   FP %016llx %016llx %016llx %016llx\n",
+           (unsigned long long)r->st.fpr[0], (unsigned long long)r->st.fpr[1],
+           (unsigned long long)r->st.fpr[2], (unsigned long long)r->st.fpr[3]);
+    for (i = 0; i < r->num && i < MAX_DELTA; i++) {
+        printf("%s%06x=%02x", ((i & 7) == 0) ? "   " : " ",
+               r->delta[i].addr, r->delta[i].data);
+        if ((i & 7) == 7 || (i + 1) == r->num || (i + 1) == MAX_DELTA)
+            printf("\n");
+    }
+}
+
+/* Compare replies, return 1 if they match */
+static int
+same_state(struct _reply *a, struct _reply *b)
+{
+    if (memcmp(a->st.gpr, b->st.gpr, sizeof(a->st.gpr)) != 0)
+        return 0;
+    if (memcmp(a->st.fpr, b->st.fpr, sizeof(a->st.fpr)) != 0)
+        return 0;
+    return a->st.ia == b->st.ia && a->st.cc == b->st.cc &&
+           a->st.pm == b->st.pm && a->st.trap == b->st.trap &&
+           a->st.hung == b->st.hung && a->hash == b->hash;
+}
+
+/* Run one case on both models, return 0 if they diverged */
+static int
+run_case(struct _model *m, uint64_t n, struct _total *tot)
+{
+    struct lockstep_state  st;
+    struct _cmd            c;
+    uint32_t               ia;
+    int                    len;
+    int                    done = 0;
+    int                    i, j;
+
+    len = make_case(n, &st);
+    c.cmd = CMD_LOAD;
+    c.st = st;
+    for (i = 0; i < 2; i++) {
+        if (!write_all(m[i].cmd, &c, sizeof(c)) ||
+            !write_all(m[i].cmd, mem, sizeof(mem)))
+            return 0;
+    }
+    tot->cases++;
+    for (j = 0; j < len; j++) {
+        ia = st.ia;
+        c.cmd = CMD_STEP;
+        c.st = st;
+        for (i = 0; i < 2; i++) {
+            if (!write_all(m[i].cmd, &c, sizeof(c)))
+                return 0;
+        }
+        for (i = 0; i < 2; i++) {
+            if (!read_all(m[i].reply, &m[i].r, sizeof(m[i].r)))
+                return 0;
+        }
+        tot->insts++;
+        done++;
+        if (!same_state(&m[0].r, &m[1].r)) {
+            printf("Case %llu seed %llu instruction %d at %06x: %02x%02x",
+                   (unsigned long long)n, (unsigned long long)seed, j, ia,
+                   mem[ia & 0xffff], mem[(ia + 1) & 0xffff]);
+            if (mem[ia & 0xffff] >= 0x40)
+                printf("%02x%02x", mem[(ia + 2) & 0xffff], mem[(ia + 3) & 0xffff]);
+            if (mem[ia & 0xffff] >= 0xC0)
+                printf("%02x%02x", mem[(ia + 4) & 0xffff], mem[(ia + 5) & 0xffff]);
+            printf("\n");
+            print_state(m[0].model->name, &m[0].r);
+            print_state(m[1].model->name, &m[1].r);
+            fflush(stdout);
+            return 0;
+        }
+        st = m[0].r.st;
+        /* Stop on interrupt, or leaving the stream */
+        if (st.trap || st.hung || st.ia < PROG_ADDR || st.ia >= (uint32_t)(PROG_ADDR + len))
+            break;
+    }
+    if (verbose) {
+        printf("Case %llu ok, %d instructions\n", (unsigned long long)n, done);
+    }
+    return 1;
+}
+
+/* Run every jobs'th case from first on a pair of models */
+static void
+run_pair(uint64_t first, uint64_t ncase, int jobs, struct _total *tot)
+{
+    struct _model   m[2];
+    uint64_t        n;
+
+    memset(tot, 0, sizeof(*tot));
+    fflush(stdout);
+    if (!start_model(&m[0], &lockstep_2030, NULL) ||
+        !start_model(&m[1], &lockstep_2050, &m[0])) {
+        fprintf(stderr, "Unable to start models\n");
+        exit(1);
+    }
+    for (n = first; n < ncase; n += jobs) {
+        if (!run_case(m, n, tot))
+            tot->diverge++;
+    }
+    stop_model(&m[0]);
+    stop_model(&m[1]);
+}
+
+static void
+read_streams(const char *name)
+{
+    FILE   *f;
+    char    line[2048];
+    uint8_t p[PROG_MAX];
+
+    if ((f = fopen(name, "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s\n", name);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (inst_parse(line, p, sizeof(p)) == 0)
+            continue;
+        streams = (char **)realloc(streams, (nstreams + 1) * sizeof(char *));
+        streams[nstreams++] = strdup(line);
+    }
+    fclose(f);
+    if (nstreams == 0) {
+        fprintf(stderr, "No instruction streams in %s\n", name);
+        exit(1);
+    }
+}
+
+int
+main(int argc, const char *argv[])
+{
+    struct _total   tot, t;
+    uint64_t        ncase = 1000;
+    int64_t         one = -1;
+    int             jobs = 1;
+    int             res[2];
+    pid_t          *pid;
+    int             i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "-F") == 0) {
+            classes |= C_FLT;
+        } else if (strcmp(argv[i], "-B") == 0) {
+            classes &= ~C_BR;
+        } else if ((i + 1) < argc && strcmp(argv[i], "-j") == 0) {
+            jobs = atoi(argv[++i]);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-n") == 0) {
+            ncase = strtoull(argv[++i], NULL, 0);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-i") == 0) {
+            ninst = atoi(argv[++i]);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-s") == 0) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-c") == 0) {
+            one = strtoll(argv[++i], NULL, 0);
+        } else if ((i + 1) < argc && strcmp(argv[i], "-f") == 0) {
+            read_streams(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [-j pairs] [-n cases] [-i insts] [-s seed] "
+                            "[-c case] [-F] [-B] [-f file] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (jobs < 1)
+        jobs = 1;
+    if (ninst < 1)
+        ninst = 1;
+
+    if (one >= 0) {
+        run_pair(one, one + 1, 1, &tot);
+    } else if (jobs == 1) {
+        run_pair(0, ncase, 1, &tot);
+    } else {
+        /* Each pair sends its totals back when done */
+        memset(&tot, 0, sizeof(tot));
+        if (pipe(res) < 0)
+            return 1;
+        pid = (pid_t *)calloc(jobs, sizeof(pid_t));
+        fflush(stdout);
+        for (i = 0; i < jobs; i++) {
+            if ((pid[i] = fork()) == 0) {
+                close(res[0]);
+                run_pair(i, ncase, jobs, &t);
+                write_all(res[1], &t, sizeof(t));
+                _exit(0);
+            }
+        }
+        close(res[1]);
+        while (read_all(res[0], &t, sizeof(t))) {
+            tot.cases += t.cases;
+            tot.insts += t.insts;
+            tot.diverge += t.diverge;
+        }
+        for (i = 0; i < jobs; i++)
+            waitpid(pid[i], NULL, 0);
+        free(pid);
+    }
+    printf("RESULTS: %llu cases, %llu instructions, %llu diverged\n",
+           (unsigned long long)tot.cases, (unsigned long long)tot.insts,
+           (unsigned long long)tot.diverge);
+    return tot.diverge != 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * microsim360 - Performance counter test cases.
+ *
+ * Copyright 2025, Richard Cornwell
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ctest.h"
+#include "device.h"
+#include "event.h"
+#include "stats.h"
+
+extern MACHINE_LOCAL uint64_t   step_count;
+
+static void
+stats_callback(struct _device *unit, void *arg, int iarg)
+{
+}
+
+/* Events scheduled and fired are counted */
+CTEST(stats, events) {
+    struct _device  dev;
+    uint64_t        added = stats.events_added;
+    uint64_t        fired = stats.events_fired;
+    int             i;
+
+    add_event(&dev, &stats_callback, 5, NULL, 0);
+    add_event(&dev, &stats_callback, 0, NULL, 0);
+    for (i = 0; i < 10; i++)
+        advance();
+    ASSERT_EQUAL(2, stats.events_added - added);
+    ASSERT_EQUAL(2, stats.events_fired - fired);
+}
+
+/* One byte per raise of service out in answer to service in */
+CTEST(stats, channel) {
+    uint64_t        bytes = stats.chan_bytes[1];
+
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN|CHAN_SRV_IN);
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN|CHAN_SRV_IN|CHAN_SRV_OUT);
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN|CHAN_SRV_IN|CHAN_SRV_OUT);
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN|CHAN_SRV_OUT);
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN|CHAN_SRV_IN);
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN|CHAN_SRV_IN|CHAN_SRV_OUT);
+    /* Status in is not data */
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN);
+    STATS_CHAN(1, CHAN_OPR_OUT|CHAN_OPR_IN|CHAN_STA_IN|CHAN_SRV_OUT);
+    ASSERT_EQUAL(2, stats.chan_bytes[1] - bytes);
+}
+
+/* Counters are written as name and value */
+CTEST(stats, save) {
+    FILE           *f;
+    char            line[128];
+    int             found_cycles = 0;
+    int             found_chan = 0;
+    int             found_lines = 0;
+
+    stats_file = "stats.out";
+    step_count = 1234;
+    stats.lines_printed = 42;
+    stats.chan_bytes[2] = 7;
+    ASSERT_TRUE(stats_save());
+    stats_file = NULL;
+    f = fopen("stats.out", "r");
+    ASSERT_NOT_NULL(f);
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strcmp(line, "cycles 1234\n") == 0)
+            found_cycles = 1;
+        if (strcmp(line, "chan_bytes 2 7\n") == 0)
+            found_chan = 1;
+        if (strcmp(line, "lines_printed 42\n") == 0)
+            found_lines = 1;
+    }
+    fclose(f);
+    (void)remove("stats.out");
+    ASSERT_TRUE(found_cycles);
+    ASSERT_TRUE(found_chan);
+    ASSERT_TRUE(found_lines);
+}
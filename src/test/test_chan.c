@@ -507,7 +507,7 @@ start_io(uint8_t device, uint16_t caw, int sel, int halt)
                  /* Wait for oper in to drop */
                  if ((tags_in & CHAN_OPR_IN) == 0) {
                      tags &= ~(CHAN_SEL_OUT|CHAN_HLD_OUT);
-                     dly = 50;
+                     dly = 10;     /* Chain inside the 2311 count gap */
                      chan_clk = 0; /* Go start next command */
                      break;
                  }